@@ -117,18 +117,20 @@ class ViewHandler(webapp.RequestHandler):
     self.response.out.write(template.render('subscriber.html', context))
 
 
+# Keys of each item in the /items output, escaped once for all requests.
+encode_items = simplejson.JSONEncoder().record_encoder(
+    ('time', 'title', 'content', 'source'))
+
+
 class ItemsHandler(webapp.RequestHandler):
   """Gets the items."""
 
   def get(self):
-    encoder = simplejson.JSONEncoder()
     stuff = []
     for update in SomeUpdate.gql('ORDER BY updated DESC').fetch(10):
-      stuff.append({'time': str(update.updated),
-                    'title': update.title,
-                    'content': update.content,
-                    'source': update.link})
-    self.response.out.write(encoder.encode(stuff))
+      stuff.append((str(update.updated), update.title, update.content,
+                    update.link))
+    self.response.out.write(encode_items(stuff))
 
 
 application = webapp.WSGIApplication(
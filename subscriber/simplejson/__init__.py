@@ -103,17 +103,17 @@ is a subset of YAML, so it may be used as a serializer for that as well.
 """
 __version__ = '2.0.1'
 __all__ = [
-    'dump', 'dumps', 'load', 'loads',
+    'dump', 'dumps', 'load', 'loads', 'validate', 'minify',
     'JSONDecoder', 'JSONEncoder',
 ]
 
 if __name__ == '__main__':
     import warnings
     warnings.warn('python -msimplejson is deprecated, use python -msiplejson.tool', DeprecationWarning)
-    from simplejson.decoder import JSONDecoder
+    from simplejson.decoder import JSONDecoder, validate, minify
     from simplejson.encoder import JSONEncoder
 else:
-    from decoder import JSONDecoder
+    from decoder import JSONDecoder, validate, minify
     from encoder import JSONEncoder
 
 _default_encoder = JSONEncoder(
@@ -132,7 +132,8 @@ def dump(obj, fp, skipkeys=False, ensure_ascii=True, check_circular=True,
         encoding='utf-8', default=None, **kw):
     """
     Serialize ``obj`` as a JSON formatted stream to ``fp`` (a
-    ``.write()``-supporting file-like object).
+    ``.write()``-supporting file-like object, or an integer file
+    descriptor which is written UTF-8 encoded bytes).
 
     If ``skipkeys`` is ``True`` then ``dict`` keys that are not basic types
     (``str``, ``unicode``, ``int``, ``long``, ``float``, ``bool``, ``None``) 
@@ -175,18 +176,14 @@ def dump(obj, fp, skipkeys=False, ensure_ascii=True, check_circular=True,
         check_circular is True and allow_nan is True and
         cls is None and indent is None and separators is None and
         encoding == 'utf-8' and default is None and not kw):
-        iterable = _default_encoder.iterencode(obj)
+        _default_encoder.dump(obj, fp)
     else:
         if cls is None:
             cls = JSONEncoder
-        iterable = cls(skipkeys=skipkeys, ensure_ascii=ensure_ascii,
+        cls(skipkeys=skipkeys, ensure_ascii=ensure_ascii,
             check_circular=check_circular, allow_nan=allow_nan, indent=indent,
             separators=separators, encoding=encoding,
-            default=default, **kw).iterencode(obj)
-    # could accelerate with writelines in some versions of Python, at
-    # a debuggability cost
-    for chunk in iterable:
-        fp.write(chunk)
+            default=default, **kw).dump(obj, fp)
 
 
 def dumps(obj, skipkeys=False, ensure_ascii=True, check_circular=True,
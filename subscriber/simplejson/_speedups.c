@@ -1,5 +1,6 @@
 #include "Python.h"
 #include "structmember.h"
+#include "datetime.h"
 #if PY_VERSION_HEX < 0x02060000 && !defined(Py_TYPE)
 #define Py_TYPE(ob)     (((PyObject*)(ob))->ob_type)
 #endif
@@ -17,15 +18,69 @@ typedef int Py_ssize_t;
 #define UNUSED
 #endif
 
+/* SSE2 is part of the x86-64 baseline, AVX2 is selected at runtime */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JSON_HAVE_SSE2 1
+#include <emmintrin.h>
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#define JSON_HAVE_AVX2 1
+#define JSON_TARGET_AVX2 __attribute__((__target__("avx2")))
+#include <immintrin.h>
+#endif
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include <float.h>
+#include <errno.h>
+#ifdef MS_WINDOWS
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+typedef unsigned PY_LONG_LONG JSON_UINT64;
+#include "_speedups_pow5.h"
+
+/* double arithmetic is exactly rounded (no x87 extended precision) */
+#if (defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0) || defined(_M_X64)
+#define JSON_EXACT_DOUBLE_ARITH 1
+#endif
+
+/* numbers up to this many characters are parsed from a stack copy */
+#define JSON_NUMBER_INLINE 64
+
 #define DEFAULT_ENCODING "utf-8"
 
 #define PyScanner_Check(op) PyObject_TypeCheck(op, &PyScannerType)
 #define PyScanner_CheckExact(op) (Py_TYPE(op) == &PyScannerType)
 #define PyEncoder_Check(op) PyObject_TypeCheck(op, &PyEncoderType)
 #define PyEncoder_CheckExact(op) (Py_TYPE(op) == &PyEncoderType)
+#define PyPushParser_Check(op) PyObject_TypeCheck(op, &PyPushParserType)
+#define PyLazyDocument_Check(op) PyObject_TypeCheck(op, &PyLazyDocumentType)
+#define PyLineReader_Check(op) PyObject_TypeCheck(op, &PyLineReaderType)
+#define PyRecordEncoder_Check(op) PyObject_TypeCheck(op, &PyRecordEncoderType)
 
 static PyTypeObject PyScannerType;
 static PyTypeObject PyEncoderType;
+static PyTypeObject PyPushParserType;
+static PyTypeObject PyLazyDocumentType;
+static PyTypeObject PyLineReaderType;
+static PyTypeObject PyRecordEncoderType;
+
+/* Object keys without escapes are memoized by their raw text so repeated
+   keys share one object.  JSON_MEMO_SIZE must be a power of two, and the
+   table stops taking new keys at JSON_MEMO_MAX entries. */
+#define JSON_MEMO_SIZE 512
+#define JSON_MEMO_MAX 384
+
+typedef struct _JSON_MemoEntry {
+    long hash;
+    PyObject *raw;
+    PyObject *key;
+    Py_ssize_t field;
+} JSON_MemoEntry;
 
 typedef struct _PyScannerObject {
     PyObject_HEAD
@@ -35,6 +90,14 @@ typedef struct _PyScannerObject {
     PyObject *parse_float;
     PyObject *parse_int;
     PyObject *parse_constant;
+    PyObject *record_type;
+    PyObject *record_fields;
+    PyObject *record_index;
+    PyObject *record_index_str;
+    PyObject *record_names_str;
+    JSON_MemoEntry *memo;
+    Py_ssize_t memo_len;
+    Py_ssize_t max_depth;
 } PyScannerObject;
 
 static PyMemberDef scanner_members[] = {
@@ -44,9 +107,23 @@ static PyMemberDef scanner_members[] = {
     {"parse_float", T_OBJECT, offsetof(PyScannerObject, parse_float), READONLY, "parse_float"},
     {"parse_int", T_OBJECT, offsetof(PyScannerObject, parse_int), READONLY, "parse_int"},
     {"parse_constant", T_OBJECT, offsetof(PyScannerObject, parse_constant), READONLY, "parse_constant"},
+    {"record_type", T_OBJECT, offsetof(PyScannerObject, record_type), READONLY, "record_type"},
+    {"record_fields", T_OBJECT, offsetof(PyScannerObject, record_fields), READONLY, "record_fields"},
+    {"max_depth", T_PYSSIZET, offsetof(PyScannerObject, max_depth), READONLY, "max_depth"},
     {NULL}
 };
 
+/* Which builtin string encoder the encoder was given, if any */
+#define FAST_ENCODE_NONE 0
+#define FAST_ENCODE_ASCII 1
+#define FAST_ENCODE_UNICODE 2
+
+/*
+The encoder only holds settings.  The state of an encoding (buffer and
+open containers) lives in the call, so JSONEncoder makes one encoder per
+configuration and shares it between threads and reentrant calls from
+default.  markers is only tested against None.
+*/
 typedef struct _PyEncoderObject {
     PyObject_HEAD
     PyObject *markers;
@@ -57,10 +134,138 @@ typedef struct _PyEncoderObject {
     PyObject *item_separator;
     PyObject *sort_keys;
     PyObject *skipkeys;
+    Py_ssize_t indent_width;
+    Py_ssize_t markers_depth;
+    int sort_keys_flag;
     int fast_encode;
     int allow_nan;
+    PyObject *decimal_type;
+    int use_datetime;
+    int use_set;
 } PyEncoderObject;
 
+/* Parse states of the push parser, see push_parser_scan */
+#define PUSH_VALUE 0
+#define PUSH_STRING 1
+#define PUSH_ESCAPE 2
+#define PUSH_TOKEN 3
+#define PUSH_NESTED 4
+#define PUSH_ERROR 5
+
+/* What items mode accepts next at the level of the outer array */
+#define PUSH_EXPECT_OPEN 0
+#define PUSH_EXPECT_FIRST 1
+#define PUSH_EXPECT_VALUE 2
+#define PUSH_EXPECT_DELIMITER 3
+#define PUSH_EXPECT_END 4
+
+typedef struct _PyPushParserObject {
+    PyObject_HEAD
+    PyObject *scanner;
+    char *buf;
+    Py_ssize_t len;
+    Py_ssize_t size;
+    Py_ssize_t pos;
+    Py_ssize_t start;
+    Py_ssize_t offset;
+    Py_ssize_t depth;
+    int items;
+    int state;
+    int expect;
+    int running;
+    PyObject *err_type;
+    PyObject *err_value;
+} PyPushParserObject;
+
+/*
+Tape of a lazy document: one entry per value and object key in document
+order.  next is the tape index just past the entry and its children, so
+a container's members are walked by following next.
+*/
+typedef struct {
+    Py_ssize_t start;
+    Py_ssize_t end;
+    Py_ssize_t next;
+} JSON_TapeEntry;
+
+typedef struct _PyLazyDocumentObject {
+    PyObject_HEAD
+    PyObject *root;
+    PyObject *pystr;
+    PyObject *scanner;
+    const char *cstr;
+    const Py_UNICODE *ustr;
+    Py_ssize_t len;
+    JSON_TapeEntry *tape;
+    Py_ssize_t tape_len;
+    Py_ssize_t node;
+    Py_ssize_t count;
+    Py_ssize_t cache_index;
+    Py_ssize_t cache_child;
+} PyLazyDocumentObject;
+
+/*
+Iterator over newline-delimited JSON.  pystr holds the text being split:
+the source itself when it is a string or buffer, which is scanned in
+place, or the unread rest of the previous chunk followed by the next
+chunk read from a file.  offset is the stream offset of pystr[0].
+*/
+typedef struct _PyLineReaderObject {
+    PyObject_HEAD
+    PyObject *scanner;
+    PyObject *read;
+    PyObject *pystr;
+    Py_ssize_t pos;
+    Py_ssize_t offset;
+    Py_ssize_t chunk_size;
+    int offsets;
+    int eof;
+} PyLineReaderObject;
+
+/*
+Encoder for lists of records of one declared shape.  frags holds every
+constant piece of the output, escaped once up front; fragment i is
+frags[frag_start[i]:frag_start[i + 1]], indexed by the RECORD_* values
+below and then RECORD_FIELD + n for the n-th field written.  That is
+field order[n], which is the n-th declared field unless keys are sorted.
+*/
+#define RECORD_OPEN 0       /* '[' */
+#define RECORD_NEXT 1       /* item separator between records */
+#define RECORD_END 2        /* '}' */
+#define RECORD_CLOSE 3      /* ']' */
+#define RECORD_FIELD 4      /* '{' or item separator, key and key separator */
+
+typedef struct _PyRecordEncoderObject {
+    PyObject_HEAD
+    PyObject *encoder;
+    PyObject *fields;
+    Py_ssize_t num_fields;
+    Py_ssize_t *order;
+    char *frags;
+    Py_ssize_t *frag_start;
+    int is_unicode;
+} PyRecordEncoderObject;
+
+static PyMemberDef push_parser_members[] = {
+    {"scanner", T_OBJECT, offsetof(PyPushParserObject, scanner), READONLY, "scanner"},
+    {"items", T_INT, offsetof(PyPushParserObject, items), READONLY, "items"},
+    {"offset", T_PYSSIZET, offsetof(PyPushParserObject, offset), READONLY, "offset"},
+    {NULL}
+};
+
+static PyMemberDef line_reader_members[] = {
+    {"scanner", T_OBJECT, offsetof(PyLineReaderObject, scanner), READONLY, "scanner"},
+    {"offsets", T_INT, offsetof(PyLineReaderObject, offsets), READONLY, "offsets"},
+    {"chunk_size", T_PYSSIZET, offsetof(PyLineReaderObject, chunk_size), READONLY, "chunk_size"},
+    {NULL}
+};
+
+static PyMemberDef record_encoder_members[] = {
+    {"encoder", T_OBJECT, offsetof(PyRecordEncoderObject, encoder), READONLY, "encoder"},
+    {"fields", T_OBJECT, offsetof(PyRecordEncoderObject, fields), READONLY, "fields"},
+    {NULL}
+};
+
 static PyMemberDef encoder_members[] = {
     {"markers", T_OBJECT, offsetof(PyEncoderObject, markers), READONLY, "markers"},
     {"default", T_OBJECT, offsetof(PyEncoderObject, defaultfn), READONLY, "default"},
@@ -70,9 +275,114 @@ static PyMemberDef encoder_members[] = {
     {"item_separator", T_OBJECT, offsetof(PyEncoderObject, item_separator), READONLY, "item_separator"},
     {"sort_keys", T_OBJECT, offsetof(PyEncoderObject, sort_keys), READONLY, "sort_keys"},
     {"skipkeys", T_OBJECT, offsetof(PyEncoderObject, skipkeys), READONLY, "skipkeys"},
+    {"markers_depth", T_PYSSIZET, offsetof(PyEncoderObject, markers_depth), READONLY, "markers_depth"},
     {NULL}
 };
 
+/*
+Growable output buffer for the encoder.  Everything is appended to one
+block of memory and the result string is built once at the end.  Small
+outputs never leave the inline storage.  If any unicode chunk is appended
+the contents are treated as UTF-8 and the result is a unicode object.
+
+A buffer with a sink (a write callable or a file descriptor) is drained
+to it whenever it would grow past flush_size, so it stays bounded while
+streaming.  Flushes only happen when space is reserved, which is always
+between whole characters.
+*/
+#define JSON_BUFFER_INLINE 512
+#define JSON_BUFFER_FLUSH 65536
+
+typedef struct {
+    char *buf;
+    Py_ssize_t len;
+    Py_ssize_t size;
+    int is_unicode;
+    PyObject *write;
+    int fd;
+    Py_ssize_t flush_size;
+    char inline_buf[JSON_BUFFER_INLINE];
+} JSON_Buffer;
+
+/*
+Containers being encoded, innermost last, for circular reference checks.
+The stack is only searched once it is deeper than the encoder's
+markers_depth, so well formed shallow documents just push and pop.
+*/
+#define JSON_MARKERS_INLINE 64
+#define JSON_MARKERS_DEPTH 32
+
+typedef struct _JSON_Markers {
+    PyObject **items;
+    Py_ssize_t len;
+    Py_ssize_t size;
+    PyObject *inline_items[JSON_MARKERS_INLINE];
+} JSON_Markers;
+
+/*
+Scratch space for decoding a string that has escapes.  The characters
+are decoded straight into it in one pass and the result string is built
+from it with a single allocation.  Most strings fit in the inline
+storage on the stack.
+*/
+#define JSON_SCRATCH_INLINE 256
+
+typedef struct {
+    Py_UNICODE *buf;
+    Py_ssize_t len;
+    Py_ssize_t size;
+    Py_UNICODE inline_buf[JSON_SCRATCH_INLINE];
+} JSON_Scratch;
+
+/*
+Objects and arrays still open while a value is being scanned, innermost
+last.  The scanner keeps them here instead of recursing, so each level
+of nesting costs one frame and the depth is bounded by max_depth.
+*/
+#define JSON_STACK_INLINE 32
+#define JSON_MAX_DEPTH 1000
+
+typedef struct {
+    PyObject *container;
+    PyObject *key;
+    Py_ssize_t field;
+    int is_array;
+} JSON_Frame;
+
+typedef struct {
+    JSON_Frame *frames;
+    Py_ssize_t len;
+    Py_ssize_t size;
+    JSON_Frame inline_frames[JSON_STACK_INLINE];
+} JSON_Stack;
+
+#define BUFFER_RESERVE(b, n) (((b)->size - (b)->len >= (n)) ? 0 : buffer_grow((b), (n)))
+#define STACK_RESERVE(st) (((st)->len < (st)->size) ? 0 : stack_grow(st))
+#define SCRATCH_RESERVE(b, n) (((b)->size - (b)->len >= (n)) ? 0 : scratch_grow((b), (n)))
+
+/*
+Process wide counters of what the decoder and encoder spend their time
+on, read with stats().  They are always compiled in but only updated
+after enable_stats(), so when off each event costs one predictable
+branch.  validate() and minify() run without the GIL and are not
+counted.
+*/
+typedef struct {
+    unsigned PY_LONG_LONG bytes_scanned;
+    unsigned PY_LONG_LONG bytes_encoded;
+    unsigned PY_LONG_LONG objects;
+    unsigned PY_LONG_LONG strings;
+    unsigned PY_LONG_LONG escapes;
+    unsigned PY_LONG_LONG callbacks;
+    unsigned PY_LONG_LONG fallbacks;
+} JSON_Stats;
+
+static int stats_enabled = 0;
+static JSON_Stats json_stats;
+
+#define STATS_ADD(field, n) do { if (stats_enabled) json_stats.field += (n); } while (0)
+#define STATS_INC(field) STATS_ADD(field, 1)
+
 static Py_ssize_t
 ascii_escape_char(Py_UNICODE c, char *output, Py_ssize_t chars);
 static PyObject *
@@ -81,13 +391,19 @@ static PyObject *
 ascii_escape_str(PyObject *pystr);
 static PyObject *
 py_encode_basestring_ascii(PyObject* self UNUSED, PyObject *pystr);
+static PyObject *
+py_encode_basestring(PyObject* self UNUSED, PyObject *pystr);
 void init_speedups(void);
+static int
+scratch_grow(JSON_Scratch *b, Py_ssize_t need);
 static PyObject *
-scan_once_str(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx);
+scan_once_str(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx, Py_ssize_t *next_idx_ptr);
 static PyObject *
-scan_once_unicode(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx);
+scan_once_unicode(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx, Py_ssize_t *next_idx_ptr);
 static PyObject *
 _build_rval_index_tuple(PyObject *rval, Py_ssize_t idx);
+static Py_ssize_t
+record_field(PyScannerObject *s, PyObject *key);
 static int
 scanner_init(PyObject *self, PyObject *args, PyObject *kwds);
 static void
@@ -97,17 +413,21 @@ encoder_init(PyObject *self, PyObject *args, PyObject *kwds);
 static void
 encoder_dealloc(PyObject *self);
 static int
-encoder_listencode_list(PyEncoderObject *s, PyObject *rval, PyObject *seq, Py_ssize_t indent_level);
+encoder_clear(PyObject *self);
 static int
-encoder_listencode_obj(PyEncoderObject *s, PyObject *rval, PyObject *obj, Py_ssize_t indent_level);
+encoder_listencode_list(PyEncoderObject *s, JSON_Buffer *rval, JSON_Markers *markers, PyObject *seq, Py_ssize_t indent_level);
 static int
-encoder_listencode_dict(PyEncoderObject *s, PyObject *rval, PyObject *dct, Py_ssize_t indent_level);
-static PyObject *
-_encoded_const(PyObject *const);
+encoder_listencode_obj(PyEncoderObject *s, JSON_Buffer *rval, JSON_Markers *markers, PyObject *obj, Py_ssize_t indent_level);
+static int
+encoder_listencode_dict(PyEncoderObject *s, JSON_Buffer *rval, JSON_Markers *markers, PyObject *dct, Py_ssize_t indent_level);
+static const char *
+_encoded_const(PyObject *obj);
 static void
 raise_errmsg(char *msg, PyObject *s, Py_ssize_t end);
+static int
+encoder_write_string(PyEncoderObject *s, JSON_Buffer *rval, PyObject *obj);
 static PyObject *
-encoder_encode_string(PyEncoderObject *s, PyObject *obj);
+decimal_type(void);
 static int
 _convertPyInt_AsSsize_t(PyObject *o, Py_ssize_t *size_ptr);
 static PyObject *
@@ -140,1410 +460,5284 @@ _convertPyInt_FromSsize_t(Py_ssize_t *size_ptr)
     return PyInt_FromSsize_t(*size_ptr);
 }
 
-static Py_ssize_t
-ascii_escape_char(Py_UNICODE c, char *output, Py_ssize_t chars)
+static void
+buffer_init(JSON_Buffer *b)
 {
-    output[chars++] = '\\';
-    switch (c) {
-        case '\\': output[chars++] = (char)c; break;
-        case '"': output[chars++] = (char)c; break;
-        case '\b': output[chars++] = 'b'; break;
-        case '\f': output[chars++] = 'f'; break;
-        case '\n': output[chars++] = 'n'; break;
-        case '\r': output[chars++] = 'r'; break;
-        case '\t': output[chars++] = 't'; break;
-        default:
-#ifdef Py_UNICODE_WIDE
-            if (c >= 0x10000) {
-                /* UTF-16 surrogate pair */
-                Py_UNICODE v = c - 0x10000;
-                c = 0xd800 | ((v >> 10) & 0x3ff);
-                output[chars++] = 'u';
-                output[chars++] = "0123456789abcdef"[(c >> 12) & 0xf];
-                output[chars++] = "0123456789abcdef"[(c >>  8) & 0xf];
-                output[chars++] = "0123456789abcdef"[(c >>  4) & 0xf];
-                output[chars++] = "0123456789abcdef"[(c      ) & 0xf];
-                c = 0xdc00 | (v & 0x3ff);
-                output[chars++] = '\\';
-            }
-#endif
-            output[chars++] = 'u';
-            output[chars++] = "0123456789abcdef"[(c >> 12) & 0xf];
-            output[chars++] = "0123456789abcdef"[(c >>  8) & 0xf];
-            output[chars++] = "0123456789abcdef"[(c >>  4) & 0xf];
-            output[chars++] = "0123456789abcdef"[(c      ) & 0xf];
-    }
-    return chars;
+    b->buf = b->inline_buf;
+    b->len = 0;
+    b->size = JSON_BUFFER_INLINE;
+    b->is_unicode = 0;
+    b->write = NULL;
+    b->fd = -1;
+    b->flush_size = PY_SSIZE_T_MAX;
 }
 
-static PyObject *
-ascii_escape_unicode(PyObject *pystr)
+static void
+buffer_free(JSON_Buffer *b)
 {
-    Py_ssize_t i;
-    Py_ssize_t input_chars;
-    Py_ssize_t output_size;
-    Py_ssize_t chars;
-    PyObject *rval;
-    char *output;
-    Py_UNICODE *input_unicode;
-
-    input_chars = PyUnicode_GET_SIZE(pystr);
-    input_unicode = PyUnicode_AS_UNICODE(pystr);
-
-    /* One char input can be up to 6 chars output, estimate 4 of these */
-    output_size = 2 + (MIN_EXPANSION * 4) + input_chars;
-    rval = PyString_FromStringAndSize(NULL, output_size);
-    if (rval == NULL) {
-        return NULL;
+    if (b->buf != b->inline_buf) {
+        PyMem_Free(b->buf);
     }
-    output = PyString_AS_STRING(rval);
-    chars = 0;
-    output[chars++] = '"';
-    for (i = 0; i < input_chars; i++) {
-        Py_UNICODE c = input_unicode[i];
-        if (S_CHAR(c)) {
-            output[chars++] = (char)c;
-        }
-        else {
-            chars = ascii_escape_char(c, output, chars);
-        }
-        if (output_size - chars < (1 + MAX_EXPANSION)) {
-            /* There's more than four, so let's resize by a lot */
-            output_size *= 2;
-            /* This is an upper bound */
-            if (output_size > 2 + (input_chars * MAX_EXPANSION)) {
-                output_size = 2 + (input_chars * MAX_EXPANSION);
-            }
-            if (_PyString_Resize(&rval, output_size) == -1) {
-                return NULL;
+    b->buf = b->inline_buf;
+    b->len = 0;
+    b->size = JSON_BUFFER_INLINE;
+}
+
+static int
+buffer_flush(JSON_Buffer *b)
+{
+    /* Hand the contents to the sink and empty the buffer.  Once unicode
+       has been seen the chunks passed to a write callable are unicode,
+       a file descriptor always gets the UTF-8 bytes. */
+    if (b->len == 0)
+        return 0;
+    STATS_ADD(bytes_encoded, b->len);
+    if (b->fd >= 0) {
+        const char *p = b->buf;
+        Py_ssize_t left = b->len;
+        while (left > 0) {
+            Py_ssize_t n;
+            Py_BEGIN_ALLOW_THREADS
+            n = write(b->fd, p, (left > INT_MAX) ? INT_MAX : left);
+            Py_END_ALLOW_THREADS
+            if (n < 0) {
+                if (errno == EINTR && !PyErr_CheckSignals())
+                    continue;
+                if (!PyErr_Occurred())
+                    PyErr_SetFromErrno(PyExc_OSError);
+                return -1;
             }
-            output = PyString_AS_STRING(rval);
+            p += n;
+            left -= n;
         }
     }
-    output[chars++] = '"';
-    if (_PyString_Resize(&rval, chars) == -1) {
-        return NULL;
+    else {
+        PyObject *chunk;
+        PyObject *res;
+        if (b->is_unicode)
+            chunk = PyUnicode_DecodeUTF8(b->buf, b->len, "strict");
+        else
+            chunk = PyString_FromStringAndSize(b->buf, b->len);
+        if (chunk == NULL)
+            return -1;
+        res = PyObject_CallFunctionObjArgs(b->write, chunk, NULL);
+        Py_DECREF(chunk);
+        if (res == NULL)
+            return -1;
+        Py_DECREF(res);
     }
-    return rval;
+    b->len = 0;
+    return 0;
 }
 
-static PyObject *
-ascii_escape_str(PyObject *pystr)
+static int
+buffer_grow(JSON_Buffer *b, Py_ssize_t need)
 {
-    Py_ssize_t i;
-    Py_ssize_t input_chars;
-    Py_ssize_t output_size;
-    Py_ssize_t chars;
-    PyObject *rval;
-    char *output;
-    char *input_str;
-
-    input_chars = PyString_GET_SIZE(pystr);
-    input_str = PyString_AS_STRING(pystr);
-
-    /* Fast path for a string that's already ASCII */
-    for (i = 0; i < input_chars; i++) {
-        Py_UNICODE c = (Py_UNICODE)(unsigned char)input_str[i];
-        if (!S_CHAR(c)) {
-            /* If we have to escape something, scan the string for unicode */
-            Py_ssize_t j;
-            for (j = i; j < input_chars; j++) {
-                c = (Py_UNICODE)(unsigned char)input_str[j];
-                if (c > 0x7f) {
-                    /* We hit a non-ASCII character, bail to unicode mode */
-                    PyObject *uni;
-                    uni = PyUnicode_DecodeUTF8(input_str, input_chars, "strict");
-                    if (uni == NULL) {
-                        return NULL;
-                    }
-                    rval = ascii_escape_unicode(uni);
-                    Py_DECREF(uni);
-                    return rval;
-                }
-            }
+    /* Make room for at least need more bytes, doubling the allocation.
+       A streaming buffer is flushed instead once it is full enough. */
+    Py_ssize_t size = b->size;
+    char *buf;
+    if (b->len > 0 && need > b->flush_size - b->len) {
+        if (buffer_flush(b))
+            return -1;
+        if (size >= need)
+            return 0;
+    }
+    if (need > PY_SSIZE_T_MAX - b->len) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    while (size - b->len < need) {
+        if (size > PY_SSIZE_T_MAX / 2) {
+            size = b->len + need;
             break;
         }
+        size *= 2;
     }
-
-    if (i == input_chars) {
-        /* Input is already ASCII */
-        output_size = 2 + input_chars;
+    if (b->buf == b->inline_buf) {
+        buf = (char *)PyMem_Malloc(size);
+        if (buf != NULL) {
+            memcpy(buf, b->inline_buf, b->len);
+        }
     }
     else {
-        /* One char input can be up to 6 chars output, estimate 4 of these */
-        output_size = 2 + (MIN_EXPANSION * 4) + input_chars;
+        buf = (char *)PyMem_Realloc(b->buf, size);
     }
-    rval = PyString_FromStringAndSize(NULL, output_size);
-    if (rval == NULL) {
-        return NULL;
+    if (buf == NULL) {
+        PyErr_NoMemory();
+        return -1;
     }
-    output = PyString_AS_STRING(rval);
-    output[0] = '"';
-    
-    /* We know that everything up to i is ASCII already */
-    chars = i + 1;
-    memcpy(&output[1], input_str, i);
+    b->buf = buf;
+    b->size = size;
+    return 0;
+}
 
-    for (; i < input_chars; i++) {
-        Py_UNICODE c = (Py_UNICODE)(unsigned char)input_str[i];
-        if (S_CHAR(c)) {
-            output[chars++] = (char)c;
-        }
-        else {
-            chars = ascii_escape_char(c, output, chars);
-        }
-        /* An ASCII char can't possibly expand to a surrogate! */
-        if (output_size - chars < (1 + MIN_EXPANSION)) {
-            /* There's more than four, so let's resize by a lot */
-            output_size *= 2;
-            if (output_size > 2 + (input_chars * MIN_EXPANSION)) {
-                output_size = 2 + (input_chars * MIN_EXPANSION);
-            }
-            if (_PyString_Resize(&rval, output_size) == -1) {
-                return NULL;
-            }
-            output = PyString_AS_STRING(rval);
-        }
-    }
-    output[chars++] = '"';
-    if (_PyString_Resize(&rval, chars) == -1) {
-        return NULL;
-    }
-    return rval;
+static int
+buffer_append(JSON_Buffer *b, const char *s, Py_ssize_t n)
+{
+    if (BUFFER_RESERVE(b, n))
+        return -1;
+    memcpy(b->buf + b->len, s, n);
+    b->len += n;
+    return 0;
 }
 
-static void
-raise_errmsg(char *msg, PyObject *s, Py_ssize_t end)
+static int
+buffer_append_obj(JSON_Buffer *b, PyObject *obj)
 {
-    static PyObject *errmsg_fn = NULL;
-    PyObject *pymsg;
-    if (errmsg_fn == NULL) {
-        PyObject *decoder = PyImport_ImportModule("simplejson.decoder");
-        if (decoder == NULL)
-            return;
-        errmsg_fn = PyObject_GetAttrString(decoder, "errmsg");
-        Py_DECREF(decoder);
-        if (errmsg_fn == NULL)
-            return;
+    /* Append a str, or a unicode encoded as UTF-8 which makes the result unicode */
+    if (PyString_Check(obj)) {
+        return buffer_append(b, PyString_AS_STRING(obj), PyString_GET_SIZE(obj));
     }
-    pymsg = PyObject_CallFunction(errmsg_fn, "(zOO&)", msg, s, _convertPyInt_FromSsize_t, &end);
-    if (pymsg) {
-        PyErr_SetObject(PyExc_ValueError, pymsg);
-        Py_DECREF(pymsg);
+    else if (PyUnicode_Check(obj)) {
+        int rval;
+        PyObject *utf8 = PyUnicode_AsUTF8String(obj);
+        if (utf8 == NULL)
+            return -1;
+        rval = buffer_append(b, PyString_AS_STRING(utf8), PyString_GET_SIZE(utf8));
+        Py_DECREF(utf8);
+        b->is_unicode = 1;
+        return rval;
     }
+    PyErr_Format(PyExc_TypeError,
+                 "expected a string chunk, not %.80s",
+                 Py_TYPE(obj)->tp_name);
+    return -1;
 }
 
-static PyObject *
-join_list_string(PyObject *lst)
+static int
+buffer_append_long(JSON_Buffer *b, long v)
 {
-    static PyObject *joinfn = NULL;
-    if (joinfn == NULL) {
-        PyObject *ustr = PyString_FromStringAndSize(NULL, 0);
-        if (ustr == NULL)
-            return NULL;
-        
-        joinfn = PyObject_GetAttrString(ustr, "join");
-        Py_DECREF(ustr);
-        if (joinfn == NULL)
-            return NULL;
+    char digits[24];
+    char *p = digits + sizeof(digits);
+    unsigned long u = (v < 0) ? (0UL - (unsigned long)v) : (unsigned long)v;
+    do {
+        *--p = (char)('0' + (u % 10));
+        u /= 10;
+    } while (u);
+    if (v < 0) {
+        *--p = '-';
     }
-    return PyObject_CallFunctionObjArgs(joinfn, lst, NULL);
+    return buffer_append(b, p, digits + sizeof(digits) - p);
 }
 
-static PyObject *
-_build_rval_index_tuple(PyObject *rval, Py_ssize_t idx) {
-    /*
-    steal a reference to rval, returns (rval, idx)
-    */
-    if (rval == NULL) {
-        return NULL;
-    }
-    PyObject *tpl;
-    PyObject *pyidx = PyInt_FromSsize_t(idx);
-    if (pyidx == NULL) {
-        Py_DECREF(rval);
-        return NULL;
+/*
+Shortest round-trip formatting of doubles, after Ulf Adams' Ryu
+(https://github.com/ulfjack/ryu).  float_to_decimal finds the shortest
+decimal that reads back as the same double; buffer_append_double lays it
+out exactly like float.__repr__.
+*/
+
+/* Python's repr only uses the shortest form when it has correctly rounded
+   float conversions, otherwise repr stays the only source of truth */
+#ifdef PY_NO_SHORT_FLOAT_REPR
+static int float_shortest = 0;
+#else
+static int float_shortest = 1;
+#endif
+
+static int
+pow5bits(int e)
+{
+    /* bit length of 5**e, for 0 <= e <= 3528 */
+    return (int)(((unsigned int)e * 1217359) >> 19) + 1;
+}
+
+static unsigned int
+log10_pow2(int e)
+{
+    /* floor(log10(2**e)), for 0 <= e <= 1650 */
+    return ((unsigned int)e * 78913) >> 18;
+}
+
+static unsigned int
+log10_pow5(int e)
+{
+    /* floor(log10(5**e)), for 0 <= e <= 2620 */
+    return ((unsigned int)e * 732923) >> 20;
+}
+
+static int
+multiple_of_pow5(JSON_UINT64 value, unsigned int p)
+{
+    unsigned int count = 0;
+    while (value % 5 == 0) {
+        value /= 5;
+        count++;
     }
-    tpl = PyTuple_Pack(2, rval, pyidx);
-    Py_DECREF(pyidx);
-    Py_DECREF(rval);
-    return tpl;
+    return count >= p;
 }
 
-static PyObject *
-scanstring_str(PyObject *pystr, Py_ssize_t end, char *encoding, int strict, Py_ssize_t *next_end_ptr)
+static int
+multiple_of_pow2(JSON_UINT64 value, unsigned int p)
 {
-    PyObject *rval;
-    Py_ssize_t len = PyString_GET_SIZE(pystr);
-    Py_ssize_t begin = end - 1;
-    Py_ssize_t next = begin;
-    int has_unicode = 0;
-    char *buf = PyString_AS_STRING(pystr);
-    PyObject *chunks = PyList_New(0);
-    if (chunks == NULL) {
-        goto bail;
+    return (value & ((((JSON_UINT64)1) << p) - 1)) == 0;
+}
+
+static JSON_UINT64
+mul_shift64(JSON_UINT64 m, const JSON_UINT64 *mul, int j)
+{
+    /* (m * (mul[1] * 2**64 + mul[0])) >> j, for 64 < j < 128 */
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 b0 = (unsigned __int128)m * mul[0];
+    unsigned __int128 b2 = (unsigned __int128)m * mul[1];
+    return (JSON_UINT64)(((b0 >> 64) + b2) >> (j - 64));
+#else
+    JSON_UINT64 m_lo = m & 0xffffffffU;
+    JSON_UINT64 m_hi = m >> 32;
+    JSON_UINT64 b0_hi, b2_lo, b2_hi, lo, hi, t;
+    /* high half of m * mul[0] */
+    t = (m_lo * (mul[0] & 0xffffffffU)) >> 32;
+    t += m_hi * (mul[0] & 0xffffffffU);
+    lo = (t & 0xffffffffU) + m_lo * (mul[0] >> 32);
+    b0_hi = m_hi * (mul[0] >> 32) + (t >> 32) + (lo >> 32);
+    /* full m * mul[1] */
+    t = m_lo * (mul[1] & 0xffffffffU);
+    b2_lo = t & 0xffffffffU;
+    t = (t >> 32) + m_hi * (mul[1] & 0xffffffffU);
+    lo = (t & 0xffffffffU) + m_lo * (mul[1] >> 32);
+    b2_lo |= lo << 32;
+    b2_hi = m_hi * (mul[1] >> 32) + (t >> 32) + (lo >> 32);
+    /* (b2 + b0_hi) >> (j - 64) */
+    lo = b2_lo + b0_hi;
+    hi = b2_hi + (lo < b2_lo);
+    j -= 64;
+    return (hi << (64 - j)) | (lo >> j);
+#endif
+}
+
+static int
+float_to_decimal(double d, JSON_UINT64 *digits, int *exponent)
+{
+    /*
+    Find the shortest digits * 10**exponent that reads back as the finite,
+    nonzero magnitude |d|.  Returns the number of digits.
+    */
+    JSON_UINT64 bits;
+    JSON_UINT64 ieee_mantissa;
+    unsigned int ieee_exponent;
+    JSON_UINT64 m2, mv, vr, vp, vm, output, t;
+    unsigned int mm_shift;
+    int e2, e10, removed = 0;
+    int accept_bounds;
+    int vm_trailing_zeros = 0;
+    int vr_trailing_zeros = 0;
+    int last_removed = 0;
+    int ndigits;
+
+    memcpy(&bits, &d, sizeof(bits));
+    ieee_mantissa = bits & ((((JSON_UINT64)1) << 52) - 1);
+    ieee_exponent = (unsigned int)((bits >> 52) & 0x7ff);
+    if (ieee_exponent == 0) {
+        e2 = 1 - 1023 - 52 - 2;
+        m2 = ieee_mantissa;
     }
-    if (end < 0 || len <= end) {
-        PyErr_SetString(PyExc_ValueError, "end is out of bounds");
-        goto bail;
+    else {
+        e2 = (int)ieee_exponent - 1023 - 52 - 2;
+        m2 = (((JSON_UINT64)1) << 52) | ieee_mantissa;
     }
-    while (1) {
-        /* Find the end of the string or the next escape */
-        Py_UNICODE c = 0;
-        PyObject *chunk = NULL;
-        for (next = end; next < len; next++) {
-            c = (unsigned char)buf[next];
-            if (c == '"' || c == '\\') {
-                break;
+    accept_bounds = (m2 & 1) == 0;
+
+    /* the interval of decimals that round to d is [mv - 1 - mm_shift, mv + 2] / 4 */
+    mv = 4 * m2;
+    mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+
+    if (e2 >= 0) {
+        unsigned int q = log10_pow2(e2) - (e2 > 3);
+        int k = DOUBLE_POW5_INV_BITCOUNT + pow5bits((int)q) - 1;
+        int i = -e2 + (int)q + k;
+        e10 = (int)q;
+        vr = mul_shift64(4 * m2, DOUBLE_POW5_INV_SPLIT[q], i);
+        vp = mul_shift64(4 * m2 + 2, DOUBLE_POW5_INV_SPLIT[q], i);
+        vm = mul_shift64(4 * m2 - 1 - mm_shift, DOUBLE_POW5_INV_SPLIT[q], i);
+        if (q <= 21) {
+            if (mv % 5 == 0) {
+                vr_trailing_zeros = multiple_of_pow5(mv, q);
             }
-            else if (strict && c <= 0x1f) {
-                raise_errmsg("Invalid control character at", pystr, next);
-                goto bail;
+            else if (accept_bounds) {
+                vm_trailing_zeros = multiple_of_pow5(mv - 1 - mm_shift, q);
             }
-            else if (c > 0x7f) {
-                has_unicode = 1;
+            else {
+                vp -= multiple_of_pow5(mv + 2, q);
             }
         }
-        if (!(c == '"' || c == '\\')) {
-            raise_errmsg("Unterminated string starting at", pystr, begin);
-            goto bail;
-        }
-        /* Pick up this chunk if it's not zero length */
-        if (next != end) {
-            PyObject *strchunk = PyString_FromStringAndSize(&buf[end], next - end);
-            if (strchunk == NULL) {
-                goto bail;
-            }
-            if (has_unicode) {
-                chunk = PyUnicode_FromEncodedObject(strchunk, encoding, NULL);
-                Py_DECREF(strchunk);
-                if (chunk == NULL) {
-                    goto bail;
-                }
+    }
+    else {
+        unsigned int q = log10_pow5(-e2) - (-e2 > 1);
+        int i = -e2 - (int)q;
+        int k = pow5bits(i) - DOUBLE_POW5_BITCOUNT;
+        int j = (int)q - k;
+        e10 = (int)q + e2;
+        vr = mul_shift64(4 * m2, DOUBLE_POW5_SPLIT[i], j);
+        vp = mul_shift64(4 * m2 + 2, DOUBLE_POW5_SPLIT[i], j);
+        vm = mul_shift64(4 * m2 - 1 - mm_shift, DOUBLE_POW5_SPLIT[i], j);
+        if (q <= 1) {
+            vr_trailing_zeros = 1;
+            if (accept_bounds) {
+                vm_trailing_zeros = mm_shift == 1;
             }
             else {
-                chunk = strchunk;
+                vp--;
             }
-            if (PyList_Append(chunks, chunk)) {
-                goto bail;
-            }
-            Py_DECREF(chunk);
         }
-        next++;
-        if (c == '"') {
-            end = next;
-            break;
+        else if (q < 63) {
+            vr_trailing_zeros = multiple_of_pow2(mv, q);
         }
-        if (next == len) {
-            raise_errmsg("Unterminated string starting at", pystr, begin);
-            goto bail;
+    }
+
+    /* drop digits while the interval still holds a shorter decimal */
+    if (vm_trailing_zeros || vr_trailing_zeros) {
+        while (vp / 10 > vm / 10) {
+            vm_trailing_zeros &= vm % 10 == 0;
+            vr_trailing_zeros &= last_removed == 0;
+            last_removed = (int)(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
         }
-        c = buf[next];
-        if (c != 'u') {
-            /* Non-unicode backslash escapes */
-            end = next + 1;
-            switch (c) {
-                case '"': break;
-                case '\\': break;
-                case '/': break;
-                case 'b': c = '\b'; break;
-                case 'f': c = '\f'; break;
-                case 'n': c = '\n'; break;
-                case 'r': c = '\r'; break;
-                case 't': c = '\t'; break;
-                default: c = 0;
-            }
-            if (c == 0) {
-                raise_errmsg("Invalid \\escape", pystr, end - 2);
-                goto bail;
+        if (vm_trailing_zeros) {
+            while (vm % 10 == 0) {
+                vr_trailing_zeros &= last_removed == 0;
+                last_removed = (int)(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
             }
         }
-        else {
-            c = 0;
-            next++;
-            end = next + 4;
-            if (end >= len) {
-                raise_errmsg("Invalid \\uXXXX escape", pystr, next - 1);
-                goto bail;
-            }
-            /* Decode 4 hex digits */
-            for (; next < end; next++) {
-                c <<= 4;
-                Py_UNICODE digit = buf[next];
-                switch (digit) {
-                    case '0': case '1': case '2': case '3': case '4':
-                    case '5': case '6': case '7': case '8': case '9':
-                        c |= (digit - '0'); break;
-                    case 'a': case 'b': case 'c': case 'd': case 'e':
-                    case 'f':
-                        c |= (digit - 'a' + 10); break;
-                    case 'A': case 'B': case 'C': case 'D': case 'E':
-                    case 'F':
-                        c |= (digit - 'A' + 10); break;
-                    default:
-                        raise_errmsg("Invalid \\uXXXX escape", pystr, end - 5);
-                        goto bail;
-                }
-            }
-#ifdef Py_UNICODE_WIDE
-            /* Surrogate pair */
-            if ((c & 0xfc00) == 0xd800) {
-                Py_UNICODE c2 = 0;
-                if (end + 6 >= len) {
-                    raise_errmsg("Unpaired high surrogate", pystr, end - 5);
-                    goto bail;
-                }
-                if (buf[next++] != '\\' || buf[next++] != 'u') {
-                    raise_errmsg("Unpaired high surrogate", pystr, end - 5);
-                    goto bail;
-                }
-                end += 6;
-                /* Decode 4 hex digits */
-                for (; next < end; next++) {
-                    c2 <<= 4;
-                    Py_UNICODE digit = buf[next];
-                    switch (digit) {
-                        case '0': case '1': case '2': case '3': case '4':
-                        case '5': case '6': case '7': case '8': case '9':
-                            c2 |= (digit - '0'); break;
-                        case 'a': case 'b': case 'c': case 'd': case 'e':
-                        case 'f':
-                            c2 |= (digit - 'a' + 10); break;
-                        case 'A': case 'B': case 'C': case 'D': case 'E':
-                        case 'F':
-                            c2 |= (digit - 'A' + 10); break;
-                        default:
-                            raise_errmsg("Invalid \\uXXXX escape", pystr, end - 5);
-                            goto bail;
-                    }
-                }
-                if ((c2 & 0xfc00) != 0xdc00) {
-                    raise_errmsg("Unpaired high surrogate", pystr, end - 5);
-                    goto bail;
-                }
-                c = 0x10000 + (((c - 0xd800) << 10) | (c2 - 0xdc00));
-            }
-            else if ((c & 0xfc00) == 0xdc00) {
-                raise_errmsg("Unpaired low surrogate", pystr, end - 5);
-                goto bail;
-            }
-#endif
+        if (vr_trailing_zeros && last_removed == 5 && vr % 2 == 0) {
+            /* round half to even */
+            last_removed = 4;
         }
-        if (c > 0x7f) {
-            has_unicode = 1;
+        output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) || last_removed >= 5);
+    }
+    else {
+        int round_up = 0;
+        if (vp / 100 > vm / 100) {
+            round_up = vr % 100 >= 50;
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
         }
-        if (has_unicode) {
-            chunk = PyUnicode_FromUnicode(&c, 1);
-            if (chunk == NULL) {
-                goto bail;
-            }
+        while (vp / 10 > vm / 10) {
+            round_up = vr % 10 >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        output = vr + (vr == vm || round_up);
+    }
+    ndigits = 1;
+    for (t = output; t >= 10; t /= 10) {
+        ndigits++;
+    }
+    *digits = output;
+    *exponent = e10 + removed;
+    return ndigits;
+}
+
+static int
+buffer_append_double(JSON_Buffer *b, double d)
+{
+    /* Append a finite double formatted like float.__repr__ */
+    char out[32];
+    /* zeroed: gcc cannot see that float_to_decimal gives ndigits >= 1 */
+    char digits[20] = {0};
+    char *p = out;
+    JSON_UINT64 v;
+    int exponent, ndigits, decpt, i;
+    if (d < 0 || (d == 0 && copysign(1.0, d) < 0)) {
+        *p++ = '-';
+        d = -d;
+    }
+    if (d == 0) {
+        memcpy(p, "0.0", 3);
+        return buffer_append(b, out, p + 3 - out);
+    }
+    ndigits = float_to_decimal(d, &v, &exponent);
+    for (i = ndigits - 1; i >= 0; i--) {
+        digits[i] = (char)('0' + (int)(v % 10));
+        v /= 10;
+    }
+    /* the value is 0.DIGITS * 10**decpt */
+    decpt = ndigits + exponent;
+    if (decpt <= -4 || decpt > 16) {
+        int e = decpt - 1;
+        *p++ = digits[0];
+        if (ndigits > 1) {
+            *p++ = '.';
+            memcpy(p, digits + 1, ndigits - 1);
+            p += ndigits - 1;
+        }
+        *p++ = 'e';
+        if (e < 0) {
+            *p++ = '-';
+            e = -e;
         }
         else {
-            char c_char = Py_CHARMASK(c);
-            chunk = PyString_FromStringAndSize(&c_char, 1);
-            if (chunk == NULL) {
-                goto bail;
-            }
+            *p++ = '+';
         }
-        if (PyList_Append(chunks, chunk)) {
-            goto bail;
+        if (e >= 100) {
+            *p++ = (char)('0' + e / 100);
         }
-        Py_DECREF(chunk);
+        *p++ = (char)('0' + (e / 10) % 10);
+        *p++ = (char)('0' + e % 10);
     }
-
-    rval = join_list_string(chunks);
-    if (rval == NULL) {
-        goto bail;
+    else if (decpt <= 0) {
+        *p++ = '0';
+        *p++ = '.';
+        for (i = decpt; i < 0; i++) {
+            *p++ = '0';
+        }
+        memcpy(p, digits, ndigits);
+        p += ndigits;
     }
-    Py_DECREF(chunks);
-    chunks = NULL;
-    *next_end_ptr = end;
-    return rval;
-bail:
-    *next_end_ptr = -1;
-    Py_XDECREF(chunks);
-    return NULL;
+    else if (decpt >= ndigits) {
+        memcpy(p, digits, ndigits);
+        p += ndigits;
+        for (i = ndigits; i < decpt; i++) {
+            *p++ = '0';
+        }
+        *p++ = '.';
+        *p++ = '0';
+    }
+    else {
+        memcpy(p, digits, decpt);
+        p += decpt;
+        *p++ = '.';
+        memcpy(p, digits + decpt, ndigits - decpt);
+        p += ndigits - decpt;
+    }
+    return buffer_append(b, out, p - out);
 }
 
-
 static PyObject *
-scanstring_unicode(PyObject *pystr, Py_ssize_t end, int strict, Py_ssize_t *next_end_ptr)
+buffer_finish(JSON_Buffer *b)
 {
+    /* Build the single result string and release the buffer */
     PyObject *rval;
-    Py_ssize_t len = PyUnicode_GET_SIZE(pystr);
-    Py_ssize_t begin = end - 1;
-    Py_ssize_t next = begin;
-    const Py_UNICODE *buf = PyUnicode_AS_UNICODE(pystr);
-    PyObject *chunks = PyList_New(0);
-    if (chunks == NULL) {
-        goto bail;
+    if (b->is_unicode) {
+        rval = PyUnicode_DecodeUTF8(b->buf, b->len, "strict");
     }
-    if (end < 0 || len <= end) {
-        PyErr_SetString(PyExc_ValueError, "end is out of bounds");
-        goto bail;
+    else {
+        rval = PyString_FromStringAndSize(b->buf, b->len);
     }
-    while (1) {
-        /* Find the end of the string or the next escape */
-        Py_UNICODE c = 0;
-        PyObject *chunk = NULL;
-        for (next = end; next < len; next++) {
-            c = buf[next];
-            if (c == '"' || c == '\\') {
-                break;
-            }
-            else if (strict && c <= 0x1f) {
-                raise_errmsg("Invalid control character at", pystr, next);
-                goto bail;
+    buffer_free(b);
+    return rval;
+}
+
+static void
+markers_init(JSON_Markers *m)
+{
+    m->items = m->inline_items;
+    m->len = 0;
+    m->size = JSON_MARKERS_INLINE;
+}
+
+static void
+markers_free(JSON_Markers *m)
+{
+    if (m->items != m->inline_items)
+        PyMem_Free(m->items);
+    m->items = m->inline_items;
+}
+
+static int
+markers_push(PyEncoderObject *s, JSON_Markers *m, PyObject *obj)
+{
+    /* Open obj, raising ValueError if it is already open.  m is NULL when
+       check_circular is off. */
+    Py_ssize_t i;
+    if (m == NULL)
+        return 0;
+    if (m->len >= s->markers_depth) {
+        for (i = m->len - 1; i >= 0; i--) {
+            if (m->items[i] == obj) {
+                PyErr_SetString(PyExc_ValueError, "Circular reference detected");
+                return -1;
             }
         }
-        if (!(c == '"' || c == '\\')) {
-            raise_errmsg("Unterminated string starting at", pystr, begin);
-            goto bail;
-        }
-        /* Pick up this chunk if it's not zero length */
-        if (next != end) {
-            chunk = PyUnicode_FromUnicode(&buf[end], next - end);
-            if (chunk == NULL) {
-                goto bail;
-            }
-            if (PyList_Append(chunks, chunk)) {
-                goto bail;
-            }
-            Py_DECREF(chunk);
+    }
+    if (m->len == m->size) {
+        PyObject **items;
+        Py_ssize_t size = m->size * 2;
+        if (m->items == m->inline_items) {
+            items = (PyObject **)PyMem_Malloc(size * sizeof(PyObject *));
+            if (items != NULL)
+                memcpy(items, m->inline_items, m->len * sizeof(PyObject *));
         }
-        next++;
-        if (c == '"') {
-            end = next;
-            break;
+        else {
+            items = (PyObject **)PyMem_Realloc(m->items, size * sizeof(PyObject *));
         }
-        if (next == len) {
-            raise_errmsg("Unterminated string starting at", pystr, begin);
-            goto bail;
+        if (items == NULL) {
+            PyErr_NoMemory();
+            return -1;
         }
-        c = buf[next];
-        if (c != 'u') {
-            /* Non-unicode backslash escapes */
-            end = next + 1;
-            switch (c) {
-                case '"': break;
-                case '\\': break;
-                case '/': break;
-                case 'b': c = '\b'; break;
-                case 'f': c = '\f'; break;
-                case 'n': c = '\n'; break;
-                case 'r': c = '\r'; break;
-                case 't': c = '\t'; break;
-                default: c = 0;
-            }
-            if (c == 0) {
-                raise_errmsg("Invalid \\escape", pystr, end - 2);
-                goto bail;
+        m->items = items;
+        m->size = size;
+    }
+    m->items[m->len++] = obj;
+    return 0;
+}
+
+static void
+markers_pop(JSON_Markers *m)
+{
+    if (m != NULL)
+        m->len--;
+}
+
+/*
+What follows the backslash when encode_basestring_ascii escapes a byte or
+Latin-1 character, 0 for the printable ASCII it copies unchanged.  'u'
+is followed by four hex digits.
+*/
+static const char ascii_escape_table[256] = {
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    0, 0, '"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u'
+};
+
+static char *
+ascii_escape_byte(unsigned char c, char *output)
+{
+    char e = ascii_escape_table[c];
+    *output++ = '\\';
+    *output++ = e;
+    if (e == 'u') {
+        *output++ = '0';
+        *output++ = '0';
+        *output++ = "0123456789abcdef"[c >> 4];
+        *output++ = "0123456789abcdef"[c & 0xf];
+    }
+    return output;
+}
+
+static Py_ssize_t
+ascii_escape_char(Py_UNICODE c, char *output, Py_ssize_t chars)
+{
+    output[chars++] = '\\';
+    switch (c) {
+        case '\\': output[chars++] = (char)c; break;
+        case '"': output[chars++] = (char)c; break;
+        case '\b': output[chars++] = 'b'; break;
+        case '\f': output[chars++] = 'f'; break;
+        case '\n': output[chars++] = 'n'; break;
+        case '\r': output[chars++] = 'r'; break;
+        case '\t': output[chars++] = 't'; break;
+        default:
+#ifdef Py_UNICODE_WIDE
+            if (c >= 0x10000) {
+                /* UTF-16 surrogate pair */
+                Py_UNICODE v = c - 0x10000;
+                c = 0xd800 | ((v >> 10) & 0x3ff);
+                output[chars++] = 'u';
+                output[chars++] = "0123456789abcdef"[(c >> 12) & 0xf];
+                output[chars++] = "0123456789abcdef"[(c >>  8) & 0xf];
+                output[chars++] = "0123456789abcdef"[(c >>  4) & 0xf];
+                output[chars++] = "0123456789abcdef"[(c      ) & 0xf];
+                c = 0xdc00 | (v & 0x3ff);
+                output[chars++] = '\\';
             }
-        }
-        else {
-            c = 0;
+#endif
+            output[chars++] = 'u';
+            output[chars++] = "0123456789abcdef"[(c >> 12) & 0xf];
+            output[chars++] = "0123456789abcdef"[(c >>  8) & 0xf];
+            output[chars++] = "0123456789abcdef"[(c >>  4) & 0xf];
+            output[chars++] = "0123456789abcdef"[(c      ) & 0xf];
+    }
+    return chars;
+}
+
+static void
+raise_errmsg_range(char *msg, PyObject *s, Py_ssize_t pos, Py_ssize_t end)
+{
+    /* ValueError with decoder.errmsg(msg, s, pos, end), end < 0 is None */
+    static PyObject *errmsg_fn = NULL;
+    PyObject *pymsg;
+    if (errmsg_fn == NULL) {
+        PyObject *decoder = PyImport_ImportModule("simplejson.decoder");
+        if (decoder == NULL)
+            return;
+        errmsg_fn = PyObject_GetAttrString(decoder, "errmsg");
+        Py_DECREF(decoder);
+        if (errmsg_fn == NULL)
+            return;
+    }
+    if (end < 0)
+        pymsg = PyObject_CallFunction(errmsg_fn, "(zOO&)", msg, s, _convertPyInt_FromSsize_t, &pos);
+    else
+        pymsg = PyObject_CallFunction(errmsg_fn, "(zOO&O&)", msg, s, _convertPyInt_FromSsize_t, &pos, _convertPyInt_FromSsize_t, &end);
+    if (pymsg) {
+        PyErr_SetObject(PyExc_ValueError, pymsg);
+        Py_DECREF(pymsg);
+    }
+}
+
+static void
+raise_errmsg(char *msg, PyObject *s, Py_ssize_t end)
+{
+    raise_errmsg_range(msg, s, end, -1);
+}
+
+static PyObject *
+_build_rval_index_tuple(PyObject *rval, Py_ssize_t idx) {
+    /*
+    steal a reference to rval, returns (rval, idx)
+    */
+    if (rval == NULL) {
+        return NULL;
+    }
+    PyObject *tpl;
+    PyObject *pyidx = PyInt_FromSsize_t(idx);
+    if (pyidx == NULL) {
+        Py_DECREF(rval);
+        return NULL;
+    }
+    tpl = PyTuple_Pack(2, rval, pyidx);
+    Py_DECREF(pyidx);
+    Py_DECREF(rval);
+    return tpl;
+}
+
+/*
+The string scanners skip over runs of characters that need no special
+handling and stop at the first '"', '\\' or control character.  The str
+variant also reports whether it skipped any non-ASCII bytes.  The vector
+versions classify 16 (SSE2) or 32 (AVX2) bytes per step and finish the
+tail with the scalar loop.
+
+The ASCII escapers use the same levels to find runs of printable ASCII
+other than '"' and '\\'.  scan_ascii_str stops at the first other byte,
+copy_ascii_unicode also copies the run it skips to output, narrowing
+each character to one byte.  There is no AVX2 copy_ascii_unicode, as
+packing 256 bit vectors crosses lanes, so that level uses SSE2 for it.
+*/
+typedef Py_ssize_t (*scan_plain_str_func)(const char *buf, Py_ssize_t idx, Py_ssize_t len, int *has_unicode);
+typedef Py_ssize_t (*scan_plain_unicode_func)(const Py_UNICODE *buf, Py_ssize_t idx, Py_ssize_t len);
+typedef Py_ssize_t (*scan_ascii_str_func)(const char *buf, Py_ssize_t idx, Py_ssize_t len);
+typedef Py_ssize_t (*copy_ascii_unicode_func)(const Py_UNICODE *buf, Py_ssize_t idx, Py_ssize_t len, char *output);
+
+#define SIMD_SCALAR 0
+#define SIMD_SSE2 1
+#define SIMD_AVX2 2
+
+static const char *simd_level_names[] = {"scalar", "sse2", "avx2"};
+
+static Py_ssize_t
+scan_plain_str_scalar(const char *buf, Py_ssize_t idx, Py_ssize_t len, int *has_unicode)
+{
+    int high = 0;
+    for (; idx < len; idx++) {
+        unsigned char c = (unsigned char)buf[idx];
+        if (c == '"' || c == '\\' || c <= 0x1f) {
+            break;
+        }
+        high |= c;
+    }
+    if (high & 0x80) {
+        *has_unicode = 1;
+    }
+    return idx;
+}
+
+static Py_ssize_t
+scan_plain_unicode_scalar(const Py_UNICODE *buf, Py_ssize_t idx, Py_ssize_t len)
+{
+    for (; idx < len; idx++) {
+        Py_UNICODE c = buf[idx];
+        if (c == '"' || c == '\\' || c <= 0x1f) {
+            break;
+        }
+    }
+    return idx;
+}
+
+static Py_ssize_t
+scan_ascii_str_scalar(const char *buf, Py_ssize_t idx, Py_ssize_t len)
+{
+    while (idx < len && !ascii_escape_table[(unsigned char)buf[idx]]) {
+        idx++;
+    }
+    return idx;
+}
+
+static Py_ssize_t
+copy_ascii_unicode_scalar(const Py_UNICODE *buf, Py_ssize_t idx, Py_ssize_t len, char *output)
+{
+    for (; idx < len; idx++) {
+        Py_UNICODE c = buf[idx];
+        if (c > 0xff || ascii_escape_table[c]) {
+            break;
+        }
+        *output++ = (char)c;
+    }
+    return idx;
+}
+
+#ifdef JSON_HAVE_SSE2
+static int
+simd_ctz(unsigned int mask)
+{
+#ifdef _MSC_VER
+    unsigned long pos;
+    _BitScanForward(&pos, mask);
+    return (int)pos;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+static Py_ssize_t
+scan_plain_str_sse2(const char *buf, Py_ssize_t idx, Py_ssize_t len, int *has_unicode)
+{
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i ctrl = _mm_set1_epi8(0x1f);
+    unsigned int high = 0;
+    while (idx + 16 <= len) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(buf + idx));
+        /* v <= 0x1f (unsigned) iff max(v, 0x1f) == 0x1f */
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+            _mm_cmpeq_epi8(_mm_max_epu8(v, ctrl), ctrl));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(special);
+        if (mask) {
+            int pos = simd_ctz(mask);
+            high |= (unsigned int)_mm_movemask_epi8(v) & ((1u << pos) - 1);
+            if (high) {
+                *has_unicode = 1;
+            }
+            return idx + pos;
+        }
+        high |= (unsigned int)_mm_movemask_epi8(v);
+        idx += 16;
+    }
+    if (high) {
+        *has_unicode = 1;
+    }
+    return scan_plain_str_scalar(buf, idx, len, has_unicode);
+}
+
+static Py_ssize_t
+scan_plain_unicode_sse2(const Py_UNICODE *buf, Py_ssize_t idx, Py_ssize_t len)
+{
+#if Py_UNICODE_SIZE == 4
+    const __m128i quote = _mm_set1_epi32('"');
+    const __m128i backslash = _mm_set1_epi32('\\');
+    const __m128i space = _mm_set1_epi32(0x20);
+    const Py_ssize_t step = 4;
+#else
+    const __m128i quote = _mm_set1_epi16('"');
+    const __m128i backslash = _mm_set1_epi16('\\');
+    const __m128i ctrl = _mm_set1_epi16(0x1f);
+    const __m128i zero = _mm_setzero_si128();
+    const Py_ssize_t step = 8;
+#endif
+    while (idx + step <= len) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(buf + idx));
+#if Py_UNICODE_SIZE == 4
+        /* code points are at most 0x10ffff, so a signed compare is safe */
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi32(v, quote), _mm_cmpeq_epi32(v, backslash)),
+            _mm_cmplt_epi32(v, space));
+#else
+        /* v <= 0x1f (unsigned) iff v - 0x1f saturates to zero */
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi16(v, quote), _mm_cmpeq_epi16(v, backslash)),
+            _mm_cmpeq_epi16(_mm_subs_epu16(v, ctrl), zero));
+#endif
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(special);
+        if (mask) {
+            return idx + simd_ctz(mask) / Py_UNICODE_SIZE;
+        }
+        idx += step;
+    }
+    return scan_plain_unicode_scalar(buf, idx, len);
+}
+
+static Py_ssize_t
+scan_ascii_str_sse2(const char *buf, Py_ssize_t idx, Py_ssize_t len)
+{
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i del = _mm_set1_epi8(0x7f);
+    while (idx + 16 <= len) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(buf + idx));
+        /* signed, so bytes from 0x80 up are below ' ' too */
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+            _mm_or_si128(_mm_cmplt_epi8(v, space), _mm_cmpeq_epi8(v, del)));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(special);
+        if (mask) {
+            return idx + simd_ctz(mask);
+        }
+        idx += 16;
+    }
+    return scan_ascii_str_scalar(buf, idx, len);
+}
+
+static Py_ssize_t
+copy_ascii_unicode_sse2(const Py_UNICODE *buf, Py_ssize_t idx, Py_ssize_t len, char *output)
+{
+    /* 16 characters per step, stored once they are all safe */
+    const Py_ssize_t start = idx;
+#if Py_UNICODE_SIZE == 4
+    const __m128i quote = _mm_set1_epi32('"');
+    const __m128i backslash = _mm_set1_epi32('\\');
+    const __m128i space = _mm_set1_epi32(' ');
+    const __m128i tilde = _mm_set1_epi32('~');
+    while (idx + 16 <= len) {
+        __m128i v0 = _mm_loadu_si128((const __m128i *)(buf + idx));
+        __m128i v1 = _mm_loadu_si128((const __m128i *)(buf + idx + 4));
+        __m128i v2 = _mm_loadu_si128((const __m128i *)(buf + idx + 8));
+        __m128i v3 = _mm_loadu_si128((const __m128i *)(buf + idx + 12));
+        /* code points are at most 0x10ffff, so signed compares are safe */
+#define ASCII_SPECIAL32(v) _mm_or_si128( \
+            _mm_or_si128(_mm_cmpeq_epi32(v, quote), _mm_cmpeq_epi32(v, backslash)), \
+            _mm_or_si128(_mm_cmplt_epi32(v, space), _mm_cmpgt_epi32(v, tilde)))
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(ASCII_SPECIAL32(v0), ASCII_SPECIAL32(v1)),
+            _mm_or_si128(ASCII_SPECIAL32(v2), ASCII_SPECIAL32(v3)));
+#undef ASCII_SPECIAL32
+        if (_mm_movemask_epi8(special)) {
+            break;
+        }
+        _mm_storeu_si128((__m128i *)(output + (idx - start)),
+            _mm_packus_epi16(_mm_packs_epi32(v0, v1), _mm_packs_epi32(v2, v3)));
+        idx += 16;
+    }
+#else
+    const __m128i quote = _mm_set1_epi16('"');
+    const __m128i backslash = _mm_set1_epi16('\\');
+    const __m128i ctrl = _mm_set1_epi16(0x1f);
+    const __m128i tilde = _mm_set1_epi16('~');
+    const __m128i zero = _mm_setzero_si128();
+    while (idx + 16 <= len) {
+        __m128i v0 = _mm_loadu_si128((const __m128i *)(buf + idx));
+        __m128i v1 = _mm_loadu_si128((const __m128i *)(buf + idx + 8));
+        /* unsigned range checks by saturating subtraction: v <= 0x1f iff
+           v - 0x1f is zero, v <= '~' iff v - '~' is zero */
+#define ASCII_SAFE16(v) _mm_andnot_si128( \
+            _mm_or_si128( \
+                _mm_or_si128(_mm_cmpeq_epi16(v, quote), _mm_cmpeq_epi16(v, backslash)), \
+                _mm_cmpeq_epi16(_mm_subs_epu16(v, ctrl), zero)), \
+            _mm_cmpeq_epi16(_mm_subs_epu16(v, tilde), zero))
+        __m128i safe = _mm_and_si128(ASCII_SAFE16(v0), ASCII_SAFE16(v1));
+#undef ASCII_SAFE16
+        if (_mm_movemask_epi8(safe) != 0xffff) {
+            break;
+        }
+        _mm_storeu_si128((__m128i *)(output + (idx - start)), _mm_packus_epi16(v0, v1));
+        idx += 16;
+    }
+#endif
+    return copy_ascii_unicode_scalar(buf, idx, len, output + (idx - start));
+}
+#endif
+
+#ifdef JSON_HAVE_AVX2
+static JSON_TARGET_AVX2 Py_ssize_t
+scan_plain_str_avx2(const char *buf, Py_ssize_t idx, Py_ssize_t len, int *has_unicode)
+{
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i ctrl = _mm256_set1_epi8(0x1f);
+    unsigned int high = 0;
+    while (idx + 32 <= len) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(buf + idx));
+        __m256i special = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash)),
+            _mm256_cmpeq_epi8(_mm256_max_epu8(v, ctrl), ctrl));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(special);
+        if (mask) {
+            int pos = simd_ctz(mask);
+            /* pos can be 31, so build the prefix mask without shifting by 32 */
+            high |= (unsigned int)_mm256_movemask_epi8(v) & ~(0xffffffffu << pos);
+            if (high) {
+                *has_unicode = 1;
+            }
+            return idx + pos;
+        }
+        high |= (unsigned int)_mm256_movemask_epi8(v);
+        idx += 32;
+    }
+    if (high) {
+        *has_unicode = 1;
+    }
+    /* clear the upper halves so the SSE2 tail doesn't pay a transition */
+    _mm256_zeroupper();
+    return scan_plain_str_sse2(buf, idx, len, has_unicode);
+}
+
+static JSON_TARGET_AVX2 Py_ssize_t
+scan_plain_unicode_avx2(const Py_UNICODE *buf, Py_ssize_t idx, Py_ssize_t len)
+{
+#if Py_UNICODE_SIZE == 4
+    const __m256i quote = _mm256_set1_epi32('"');
+    const __m256i backslash = _mm256_set1_epi32('\\');
+    const __m256i space = _mm256_set1_epi32(0x20);
+    const Py_ssize_t step = 8;
+#else
+    const __m256i quote = _mm256_set1_epi16('"');
+    const __m256i backslash = _mm256_set1_epi16('\\');
+    const __m256i ctrl = _mm256_set1_epi16(0x1f);
+    const __m256i zero = _mm256_setzero_si256();
+    const Py_ssize_t step = 16;
+#endif
+    while (idx + step <= len) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(buf + idx));
+#if Py_UNICODE_SIZE == 4
+        __m256i special = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi32(v, quote), _mm256_cmpeq_epi32(v, backslash)),
+            _mm256_cmpgt_epi32(space, v));
+#else
+        __m256i special = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi16(v, quote), _mm256_cmpeq_epi16(v, backslash)),
+            _mm256_cmpeq_epi16(_mm256_subs_epu16(v, ctrl), zero));
+#endif
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(special);
+        if (mask) {
+            return idx + simd_ctz(mask) / Py_UNICODE_SIZE;
+        }
+        idx += step;
+    }
+    _mm256_zeroupper();
+    return scan_plain_unicode_sse2(buf, idx, len);
+}
+
+static JSON_TARGET_AVX2 Py_ssize_t
+scan_ascii_str_avx2(const char *buf, Py_ssize_t idx, Py_ssize_t len)
+{
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i del = _mm256_set1_epi8(0x7f);
+    while (idx + 32 <= len) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(buf + idx));
+        __m256i special = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash)),
+            _mm256_or_si256(_mm256_cmpgt_epi8(space, v), _mm256_cmpeq_epi8(v, del)));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(special);
+        if (mask) {
+            return idx + simd_ctz(mask);
+        }
+        idx += 32;
+    }
+    _mm256_zeroupper();
+    return scan_ascii_str_sse2(buf, idx, len);
+}
+#endif
+
+static int simd_level = SIMD_SCALAR;
+static scan_plain_str_func scan_plain_str = scan_plain_str_scalar;
+static scan_plain_unicode_func scan_plain_unicode = scan_plain_unicode_scalar;
+static scan_ascii_str_func scan_ascii_str = scan_ascii_str_scalar;
+static copy_ascii_unicode_func copy_ascii_unicode = copy_ascii_unicode_scalar;
+
+static int
+simd_supported(int level)
+{
+    switch (level) {
+        case SIMD_SCALAR:
+            return 1;
+#ifdef JSON_HAVE_SSE2
+        case SIMD_SSE2:
+            return 1;
+#endif
+#ifdef JSON_HAVE_AVX2
+        case SIMD_AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#endif
+    }
+    return 0;
+}
+
+static void
+simd_select(int level)
+{
+    simd_level = level;
+    switch (level) {
+#ifdef JSON_HAVE_AVX2
+        case SIMD_AVX2:
+            scan_plain_str = scan_plain_str_avx2;
+            scan_plain_unicode = scan_plain_unicode_avx2;
+            scan_ascii_str = scan_ascii_str_avx2;
+            copy_ascii_unicode = copy_ascii_unicode_sse2;
+            break;
+#endif
+#ifdef JSON_HAVE_SSE2
+        case SIMD_SSE2:
+            scan_plain_str = scan_plain_str_sse2;
+            scan_plain_unicode = scan_plain_unicode_sse2;
+            scan_ascii_str = scan_ascii_str_sse2;
+            copy_ascii_unicode = copy_ascii_unicode_sse2;
+            break;
+#endif
+        default:
+            simd_level = SIMD_SCALAR;
+            scan_plain_str = scan_plain_str_scalar;
+            scan_plain_unicode = scan_plain_unicode_scalar;
+            scan_ascii_str = scan_ascii_str_scalar;
+            copy_ascii_unicode = copy_ascii_unicode_scalar;
+    }
+}
+
+/*
+The str variants of the scanner also parse any other object with a read
+buffer (mmap, bytearray, buffer) in place.  An mmap has no buffer view to
+hold, so a hook or codec may close or resize it while it is being decoded;
+the pointer is looked up again with str_source_again after any Python
+code has run.
+*/
+static char *
+str_source(PyObject *pystr, Py_ssize_t *len_ptr)
+{
+    const void *buf;
+    if (PyString_Check(pystr)) {
+        *len_ptr = PyString_GET_SIZE(pystr);
+        return PyString_AS_STRING(pystr);
+    }
+    if (PyObject_AsReadBuffer(pystr, &buf, len_ptr) == -1)
+        return NULL;
+    return (char *)buf;
+}
+
+static char *
+str_source_again(PyObject *pystr, Py_ssize_t len)
+{
+    /* The pointer to pystr, which had len bytes before Python code ran.
+       Raises ValueError if it was closed or resized in the meantime. */
+    char *buf;
+    Py_ssize_t new_len;
+    if (PyString_Check(pystr))
+        return PyString_AS_STRING(pystr);
+    buf = str_source(pystr, &new_len);
+    if (buf == NULL || new_len != len) {
+        /* a closed mmap fails with TypeError */
+        PyErr_Clear();
+        PyErr_SetString(PyExc_ValueError, "source was closed or resized while being decoded");
+        return NULL;
+    }
+    return buf;
+}
+
+static void
+scratch_init(JSON_Scratch *b)
+{
+    b->buf = b->inline_buf;
+    b->len = 0;
+    b->size = JSON_SCRATCH_INLINE;
+}
+
+static void
+scratch_free(JSON_Scratch *b)
+{
+    if (b->buf != b->inline_buf) {
+        PyMem_Free(b->buf);
+    }
+    b->buf = b->inline_buf;
+    b->len = 0;
+    b->size = JSON_SCRATCH_INLINE;
+}
+
+static int
+scratch_grow(JSON_Scratch *b, Py_ssize_t need)
+{
+    /* Make room for at least need more characters, doubling the allocation */
+    Py_ssize_t size = b->size;
+    Py_UNICODE *buf;
+    if (need > PY_SSIZE_T_MAX / (Py_ssize_t)sizeof(Py_UNICODE) - b->len) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    while (size - b->len < need) {
+        if (size > PY_SSIZE_T_MAX / (Py_ssize_t)(2 * sizeof(Py_UNICODE))) {
+            size = b->len + need;
+            break;
+        }
+        size *= 2;
+    }
+    if (b->buf == b->inline_buf) {
+        buf = PyMem_New(Py_UNICODE, size);
+        if (buf != NULL) {
+            memcpy(buf, b->inline_buf, b->len * sizeof(Py_UNICODE));
+        }
+    }
+    else {
+        buf = PyMem_Resize(b->buf, Py_UNICODE, size);
+    }
+    if (buf == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    b->buf = buf;
+    b->size = size;
+    return 0;
+}
+
+static int
+scratch_append_utf8(JSON_Scratch *b, const unsigned char *p, Py_ssize_t n)
+{
+    /* Decode UTF-8 the way Python's codec does, which accepts encoded
+       surrogates.  Returns 1 without appending anything if p[:n] is not
+       entirely valid so the caller can let the codec report the error. */
+    Py_UNICODE *out;
+    Py_ssize_t i = 0;
+    if (SCRATCH_RESERVE(b, n))
+        return -1;
+    out = b->buf + b->len;
+    while (i < n) {
+        unsigned char c = p[i];
+        Py_UCS4 ch;
+        if (c < 0x80) {
+            *out++ = c;
+            i++;
+            continue;
+        }
+        if (c >= 0xc2 && c <= 0xdf) {
+            if (i + 1 >= n || (p[i + 1] & 0xc0) != 0x80)
+                return 1;
+            ch = ((c & 0x1f) << 6) | (p[i + 1] & 0x3f);
+            i += 2;
+        }
+        else if (c >= 0xe0 && c <= 0xef) {
+            if (i + 2 >= n || (p[i + 1] & 0xc0) != 0x80 || (p[i + 2] & 0xc0) != 0x80 ||
+                    (c == 0xe0 && p[i + 1] < 0xa0))
+                return 1;
+            ch = ((c & 0x0f) << 12) | ((p[i + 1] & 0x3f) << 6) | (p[i + 2] & 0x3f);
+            i += 3;
+        }
+        else if (c >= 0xf0 && c <= 0xf4) {
+            if (i + 3 >= n || (p[i + 1] & 0xc0) != 0x80 || (p[i + 2] & 0xc0) != 0x80 ||
+                    (p[i + 3] & 0xc0) != 0x80 || (c == 0xf0 && p[i + 1] < 0x90) ||
+                    (c == 0xf4 && p[i + 1] >= 0x90))
+                return 1;
+            ch = ((c & 0x07) << 18) | ((p[i + 1] & 0x3f) << 12) |
+                ((p[i + 2] & 0x3f) << 6) | (p[i + 3] & 0x3f);
+            i += 4;
+#ifndef Py_UNICODE_WIDE
+            ch -= 0x10000;
+            *out++ = 0xd800 | (ch >> 10);
+            ch = 0xdc00 | (ch & 0x3ff);
+#endif
+        }
+        else {
+            return 1;
+        }
+        *out++ = (Py_UNICODE)ch;
+    }
+    b->len = out - b->buf;
+    return 0;
+}
+
+static int
+scratch_append_str(JSON_Scratch *b, const char *p, Py_ssize_t n, char *encoding)
+{
+    /* Append p[:n], which is ASCII when encoding is NULL */
+    PyObject *chunk;
+    Py_ssize_t i;
+    int rval;
+    if (encoding == NULL) {
+        if (SCRATCH_RESERVE(b, n))
+            return -1;
+        for (i = 0; i < n; i++) {
+            b->buf[b->len + i] = (unsigned char)p[i];
+        }
+        b->len += n;
+        return 0;
+    }
+    if (strcmp(encoding, DEFAULT_ENCODING) == 0) {
+        rval = scratch_append_utf8(b, (const unsigned char *)p, n);
+        if (rval <= 0)
+            return rval;
+    }
+    STATS_INC(fallbacks);
+    chunk = PyUnicode_Decode(p, n, encoding, NULL);
+    if (chunk == NULL)
+        return -1;
+    if (!PyUnicode_Check(chunk)) {
+        PyErr_Format(PyExc_TypeError,
+                     "decoder did not return a unicode object (type=%.400s)",
+                     Py_TYPE(chunk)->tp_name);
+        Py_DECREF(chunk);
+        return -1;
+    }
+    rval = SCRATCH_RESERVE(b, PyUnicode_GET_SIZE(chunk));
+    if (rval == 0) {
+        memcpy(b->buf + b->len, PyUnicode_AS_UNICODE(chunk),
+               PyUnicode_GET_SIZE(chunk) * sizeof(Py_UNICODE));
+        b->len += PyUnicode_GET_SIZE(chunk);
+    }
+    Py_DECREF(chunk);
+    return rval;
+}
+
+static PyObject *
+scratch_finish(JSON_Scratch *b, int is_unicode)
+{
+    /* The contents as unicode, or as str when they are all ASCII */
+    PyObject *rval;
+    Py_ssize_t i;
+    if (is_unicode) {
+        rval = PyUnicode_FromUnicode(b->buf, b->len);
+    }
+    else {
+        rval = PyString_FromStringAndSize(NULL, b->len);
+        if (rval != NULL) {
+            char *out = PyString_AS_STRING(rval);
+            for (i = 0; i < b->len; i++) {
+                out[i] = (char)b->buf[i];
+            }
+        }
+    }
+    scratch_free(b);
+    return rval;
+}
+
+static PyObject *
+scanstring_str(PyObject *pystr, Py_ssize_t end, char *encoding, int strict, Py_ssize_t *next_end_ptr)
+{
+    PyObject *rval;
+    Py_ssize_t len;
+    Py_ssize_t begin = end - 1;
+    Py_ssize_t next = begin;
+    int has_unicode = 0;
+    char *buf = str_source(pystr, &len);
+    JSON_Scratch scratch;
+    scratch_init(&scratch);
+    if (buf == NULL) {
+        goto bail;
+    }
+    if (end < 0 || len <= end) {
+        PyErr_SetString(PyExc_ValueError, "end is out of bounds");
+        goto bail;
+    }
+    while (1) {
+        /* Find the end of the string or the next escape */
+        Py_UNICODE c = 0;
+        for (next = end; ; next++) {
+            next = scan_plain_str(buf, next, len, &has_unicode);
+            if (next == len) {
+                break;
+            }
+            c = (unsigned char)buf[next];
+            if (c == '"' || c == '\\') {
+                break;
+            }
+            else if (strict) {
+                raise_errmsg("Invalid control character at", pystr, next);
+                goto bail;
+            }
+        }
+        if (!(c == '"' || c == '\\')) {
+            raise_errmsg("Unterminated string starting at", pystr, begin);
+            goto bail;
+        }
+        /* Pick up this chunk if it's not zero length */
+        if (next != end) {
+            if (c == '"' && scratch.len == 0) {
+                /* no escapes, the result is just this chunk */
+                if (has_unicode)
+                    rval = PyUnicode_Decode(&buf[end], next - end, encoding, NULL);
+                else
+                    rval = PyString_FromStringAndSize(&buf[end], next - end);
+                if (rval == NULL) {
+                    goto bail;
+                }
+                STATS_INC(strings);
+                *next_end_ptr = next + 1;
+                return rval;
+            }
+            if (scratch_append_str(&scratch, &buf[end], next - end, has_unicode ? encoding : NULL)) {
+                goto bail;
+            }
+            if (has_unicode) {
+                /* the codec may have been Python code */
+                buf = str_source_again(pystr, len);
+                if (buf == NULL)
+                    goto bail;
+            }
+        }
+        next++;
+        if (c == '"') {
+            end = next;
+            break;
+        }
+        if (next == len) {
+            raise_errmsg("Unterminated string starting at", pystr, begin);
+            goto bail;
+        }
+        c = buf[next];
+        if (c != 'u') {
+            /* Non-unicode backslash escapes */
+            end = next + 1;
+            switch (c) {
+                case '"': break;
+                case '\\': break;
+                case '/': break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'n': c = '\n'; break;
+                case 'r': c = '\r'; break;
+                case 't': c = '\t'; break;
+                default: c = 0;
+            }
+            if (c == 0) {
+                raise_errmsg("Invalid \\escape", pystr, end - 2);
+                goto bail;
+            }
+        }
+        else {
+            c = 0;
+            next++;
+            end = next + 4;
+            if (end >= len) {
+                raise_errmsg("Invalid \\uXXXX escape", pystr, next - 1);
+                goto bail;
+            }
+            /* Decode 4 hex digits */
+            for (; next < end; next++) {
+                c <<= 4;
+                Py_UNICODE digit = buf[next];
+                switch (digit) {
+                    case '0': case '1': case '2': case '3': case '4':
+                    case '5': case '6': case '7': case '8': case '9':
+                        c |= (digit - '0'); break;
+                    case 'a': case 'b': case 'c': case 'd': case 'e':
+                    case 'f':
+                        c |= (digit - 'a' + 10); break;
+                    case 'A': case 'B': case 'C': case 'D': case 'E':
+                    case 'F':
+                        c |= (digit - 'A' + 10); break;
+                    default:
+                        raise_errmsg("Invalid \\uXXXX escape", pystr, end - 5);
+                        goto bail;
+                }
+            }
+#ifdef Py_UNICODE_WIDE
+            /* Surrogate pair */
+            if ((c & 0xfc00) == 0xd800) {
+                Py_UNICODE c2 = 0;
+                if (end + 6 >= len) {
+                    raise_errmsg("Unpaired high surrogate", pystr, end - 5);
+                    goto bail;
+                }
+                if (buf[next++] != '\\' || buf[next++] != 'u') {
+                    raise_errmsg("Unpaired high surrogate", pystr, end - 5);
+                    goto bail;
+                }
+                end += 6;
+                /* Decode 4 hex digits */
+                for (; next < end; next++) {
+                    c2 <<= 4;
+                    Py_UNICODE digit = buf[next];
+                    switch (digit) {
+                        case '0': case '1': case '2': case '3': case '4':
+                        case '5': case '6': case '7': case '8': case '9':
+                            c2 |= (digit - '0'); break;
+                        case 'a': case 'b': case 'c': case 'd': case 'e':
+                        case 'f':
+                            c2 |= (digit - 'a' + 10); break;
+                        case 'A': case 'B': case 'C': case 'D': case 'E':
+                        case 'F':
+                            c2 |= (digit - 'A' + 10); break;
+                        default:
+                            raise_errmsg("Invalid \\uXXXX escape", pystr, end - 5);
+                            goto bail;
+                    }
+                }
+                if ((c2 & 0xfc00) != 0xdc00) {
+                    raise_errmsg("Unpaired high surrogate", pystr, end - 5);
+                    goto bail;
+                }
+                c = 0x10000 + (((c - 0xd800) << 10) | (c2 - 0xdc00));
+            }
+            else if ((c & 0xfc00) == 0xdc00) {
+                raise_errmsg("Unpaired low surrogate", pystr, end - 5);
+                goto bail;
+            }
+#endif
+        }
+        if (c > 0x7f) {
+            has_unicode = 1;
+        }
+        if (SCRATCH_RESERVE(&scratch, 1)) {
+            goto bail;
+        }
+        STATS_INC(escapes);
+        scratch.buf[scratch.len++] = c;
+    }
+
+    rval = scratch_finish(&scratch, has_unicode);
+    if (rval == NULL) {
+        goto bail;
+    }
+    STATS_INC(strings);
+    *next_end_ptr = end;
+    return rval;
+bail:
+    *next_end_ptr = -1;
+    scratch_free(&scratch);
+    return NULL;
+}
+
+
+static PyObject *
+scanstring_unicode(PyObject *pystr, Py_ssize_t end, int strict, Py_ssize_t *next_end_ptr)
+{
+    PyObject *rval;
+    Py_ssize_t len = PyUnicode_GET_SIZE(pystr);
+    Py_ssize_t begin = end - 1;
+    Py_ssize_t next = begin;
+    const Py_UNICODE *buf = PyUnicode_AS_UNICODE(pystr);
+    JSON_Scratch scratch;
+    scratch_init(&scratch);
+    if (end < 0 || len <= end) {
+        PyErr_SetString(PyExc_ValueError, "end is out of bounds");
+        goto bail;
+    }
+    while (1) {
+        /* Find the end of the string or the next escape */
+        Py_UNICODE c = 0;
+        for (next = end; ; next++) {
+            next = scan_plain_unicode(buf, next, len);
+            if (next == len) {
+                break;
+            }
+            c = buf[next];
+            if (c == '"' || c == '\\') {
+                break;
+            }
+            else if (strict) {
+                raise_errmsg("Invalid control character at", pystr, next);
+                goto bail;
+            }
+        }
+        if (!(c == '"' || c == '\\')) {
+            raise_errmsg("Unterminated string starting at", pystr, begin);
+            goto bail;
+        }
+        /* Pick up this chunk if it's not zero length */
+        if (next != end) {
+            if (c == '"' && scratch.len == 0) {
+                /* no escapes, the result is just this chunk */
+                rval = PyUnicode_FromUnicode(&buf[end], next - end);
+                if (rval == NULL) {
+                    goto bail;
+                }
+                STATS_INC(strings);
+                *next_end_ptr = next + 1;
+                return rval;
+            }
+            if (SCRATCH_RESERVE(&scratch, next - end)) {
+                goto bail;
+            }
+            memcpy(scratch.buf + scratch.len, &buf[end], (next - end) * sizeof(Py_UNICODE));
+            scratch.len += next - end;
+        }
+        next++;
+        if (c == '"') {
+            end = next;
+            break;
+        }
+        if (next == len) {
+            raise_errmsg("Unterminated string starting at", pystr, begin);
+            goto bail;
+        }
+        c = buf[next];
+        if (c != 'u') {
+            /* Non-unicode backslash escapes */
+            end = next + 1;
+            switch (c) {
+                case '"': break;
+                case '\\': break;
+                case '/': break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'n': c = '\n'; break;
+                case 'r': c = '\r'; break;
+                case 't': c = '\t'; break;
+                default: c = 0;
+            }
+            if (c == 0) {
+                raise_errmsg("Invalid \\escape", pystr, end - 2);
+                goto bail;
+            }
+        }
+        else {
+            c = 0;
             next++;
             end = next + 4;
             if (end >= len) {
                 raise_errmsg("Invalid \\uXXXX escape", pystr, next - 1);
                 goto bail;
             }
-            /* Decode 4 hex digits */
-            for (; next < end; next++) {
-                c <<= 4;
-                Py_UNICODE digit = buf[next];
-                switch (digit) {
-                    case '0': case '1': case '2': case '3': case '4':
-                    case '5': case '6': case '7': case '8': case '9':
-                        c |= (digit - '0'); break;
-                    case 'a': case 'b': case 'c': case 'd': case 'e':
-                    case 'f':
-                        c |= (digit - 'a' + 10); break;
-                    case 'A': case 'B': case 'C': case 'D': case 'E':
-                    case 'F':
-                        c |= (digit - 'A' + 10); break;
-                    default:
-                        raise_errmsg("Invalid \\uXXXX escape", pystr, end - 5);
-                        goto bail;
+            /* Decode 4 hex digits */
+            for (; next < end; next++) {
+                c <<= 4;
+                Py_UNICODE digit = buf[next];
+                switch (digit) {
+                    case '0': case '1': case '2': case '3': case '4':
+                    case '5': case '6': case '7': case '8': case '9':
+                        c |= (digit - '0'); break;
+                    case 'a': case 'b': case 'c': case 'd': case 'e':
+                    case 'f':
+                        c |= (digit - 'a' + 10); break;
+                    case 'A': case 'B': case 'C': case 'D': case 'E':
+                    case 'F':
+                        c |= (digit - 'A' + 10); break;
+                    default:
+                        raise_errmsg("Invalid \\uXXXX escape", pystr, end - 5);
+                        goto bail;
+                }
+            }
+#ifdef Py_UNICODE_WIDE
+            /* Surrogate pair */
+            if ((c & 0xfc00) == 0xd800) {
+                Py_UNICODE c2 = 0;
+                if (end + 6 >= len) {
+                    raise_errmsg("Unpaired high surrogate", pystr, end - 5);
+                    goto bail;
+                }
+                if (buf[next++] != '\\' || buf[next++] != 'u') {
+                    raise_errmsg("Unpaired high surrogate", pystr, end - 5);
+                    goto bail;
+                }
+                end += 6;
+                /* Decode 4 hex digits */
+                for (; next < end; next++) {
+                    c2 <<= 4;
+                    Py_UNICODE digit = buf[next];
+                    switch (digit) {
+                        case '0': case '1': case '2': case '3': case '4':
+                        case '5': case '6': case '7': case '8': case '9':
+                            c2 |= (digit - '0'); break;
+                        case 'a': case 'b': case 'c': case 'd': case 'e':
+                        case 'f':
+                            c2 |= (digit - 'a' + 10); break;
+                        case 'A': case 'B': case 'C': case 'D': case 'E':
+                        case 'F':
+                            c2 |= (digit - 'A' + 10); break;
+                        default:
+                            raise_errmsg("Invalid \\uXXXX escape", pystr, end - 5);
+                            goto bail;
+                    }
+                }
+                if ((c2 & 0xfc00) != 0xdc00) {
+                    raise_errmsg("Unpaired high surrogate", pystr, end - 5);
+                    goto bail;
+                }
+                c = 0x10000 + (((c - 0xd800) << 10) | (c2 - 0xdc00));
+            }
+            else if ((c & 0xfc00) == 0xdc00) {
+                raise_errmsg("Unpaired low surrogate", pystr, end - 5);
+                goto bail;
+            }
+#endif
+        }
+        if (SCRATCH_RESERVE(&scratch, 1)) {
+            goto bail;
+        }
+        STATS_INC(escapes);
+        scratch.buf[scratch.len++] = c;
+    }
+
+    /* an empty string is returned as str by both variants */
+    rval = scratch_finish(&scratch, scratch.len != 0);
+    if (rval == NULL) {
+        goto bail;
+    }
+    STATS_INC(strings);
+    *next_end_ptr = end;
+    return rval;
+bail:
+    *next_end_ptr = -1;
+    scratch_free(&scratch);
+    return NULL;
+}
+
+PyDoc_STRVAR(pydoc_scanstring,
+    "scanstring(basestring, end, encoding) -> (str, end)\n"
+    "\n"
+    "..."
+);
+
+static PyObject *
+py_scanstring(PyObject* self UNUSED, PyObject *args)
+{
+    PyObject *pystr;
+    PyObject *rval;
+    Py_ssize_t end;
+    Py_ssize_t next_end = -1;
+    char *encoding = NULL;
+    int strict = 0;
+    if (!PyArg_ParseTuple(args, "OO&|zi:scanstring", &pystr, _convertPyInt_AsSsize_t, &end, &encoding, &strict)) {
+        return NULL;
+    }
+    if (encoding == NULL) {
+        encoding = DEFAULT_ENCODING;
+    }
+    if (PyString_Check(pystr)) {
+        rval = scanstring_str(pystr, end, encoding, strict, &next_end);
+    }
+    else if (PyUnicode_Check(pystr)) {
+        rval = scanstring_unicode(pystr, end, strict, &next_end);
+    }
+    else {
+        PyErr_Format(PyExc_TypeError,
+                     "first argument must be a string, not %.80s",
+                     Py_TYPE(pystr)->tp_name);
+        return NULL;
+    }
+    return _build_rval_index_tuple(rval, next_end);
+}
+
+PyDoc_STRVAR(pydoc_encode_basestring_ascii,
+    "encode_basestring_ascii(basestring) -> str\n"
+    "\n"
+    "..."
+);
+
+static PyObject *
+py_encode_basestring_ascii(PyObject* self UNUSED, PyObject *pystr)
+{
+    /* METH_O */
+    if (PyString_Check(pystr)) {
+        return ascii_escape_str(pystr);
+    }
+    else if (PyUnicode_Check(pystr)) {
+        return ascii_escape_unicode(pystr);
+    }
+    else {
+        PyErr_Format(PyExc_TypeError,
+                     "first argument must be a string, not %.80s",
+                     Py_TYPE(pystr)->tp_name);
+        return NULL;
+    }
+}
+
+/* Characters checked one at a time before a run is handed to the vector
+   scan, which only pays off for longer runs, and characters escaped for
+   each reservation of buffer space */
+#define ASCII_RUN_INLINE 16
+#define ASCII_ESCAPE_BATCH 16
+
+static int
+buffer_ascii_escape_chars(JSON_Buffer *b, const Py_UNICODE *input_unicode, Py_ssize_t i, Py_ssize_t input_chars)
+{
+    /* Escape input_unicode[i:input_chars] and leave room for a closing
+       quote */
+    char *output;
+    if (BUFFER_RESERVE(b, 1 + (input_chars - i)))
+        return -1;
+    output = b->buf + b->len;
+    while (i < input_chars) {
+        /* short runs are copied here, long ones by the vector copy */
+        Py_ssize_t stop = (input_chars - i > ASCII_RUN_INLINE) ? i + ASCII_RUN_INLINE : input_chars;
+        Py_UNICODE c;
+        while (i < stop && (c = input_unicode[i]) <= 0xff && !ascii_escape_table[c]) {
+            *output++ = (char)c;
+            i++;
+        }
+        if (i == stop && i < input_chars) {
+            Py_ssize_t next = copy_ascii_unicode(input_unicode, i, input_chars, output);
+            output += next - i;
+            i = next;
+        }
+        if (i == input_chars)
+            break;
+        b->len = output - b->buf;
+        if (BUFFER_RESERVE(b, 1 + (input_chars - i) + ASCII_ESCAPE_BATCH * MAX_EXPANSION))
+            return -1;
+        output = b->buf + b->len;
+        stop = (input_chars - i > ASCII_ESCAPE_BATCH) ? i + ASCII_ESCAPE_BATCH : input_chars;
+        c = input_unicode[i];
+        do {
+            if (c <= 0xff)
+                output = ascii_escape_byte((unsigned char)c, output);
+            else
+                output += ascii_escape_char(c, output, 0);
+            i++;
+        } while (i < stop && ((c = input_unicode[i]) > 0xff || ascii_escape_table[c]));
+    }
+    b->len = output - b->buf;
+    return 0;
+}
+
+static int
+buffer_ascii_escape_unicode(JSON_Buffer *b, PyObject *pystr)
+{
+    if (buffer_append(b, "\"", 1))
+        return -1;
+    if (buffer_ascii_escape_chars(b, PyUnicode_AS_UNICODE(pystr), 0, PyUnicode_GET_SIZE(pystr)))
+        return -1;
+    b->buf[b->len++] = '"';
+    return 0;
+}
+
+static int
+buffer_ascii_escape_str(JSON_Buffer *b, PyObject *pystr)
+{
+    Py_ssize_t i = 0;
+    Py_ssize_t input_chars = PyString_GET_SIZE(pystr);
+    char *input_str = PyString_AS_STRING(pystr);
+    char *output;
+
+    /* Enough room for the quotes and an unescaped copy, escapes reserve more */
+    if (BUFFER_RESERVE(b, 2 + input_chars))
+        return -1;
+    output = b->buf + b->len;
+    *output++ = '"';
+    while (i < input_chars) {
+        Py_ssize_t next = i;
+        Py_ssize_t stop = (input_chars - i > ASCII_RUN_INLINE) ? i + ASCII_RUN_INLINE : input_chars;
+        unsigned char c;
+        while (next < stop && !ascii_escape_table[(unsigned char)input_str[next]])
+            next++;
+        if (next == stop && next < input_chars)
+            next = scan_ascii_str(input_str, next, input_chars);
+        memcpy(output, input_str + i, next - i);
+        output += next - i;
+        if (next == input_chars)
+            break;
+        b->len = output - b->buf;
+        c = (unsigned char)input_str[next];
+        if (c > 0x7f) {
+            /* Everything before it was ASCII, so the rest continues from
+               the same index of the decoded string */
+            PyObject *uni = PyUnicode_DecodeUTF8(input_str, input_chars, "strict");
+            int rv;
+            if (uni == NULL)
+                return -1;
+            rv = buffer_ascii_escape_chars(b, PyUnicode_AS_UNICODE(uni), next, PyUnicode_GET_SIZE(uni));
+            Py_DECREF(uni);
+            if (rv)
+                return -1;
+            b->buf[b->len++] = '"';
+            return 0;
+        }
+        /* An ASCII char can't possibly expand to a surrogate! */
+        if (BUFFER_RESERVE(b, 1 + (input_chars - next) + MIN_EXPANSION))
+            return -1;
+        output = ascii_escape_byte(c, b->buf + b->len);
+        i = next + 1;
+    }
+    *output++ = '"';
+    b->len = output - b->buf;
+    return 0;
+}
+
+static PyObject *
+ascii_escape_unicode(PyObject *pystr)
+{
+    JSON_Buffer b;
+    buffer_init(&b);
+    if (buffer_ascii_escape_unicode(&b, pystr)) {
+        buffer_free(&b);
+        return NULL;
+    }
+    return buffer_finish(&b);
+}
+
+static PyObject *
+ascii_escape_str(PyObject *pystr)
+{
+    JSON_Buffer b;
+    buffer_init(&b);
+    if (buffer_ascii_escape_str(&b, pystr)) {
+        buffer_free(&b);
+        return NULL;
+    }
+    return buffer_finish(&b);
+}
+
+static int
+buffer_escape_str(JSON_Buffer *b, PyObject *pystr)
+{
+    /* Quote a str with only the escapes JSON requires, bytes pass through */
+    char *input_str = PyString_AS_STRING(pystr);
+    Py_ssize_t input_chars = PyString_GET_SIZE(pystr);
+    Py_ssize_t i = 0;
+    int has_unicode = 0;
+    char *output;
+    if (buffer_append(b, "\"", 1))
+        return -1;
+    while (i < input_chars) {
+        Py_ssize_t next = scan_plain_str(input_str, i, input_chars, &has_unicode);
+        if (buffer_append(b, input_str + i, next - i))
+            return -1;
+        if (next == input_chars)
+            break;
+        if (BUFFER_RESERVE(b, MIN_EXPANSION))
+            return -1;
+        output = b->buf + b->len;
+        b->len += ascii_escape_char((Py_UNICODE)(unsigned char)input_str[next], output, 0);
+        i = next + 1;
+    }
+    return buffer_append(b, "\"", 1);
+}
+
+static int
+buffer_escape_unicode(JSON_Buffer *b, PyObject *pystr)
+{
+    /* Quote a unicode string as UTF-8 with only the escapes JSON requires */
+    Py_UNICODE *input_unicode = PyUnicode_AS_UNICODE(pystr);
+    Py_ssize_t input_chars = PyUnicode_GET_SIZE(pystr);
+    Py_ssize_t i = 0;
+    char *output;
+    b->is_unicode = 1;
+    /* Enough for the quotes and a copy at 4 bytes per character (3 for
+       narrow builds, where a surrogate pair takes two units), escapes
+       reserve more */
+    if (BUFFER_RESERVE(b, 2 + 4 * input_chars))
+        return -1;
+    output = b->buf + b->len;
+    *output++ = '"';
+    while (i < input_chars) {
+        Py_ssize_t next = scan_plain_unicode(input_unicode, i, input_chars);
+        for (; i < next; i++) {
+            Py_UCS4 c = input_unicode[i];
+            if (c < 0x80) {
+                *output++ = (char)c;
+            }
+            else if (c < 0x800) {
+                *output++ = (char)(0xc0 | (c >> 6));
+                *output++ = (char)(0x80 | (c & 0x3f));
+            }
+            else {
+#ifndef Py_UNICODE_WIDE
+                if (c >= 0xd800 && c < 0xdc00 && i + 1 < next &&
+                        input_unicode[i + 1] >= 0xdc00 && input_unicode[i + 1] < 0xe000) {
+                    c = 0x10000 + (((c & 0x3ff) << 10) | (input_unicode[++i] & 0x3ff));
+                }
+#endif
+                if (c < 0x10000) {
+                    *output++ = (char)(0xe0 | (c >> 12));
+                }
+                else {
+                    *output++ = (char)(0xf0 | (c >> 18));
+                    *output++ = (char)(0x80 | ((c >> 12) & 0x3f));
+                }
+                *output++ = (char)(0x80 | ((c >> 6) & 0x3f));
+                *output++ = (char)(0x80 | (c & 0x3f));
+            }
+        }
+        if (i == input_chars)
+            break;
+        b->len = output - b->buf;
+        if (BUFFER_RESERVE(b, 1 + 4 * (input_chars - i) + MIN_EXPANSION))
+            return -1;
+        output = b->buf + b->len;
+        output += ascii_escape_char(input_unicode[i], output, 0);
+        i++;
+    }
+    *output++ = '"';
+    b->len = output - b->buf;
+    return 0;
+}
+
+PyDoc_STRVAR(pydoc_encode_basestring,
+    "encode_basestring(basestring) -> str or unicode\n"
+    "\n"
+    "Quote a string for JSON without escaping non-ASCII characters.\n"
+    "str input is returned as str with its bytes unchanged, unicode\n"
+    "input as unicode."
+);
+
+static PyObject *
+py_encode_basestring(PyObject* self UNUSED, PyObject *pystr)
+{
+    /* METH_O */
+    JSON_Buffer b;
+    int rv;
+    if (PyString_Check(pystr)) {
+        buffer_init(&b);
+        rv = buffer_escape_str(&b, pystr);
+    }
+    else if (PyUnicode_Check(pystr)) {
+        buffer_init(&b);
+        rv = buffer_escape_unicode(&b, pystr);
+    }
+    else {
+        PyErr_Format(PyExc_TypeError,
+                     "first argument must be a string, not %.80s",
+                     Py_TYPE(pystr)->tp_name);
+        return NULL;
+    }
+    if (rv) {
+        buffer_free(&b);
+        return NULL;
+    }
+    return buffer_finish(&b);
+}
+
+PyDoc_STRVAR(pydoc_simd_level,
+    "simd_level() -> str\n"
+    "\n"
+    "Return the instruction set used by the string scanners:\n"
+    "'avx2', 'sse2' or 'scalar'."
+);
+
+static PyObject *
+py_simd_level(PyObject* self UNUSED, PyObject *args UNUSED)
+{
+    return PyString_FromString(simd_level_names[simd_level]);
+}
+
+PyDoc_STRVAR(pydoc_set_simd_level,
+    "_set_simd_level(name) -> str\n"
+    "\n"
+    "Force the string scanners to use the named instruction set and return\n"
+    "the previous one.  Raises ValueError if this CPU or build lacks it.\n"
+    "Intended for tests and benchmarks."
+);
+
+static PyObject *
+py_set_simd_level(PyObject* self UNUSED, PyObject *args)
+{
+    char *name;
+    int level;
+    PyObject *prev;
+    if (!PyArg_ParseTuple(args, "s:_set_simd_level", &name)) {
+        return NULL;
+    }
+    for (level = SIMD_AVX2; level >= SIMD_SCALAR; level--) {
+        if (strcmp(name, simd_level_names[level]) == 0) {
+            break;
+        }
+    }
+    if (level < SIMD_SCALAR || !simd_supported(level)) {
+        PyErr_Format(PyExc_ValueError, "SIMD level %.80s is not available", name);
+        return NULL;
+    }
+    prev = PyString_FromString(simd_level_names[simd_level]);
+    if (prev == NULL) {
+        return NULL;
+    }
+    simd_select(level);
+    return prev;
+}
+
+PyDoc_STRVAR(pydoc_set_float_format,
+    "_set_float_format(name) -> str\n"
+    "\n"
+    "Choose how the encoder formats floats, 'shortest' for the native\n"
+    "formatter or 'repr' to call float.__repr__, and return the previous\n"
+    "choice.  Intended for tests and benchmarks."
+);
+
+static PyObject *
+py_set_float_format(PyObject* self UNUSED, PyObject *args)
+{
+    char *name;
+    PyObject *prev;
+    if (!PyArg_ParseTuple(args, "s:_set_float_format", &name)) {
+        return NULL;
+    }
+    if (strcmp(name, "shortest") != 0 && strcmp(name, "repr") != 0) {
+        PyErr_Format(PyExc_ValueError, "unknown float format %.80s", name);
+        return NULL;
+    }
+#ifdef PY_NO_SHORT_FLOAT_REPR
+    if (name[0] == 's') {
+        PyErr_SetString(PyExc_ValueError, "float.__repr__ is not shortest round-trip in this build");
+        return NULL;
+    }
+#endif
+    prev = PyString_FromString(float_shortest ? "shortest" : "repr");
+    if (prev == NULL) {
+        return NULL;
+    }
+    float_shortest = name[0] == 's';
+    return prev;
+}
+
+PyDoc_STRVAR(pydoc_enable_stats,
+    "enable_stats(flag=True) -> bool\n"
+    "\n"
+    "Turn the hot-path counters reported by stats() on or off and return\n"
+    "whether they were on.  They are off by default."
+);
+
+static PyObject *
+py_enable_stats(PyObject* self UNUSED, PyObject *args)
+{
+    PyObject *flag = Py_True;
+    int prev = stats_enabled;
+    int enable;
+    if (!PyArg_ParseTuple(args, "|O:enable_stats", &flag))
+        return NULL;
+    enable = PyObject_IsTrue(flag);
+    if (enable == -1)
+        return NULL;
+    stats_enabled = enable;
+    return PyBool_FromLong(prev);
+}
+
+PyDoc_STRVAR(pydoc_stats,
+    "stats() -> dict\n"
+    "\n"
+    "Return the hot-path counters collected since the last reset_stats():\n"
+    "\n"
+    "    bytes_scanned   bytes (characters of unicode) of JSON decoded\n"
+    "    bytes_encoded   bytes of JSON encoded\n"
+    "    objects         dicts, lists and records built by the decoder\n"
+    "    strings         strings built by the decoder, repeated object\n"
+    "                    keys shared from the memo are not counted\n"
+    "    escapes         backslash escapes decoded\n"
+    "    callbacks       calls to default, object_hook, record_type and\n"
+    "                    the parse_* hooks\n"
+    "    fallbacks       values handed to Python code the C speedups\n"
+    "                    could not handle natively, such as a custom\n"
+    "                    string encoder or codec, float.__repr__ or\n"
+    "                    subclasses of Decimal and datetime"
+);
+
+static PyObject *
+py_stats(PyObject* self UNUSED, PyObject *args UNUSED)
+{
+    return Py_BuildValue("{s:K,s:K,s:K,s:K,s:K,s:K,s:K}",
+        "bytes_scanned", json_stats.bytes_scanned,
+        "bytes_encoded", json_stats.bytes_encoded,
+        "objects", json_stats.objects,
+        "strings", json_stats.strings,
+        "escapes", json_stats.escapes,
+        "callbacks", json_stats.callbacks,
+        "fallbacks", json_stats.fallbacks);
+}
+
+PyDoc_STRVAR(pydoc_reset_stats,
+    "reset_stats()\n"
+    "\n"
+    "Set all of the counters reported by stats() back to zero."
+);
+
+static PyObject *
+py_reset_stats(PyObject* self UNUSED, PyObject *args UNUSED)
+{
+    memset(&json_stats, 0, sizeof(json_stats));
+    Py_RETURN_NONE;
+}
+
+static long
+memo_hash(const void *raw, Py_ssize_t size)
+{
+    /* FNV-1a over the raw bytes of the key */
+    const unsigned char *p = (const unsigned char *)raw;
+    unsigned long h = 2166136261UL;
+    Py_ssize_t i;
+    for (i = 0; i < size; i++) {
+        h = (h ^ p[i]) * 16777619UL;
+    }
+    return (long)h;
+}
+
+static JSON_MemoEntry *
+memo_find(PyScannerObject *s, const void *raw, Py_ssize_t size, long hash, int is_unicode)
+{
+    /*
+    Return the entry whose raw text is raw[0:size] (size in bytes), or the
+    empty entry where it would be stored.  Returns NULL with an exception
+    set if the table can not be allocated.
+    */
+    size_t mask = JSON_MEMO_SIZE - 1;
+    size_t i = (size_t)hash & mask;
+    if (s->memo == NULL) {
+        s->memo = (JSON_MemoEntry *)PyMem_Malloc(JSON_MEMO_SIZE * sizeof(JSON_MemoEntry));
+        if (s->memo == NULL) {
+            PyErr_NoMemory();
+            return NULL;
+        }
+        memset(s->memo, 0, JSON_MEMO_SIZE * sizeof(JSON_MemoEntry));
+        s->memo_len = 0;
+    }
+    for (;;) {
+        JSON_MemoEntry *entry = &s->memo[i];
+        if (entry->raw == NULL)
+            return entry;
+        if (entry->hash == hash) {
+            if (is_unicode) {
+                if (PyUnicode_CheckExact(entry->raw) &&
+                        (Py_ssize_t)PyUnicode_GET_DATA_SIZE(entry->raw) == size &&
+                        memcmp(PyUnicode_AS_DATA(entry->raw), raw, size) == 0)
+                    return entry;
+            }
+            else if (PyString_CheckExact(entry->raw) &&
+                    PyString_GET_SIZE(entry->raw) == size &&
+                    memcmp(PyString_AS_STRING(entry->raw), raw, size) == 0) {
+                return entry;
+            }
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+static void
+memo_store(PyScannerObject *s, JSON_MemoEntry *entry, long hash, PyObject *raw, PyObject *key)
+{
+    /* Fill the empty entry returned by memo_find, stealing a reference to
+       raw.  An entry filled in the meantime is kept. */
+    if (raw == NULL) {
+        PyErr_Clear();
+        return;
+    }
+    if (entry->raw != NULL) {
+        Py_DECREF(raw);
+        return;
+    }
+    entry->hash = hash;
+    entry->raw = raw;
+    entry->key = key;
+    entry->field = record_field(s, key);
+    Py_INCREF(key);
+    s->memo_len++;
+}
+
+static void
+memo_clear(PyScannerObject *s)
+{
+    Py_ssize_t i;
+    if (s->memo == NULL || s->memo_len == 0)
+        return;
+    for (i = 0; i < JSON_MEMO_SIZE; i++) {
+        JSON_MemoEntry *entry = &s->memo[i];
+        if (entry->raw != NULL) {
+            Py_CLEAR(entry->raw);
+            Py_CLEAR(entry->key);
+        }
+    }
+    s->memo_len = 0;
+}
+
+static void
+scanner_dealloc(PyObject *self)
+{
+    assert(PyScanner_Check(self));
+    PyScannerObject *s = (PyScannerObject *)self;
+    memo_clear(s);
+    PyMem_Free(s->memo);
+    s->memo = NULL;
+    Py_XDECREF(s->encoding);
+    Py_XDECREF(s->strict);
+    Py_XDECREF(s->object_hook);
+    Py_XDECREF(s->parse_float);
+    Py_XDECREF(s->parse_int);
+    Py_XDECREF(s->parse_constant);
+    Py_XDECREF(s->record_type);
+    Py_XDECREF(s->record_fields);
+    Py_XDECREF(s->record_index);
+    Py_XDECREF(s->record_index_str);
+    Py_XDECREF(s->record_names_str);
+    s->encoding = NULL;
+    s->strict = NULL;
+    s->object_hook = NULL;
+    s->parse_float = NULL;
+    s->parse_int = NULL;
+    s->parse_constant = NULL;
+    s->record_type = NULL;
+    s->record_fields = NULL;
+    s->record_index = NULL;
+    s->record_index_str = NULL;
+    s->record_names_str = NULL;
+    self->ob_type->tp_free(self);
+}
+
+/* With record_fields set, an object is collected straight into a tuple
+   ordered by the field names, allocated as the record_type itself when
+   that is a tuple subclass.  It only becomes a dict if it turns out to
+   have a key that is not a field.  Keys from str documents are str when
+   they are ASCII, so those are looked up in record_index_str and named
+   by record_names_str, which never compares them with unicode names. */
+static PyObject *
+record_new(PyScannerObject *s)
+{
+    PyTypeObject *tp = (PyTypeObject *)s->record_type;
+    STATS_INC(objects);
+    if (s->record_index == NULL)
+        return PyDict_New();
+    if (tp != &PyTuple_Type && PyType_Check(tp) && PyType_IsSubtype(tp, &PyTuple_Type))
+        return tp->tp_alloc(tp, PyTuple_GET_SIZE(s->record_fields));
+    return PyTuple_New(PyTuple_GET_SIZE(s->record_fields));
+}
+
+static Py_ssize_t
+record_field(PyScannerObject *s, PyObject *key)
+{
+    /* index of key in record_fields, or -1 */
+    PyObject *idx;
+    if (s->record_index == NULL)
+        return -1;
+    if (PyString_CheckExact(key))
+        idx = PyDict_GetItem(s->record_index_str, key);
+    else
+        idx = PyDict_GetItem(s->record_index, key);
+    if (idx == NULL)
+        return -1;
+    return PyInt_AS_LONG(idx);
+}
+
+static int
+record_set_item(PyScannerObject *s, PyObject **rval_ptr, PyObject *key, PyObject *val, Py_ssize_t field, int is_unicode)
+{
+    /* field is record_field(s, key) */
+    PyObject *rval = *rval_ptr;
+    PyObject *names = is_unicode ? s->record_fields : s->record_names_str;
+    PyObject *item;
+    PyObject *dct;
+    Py_ssize_t i = field;
+    if (!PyTuple_Check(rval))
+        return PyDict_SetItem(rval, key, val);
+    if (i >= 0) {
+        Py_XDECREF(PyTuple_GET_ITEM(rval, i));
+        Py_INCREF(val);
+        PyTuple_SET_ITEM(rval, i, val);
+        return 0;
+    }
+    /* not a record, move the fields seen so far into a dict */
+    dct = PyDict_New();
+    if (dct == NULL)
+        return -1;
+    for (i = 0; i < PyTuple_GET_SIZE(rval); i++) {
+        item = PyTuple_GET_ITEM(rval, i);
+        if (item != NULL && PyDict_SetItem(dct, PyTuple_GET_ITEM(names, i), item) == -1) {
+            Py_DECREF(dct);
+            return -1;
+        }
+    }
+    Py_DECREF(rval);
+    *rval_ptr = dct;
+    return PyDict_SetItem(dct, key, val);
+}
+
+static PyObject *
+record_finish(PyScannerObject *s, PyObject *rval)
+{
+    /* Steals rval.  Missing fields are None, and a record_type that is
+       not a tuple subclass is called with the field values. */
+    PyObject *res;
+    Py_ssize_t i;
+    for (i = 0; i < PyTuple_GET_SIZE(rval); i++) {
+        if (PyTuple_GET_ITEM(rval, i) == NULL) {
+            Py_INCREF(Py_None);
+            PyTuple_SET_ITEM(rval, i, Py_None);
+        }
+    }
+    if (!PyTuple_CheckExact(rval) || s->record_type == (PyObject *)&PyTuple_Type)
+        return rval;
+    STATS_INC(callbacks);
+    res = PyObject_CallObject(s->record_type, rval);
+    Py_DECREF(rval);
+    return res;
+}
+
+static void
+stack_init(JSON_Stack *st)
+{
+    st->frames = st->inline_frames;
+    st->len = 0;
+    st->size = JSON_STACK_INLINE;
+}
+
+static void
+stack_free(JSON_Stack *st)
+{
+    /* release the containers that were still open */
+    while (st->len > 0) {
+        JSON_Frame *frame = &st->frames[--st->len];
+        Py_DECREF(frame->container);
+        Py_XDECREF(frame->key);
+    }
+    if (st->frames != st->inline_frames)
+        PyMem_Free(st->frames);
+    st->frames = st->inline_frames;
+}
+
+static int
+stack_grow(JSON_Stack *st)
+{
+    /* Make room for one more frame */
+    JSON_Frame *frames;
+    Py_ssize_t size = st->size * 2;
+    if (st->frames == st->inline_frames) {
+        frames = (JSON_Frame *)PyMem_Malloc(size * sizeof(JSON_Frame));
+        if (frames != NULL)
+            memcpy(frames, st->inline_frames, st->len * sizeof(JSON_Frame));
+    }
+    else {
+        frames = (JSON_Frame *)PyMem_Realloc(st->frames, size * sizeof(JSON_Frame));
+    }
+    if (frames == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    st->frames = frames;
+    st->size = size;
+    return 0;
+}
+
+static PyObject *
+scan_finish_object(PyScannerObject *s, PyObject *rval)
+{
+    /* Steals rval: records are completed and other objects go through
+       object_hook */
+    PyObject *val;
+    if (PyTuple_Check(rval))
+        return record_finish(s, rval);
+    /* if object_hook is not None: rval = object_hook(rval) */
+    if (s->object_hook != Py_None) {
+        STATS_INC(callbacks);
+        val = PyObject_CallFunctionObjArgs(s->object_hook, rval, NULL);
+        Py_DECREF(rval);
+        return val;
+    }
+    return rval;
+}
+
+static Py_ssize_t
+_parse_key_str(PyScannerObject *s, PyObject *pystr, const char *str, Py_ssize_t length, Py_ssize_t idx, PyObject **key_ptr, Py_ssize_t *field_ptr)
+{
+    /* Read the object key at idx and the : delimiter after it, and return
+       the index of its value, or -1 with an exception set */
+    PyObject *key = NULL;
+    Py_ssize_t next_idx;
+    Py_ssize_t key_end;
+    JSON_MemoEntry *entry = NULL;
+    long hash = 0;
+    int has_unicode = 0;
+    if (str[idx] != '"') {
+        raise_errmsg("Expecting property name", pystr, idx);
+        return -1;
+    }
+    /* reuse the memoized key if it has no escapes and was seen before */
+    key_end = scan_plain_str(str, idx + 1, length, &has_unicode);
+    if (key_end < length && str[key_end] == '"') {
+        hash = memo_hash(str + idx + 1, key_end - idx - 1);
+        entry = memo_find(s, str + idx + 1, key_end - idx - 1, hash, 0);
+        if (entry == NULL)
+            return -1;
+        if (entry->raw != NULL) {
+            key = entry->key;
+            Py_INCREF(key);
+            next_idx = key_end + 1;
+        }
+    }
+    if (key == NULL) {
+        key = scanstring_str(pystr, idx + 1, PyString_AS_STRING(s->encoding),
+                            PyObject_IsTrue(s->strict), &next_idx);
+        if (key == NULL)
+            return -1;
+        str = str_source_again(pystr, length);
+        if (str == NULL) {
+            Py_DECREF(key);
+            return -1;
+        }
+        if (entry != NULL) {
+            /* a codec for another encoding may have decoded with this
+               scanner and filled the slot, so look it up again */
+            entry = memo_find(s, str + idx + 1, key_end - idx - 1, hash, 0);
+            if (entry == NULL) {
+                Py_DECREF(key);
+                return -1;
+            }
+        }
+        if (entry != NULL && entry->raw == NULL && s->memo_len < JSON_MEMO_MAX) {
+            PyObject *raw = key;
+            if (PyString_CheckExact(key))
+                Py_INCREF(raw);
+            else
+                raw = PyString_FromStringAndSize(str + idx + 1, key_end - idx - 1);
+            memo_store(s, entry, hash, raw, key);
+        }
+    }
+    if (entry != NULL && entry->raw != NULL)
+        *field_ptr = entry->field;
+    else
+        *field_ptr = record_field(s, key);
+    *key_ptr = key;
+    idx = next_idx;
+
+    /* skip whitespace between key and : delimiter, read :, skip whitespace */
+    while (idx < length && IS_WHITESPACE(str[idx])) idx++;
+    if (idx >= length || str[idx] != ':') {
+        raise_errmsg("Expecting : delimiter", pystr, idx);
+        return -1;
+    }
+    idx++;
+    while (idx < length && IS_WHITESPACE(str[idx])) idx++;
+    return idx;
+}
+
+static Py_ssize_t
+_parse_key_unicode(PyScannerObject *s, PyObject *pystr, const Py_UNICODE *str, Py_ssize_t length, Py_ssize_t idx, PyObject **key_ptr, Py_ssize_t *field_ptr)
+{
+    /* Read the object key at idx and the : delimiter after it, and return
+       the index of its value, or -1 with an exception set */
+    PyObject *key = NULL;
+    Py_ssize_t next_idx;
+    Py_ssize_t key_end;
+    JSON_MemoEntry *entry = NULL;
+    long hash = 0;
+    if (str[idx] != '"') {
+        raise_errmsg("Expecting property name", pystr, idx);
+        return -1;
+    }
+    /* reuse the memoized key if it has no escapes and was seen before */
+    key_end = scan_plain_unicode(str, idx + 1, length);
+    if (key_end < length && str[key_end] == '"') {
+        Py_ssize_t size = (key_end - idx - 1) * sizeof(Py_UNICODE);
+        hash = memo_hash(str + idx + 1, size);
+        entry = memo_find(s, str + idx + 1, size, hash, 1);
+        if (entry == NULL)
+            return -1;
+        if (entry->raw != NULL) {
+            key = entry->key;
+            Py_INCREF(key);
+            next_idx = key_end + 1;
+        }
+    }
+    if (key == NULL) {
+        key = scanstring_unicode(pystr, idx + 1, PyObject_IsTrue(s->strict), &next_idx);
+        if (key == NULL)
+            return -1;
+        if (entry != NULL && s->memo_len < JSON_MEMO_MAX) {
+            Py_INCREF(key);
+            memo_store(s, entry, hash, key, key);
+        }
+    }
+    if (entry != NULL && entry->raw != NULL)
+        *field_ptr = entry->field;
+    else
+        *field_ptr = record_field(s, key);
+    *key_ptr = key;
+    idx = next_idx;
+
+    /* skip whitespace between key and : delimiter, read :, skip whitespace */
+    while (idx < length && IS_WHITESPACE(str[idx])) idx++;
+    if (idx >= length || str[idx] != ':') {
+        raise_errmsg("Expecting : delimiter", pystr, idx);
+        return -1;
+    }
+    idx++;
+    while (idx < length && IS_WHITESPACE(str[idx])) idx++;
+    return idx;
+}
+
+static PyObject *
+_parse_constant(PyScannerObject *s, char *constant, Py_ssize_t idx, Py_ssize_t *next_idx_ptr) {
+    PyObject *cstr;
+    PyObject *rval;
+    /* constant is "NaN", "Infinity", or "-Infinity" */
+    cstr = PyString_InternFromString(constant);
+    if (cstr == NULL)
+        return NULL;
+
+    /* rval = parse_constant(constant) */
+    STATS_INC(callbacks);
+    rval = PyObject_CallFunctionObjArgs(s->parse_constant, cstr, NULL);
+    idx += PyString_GET_SIZE(cstr);
+    Py_DECREF(cstr);
+    *next_idx_ptr = idx;
+    return rval;
+}
+
+static void
+mul_64x64(JSON_UINT64 a, JSON_UINT64 b, JSON_UINT64 *hi, JSON_UINT64 *lo)
+{
+    /* full 128-bit product of a and b */
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 r = (unsigned __int128)a * b;
+    *hi = (JSON_UINT64)(r >> 64);
+    *lo = (JSON_UINT64)r;
+#else
+    JSON_UINT64 a_lo = a & 0xffffffffU, a_hi = a >> 32;
+    JSON_UINT64 b_lo = b & 0xffffffffU, b_hi = b >> 32;
+    JSON_UINT64 ll = a_lo * b_lo, lh = a_lo * b_hi;
+    JSON_UINT64 hl = a_hi * b_lo, hh = a_hi * b_hi;
+    JSON_UINT64 mid = (ll >> 32) + (lh & 0xffffffffU) + (hl & 0xffffffffU);
+    *lo = (mid << 32) | (ll & 0xffffffffU);
+    *hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+}
+
+static int
+clz64(JSON_UINT64 v)
+{
+    /* leading zero bits of a nonzero v */
+#if defined(__GNUC__)
+    return __builtin_clzll(v);
+#else
+    int n = 0;
+    while (!(v & (((JSON_UINT64)1) << 63))) {
+        v <<= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+static int
+eisel_lemire(JSON_UINT64 w, int q, JSON_UINT64 *bits)
+{
+    /*
+    Round w * 10**q to the nearest double (Eisel-Lemire, as in fast_float)
+    and store its bit pattern.  w must be nonzero.  Returns 0 when the
+    128-bit product can not settle the rounding.
+    */
+    const JSON_UINT64 *pow5;
+    JSON_UINT64 hi, lo, hi2, lo2, mantissa;
+    int lz, upperbit, power2;
+    if (q < POW5_128_MIN_EXPONENT) {
+        *bits = 0;
+        return 1;
+    }
+    if (q > POW5_128_MAX_EXPONENT) {
+        *bits = ((JSON_UINT64)0x7ff) << 52;
+        return 1;
+    }
+    lz = clz64(w);
+    w <<= lz;
+    pow5 = POW5_128[q - POW5_128_MIN_EXPONENT];
+    mul_64x64(w, pow5[0], &hi, &lo);
+    if ((hi & 0x1ff) == 0x1ff) {
+        /* the low bits are all ones, refine with the next 64 bits of 5**q */
+        mul_64x64(w, pow5[1], &hi2, &lo2);
+        lo += hi2;
+        if (hi2 > lo)
+            hi++;
+    }
+    if (lo == ~(JSON_UINT64)0 && (q < -27 || q > 55))
+        return 0;
+    upperbit = (int)(hi >> 63);
+    mantissa = hi >> (upperbit + 9);
+    /* floor(log2(10**q)) + 63, then the unbiased exponent */
+    power2 = (int)((((152170 + 65536) * q) >> 16) + 63) + upperbit - lz + 1023;
+    if (power2 <= 0) {
+        /* subnormal */
+        if (-power2 + 1 >= 64) {
+            *bits = 0;
+            return 1;
+        }
+        mantissa >>= -power2 + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        power2 = (mantissa < (((JSON_UINT64)1) << 52)) ? 0 : 1;
+        *bits = (mantissa & ((((JSON_UINT64)1) << 52) - 1)) | ((JSON_UINT64)power2 << 52);
+        return 1;
+    }
+    if (lo <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1) {
+        /* exactly halfway, round to even */
+        if ((mantissa << (upperbit + 9)) == hi)
+            mantissa &= ~(JSON_UINT64)1;
+    }
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= (((JSON_UINT64)2) << 52)) {
+        mantissa = ((JSON_UINT64)1) << 52;
+        power2++;
+    }
+    mantissa &= ~(((JSON_UINT64)1) << 52);
+    if (power2 >= 0x7ff) {
+        *bits = ((JSON_UINT64)0x7ff) << 52;
+        return 1;
+    }
+    *bits = mantissa | ((JSON_UINT64)power2 << 52);
+    return 1;
+}
+
+static int
+decimal_to_double(JSON_UINT64 w, int q, int truncated, double *out)
+{
+    /*
+    Convert w * 10**q to the nearest double without allocating.  When
+    truncated, the exact value lies between w and w + 1 (times 10**q).
+    Returns 0 if the caller must fall back to PyOS_string_to_double.
+    */
+    static const double pow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    JSON_UINT64 bits, bits_up;
+    if (w == 0) {
+        *out = 0.0;
+        return 1;
+    }
+#ifdef JSON_EXACT_DOUBLE_ARITH
+    /* Clinger's fast path: both operands and the result are exact doubles */
+    if (!truncated && w <= (((JSON_UINT64)1) << 53) && q >= -22 && q <= 22) {
+        *out = (q < 0) ? (double)w / pow10[-q] : (double)w * pow10[q];
+        return 1;
+    }
+#endif
+    if (!eisel_lemire(w, q, &bits))
+        return 0;
+    if (truncated) {
+        if (w + 1 == 0 || !eisel_lemire(w + 1, q, &bits_up) || bits != bits_up)
+            return 0;
+    }
+    memcpy(out, &bits, sizeof(*out));
+    return 1;
+}
+
+static PyObject *
+_number_from_ascii(const char *num, Py_ssize_t n, int is_float)
+{
+    /*
+    Build an int, long or float from the validated JSON number num[0:n].
+    Machine-sized ints and most floats are parsed in place; the rest go
+    through Python's own conversions on a NUL terminated copy.
+    */
+    const char *p = num;
+    const char *end = num + n;
+    char inline_buf[JSON_NUMBER_INLINE + 1];
+    char *buf;
+    PyObject *rval;
+    int negative = 0;
+    if (*p == '-') {
+        negative = 1;
+        p++;
+    }
+    if (!is_float && end - p <= 18) {
+        /* fits in 63 bits */
+        PY_LONG_LONG v = 0;
+        while (p < end) {
+            v = v * 10 + (*p++ - '0');
+        }
+        if (negative)
+            v = -v;
+        if (v >= LONG_MIN && v <= LONG_MAX)
+            return PyInt_FromLong((long)v);
+        return PyLong_FromLongLong(v);
+    }
+    if (is_float) {
+        JSON_UINT64 w = 0;
+        int ndigits = 0;
+        int q = 0;
+        int truncated = 0;
+        double d;
+        /* keep the first 19 significant digits in w */
+        for (; p < end && *p >= '0' && *p <= '9'; p++) {
+            if (ndigits < 19) {
+                w = w * 10 + (*p - '0');
+                if (w)
+                    ndigits++;
+            }
+            else {
+                q++;
+                truncated |= *p != '0';
+            }
+        }
+        if (p < end && *p == '.') {
+            for (p++; p < end && *p >= '0' && *p <= '9'; p++) {
+                if (ndigits < 19) {
+                    w = w * 10 + (*p - '0');
+                    q--;
+                    if (w)
+                        ndigits++;
+                }
+                else {
+                    truncated |= *p != '0';
+                }
+            }
+        }
+        if (p < end) {
+            /* exponent, saturated well past the range of doubles */
+            int exp_negative = 0;
+            int e = 0;
+            p++;
+            if (*p == '-' || *p == '+') {
+                exp_negative = *p == '-';
+                p++;
+            }
+            for (; p < end; p++) {
+                if (e < 100000)
+                    e = e * 10 + (*p - '0');
+            }
+            q += exp_negative ? -e : e;
+        }
+        if (decimal_to_double(w, q, truncated, &d))
+            return PyFloat_FromDouble(negative ? -d : d);
+    }
+    /* long ints and hard floats */
+    if (n <= JSON_NUMBER_INLINE) {
+        buf = inline_buf;
+    }
+    else {
+        buf = (char *)PyMem_Malloc(n + 1);
+        if (buf == NULL)
+            return PyErr_NoMemory();
+    }
+    memcpy(buf, num, n);
+    buf[n] = '\0';
+    if (is_float) {
+        double d = PyOS_string_to_double(buf, NULL, NULL);
+        rval = (d == -1.0 && PyErr_Occurred()) ? NULL : PyFloat_FromDouble(d);
+    }
+    else {
+        rval = PyInt_FromString(buf, NULL, 10);
+    }
+    if (buf != inline_buf)
+        PyMem_Free(buf);
+    return rval;
+}
+
+static PyObject *
+_match_number_str(PyScannerObject *s, PyObject *pystr, Py_ssize_t start, Py_ssize_t *next_idx_ptr) {
+    Py_ssize_t end_idx;
+    char *str = str_source(pystr, &end_idx);
+    Py_ssize_t idx = start;
+    int is_float = 0;
+    PyObject *rval;
+    PyObject *numstr;
+    if (str == NULL)
+        return NULL;
+    end_idx--;
+
+    /* read a sign if it's there, make sure it's not the end of the string */
+    if (str[idx] == '-') {
+        idx++;
+        if (idx > end_idx) {
+            PyErr_SetNone(PyExc_StopIteration);
+            return NULL;
+        }
+    }
+
+    /* read as many integer digits as we find as long as it doesn't start with 0 */
+    if (str[idx] >= '1' && str[idx] <= '9') {
+        idx++;
+        while (idx <= end_idx && str[idx] >= '0' && str[idx] <= '9') idx++;
+    }
+    /* if it starts with 0 we only expect one integer digit */
+    else if (str[idx] == '0') {
+        idx++;
+    }
+    /* no integer digits, error */
+    else {
+        PyErr_SetNone(PyExc_StopIteration);
+        return NULL;
+    }
+    
+    /* if the next char is '.' followed by a digit then read all float digits */
+    if (idx < end_idx && str[idx] == '.' && str[idx + 1] >= '0' && str[idx + 1] <= '9') {
+        is_float = 1;
+        idx += 2;
+        while (idx <= end_idx && str[idx] >= '0' && str[idx] <= '9') idx++;
+    }
+
+    /* if the next char is 'e' or 'E' then maybe read the exponent (or backtrack) */
+    if (idx < end_idx && (str[idx] == 'e' || str[idx] == 'E')) {
+
+        /* save the index of the 'e' or 'E' just in case we need to backtrack */
+        Py_ssize_t e_start = idx;
+        idx++;
+
+        /* read an exponent sign if present */
+        if (idx < end_idx && (str[idx] == '-' || str[idx] == '+')) idx++;
+
+        /* read all digits */
+        while (idx <= end_idx && str[idx] >= '0' && str[idx] <= '9') idx++;
+
+        /* if we got a digit, then parse as float. if not, backtrack */
+        if (str[idx - 1] >= '0' && str[idx - 1] <= '9') {
+            is_float = 1;
+        }
+        else {
+            idx = e_start;
+        }
+    }
+    
+    /* parse in place unless there is a user defined method */
+    if (is_float ? s->parse_float == (PyObject *)&PyFloat_Type : s->parse_int == (PyObject *)&PyInt_Type) {
+        rval = _number_from_ascii(&str[start], idx - start, is_float);
+        *next_idx_ptr = idx;
+        return rval;
+    }
+
+    /* copy the section we determined to be a number */
+    numstr = PyString_FromStringAndSize(&str[start], idx - start);
+    if (numstr == NULL)
+        return NULL;
+    STATS_INC(callbacks);
+    if (is_float) {
+        rval = PyObject_CallFunctionObjArgs(s->parse_float, numstr, NULL);
+    }
+    else {
+        rval = PyObject_CallFunctionObjArgs(s->parse_int, numstr, NULL);
+    }
+    Py_DECREF(numstr);
+    *next_idx_ptr = idx;
+    return rval;
+}
+
+static PyObject *
+_match_number_unicode(PyScannerObject *s, PyObject *pystr, Py_ssize_t start, Py_ssize_t *next_idx_ptr) {
+    Py_UNICODE *str = PyUnicode_AS_UNICODE(pystr);
+    Py_ssize_t end_idx = PyUnicode_GET_SIZE(pystr) - 1;
+    Py_ssize_t idx = start;
+    int is_float = 0;
+    PyObject *rval;
+    PyObject *numstr;
+
+    /* read a sign if it's there, make sure it's not the end of the string */
+    if (str[idx] == '-') {
+        idx++;
+        if (idx > end_idx) {
+            PyErr_SetNone(PyExc_StopIteration);
+            return NULL;
+        }
+    }
+
+    /* read as many integer digits as we find as long as it doesn't start with 0 */
+    if (str[idx] >= '1' && str[idx] <= '9') {
+        idx++;
+        while (idx <= end_idx && str[idx] >= '0' && str[idx] <= '9') idx++;
+    }
+    /* if it starts with 0 we only expect one integer digit */
+    else if (str[idx] == '0') {
+        idx++;
+    }
+    /* no integer digits, error */
+    else {
+        PyErr_SetNone(PyExc_StopIteration);
+        return NULL;
+    }
+
+    /* if the next char is '.' followed by a digit then read all float digits */
+    if (idx < end_idx && str[idx] == '.' && str[idx + 1] >= '0' && str[idx + 1] <= '9') {
+        is_float = 1;
+        idx += 2;
+        while (idx <= end_idx && str[idx] >= '0' && str[idx] <= '9') idx++;
+    }
+
+    /* if the next char is 'e' or 'E' then maybe read the exponent (or backtrack) */
+    if (idx < end_idx && (str[idx] == 'e' || str[idx] == 'E')) {
+        Py_ssize_t e_start = idx;
+        idx++;
+
+        /* read an exponent sign if present */
+        if (idx < end_idx && (str[idx] == '-' || str[idx] == '+')) idx++;
+
+        /* read all digits */
+        while (idx <= end_idx && str[idx] >= '0' && str[idx] <= '9') idx++;
+
+        /* if we got a digit, then parse as float. if not, backtrack */
+        if (str[idx - 1] >= '0' && str[idx - 1] <= '9') {
+            is_float = 1;
+        }
+        else {
+            idx = e_start;
+        }
+    }
+
+    /* parse an ASCII copy in place unless there is a user defined method */
+    if (idx - start <= JSON_NUMBER_INLINE &&
+            (is_float ? s->parse_float == (PyObject *)&PyFloat_Type : s->parse_int == (PyObject *)&PyInt_Type)) {
+        char num[JSON_NUMBER_INLINE];
+        Py_ssize_t i;
+        for (i = start; i < idx; i++) {
+            num[i - start] = (char)str[i];
+        }
+        rval = _number_from_ascii(num, idx - start, is_float);
+        *next_idx_ptr = idx;
+        return rval;
+    }
+
+    /* copy the section we determined to be a number */
+    numstr = PyUnicode_FromUnicode(&str[start], idx - start);
+    if (numstr == NULL)
+        return NULL;
+    if (is_float) {
+        /* parse as a float using a fast path if available, otherwise call user defined method */
+        if (s->parse_float != (PyObject *)&PyFloat_Type) {
+            STATS_INC(callbacks);
+            rval = PyObject_CallFunctionObjArgs(s->parse_float, numstr, NULL);
+        }
+        else {
+            rval = PyFloat_FromString(numstr, NULL);
+        }
+    }
+    else {
+        /* no fast path for unicode -> int, just call */
+        if (s->parse_int != (PyObject *)&PyInt_Type)
+            STATS_INC(callbacks);
+        rval = PyObject_CallFunctionObjArgs(s->parse_int, numstr, NULL);
+    }
+    Py_DECREF(numstr);
+    *next_idx_ptr = idx;
+    return rval;
+}
+
+static PyObject *
+scan_scalar_str(PyScannerObject *s, PyObject *pystr, const char *str, Py_ssize_t length, Py_ssize_t idx, Py_ssize_t *next_idx_ptr)
+{
+    /* Scan a value other than an object or array at idx */
+    if (idx >= length) {
+        PyErr_SetNone(PyExc_StopIteration);
+        return NULL;
+    }
+    switch (str[idx]) {
+        case '"':
+            /* string */
+            return scanstring_str(pystr, idx + 1,
+                PyString_AS_STRING(s->encoding),
+                PyObject_IsTrue(s->strict),
+                next_idx_ptr);
+        case 'n':
+            /* null */
+            if ((idx + 3 < length) && str[idx + 1] == 'u' && str[idx + 2] == 'l' && str[idx + 3] == 'l') {
+                Py_INCREF(Py_None);
+                *next_idx_ptr = idx + 4;
+                return Py_None;
+            }
+            break;
+        case 't':
+            /* true */
+            if ((idx + 3 < length) && str[idx + 1] == 'r' && str[idx + 2] == 'u' && str[idx + 3] == 'e') {
+                Py_INCREF(Py_True);
+                *next_idx_ptr = idx + 4;
+                return Py_True;
+            }
+            break;
+        case 'f':
+            /* false */
+            if ((idx + 4 < length) && str[idx + 1] == 'a' && str[idx + 2] == 'l' && str[idx + 3] == 's' && str[idx + 4] == 'e') {
+                Py_INCREF(Py_False);
+                *next_idx_ptr = idx + 5;
+                return Py_False;
+            }
+            break;
+        case 'N':
+            /* NaN */
+            if ((idx + 2 < length) && str[idx + 1] == 'a' && str[idx + 2] == 'N') {
+                return _parse_constant(s, "NaN", idx, next_idx_ptr);
+            }
+            break;
+        case 'I':
+            /* Infinity */
+            if ((idx + 7 < length) && str[idx + 1] == 'n' && str[idx + 2] == 'f' && str[idx + 3] == 'i' && str[idx + 4] == 'n' && str[idx + 5] == 'i' && str[idx + 6] == 't' && str[idx + 7] == 'y') {
+                return _parse_constant(s, "Infinity", idx, next_idx_ptr);
+            }
+            break;
+        case '-':
+            /* -Infinity */
+            if ((idx + 8 < length) && str[idx + 1] == 'I' && str[idx + 2] == 'n' && str[idx + 3] == 'f' && str[idx + 4] == 'i' && str[idx + 5] == 'n' && str[idx + 6] == 'i' && str[idx + 7] == 't' && str[idx + 8] == 'y') {
+                return _parse_constant(s, "-Infinity", idx, next_idx_ptr);
+            }
+            break;
+    }
+    /* Didn't find a string or named constant. Look for a number. */
+    return _match_number_str(s, pystr, idx, next_idx_ptr);
+}
+
+static PyObject *
+scan_once_str(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx, Py_ssize_t *next_idx_ptr)
+{
+    /*
+    Scan the JSON value at idx.  Objects and arrays are built on an
+    explicit stack rather than by recursion.  The innermost open container
+    and its pending key are kept in top and key, the ones enclosing it are
+    saved on the stack, and the value is complete when the outermost
+    container closes.
+    */
+    Py_ssize_t length;
+    char *str = str_source(pystr, &length);
+    JSON_Stack stack;
+    PyObject *top = NULL;
+    PyObject *key = NULL;
+    PyObject *val = NULL;
+    Py_ssize_t field = -1;
+    Py_ssize_t next_idx;
+    int is_array = 0;
+    int want_key = 0;
+    /* scanning a buffer in place, see str_source_again */
+    int in_place = !PyString_Check(pystr);
+    if (str == NULL)
+        return NULL;
+    if (idx >= length || (str[idx] != '{' && str[idx] != '['))
+        return scan_scalar_str(s, pystr, str, length, idx, next_idx_ptr);
+    stack_init(&stack);
+    for (;;) {
+        if (want_key) {
+            /* an object's key and : come before each of its terms */
+            idx = _parse_key_str(s, pystr, str, length, idx, &key, &field);
+            if (idx == -1)
+                goto bail;
+            if (in_place && (str = str_source_again(pystr, length)) == NULL)
+                goto bail;
+            want_key = 0;
+        }
+        /* read any JSON term */
+        if (idx < length && (str[idx] == '{' || str[idx] == '[')) {
+            /* save the enclosing container and open a new one */
+            if (top != NULL) {
+                JSON_Frame *frame;
+                if (STACK_RESERVE(&stack))
+                    goto bail;
+                frame = &stack.frames[stack.len++];
+                frame->container = top;
+                frame->key = key;
+                frame->field = field;
+                frame->is_array = is_array;
+                top = NULL;
+                key = NULL;
+            }
+            if (stack.len >= s->max_depth) {
+                raise_errmsg("Maximum nesting depth exceeded", pystr, idx);
+                goto bail;
+            }
+            is_array = str[idx] == '[';
+            top = is_array ? PyList_New(0) : record_new(s);
+            if (top == NULL)
+                goto bail;
+            if (is_array)
+                STATS_INC(objects);
+            /* skip whitespace after { or [ */
+            idx++;
+            while (idx < length && IS_WHITESPACE(str[idx])) idx++;
+            if (idx < length && str[idx] != (is_array ? ']' : '}')) {
+                /* read its first term */
+                want_key = !is_array;
+                continue;
+            }
+            /* empty */
+        }
+        else {
+            val = scan_scalar_str(s, pystr, str, length, idx, &next_idx);
+            if (val == NULL)
+                goto bail;
+            /* hooks such as parse_float run Python code */
+            if (in_place && (str = str_source_again(pystr, length)) == NULL)
+                goto bail;
+            idx = next_idx;
+            if (top == NULL)
+                break;
+        }
+
+        /* add val to the innermost container, closing each container that
+           ends right after it, until one expects another term */
+        for (;;) {
+            if (val != NULL) {
+                if (is_array) {
+                    if (PyList_Append(top, val) == -1)
+                        goto bail;
+                }
+                else {
+                    PyObject *obj = top;
+                    int rval = record_set_item(s, &obj, key, val, field, 0);
+                    top = obj;
+                    if (rval == -1)
+                        goto bail;
+                    Py_CLEAR(key);
+                }
+                Py_CLEAR(val);
+                /* skip whitespace before the close or , */
+                while (idx < length && IS_WHITESPACE(str[idx])) idx++;
+                if (idx < length && str[idx] == ',') {
+                    /* skip whitespace after the , delimiter */
+                    idx++;
+                    while (idx < length && IS_WHITESPACE(str[idx])) idx++;
+                    if (idx < length) {
+                        /* an array's next term is read right here unless
+                           it opens a container */
+                        want_key = !is_array;
+                        if (is_array && str[idx] != '{' && str[idx] != '[') {
+                            val = scan_scalar_str(s, pystr, str, length, idx, &next_idx);
+                            if (val == NULL)
+                                goto bail;
+                            if (in_place && (str = str_source_again(pystr, length)) == NULL)
+                                goto bail;
+                            idx = next_idx;
+                            continue;
+                        }
+                        break;
+                    }
+                }
+                else if (idx < length && str[idx] != (is_array ? ']' : '}')) {
+                    raise_errmsg("Expecting , delimiter", pystr, idx);
+                    goto bail;
+                }
+            }
+            /* verify that idx < length, str[idx] should be the close */
+            if (idx >= length || str[idx] != (is_array ? ']' : '}')) {
+                raise_errmsg("Expecting object", pystr, length - 1);
+                goto bail;
+            }
+            idx++;
+            val = is_array ? top : scan_finish_object(s, top);
+            top = NULL;
+            if (val == NULL)
+                goto bail;
+            if (in_place && (str = str_source_again(pystr, length)) == NULL)
+                goto bail;
+            if (stack.len == 0)
+                break;
+            /* back to the enclosing container */
+            stack.len--;
+            top = stack.frames[stack.len].container;
+            key = stack.frames[stack.len].key;
+            field = stack.frames[stack.len].field;
+            is_array = stack.frames[stack.len].is_array;
+        }
+        if (top == NULL && val != NULL)
+            break;
+    }
+    if (stack.frames != stack.inline_frames)
+        PyMem_Free(stack.frames);
+    *next_idx_ptr = idx;
+    return val;
+bail:
+    Py_XDECREF(val);
+    Py_XDECREF(key);
+    Py_XDECREF(top);
+    stack_free(&stack);
+    return NULL;
+}
+
+static PyObject *
+scan_scalar_unicode(PyScannerObject *s, PyObject *pystr, const Py_UNICODE *str, Py_ssize_t length, Py_ssize_t idx, Py_ssize_t *next_idx_ptr)
+{
+    /* Scan a value other than an object or array at idx */
+    if (idx >= length) {
+        PyErr_SetNone(PyExc_StopIteration);
+        return NULL;
+    }
+    switch (str[idx]) {
+        case '"':
+            /* string */
+            return scanstring_unicode(pystr, idx + 1,
+                PyObject_IsTrue(s->strict),
+                next_idx_ptr);
+        case 'n':
+            /* null */
+            if ((idx + 3 < length) && str[idx + 1] == 'u' && str[idx + 2] == 'l' && str[idx + 3] == 'l') {
+                Py_INCREF(Py_None);
+                *next_idx_ptr = idx + 4;
+                return Py_None;
+            }
+            break;
+        case 't':
+            /* true */
+            if ((idx + 3 < length) && str[idx + 1] == 'r' && str[idx + 2] == 'u' && str[idx + 3] == 'e') {
+                Py_INCREF(Py_True);
+                *next_idx_ptr = idx + 4;
+                return Py_True;
+            }
+            break;
+        case 'f':
+            /* false */
+            if ((idx + 4 < length) && str[idx + 1] == 'a' && str[idx + 2] == 'l' && str[idx + 3] == 's' && str[idx + 4] == 'e') {
+                Py_INCREF(Py_False);
+                *next_idx_ptr = idx + 5;
+                return Py_False;
+            }
+            break;
+        case 'N':
+            /* NaN */
+            if ((idx + 2 < length) && str[idx + 1] == 'a' && str[idx + 2] == 'N') {
+                return _parse_constant(s, "NaN", idx, next_idx_ptr);
+            }
+            break;
+        case 'I':
+            /* Infinity */
+            if ((idx + 7 < length) && str[idx + 1] == 'n' && str[idx + 2] == 'f' && str[idx + 3] == 'i' && str[idx + 4] == 'n' && str[idx + 5] == 'i' && str[idx + 6] == 't' && str[idx + 7] == 'y') {
+                return _parse_constant(s, "Infinity", idx, next_idx_ptr);
+            }
+            break;
+        case '-':
+            /* -Infinity */
+            if ((idx + 8 < length) && str[idx + 1] == 'I' && str[idx + 2] == 'n' && str[idx + 3] == 'f' && str[idx + 4] == 'i' && str[idx + 5] == 'n' && str[idx + 6] == 'i' && str[idx + 7] == 't' && str[idx + 8] == 'y') {
+                return _parse_constant(s, "-Infinity", idx, next_idx_ptr);
+            }
+            break;
+    }
+    /* Didn't find a string or named constant. Look for a number. */
+    return _match_number_unicode(s, pystr, idx, next_idx_ptr);
+}
+
+static PyObject *
+scan_once_unicode(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx, Py_ssize_t *next_idx_ptr)
+{
+    /* scan_once_str for unicode */
+    Py_UNICODE *str = PyUnicode_AS_UNICODE(pystr);
+    Py_ssize_t length = PyUnicode_GET_SIZE(pystr);
+    JSON_Stack stack;
+    PyObject *top = NULL;
+    PyObject *key = NULL;
+    PyObject *val = NULL;
+    Py_ssize_t field = -1;
+    Py_ssize_t next_idx;
+    int is_array = 0;
+    int want_key = 0;
+    if (idx >= length || (str[idx] != '{' && str[idx] != '['))
+        return scan_scalar_unicode(s, pystr, str, length, idx, next_idx_ptr);
+    stack_init(&stack);
+    for (;;) {
+        if (want_key) {
+            /* an object's key and : come before each of its terms */
+            idx = _parse_key_unicode(s, pystr, str, length, idx, &key, &field);
+            if (idx == -1)
+                goto bail;
+            want_key = 0;
+        }
+        /* read any JSON term */
+        if (idx < length && (str[idx] == '{' || str[idx] == '[')) {
+            /* save the enclosing container and open a new one */
+            if (top != NULL) {
+                JSON_Frame *frame;
+                if (STACK_RESERVE(&stack))
+                    goto bail;
+                frame = &stack.frames[stack.len++];
+                frame->container = top;
+                frame->key = key;
+                frame->field = field;
+                frame->is_array = is_array;
+                top = NULL;
+                key = NULL;
+            }
+            if (stack.len >= s->max_depth) {
+                raise_errmsg("Maximum nesting depth exceeded", pystr, idx);
+                goto bail;
+            }
+            is_array = str[idx] == '[';
+            top = is_array ? PyList_New(0) : record_new(s);
+            if (top == NULL)
+                goto bail;
+            if (is_array)
+                STATS_INC(objects);
+            /* skip whitespace after { or [ */
+            idx++;
+            while (idx < length && IS_WHITESPACE(str[idx])) idx++;
+            if (idx < length && str[idx] != (is_array ? ']' : '}')) {
+                /* read its first term */
+                want_key = !is_array;
+                continue;
+            }
+            /* empty */
+        }
+        else {
+            val = scan_scalar_unicode(s, pystr, str, length, idx, &next_idx);
+            if (val == NULL)
+                goto bail;
+            idx = next_idx;
+            if (top == NULL)
+                break;
+        }
+
+        /* add val to the innermost container, closing each container that
+           ends right after it, until one expects another term */
+        for (;;) {
+            if (val != NULL) {
+                if (is_array) {
+                    if (PyList_Append(top, val) == -1)
+                        goto bail;
+                }
+                else {
+                    PyObject *obj = top;
+                    int rval = record_set_item(s, &obj, key, val, field, 1);
+                    top = obj;
+                    if (rval == -1)
+                        goto bail;
+                    Py_CLEAR(key);
+                }
+                Py_CLEAR(val);
+                /* skip whitespace before the close or , */
+                while (idx < length && IS_WHITESPACE(str[idx])) idx++;
+                if (idx < length && str[idx] == ',') {
+                    /* skip whitespace after the , delimiter */
+                    idx++;
+                    while (idx < length && IS_WHITESPACE(str[idx])) idx++;
+                    if (idx < length) {
+                        /* an array's next term is read right here unless
+                           it opens a container */
+                        want_key = !is_array;
+                        if (is_array && str[idx] != '{' && str[idx] != '[') {
+                            val = scan_scalar_unicode(s, pystr, str, length, idx, &next_idx);
+                            if (val == NULL)
+                                goto bail;
+                            idx = next_idx;
+                            continue;
+                        }
+                        break;
+                    }
+                }
+                else if (idx < length && str[idx] != (is_array ? ']' : '}')) {
+                    raise_errmsg("Expecting , delimiter", pystr, idx);
+                    goto bail;
+                }
+            }
+            /* verify that idx < length, str[idx] should be the close */
+            if (idx >= length || str[idx] != (is_array ? ']' : '}')) {
+                raise_errmsg("Expecting object", pystr, length - 1);
+                goto bail;
+            }
+            idx++;
+            val = is_array ? top : scan_finish_object(s, top);
+            top = NULL;
+            if (val == NULL)
+                goto bail;
+            if (stack.len == 0)
+                break;
+            /* back to the enclosing container */
+            stack.len--;
+            top = stack.frames[stack.len].container;
+            key = stack.frames[stack.len].key;
+            field = stack.frames[stack.len].field;
+            is_array = stack.frames[stack.len].is_array;
+        }
+        if (top == NULL && val != NULL)
+            break;
+    }
+    if (stack.frames != stack.inline_frames)
+        PyMem_Free(stack.frames);
+    *next_idx_ptr = idx;
+    return val;
+bail:
+    Py_XDECREF(val);
+    Py_XDECREF(key);
+    Py_XDECREF(top);
+    stack_free(&stack);
+    return NULL;
+}
+
+static PyObject *
+scan_once_buffer(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx, Py_ssize_t *next_idx_ptr)
+{
+    /* scan_once_str on a read buffer parsed in place, holding a view where
+       possible so that a bytearray can not be resized underneath the
+       scanner.  Before 2.6 there are no views and only str_source_again
+       guards the pointer. */
+#if PY_VERSION_HEX >= 0x02060000
+    if (PyObject_CheckBuffer(pystr)) {
+        Py_buffer view;
+        PyObject *rval;
+        if (PyObject_GetBuffer(pystr, &view, PyBUF_SIMPLE) == -1)
+            return NULL;
+        rval = scan_once_str(s, pystr, idx, next_idx_ptr);
+        PyBuffer_Release(&view);
+        return rval;
+    }
+#endif
+    return scan_once_str(s, pystr, idx, next_idx_ptr);
+}
+
+static PyObject *
+scanner_call(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    PyObject *pystr;
+    Py_ssize_t idx;
+    static char *kwlist[] = {"string", "idx", NULL};
+    PyScannerObject *s = (PyScannerObject *)self;
+    PyObject *rval;
+    Py_ssize_t next_idx = -1;
+    assert(PyScanner_Check(self));
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO&:scan_once", kwlist, &pystr, _convertPyInt_AsSsize_t, &idx))
+        return NULL;
+    if (PyString_Check(pystr)) {
+        rval = scan_once_str(s, pystr, idx, &next_idx);
+    }
+    else if (PyUnicode_Check(pystr)) {
+        rval = scan_once_unicode(s, pystr, idx, &next_idx);
+    }
+    else if (PyObject_CheckReadBuffer(pystr)) {
+        rval = scan_once_buffer(s, pystr, idx, &next_idx);
+    }
+    else {
+        PyErr_Format(PyExc_TypeError,
+                 "first argument must be a string or buffer, not %.80s",
+                 Py_TYPE(pystr)->tp_name);
+        return NULL;
+    }
+    /* keys are only shared within one decode call */
+    memo_clear(s);
+    if (rval != NULL)
+        STATS_ADD(bytes_scanned, next_idx - idx);
+    return _build_rval_index_tuple(rval, next_idx);
+}
+
+static PyObject *
+scanner_decode_one(PyScannerObject *s, PyObject *pystr)
+{
+    /* Decode a whole document the way JSONDecoder.decode does */
+    Py_ssize_t idx = 0;
+    Py_ssize_t next_idx = -1;
+    Py_ssize_t len;
+    PyObject *val;
+    if (PyString_Check(pystr)) {
+        const char *str = PyString_AS_STRING(pystr);
+        len = PyString_GET_SIZE(pystr);
+        while (idx < len && IS_WHITESPACE(str[idx]))
+            idx++;
+        val = scan_once_str(s, pystr, idx, &next_idx);
+        if (val == NULL)
+            goto bail;
+        for (idx = next_idx; idx < len && IS_WHITESPACE(str[idx]); idx++);
+    }
+    else if (PyUnicode_Check(pystr)) {
+        const Py_UNICODE *str = PyUnicode_AS_UNICODE(pystr);
+        len = PyUnicode_GET_SIZE(pystr);
+        while (idx < len && IS_WHITESPACE(str[idx]))
+            idx++;
+        val = scan_once_unicode(s, pystr, idx, &next_idx);
+        if (val == NULL)
+            goto bail;
+        for (idx = next_idx; idx < len && IS_WHITESPACE(str[idx]); idx++);
+    }
+    else {
+        PyErr_Format(PyExc_TypeError,
+                     "expected string or buffer, not %.80s",
+                     Py_TYPE(pystr)->tp_name);
+        return NULL;
+    }
+    if (idx != len) {
+        Py_DECREF(val);
+        raise_errmsg_range("Extra data", pystr, idx, len);
+        return NULL;
+    }
+    STATS_ADD(bytes_scanned, len);
+    return val;
+bail:
+    if (PyErr_ExceptionMatches(PyExc_StopIteration)) {
+        PyErr_Clear();
+        PyErr_SetString(PyExc_ValueError, "No JSON object could be decoded");
+    }
+    return NULL;
+}
+
+PyDoc_STRVAR(scanner_decode_many_doc,
+    "decode_many(docs) -> list\n"
+    "\n"
+    "Decode each document in docs and return the list of results.  A\n"
+    "document that fails to decode gets its ValueError in its place in\n"
+    "the list.  Keys are shared across the whole batch."
+);
+
+static PyObject *
+scanner_decode_many(PyObject *self, PyObject *docs)
+{
+    /* METH_O */
+    PyScannerObject *s = (PyScannerObject *)self;
+    PyObject *seq;
+    PyObject *rval = NULL;
+    Py_ssize_t i;
+    Py_ssize_t n;
+    assert(PyScanner_Check(self));
+    seq = PySequence_Fast(docs, "decode_many() argument must be iterable");
+    if (seq == NULL)
+        return NULL;
+    n = PySequence_Fast_GET_SIZE(seq);
+    rval = PyList_New(n);
+    if (rval == NULL)
+        goto bail;
+    for (i = 0; i < n; i++) {
+        PyObject *val = scanner_decode_one(s, PySequence_Fast_GET_ITEM(seq, i));
+        if (val == NULL) {
+            PyObject *type, *tb;
+            if (!PyErr_ExceptionMatches(PyExc_ValueError))
+                goto bail;
+            PyErr_Fetch(&type, &val, &tb);
+            PyErr_NormalizeException(&type, &val, &tb);
+            Py_XDECREF(type);
+            Py_XDECREF(tb);
+            if (val == NULL)
+                goto bail;
+        }
+        PyList_SET_ITEM(rval, i, val);
+    }
+    memo_clear(s);
+    Py_DECREF(seq);
+    return rval;
+bail:
+    memo_clear(s);
+    Py_DECREF(seq);
+    Py_XDECREF(rval);
+    return NULL;
+}
+
+static PyMethodDef scanner_methods[] = {
+    {"decode_many", (PyCFunction)scanner_decode_many, METH_O, scanner_decode_many_doc},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyObject *
+scanner_context_attr(PyObject *ctx, char *name)
+{
+    /* getattr(ctx, name, None) */
+    PyObject *rval = PyObject_GetAttrString(ctx, name);
+    if (rval == NULL && PyErr_ExceptionMatches(PyExc_AttributeError)) {
+        PyErr_Clear();
+        Py_INCREF(Py_None);
+        rval = Py_None;
+    }
+    return rval;
+}
+
+static PyObject *
+scanner_record_fields(PyObject *fields)
+{
+    /* tuple(unicode(name) for name in fields), names must be strings */
+    PyObject *seq;
+    PyObject *rval;
+    PyObject *name;
+    Py_ssize_t i;
+    Py_ssize_t n;
+    seq = PySequence_Fast(fields, "record_fields must be a sequence of strings");
+    if (seq == NULL)
+        return NULL;
+    n = PySequence_Fast_GET_SIZE(seq);
+    if (n == 0) {
+        PyErr_SetString(PyExc_ValueError, "record_fields must not be empty");
+        Py_DECREF(seq);
+        return NULL;
+    }
+    rval = PyTuple_New(n);
+    if (rval == NULL) {
+        Py_DECREF(seq);
+        return NULL;
+    }
+    for (i = 0; i < n; i++) {
+        name = PySequence_Fast_GET_ITEM(seq, i);
+        if (!PyString_Check(name) && !PyUnicode_Check(name)) {
+            PyErr_SetString(PyExc_TypeError, "record_fields must be a sequence of strings");
+            goto bail;
+        }
+        name = PyUnicode_FromObject(name);
+        if (name == NULL)
+            goto bail;
+        PyTuple_SET_ITEM(rval, i, name);
+    }
+    Py_DECREF(seq);
+    return rval;
+bail:
+    Py_DECREF(seq);
+    Py_DECREF(rval);
+    return NULL;
+}
+
+static int
+scanner_init(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    PyObject *ctx;
+    PyObject *fields;
+    Py_ssize_t i;
+    PyObject *max_depth;
+    static char *kwlist[] = {"context", NULL};
+
+    assert(PyScanner_Check(self));
+    PyScannerObject *s = (PyScannerObject *)self;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O:make_scanner", kwlist, &ctx))
+        return -1;
+
+    s->encoding = NULL;
+    s->strict = NULL;
+    s->object_hook = NULL;
+    s->parse_float = NULL;
+    s->parse_int = NULL;
+    s->parse_constant = NULL;
+    s->record_type = NULL;
+    s->record_fields = NULL;
+    s->record_index = NULL;
+    s->record_index_str = NULL;
+    s->record_names_str = NULL;
+
+    /* PyString_AS_STRING is used on encoding */
+    s->encoding = PyObject_GetAttrString(ctx, "encoding");
+    if (s->encoding == Py_None) {
+        Py_DECREF(Py_None);
+        s->encoding = PyString_InternFromString(DEFAULT_ENCODING);
+    }
+    else if (PyUnicode_Check(s->encoding)) {
+        PyObject *tmp = PyUnicode_AsEncodedString(s->encoding, NULL, NULL);
+        Py_DECREF(s->encoding);
+        s->encoding = tmp;
+    }
+    if (s->encoding == NULL || !PyString_Check(s->encoding))
+        goto bail;
+    
+    /* All of these will fail "gracefully" so we don't need to verify them */
+    s->strict = PyObject_GetAttrString(ctx, "strict");
+    if (s->strict == NULL)
+        goto bail;
+    s->object_hook = PyObject_GetAttrString(ctx, "object_hook");
+    if (s->object_hook == NULL)
+        goto bail;
+    s->parse_float = PyObject_GetAttrString(ctx, "parse_float");
+    if (s->parse_float == NULL)
+        goto bail;
+    s->parse_int = PyObject_GetAttrString(ctx, "parse_int");
+    if (s->parse_int == NULL)
+        goto bail;
+    s->parse_constant = PyObject_GetAttrString(ctx, "parse_constant");
+    if (s->parse_constant == NULL)
+        goto bail;
+
+    /* record_type and record_fields are optional on the context */
+    s->record_type = scanner_context_attr(ctx, "record_type");
+    if (s->record_type == NULL)
+        goto bail;
+    fields = scanner_context_attr(ctx, "record_fields");
+    if (fields == NULL)
+        goto bail;
+    if (fields == Py_None) {
+        s->record_fields = fields;
+    }
+    else {
+        s->record_fields = scanner_record_fields(fields);
+        Py_DECREF(fields);
+        if (s->record_fields == NULL)
+            goto bail;
+        s->record_index = PyDict_New();
+        if (s->record_index == NULL)
+            goto bail;
+        s->record_index_str = PyDict_New();
+        if (s->record_index_str == NULL)
+            goto bail;
+        s->record_names_str = PyTuple_New(PyTuple_GET_SIZE(s->record_fields));
+        if (s->record_names_str == NULL)
+            goto bail;
+        for (i = 0; i < PyTuple_GET_SIZE(s->record_fields); i++) {
+            PyObject *name = PyTuple_GET_ITEM(s->record_fields, i);
+            PyObject *idx = PyInt_FromSsize_t(i);
+            PyObject *ascii;
+            if (idx == NULL)
+                goto bail;
+            if (PyDict_SetItem(s->record_index, name, idx) == -1) {
+                Py_DECREF(idx);
+                goto bail;
+            }
+            ascii = PyUnicode_AsASCIIString(name);
+            if (ascii == NULL) {
+                /* never a str key */
+                PyErr_Clear();
+                Py_INCREF(name);
+                PyTuple_SET_ITEM(s->record_names_str, i, name);
+            }
+            else {
+                PyTuple_SET_ITEM(s->record_names_str, i, ascii);
+                if (PyDict_SetItem(s->record_index_str, ascii, idx) == -1) {
+                    Py_DECREF(idx);
+                    goto bail;
+                }
+            }
+            Py_DECREF(idx);
+        }
+        if (PyDict_Size(s->record_index) != PyTuple_GET_SIZE(s->record_fields)) {
+            PyErr_SetString(PyExc_ValueError, "record_fields must not repeat a field");
+            goto bail;
+        }
+        if (s->record_type == Py_None) {
+            Py_DECREF(s->record_type);
+            s->record_type = (PyObject *)&PyTuple_Type;
+            Py_INCREF(s->record_type);
+        }
+    }
+
+    /* max_depth is optional too, None is the default */
+    max_depth = scanner_context_attr(ctx, "max_depth");
+    if (max_depth == NULL)
+        goto bail;
+    if (max_depth == Py_None) {
+        s->max_depth = JSON_MAX_DEPTH;
+    }
+    else {
+        s->max_depth = PyInt_AsSsize_t(max_depth);
+        if (s->max_depth == -1 && PyErr_Occurred()) {
+            Py_DECREF(max_depth);
+            goto bail;
+        }
+        if (s->max_depth < 1) {
+            PyErr_SetString(PyExc_ValueError, "max_depth must be positive");
+            Py_DECREF(max_depth);
+            goto bail;
+        }
+    }
+    Py_DECREF(max_depth);
+
+    return 0;
+
+bail:
+    Py_XDECREF(s->encoding);
+    Py_XDECREF(s->strict);
+    Py_XDECREF(s->object_hook);
+    Py_XDECREF(s->parse_float);
+    Py_XDECREF(s->parse_int);
+    Py_XDECREF(s->parse_constant);
+    Py_XDECREF(s->record_type);
+    Py_XDECREF(s->record_fields);
+    Py_XDECREF(s->record_index);
+    Py_XDECREF(s->record_index_str);
+    Py_XDECREF(s->record_names_str);
+    s->encoding = NULL;
+    s->strict = NULL;
+    s->object_hook = NULL;
+    s->parse_float = NULL;
+    s->parse_int = NULL;
+    s->parse_constant = NULL;
+    s->record_type = NULL;
+    s->record_fields = NULL;
+    s->record_index = NULL;
+    s->record_index_str = NULL;
+    s->record_names_str = NULL;
+    return -1;
+}
+
+PyDoc_STRVAR(scanner_doc, "JSON scanner object");
+
+static
+PyTypeObject PyScannerType = {
+    PyObject_HEAD_INIT(0)
+    0,                    /* tp_internal */
+    "make_scanner",       /* tp_name */
+    sizeof(PyScannerObject), /* tp_basicsize */
+    0,                    /* tp_itemsize */
+    scanner_dealloc, /* tp_dealloc */
+    0,                    /* tp_print */
+    0,                    /* tp_getattr */
+    0,                    /* tp_setattr */
+    0,                    /* tp_compare */
+    0,                    /* tp_repr */
+    0,                    /* tp_as_number */
+    0,                    /* tp_as_sequence */
+    0,                    /* tp_as_mapping */
+    0,                    /* tp_hash */
+    scanner_call,         /* tp_call */
+    0,                    /* tp_str */
+    0,/* PyObject_GenericGetAttr, */                    /* tp_getattro */
+    0,/* PyObject_GenericSetAttr, */                    /* tp_setattro */
+    0,                    /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,   /* tp_flags */
+    scanner_doc,          /* tp_doc */
+    0,                    /* tp_traverse */
+    0,                    /* tp_clear */
+    0,                    /* tp_richcompare */
+    0,                    /* tp_weaklistoffset */
+    0,                    /* tp_iter */
+    0,                    /* tp_iternext */
+    scanner_methods,      /* tp_methods */
+    scanner_members,                    /* tp_members */
+    0,                    /* tp_getset */
+    0,                    /* tp_base */
+    0,                    /* tp_dict */
+    0,                    /* tp_descr_get */
+    0,                    /* tp_descr_set */
+    0,                    /* tp_dictoffset */
+    scanner_init,                    /* tp_init */
+    0,/* PyType_GenericAlloc, */        /* tp_alloc */
+    0,/* PyType_GenericNew, */          /* tp_new */
+    0,/* _PyObject_Del, */              /* tp_free */
+};
+
+#define IS_TOKEN_CHAR(c) (((c) >= '0' && (c) <= '9') || ((c) >= 'a' && (c) <= 'z') || ((c) >= 'A' && (c) <= 'Z') || (c) == '-' || (c) == '+' || (c) == '.')
+
+static void
+push_parser_error(PyPushParserObject *s, char *msg, Py_ssize_t pos)
+{
+    s->state = PUSH_ERROR;
+    PyErr_Format(PyExc_ValueError, "%s: stream offset %" PY_FORMAT_SIZE_T "d",
+                 msg, s->offset + pos);
+}
+
+static void
+push_parser_scan_error(PyPushParserObject *s)
+{
+    /* Restate a scanner error "msg: line L column C (char N)" about the
+       value buf[start:] as "msg: stream offset M".  Other errors, such as
+       those raised by hooks, are left alone. */
+    PyObject *type, *value, *tb;
+    PyObject *text = NULL;
+    PyObject *msg;
+    const char *str, *line, *p;
+    Py_ssize_t pos;
+    if (!PyErr_ExceptionMatches(PyExc_ValueError))
+        return;
+    PyErr_Fetch(&type, &value, &tb);
+    PyErr_NormalizeException(&type, &value, &tb);
+    if (value != NULL)
+        text = PyObject_Str(value);
+    if (text == NULL || !PyString_Check(text))
+        goto restore;
+    str = PyString_AS_STRING(text);
+    line = NULL;
+    for (p = strstr(str, ": line "); p != NULL; p = strstr(p + 1, ": line "))
+        line = p;
+    if (line == NULL || (p = strstr(line, "(char ")) == NULL)
+        goto restore;
+    p += 6;
+    if (*p < '0' || *p > '9')
+        goto restore;
+    for (pos = 0; *p >= '0' && *p <= '9'; p++)
+        pos = pos * 10 + (*p - '0');
+    msg = PyString_FromStringAndSize(str, line - str);
+    if (msg == NULL)
+        goto restore;
+    PyErr_Format(PyExc_ValueError, "%s: stream offset %" PY_FORMAT_SIZE_T "d",
+                 PyString_AS_STRING(msg), s->offset + s->start + pos);
+    Py_DECREF(msg);
+    Py_DECREF(text);
+    Py_XDECREF(type);
+    Py_XDECREF(value);
+    Py_XDECREF(tb);
+    return;
+restore:
+    Py_XDECREF(text);
+    PyErr_Restore(type, value, tb);
+}
+
+static int
+push_parser_emit(PyPushParserObject *s, PyObject *values, Py_ssize_t end)
+{
+    /* Decode the complete value buf[start:end] with the scanner and append
+       it.  Any error leaves the parser in PUSH_ERROR. */
+    PyObject *pystr;
+    PyObject *val = NULL;
+    Py_ssize_t next_idx;
+    int rv = -1;
+    pystr = PyString_FromStringAndSize(s->buf + s->start, end - s->start);
+    if (pystr == NULL)
+        goto bail;
+    val = scan_once_str((PyScannerObject *)s->scanner, pystr, 0, &next_idx);
+    if (val == NULL) {
+        if (PyErr_ExceptionMatches(PyExc_StopIteration)) {
+            PyErr_Clear();
+            push_parser_error(s, "No JSON object could be decoded", s->start);
+        }
+        else {
+            push_parser_scan_error(s);
+        }
+        goto bail;
+    }
+    if (next_idx != PyString_GET_SIZE(pystr)) {
+        push_parser_error(s, "Extra data", s->start + next_idx);
+        goto bail;
+    }
+    if (PyList_Append(values, val))
+        goto bail;
+    s->start = -1;
+    s->state = PUSH_VALUE;
+    if (s->items)
+        s->expect = PUSH_EXPECT_DELIMITER;
+    rv = 0;
+bail:
+    if (rv)
+        s->state = PUSH_ERROR;
+    Py_XDECREF(val);
+    Py_XDECREF(pystr);
+    return rv;
+}
+
+static int
+push_parser_begin(PyPushParserObject *s, Py_ssize_t pos)
+{
+    /* Start a value at buf[pos], which is not whitespace */
+    char c = s->buf[pos];
+    Py_ssize_t base = s->items ? 1 : 0;
+    s->start = pos;
+    if (c == '"') {
+        s->state = PUSH_STRING;
+    }
+    else if (c == '{' || c == '[') {
+        s->depth = base + 1;
+        s->state = PUSH_NESTED;
+    }
+    else if (IS_TOKEN_CHAR(c)) {
+        s->state = PUSH_TOKEN;
+    }
+    else {
+        push_parser_error(s, "Expecting value", pos);
+        return -1;
+    }
+    return 0;
+}
+
+static int
+push_parser_scan(PyPushParserObject *s, PyObject *values)
+{
+    /*
+    Classify the buffered bytes from s->pos on, emitting every value that
+    is complete.  Only depth and string state are tracked here, the scanner
+    validates each value once it is complete.
+    */
+    char *buf = s->buf;
+    Py_ssize_t len = s->len;
+    Py_ssize_t pos = s->pos;
+    Py_ssize_t base = s->items ? 1 : 0;
+    int has_unicode = 0;
+    while (pos < len) {
+        char c = buf[pos];
+        switch (s->state) {
+            case PUSH_STRING:
+                pos = scan_plain_str(buf, pos, len, &has_unicode);
+                if (pos == len)
+                    break;
+                c = buf[pos++];
+                if (c == '\\') {
+                    s->state = PUSH_ESCAPE;
+                }
+                else if (c == '"') {
+                    if (s->depth > base) {
+                        s->state = PUSH_NESTED;
+                    }
+                    else if (push_parser_emit(s, values, pos)) {
+                        return -1;
+                    }
+                }
+                break;
+            case PUSH_ESCAPE:
+                pos++;
+                s->state = PUSH_STRING;
+                break;
+            case PUSH_TOKEN:
+                if (IS_TOKEN_CHAR(c)) {
+                    pos++;
+                }
+                else if (push_parser_emit(s, values, pos)) {
+                    return -1;
                 }
-            }
-#ifdef Py_UNICODE_WIDE
-            /* Surrogate pair */
-            if ((c & 0xfc00) == 0xd800) {
-                Py_UNICODE c2 = 0;
-                if (end + 6 >= len) {
-                    raise_errmsg("Unpaired high surrogate", pystr, end - 5);
-                    goto bail;
+                break;
+            case PUSH_NESTED:
+                pos++;
+                if (c == '"') {
+                    s->state = PUSH_STRING;
                 }
-                if (buf[next++] != '\\' || buf[next++] != 'u') {
-                    raise_errmsg("Unpaired high surrogate", pystr, end - 5);
-                    goto bail;
+                else if (c == '{' || c == '[') {
+                    s->depth++;
                 }
-                end += 6;
-                /* Decode 4 hex digits */
-                for (; next < end; next++) {
-                    c2 <<= 4;
-                    Py_UNICODE digit = buf[next];
-                    switch (digit) {
-                        case '0': case '1': case '2': case '3': case '4':
-                        case '5': case '6': case '7': case '8': case '9':
-                            c2 |= (digit - '0'); break;
-                        case 'a': case 'b': case 'c': case 'd': case 'e':
-                        case 'f':
-                            c2 |= (digit - 'a' + 10); break;
-                        case 'A': case 'B': case 'C': case 'D': case 'E':
-                        case 'F':
-                            c2 |= (digit - 'A' + 10); break;
-                        default:
-                            raise_errmsg("Invalid \\uXXXX escape", pystr, end - 5);
-                            goto bail;
+                else if (c == '}' || c == ']') {
+                    s->depth--;
+                    if (s->depth == base && push_parser_emit(s, values, pos))
+                        return -1;
+                }
+                break;
+            case PUSH_VALUE:
+                if (IS_WHITESPACE(c)) {
+                    pos++;
+                }
+                else if (!s->items) {
+                    if (push_parser_begin(s, pos))
+                        return -1;
+                    pos++;
+                }
+                else if (s->expect == PUSH_EXPECT_OPEN) {
+                    if (c != '[') {
+                        push_parser_error(s, "Expecting array", pos);
+                        return -1;
                     }
+                    s->expect = PUSH_EXPECT_FIRST;
+                    pos++;
                 }
-                if ((c2 & 0xfc00) != 0xdc00) {
-                    raise_errmsg("Unpaired high surrogate", pystr, end - 5);
-                    goto bail;
+                else if (s->expect == PUSH_EXPECT_END) {
+                    push_parser_error(s, "Extra data", pos);
+                    return -1;
                 }
-                c = 0x10000 + (((c - 0xd800) << 10) | (c2 - 0xdc00));
-            }
-            else if ((c & 0xfc00) == 0xdc00) {
-                raise_errmsg("Unpaired low surrogate", pystr, end - 5);
-                goto bail;
-            }
-#endif
-        }
-        chunk = PyUnicode_FromUnicode(&c, 1);
-        if (chunk == NULL) {
-            goto bail;
-        }
-        if (PyList_Append(chunks, chunk)) {
-            goto bail;
+                else if (c == ']' && s->expect != PUSH_EXPECT_VALUE) {
+                    s->expect = PUSH_EXPECT_END;
+                    pos++;
+                }
+                else if (s->expect == PUSH_EXPECT_DELIMITER) {
+                    if (c != ',') {
+                        push_parser_error(s, "Expecting , delimiter", pos);
+                        return -1;
+                    }
+                    s->expect = PUSH_EXPECT_VALUE;
+                    pos++;
+                }
+                else {
+                    if (push_parser_begin(s, pos))
+                        return -1;
+                    pos++;
+                }
+                break;
+            default:
+                PyErr_SetString(PyExc_ValueError, "push parser is in an error state");
+                return -1;
         }
-        Py_DECREF(chunk);
     }
+    s->pos = pos;
+    return 0;
+}
 
-    rval = join_list_string(chunks);
-    if (rval == NULL) {
-        goto bail;
+static void
+push_parser_compact(PyPushParserObject *s)
+{
+    /* Drop the bytes before the value in progress (or all scanned bytes) */
+    Py_ssize_t drop = (s->start == -1) ? s->pos : s->start;
+    if (drop == 0)
+        return;
+    memmove(s->buf, s->buf + drop, s->len - drop);
+    s->len -= drop;
+    s->pos -= drop;
+    if (s->start != -1)
+        s->start -= drop;
+    s->offset += drop;
+}
+
+static int
+push_parser_ready(PyPushParserObject *s)
+{
+    /* 0 if feed() or close() may go on, else -1 with the error raised.
+       An error held back by the previous feed() is raised now. */
+    if (s->running) {
+        PyErr_SetString(PyExc_ValueError, "push parser is already running");
+        return -1;
     }
-    Py_DECREF(chunks);
-    *next_end_ptr = end;
-    return rval;
-bail:
-    *next_end_ptr = -1;
-    Py_XDECREF(chunks);
-    return NULL;
+    if (s->err_type != NULL) {
+        PyErr_Restore(s->err_type, s->err_value, NULL);
+        s->err_type = NULL;
+        s->err_value = NULL;
+        return -1;
+    }
+    if (s->state == PUSH_ERROR) {
+        PyErr_SetString(PyExc_ValueError, "push parser is in an error state");
+        return -1;
+    }
+    return 0;
 }
 
-PyDoc_STRVAR(pydoc_scanstring,
-    "scanstring(basestring, end, encoding) -> (str, end)\n"
+PyDoc_STRVAR(push_parser_feed_doc,
+    "feed(data) -> list\n"
     "\n"
-    "..."
+    "Add a chunk of encoded JSON text and return the values it completed.\n"
+    "If the chunk goes wrong after completing some values, those are\n"
+    "returned and the error is raised by the next call."
 );
 
 static PyObject *
-py_scanstring(PyObject* self UNUSED, PyObject *args)
+push_parser_feed(PyObject *self, PyObject *args)
 {
-    PyObject *pystr;
-    PyObject *rval;
-    Py_ssize_t end;
-    Py_ssize_t next_end = -1;
-    char *encoding = NULL;
-    int strict = 0;
-    if (!PyArg_ParseTuple(args, "OO&|zi:scanstring", &pystr, _convertPyInt_AsSsize_t, &end, &encoding, &strict)) {
+    PyPushParserObject *s = (PyPushParserObject *)self;
+    PyObject *pydata;
+    char *data;
+    Py_ssize_t n;
+    PyObject *values;
+    if (!PyArg_ParseTuple(args, "O:feed", &pydata))
         return NULL;
+    if (PyString_AsStringAndSize(pydata, &data, &n))
+        return NULL;
+    if (push_parser_ready(s))
+        return NULL;
+    if (n > PY_SSIZE_T_MAX - s->len) {
+        return PyErr_NoMemory();
     }
-    if (encoding == NULL) {
-        encoding = DEFAULT_ENCODING;
-    }
-    if (PyString_Check(pystr)) {
-        rval = scanstring_str(pystr, end, encoding, strict, &next_end);
-    }
-    else if (PyUnicode_Check(pystr)) {
-        rval = scanstring_unicode(pystr, end, strict, &next_end);
+    if (s->len + n > s->size) {
+        Py_ssize_t size = s->size ? s->size : 4096;
+        char *buf;
+        while (size < s->len + n)
+            size = (size > PY_SSIZE_T_MAX / 2) ? s->len + n : size * 2;
+        buf = (char *)PyMem_Realloc(s->buf, size);
+        if (buf == NULL)
+            return PyErr_NoMemory();
+        s->buf = buf;
+        s->size = size;
     }
-    else {
-        PyErr_Format(PyExc_TypeError,
-                     "first argument must be a string, not %.80s",
-                     Py_TYPE(pystr)->tp_name);
+    memcpy(s->buf + s->len, data, n);
+    s->len += n;
+    STATS_ADD(bytes_scanned, n);
+    values = PyList_New(0);
+    if (values == NULL)
         return NULL;
+    /* Hooks run by the scanner must not feed() while buf is in use */
+    s->running = 1;
+    if (push_parser_scan(s, values)) {
+        PyObject *tb;
+        s->running = 0;
+        s->state = PUSH_ERROR;
+        if (PyList_GET_SIZE(values) == 0) {
+            Py_DECREF(values);
+            return NULL;
+        }
+        PyErr_Fetch(&s->err_type, &s->err_value, &tb);
+        Py_XDECREF(tb);
+        return values;
     }
-    return _build_rval_index_tuple(rval, next_end);
+    s->running = 0;
+    push_parser_compact(s);
+    return values;
 }
 
-PyDoc_STRVAR(pydoc_encode_basestring_ascii,
-    "encode_basestring_ascii(basestring) -> str\n"
+PyDoc_STRVAR(push_parser_close_doc,
+    "close() -> list\n"
     "\n"
-    "..."
+    "Finish the stream and return any value completed by its end.\n"
+    "Raises ValueError if the stream stops inside a value."
 );
 
 static PyObject *
-py_encode_basestring_ascii(PyObject* self UNUSED, PyObject *pystr)
+push_parser_close(PyObject *self, PyObject *args UNUSED)
 {
-    /* METH_O */
-    if (PyString_Check(pystr)) {
-        return ascii_escape_str(pystr);
+    PyPushParserObject *s = (PyPushParserObject *)self;
+    PyObject *values;
+    int rv = 0;
+    if (push_parser_ready(s))
+        return NULL;
+    values = PyList_New(0);
+    if (values == NULL)
+        return NULL;
+    if (s->state == PUSH_TOKEN) {
+        s->running = 1;
+        rv = push_parser_emit(s, values, s->len);
+        s->running = 0;
+        if (rv)
+            goto bail;
     }
-    else if (PyUnicode_Check(pystr)) {
-        return ascii_escape_unicode(pystr);
+    if (s->state != PUSH_VALUE) {
+        push_parser_error(s, "Unterminated value starting at", s->start);
+        goto bail;
+    }
+    if (s->items && s->expect != PUSH_EXPECT_END) {
+        push_parser_error(s, "Unterminated array", s->len);
+        goto bail;
+    }
+    push_parser_compact(s);
+    return values;
+bail:
+    Py_DECREF(values);
+    return NULL;
+}
+
+static PyMethodDef push_parser_methods[] = {
+    {"feed", (PyCFunction)push_parser_feed, METH_VARARGS, push_parser_feed_doc},
+    {"close", (PyCFunction)push_parser_close, METH_NOARGS, push_parser_close_doc},
+    {NULL, NULL, 0, NULL}
+};
+
+static int
+push_parser_init(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"context", "items", NULL};
+    PyPushParserObject *s = (PyPushParserObject *)self;
+    PyObject *ctx;
+    PyObject *scanner;
+    int items = 0;
+
+    assert(PyPushParser_Check(self));
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|i:make_push_parser", kwlist, &ctx, &items))
+        return -1;
+
+    /* Accept a scanner or anything make_scanner accepts as a context */
+    if (PyScanner_Check(ctx)) {
+        Py_INCREF(ctx);
+        scanner = ctx;
     }
     else {
-        PyErr_Format(PyExc_TypeError,
-                     "first argument must be a string, not %.80s",
-                     Py_TYPE(pystr)->tp_name);
-        return NULL;
+        scanner = PyObject_CallFunctionObjArgs((PyObject *)&PyScannerType, ctx, NULL);
+        if (scanner == NULL)
+            return -1;
     }
+    Py_XDECREF(s->scanner);
+    s->scanner = scanner;
+    s->len = 0;
+    s->pos = 0;
+    s->start = -1;
+    s->offset = 0;
+    s->depth = 0;
+    s->items = items;
+    s->state = PUSH_VALUE;
+    s->expect = PUSH_EXPECT_OPEN;
+    Py_CLEAR(s->err_type);
+    Py_CLEAR(s->err_value);
+    return 0;
 }
 
 static void
-scanner_dealloc(PyObject *self)
+push_parser_dealloc(PyObject *self)
 {
-    assert(PyScanner_Check(self));
-    PyScannerObject *s = (PyScannerObject *)self;
-    Py_XDECREF(s->encoding);
-    Py_XDECREF(s->strict);
-    Py_XDECREF(s->object_hook);
-    Py_XDECREF(s->parse_float);
-    Py_XDECREF(s->parse_int);
-    Py_XDECREF(s->parse_constant);
-    s->encoding = NULL;
-    s->strict = NULL;
-    s->object_hook = NULL;
-    s->parse_float = NULL;
-    s->parse_int = NULL;
-    s->parse_constant = NULL;
+    PyPushParserObject *s = (PyPushParserObject *)self;
+    Py_XDECREF(s->scanner);
+    s->scanner = NULL;
+    Py_CLEAR(s->err_type);
+    Py_CLEAR(s->err_value);
+    PyMem_Free(s->buf);
+    s->buf = NULL;
     self->ob_type->tp_free(self);
 }
 
-static PyObject *
-_parse_object_str(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx) {
-    char *str = PyString_AS_STRING(pystr);
-    Py_ssize_t end_idx = PyString_GET_SIZE(pystr) - 1;
-    PyObject *tpl = NULL;
-    PyObject *rval = PyDict_New();
-    PyObject *key = NULL;
-    char *encoding = PyString_AS_STRING(s->encoding);
-    int strict = PyObject_IsTrue(s->strict);
-    Py_ssize_t next_idx;
-    if (rval == NULL)
-        return NULL;
+PyDoc_STRVAR(push_parser_doc,
+    "make_push_parser(context, items=False)\n"
+    "\n"
+    "Incremental decoder for JSON text that arrives in chunks.  feed()\n"
+    "returns each top-level value as soon as it is complete.  With items\n"
+    "set, the stream must hold one array and each element is returned as\n"
+    "soon as it is complete."
+);
 
-    /* skip whitespace after { */
-    while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
+static
+PyTypeObject PyPushParserType = {
+    PyObject_HEAD_INIT(0)
+    0,                    /* tp_internal */
+    "make_push_parser",   /* tp_name */
+    sizeof(PyPushParserObject), /* tp_basicsize */
+    0,                    /* tp_itemsize */
+    push_parser_dealloc,  /* tp_dealloc */
+    0,                    /* tp_print */
+    0,                    /* tp_getattr */
+    0,                    /* tp_setattr */
+    0,                    /* tp_compare */
+    0,                    /* tp_repr */
+    0,                    /* tp_as_number */
+    0,                    /* tp_as_sequence */
+    0,                    /* tp_as_mapping */
+    0,                    /* tp_hash */
+    0,                    /* tp_call */
+    0,                    /* tp_str */
+    0,/* PyObject_GenericGetAttr, */                    /* tp_getattro */
+    0,/* PyObject_GenericSetAttr, */                    /* tp_setattro */
+    0,                    /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,   /* tp_flags */
+    push_parser_doc,      /* tp_doc */
+    0,                    /* tp_traverse */
+    0,                    /* tp_clear */
+    0,                    /* tp_richcompare */
+    0,                    /* tp_weaklistoffset */
+    0,                    /* tp_iter */
+    0,                    /* tp_iternext */
+    push_parser_methods,  /* tp_methods */
+    push_parser_members,  /* tp_members */
+    0,                    /* tp_getset */
+    0,                    /* tp_base */
+    0,                    /* tp_dict */
+    0,                    /* tp_descr_get */
+    0,                    /* tp_descr_set */
+    0,                    /* tp_dictoffset */
+    push_parser_init,     /* tp_init */
+    0,/* PyType_GenericAlloc, */        /* tp_alloc */
+    0,/* PyType_GenericNew, */          /* tp_new */
+    0,/* _PyObject_Del, */              /* tp_free */
+};
 
-    /* only loop if the object is non-empty */
-    if (idx <= end_idx && str[idx] != '}') {
-        while (idx <= end_idx) {
-            /* read key */
-            if (str[idx] != '"') {
-                raise_errmsg("Expecting property name", pystr, idx);
-                goto bail;
-            }
-            key = scanstring_str(pystr, idx + 1, encoding, strict, &next_idx);
-            if (key == NULL)
-                goto bail;
-            Py_INCREF(key);
-            idx = next_idx;
-            
-            /* skip whitespace between key and : delimiter, read :, skip whitespace */
-            while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
-            if (idx > end_idx || str[idx] != ':') {
-                raise_errmsg("Expecting : delimiter", pystr, idx);
-                goto bail;
-            }
-            idx++;
-            while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
-            
-            /* read any JSON data type and de-tuplefy the (rval, idx) */
-            tpl = scan_once_str(s, pystr, idx);
-            if (tpl == NULL)
-                goto bail;
-            next_idx = PyInt_AsSsize_t(PyTuple_GET_ITEM(tpl, 1));
-            if (next_idx == -1 && PyErr_Occurred())
-                goto bail;
-            if (PyDict_SetItem(rval, key, PyTuple_GET_ITEM(tpl, 0)) == -1)
-                goto bail;
-            Py_DECREF(tpl);
-            idx = next_idx;
-            tpl = NULL;
-            
-            /* skip whitespace before } or , */
-            while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
-
-            /* bail if the object is closed or we didn't get the , delimiter */
-            if (idx > end_idx) break;
-            if (str[idx] == '}') {
-                break;
-            }
-            else if (str[idx] != ',') {
-                raise_errmsg("Expecting , delimiter", pystr, idx);
-                goto bail;
-            }
-            idx++;
+/*
+A lazy document makes one pass over the text to build its tape, checking
+only the structure and where strings end.  Values are built by the
+scanner when they are read, and containers are returned as views that
+share the root document's tape.
+*/
+#define LAZY_CHAR(s, i) ((s)->ustr != NULL ? (Py_UCS4)(s)->ustr[i] : (Py_UCS4)(unsigned char)(s)->cstr[i])
+#define JSON_LAZY_STACK 64
 
-            /* skip whitespace after , delimiter */
-            while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
-        }
-    }
-    /* verify that idx < end_idx, str[idx] should be '}' */
-    if (idx > end_idx || str[idx] != '}') {
-        raise_errmsg("Expecting object", pystr, end_idx);
-        goto bail;
-    }
-    /* if object_hook is not None: rval = object_hook(rval) */
-    if (s->object_hook != Py_None) {
-        tpl = PyObject_CallFunctionObjArgs(s->object_hook, rval, NULL);
-        if (tpl == NULL)
-            goto bail;
-        Py_DECREF(rval);
-        rval = tpl;
-        tpl = NULL;
-    }
-    return _build_rval_index_tuple(rval, idx + 1);
-bail:
-    Py_XDECREF(key);
-    Py_XDECREF(tpl);
-    Py_DECREF(rval);
-    return NULL;    
+static Py_ssize_t
+lazy_skip_whitespace(PyLazyDocumentObject *s, Py_ssize_t idx)
+{
+    while (idx < s->len && IS_WHITESPACE(LAZY_CHAR(s, idx)))
+        idx++;
+    return idx;
 }
 
-static PyObject *
-_parse_object_unicode(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx) {
-    Py_UNICODE *str = PyUnicode_AS_UNICODE(pystr);
-    Py_ssize_t end_idx = PyUnicode_GET_SIZE(pystr) - 1;
-    PyObject *tpl = NULL;
-    PyObject *rval = PyDict_New();
-    PyObject *key = NULL;
-    int strict = PyObject_IsTrue(s->strict);
-    Py_ssize_t next_idx;
-    if (rval == NULL)
-        return NULL;
-    
-    /* skip whitespace after { */
-    while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
-
-    /* only loop if the object is non-empty */
-    if (idx <= end_idx && str[idx] != '}') {
-        while (idx <= end_idx) {
-            /* read key */
-            if (str[idx] != '"') {
-                raise_errmsg("Expecting property name", pystr, idx);
-                goto bail;
-            }
-            key = scanstring_unicode(pystr, idx + 1, strict, &next_idx);
-            if (key == NULL)
-                goto bail;
-            idx = next_idx;
-
-            /* skip whitespace between key and : delimiter, read :, skip whitespace */
-            while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
-            if (idx > end_idx || str[idx] != ':') {
-                raise_errmsg("Expecting : delimiter", pystr, idx);
-                goto bail;
-            }
-            idx++;
-            while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
-            
-            /* read any JSON term and de-tuplefy the (rval, idx) */
-            tpl = scan_once_unicode(s, pystr, idx);
-            if (tpl == NULL)
-                goto bail;
-            next_idx = PyInt_AsSsize_t(PyTuple_GET_ITEM(tpl, 1));
-            if (next_idx == -1 && PyErr_Occurred())
-                goto bail;
-            if (PyDict_SetItem(rval, key, PyTuple_GET_ITEM(tpl, 0)) == -1)
-                goto bail;
-            Py_DECREF(tpl);
-            idx = next_idx;
-            tpl = NULL;
-
-            /* skip whitespace before } or , */
-            while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
-
-            /* bail if the object is closed or we didn't get the , delimiter */
-            if (idx > end_idx) break;
-            if (str[idx] == '}') {
-                break;
-            }
-            else if (str[idx] != ',') {
-                raise_errmsg("Expecting , delimiter", pystr, idx);
-                goto bail;
-            }
-            idx++;
+static Py_ssize_t
+lazy_string_end(PyLazyDocumentObject *s, Py_ssize_t idx)
+{
+    /* Index just past the quote closing the string whose body starts at
+       idx, or -1 if it is unterminated.  Escapes are checked on read. */
+    int has_unicode = 0;
+    for (;;) {
+        Py_UCS4 c;
+        if (s->ustr != NULL)
+            idx = scan_plain_unicode(s->ustr, idx, s->len);
+        else
+            idx = scan_plain_str(s->cstr, idx, s->len, &has_unicode);
+        if (idx >= s->len)
+            return -1;
+        c = LAZY_CHAR(s, idx);
+        if (c == '"')
+            return idx + 1;
+        idx += (c == '\\') ? 2 : 1;
+    }
+}
 
-            /* skip whitespace after , delimiter */
-            while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
+static Py_ssize_t
+lazy_tape_push(PyLazyDocumentObject *s, Py_ssize_t *size, Py_ssize_t start)
+{
+    /* Append an entry for the value at start and return its index */
+    if (s->tape_len == *size) {
+        JSON_TapeEntry *tape;
+        Py_ssize_t new_size = (*size == 0) ? 64 : *size * 2;
+        if (new_size > PY_SSIZE_T_MAX / (Py_ssize_t)sizeof(JSON_TapeEntry)) {
+            PyErr_NoMemory();
+            return -1;
         }
+        tape = (JSON_TapeEntry *)PyMem_Realloc(s->tape, new_size * sizeof(JSON_TapeEntry));
+        if (tape == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        s->tape = tape;
+        *size = new_size;
     }
+    s->tape[s->tape_len].start = start;
+    s->tape[s->tape_len].end = -1;
+    s->tape[s->tape_len].next = -1;
+    return s->tape_len++;
+}
 
-    /* verify that idx < end_idx, str[idx] should be '}' */
-    if (idx > end_idx || str[idx] != '}') {
-        raise_errmsg("Expecting object", pystr, end_idx);
-        goto bail;
+static Py_ssize_t
+lazy_tape_key(PyLazyDocumentObject *s, Py_ssize_t *size, Py_ssize_t idx)
+{
+    /* Record the key at idx and return the index of its value */
+    Py_ssize_t entry;
+    Py_ssize_t end;
+    if (idx >= s->len || LAZY_CHAR(s, idx) != '"') {
+        raise_errmsg("Expecting property name", s->pystr, idx);
+        return -1;
     }
-
-    /* if object_hook is not None: rval = object_hook(rval) */
-    if (s->object_hook != Py_None) {
-        tpl = PyObject_CallFunctionObjArgs(s->object_hook, rval, NULL);
-        if (tpl == NULL)
-            goto bail;
-        Py_DECREF(rval);
-        rval = tpl;
-        tpl = NULL;
+    end = lazy_string_end(s, idx + 1);
+    if (end < 0) {
+        raise_errmsg("Unterminated string starting at", s->pystr, idx);
+        return -1;
     }
-    return _build_rval_index_tuple(rval, idx + 1);
-bail:
-    Py_XDECREF(key);
-    Py_XDECREF(tpl);
-    Py_DECREF(rval);
-    return NULL;
+    entry = lazy_tape_push(s, size, idx);
+    if (entry < 0)
+        return -1;
+    s->tape[entry].end = end;
+    s->tape[entry].next = entry + 1;
+    idx = lazy_skip_whitespace(s, end);
+    if (idx >= s->len || LAZY_CHAR(s, idx) != ':') {
+        raise_errmsg("Expecting : delimiter", s->pystr, idx);
+        return -1;
+    }
+    return lazy_skip_whitespace(s, idx + 1);
 }
 
-static PyObject *
-_parse_array_str(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx) {
-    char *str = PyString_AS_STRING(pystr);
-    Py_ssize_t end_idx = PyString_GET_SIZE(pystr) - 1;
-    PyObject *tpl = NULL;
-    PyObject *rval = PyList_New(0);
-    Py_ssize_t next_idx;
-    if (rval == NULL)
-        return NULL;
-
-    /* skip whitespace after [ */
-    while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
-
-    /* only loop if the array is non-empty */
-    if (idx <= end_idx && str[idx] != ']') {
-        while (idx <= end_idx) {
-
-            /* read any JSON term and de-tuplefy the (rval, idx) */
-            tpl = scan_once_str(s, pystr, idx);
-            if (tpl == NULL)
-                goto bail;
-            next_idx = PyInt_AsSsize_t(PyTuple_GET_ITEM(tpl, 1));
-            if (next_idx == -1 && PyErr_Occurred())
-                goto bail;
-            if (PyList_Append(rval, PyTuple_GET_ITEM(tpl, 0)) == -1)
-                goto bail;
-            Py_DECREF(tpl);
-            idx = next_idx;
-            tpl = NULL;
-            
-            /* skip whitespace between term and , */
-            while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
-
-            /* bail if the array is closed or we didn't get the , delimiter */
-            if (idx > end_idx) break;
-            if (str[idx] == ']') {
+static int
+lazy_build_tape(PyLazyDocumentObject *s)
+{
+    /* One pass over the whole text, open containers are kept on a stack */
+    Py_ssize_t inline_stack[JSON_LAZY_STACK];
+    Py_ssize_t *stack = inline_stack;
+    Py_ssize_t stack_size = JSON_LAZY_STACK;
+    Py_ssize_t depth = 0;
+    Py_ssize_t size = 0;
+    Py_ssize_t idx = lazy_skip_whitespace(s, 0);
+    Py_ssize_t entry;
+    Py_UCS4 c;
+    for (;;) {
+        if (idx >= s->len) {
+            raise_errmsg("Expecting value", s->pystr, idx);
+            goto bail;
+        }
+        c = LAZY_CHAR(s, idx);
+        entry = lazy_tape_push(s, &size, idx);
+        if (entry < 0)
+            goto bail;
+        if (c == '{' || c == '[') {
+            if (depth == stack_size) {
+                Py_ssize_t *new_stack;
+                stack_size *= 2;
+                if (stack == inline_stack) {
+                    new_stack = (Py_ssize_t *)PyMem_Malloc(stack_size * sizeof(Py_ssize_t));
+                    if (new_stack != NULL)
+                        memcpy(new_stack, inline_stack, depth * sizeof(Py_ssize_t));
+                }
+                else {
+                    new_stack = (Py_ssize_t *)PyMem_Realloc(stack, stack_size * sizeof(Py_ssize_t));
+                }
+                if (new_stack == NULL) {
+                    PyErr_NoMemory();
+                    goto bail;
+                }
+                stack = new_stack;
+            }
+            stack[depth++] = entry;
+            idx = lazy_skip_whitespace(s, idx + 1);
+            /* '}' and ']' are two past '{' and '[' */
+            if (idx >= s->len || LAZY_CHAR(s, idx) != c + 2) {
+                if (c == '{') {
+                    idx = lazy_tape_key(s, &size, idx);
+                    if (idx < 0)
+                        goto bail;
+                }
+                continue;
+            }
+        }
+        else {
+            Py_ssize_t end;
+            if (c == '"') {
+                end = lazy_string_end(s, idx + 1);
+                if (end < 0) {
+                    raise_errmsg("Unterminated string starting at", s->pystr, idx);
+                    goto bail;
+                }
+            }
+            else {
+                end = idx;
+                while (end < s->len && IS_TOKEN_CHAR(LAZY_CHAR(s, end)))
+                    end++;
+                if (end == idx) {
+                    raise_errmsg("Expecting value", s->pystr, idx);
+                    goto bail;
+                }
+            }
+            s->tape[entry].end = end;
+            s->tape[entry].next = entry + 1;
+            idx = lazy_skip_whitespace(s, end);
+        }
+        /* After a complete value: close containers or go on to the next member */
+        for (;;) {
+            Py_ssize_t open;
+            if (depth == 0)
+                goto done;
+            open = stack[depth - 1];
+            c = LAZY_CHAR(s, s->tape[open].start);
+            if (idx < s->len && LAZY_CHAR(s, idx) == c + 2) {
+                s->tape[open].end = idx + 1;
+                s->tape[open].next = s->tape_len;
+                depth--;
+                idx = lazy_skip_whitespace(s, idx + 1);
+            }
+            else if (idx < s->len && LAZY_CHAR(s, idx) == ',') {
+                idx = lazy_skip_whitespace(s, idx + 1);
+                if (c == '{') {
+                    idx = lazy_tape_key(s, &size, idx);
+                    if (idx < 0)
+                        goto bail;
+                }
                 break;
             }
-            else if (str[idx] != ',') {
-                raise_errmsg("Expecting , delimiter", pystr, idx);
+            else {
+                raise_errmsg("Expecting , delimiter", s->pystr, idx);
                 goto bail;
             }
-            idx++;
-            
-            /* skip whitespace after , */
-            while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
         }
     }
-
-    /* verify that idx < end_idx, str[idx] should be ']' */
-    if (idx > end_idx || str[idx] != ']') {
-        raise_errmsg("Expecting object", pystr, end_idx);
-        goto bail;
+done:
+    if (stack != inline_stack)
+        PyMem_Free(stack);
+    if (idx != s->len) {
+        raise_errmsg("Extra data", s->pystr, idx);
+        return -1;
     }
-    return _build_rval_index_tuple(rval, idx + 1);
+    return 0;
 bail:
-    Py_XDECREF(tpl);
-    Py_DECREF(rval);
-    return NULL;
+    if (stack != inline_stack)
+        PyMem_Free(stack);
+    return -1;
 }
 
 static PyObject *
-_parse_array_unicode(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx) {
-    Py_UNICODE *str = PyUnicode_AS_UNICODE(pystr);
-    Py_ssize_t end_idx = PyUnicode_GET_SIZE(pystr) - 1;
-    PyObject *tpl = NULL;
-    PyObject *rval = PyList_New(0);
-    Py_ssize_t next_idx;
-    if (rval == NULL)
-        return NULL;
-
-    /* skip whitespace after [ */
-    while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
-
-    /* only loop if the array is non-empty */
-    if (idx <= end_idx && str[idx] != ']') {
-        while (idx <= end_idx) {
-
-            /* read any JSON term and de-tuplefy the (rval, idx) */
-            tpl = scan_once_unicode(s, pystr, idx);
-            if (tpl == NULL)
-                goto bail;
-            next_idx = PyInt_AsSsize_t(PyTuple_GET_ITEM(tpl, 1));
-            if (next_idx == -1 && PyErr_Occurred())
-                goto bail;
-            if (PyList_Append(rval, PyTuple_GET_ITEM(tpl, 0)) == -1)
-                goto bail;
-            Py_DECREF(tpl);
-            idx = next_idx;
-            tpl = NULL;
-
-            /* skip whitespace between term and , */
-            while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
-
-            /* bail if the array is closed or we didn't get the , delimiter */
-            if (idx > end_idx) break;
-            if (str[idx] == ']') {
-                break;
-            }
-            else if (str[idx] != ',') {
-                raise_errmsg("Expecting , delimiter", pystr, idx);
-                goto bail;
-            }
-            idx++;
-
-            /* skip whitespace after , */
-            while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
+lazy_load(PyLazyDocumentObject *s, Py_ssize_t node)
+{
+    /* Build the value of a tape entry with the scanner */
+    PyScannerObject *scanner = (PyScannerObject *)s->scanner;
+    Py_ssize_t start = s->tape[node].start;
+    Py_ssize_t next_idx = -1;
+    PyObject *val;
+    if (s->ustr != NULL)
+        val = scan_once_unicode(scanner, s->pystr, start, &next_idx);
+    else
+        val = scan_once_str(scanner, s->pystr, start, &next_idx);
+    memo_clear(scanner);
+    if (val == NULL) {
+        if (PyErr_ExceptionMatches(PyExc_StopIteration)) {
+            PyErr_Clear();
+            raise_errmsg("Expecting value", s->pystr, start);
         }
+        return NULL;
     }
-
-    /* verify that idx < end_idx, str[idx] should be ']' */
-    if (idx > end_idx || str[idx] != ']') {
-        raise_errmsg("Expecting object", pystr, end_idx);
-        goto bail;
+    if (next_idx != s->tape[node].end) {
+        Py_DECREF(val);
+        raise_errmsg("Extra data", s->pystr, next_idx);
+        return NULL;
     }
-    return _build_rval_index_tuple(rval, idx + 1);
-bail:
-    Py_XDECREF(tpl);
-    Py_DECREF(rval);
-    return NULL;
+    return val;
 }
 
 static PyObject *
-_parse_constant(PyScannerObject *s, char *constant, Py_ssize_t idx) {
-    PyObject *cstr;
-    PyObject *rval;
-    /* constant is "NaN", "Infinity", or "-Infinity" */
-    cstr = PyString_InternFromString(constant);
-    if (cstr == NULL)
+lazy_view(PyLazyDocumentObject *s, Py_ssize_t node)
+{
+    /* A document for the container at node sharing the root's tape */
+    PyLazyDocumentObject *view;
+    view = (PyLazyDocumentObject *)PyLazyDocumentType.tp_alloc(&PyLazyDocumentType, 0);
+    if (view == NULL)
         return NULL;
-
-    /* rval = parse_constant(constant) */
-    rval = PyObject_CallFunctionObjArgs(s->parse_constant, cstr, NULL);
-    idx += PyString_GET_SIZE(cstr);
-    Py_DECREF(cstr);
-    return _build_rval_index_tuple(rval, idx);
+    view->root = (s->root != NULL) ? s->root : (PyObject *)s;
+    Py_INCREF(view->root);
+    view->pystr = s->pystr;
+    Py_INCREF(view->pystr);
+    view->scanner = s->scanner;
+    Py_INCREF(view->scanner);
+    view->cstr = s->cstr;
+    view->ustr = s->ustr;
+    view->len = s->len;
+    view->tape = s->tape;
+    view->tape_len = s->tape_len;
+    view->node = node;
+    view->count = -1;
+    view->cache_index = -1;
+    view->cache_child = -1;
+    return (PyObject *)view;
 }
 
 static PyObject *
-_match_number_str(PyScannerObject *s, PyObject *pystr, Py_ssize_t start) {
-    char *str = PyString_AS_STRING(pystr);
-    Py_ssize_t end_idx = PyString_GET_SIZE(pystr) - 1;
-    Py_ssize_t idx = start;
-    int is_float = 0;
-    PyObject *rval;
-    PyObject *numstr;
-    
-    /* read a sign if it's there, make sure it's not the end of the string */
-    if (str[idx] == '-') {
-        idx++;
-        if (idx > end_idx) {
-            PyErr_SetNone(PyExc_StopIteration);
-            return NULL;
-        }
-    }
-
-    /* read as many integer digits as we find as long as it doesn't start with 0 */
-    if (str[idx] >= '1' && str[idx] <= '9') {
-        idx++;
-        while (idx <= end_idx && str[idx] >= '0' && str[idx] <= '9') idx++;
-    }
-    /* if it starts with 0 we only expect one integer digit */
-    else if (str[idx] == '0') {
-        idx++;
-    }
-    /* no integer digits, error */
-    else {
-        PyErr_SetNone(PyExc_StopIteration);
-        return NULL;
-    }
-    
-    /* if the next char is '.' followed by a digit then read all float digits */
-    if (idx < end_idx && str[idx] == '.' && str[idx + 1] >= '0' && str[idx + 1] <= '9') {
-        is_float = 1;
-        idx += 2;
-        while (idx < end_idx && str[idx] >= '0' && str[idx] <= '9') idx++;
-    }
-
-    /* if the next char is 'e' or 'E' then maybe read the exponent (or backtrack) */
-    if (idx < end_idx && (str[idx] == 'e' || str[idx] == 'E')) {
-
-        /* save the index of the 'e' or 'E' just in case we need to backtrack */
-        Py_ssize_t e_start = idx;
-        idx++;
+lazy_child(PyLazyDocumentObject *s, Py_ssize_t node)
+{
+    Py_UCS4 c = LAZY_CHAR(s, s->tape[node].start);
+    if (c == '{' || c == '[')
+        return lazy_view(s, node);
+    return lazy_load(s, node);
+}
 
-        /* read an exponent sign if present */
-        if (idx < end_idx && (str[idx] == '-' || str[idx] == '+')) idx++;
+static Py_UCS4
+lazy_kind(PyLazyDocumentObject *s)
+{
+    /* '{' or '[' for containers, 0 for anything else */
+    Py_UCS4 c = LAZY_CHAR(s, s->tape[s->node].start);
+    return (c == '{' || c == '[') ? c : 0;
+}
 
-        /* read all digits */
-        while (idx <= end_idx && str[idx] >= '0' && str[idx] <= '9') idx++;
+static int
+lazy_check_kind(PyLazyDocumentObject *s, Py_UCS4 kind)
+{
+    Py_UCS4 c = lazy_kind(s);
+    if (kind ? (c == kind) : (c != 0))
+        return 0;
+    PyErr_SetString(PyExc_TypeError,
+        (kind == '{') ? "JSON value is not an object" : "JSON value is not a container");
+    return -1;
+}
 
-        /* if we got a digit, then parse as float. if not, backtrack */
-        if (str[idx - 1] >= '0' && str[idx - 1] <= '9') {
-            is_float = 1;
-        }
-        else {
-            idx = e_start;
-        }
-    }
-    
-    /* copy the section we determined to be a number */
-    numstr = PyString_FromStringAndSize(&str[start], idx - start);
-    if (numstr == NULL)
-        return NULL;
-    if (is_float) {
-        /* parse as a float using a fast path if available, otherwise call user defined method */
-        if (s->parse_float != (PyObject *)&PyFloat_Type) {
-            rval = PyObject_CallFunctionObjArgs(s->parse_float, numstr, NULL);
-        }
-        else {
-            rval = PyFloat_FromDouble(PyOS_ascii_atof(PyString_AS_STRING(numstr)));
+static PyObject *
+lazy_key_list(PyLazyDocumentObject *s)
+{
+    /* The distinct keys of an object in document order.  A repeated key
+       is listed once, where it first appears, as in the dict loads()
+       builds. */
+    PyObject *keys = NULL;
+    PyObject *seen = NULL;
+    Py_ssize_t k;
+    Py_ssize_t end = s->tape[s->node].next;
+    keys = PyList_New(0);
+    if (keys == NULL)
+        goto bail;
+    seen = PyDict_New();
+    if (seen == NULL)
+        goto bail;
+    for (k = s->node + 1; k < end; k = s->tape[k + 1].next) {
+        Py_ssize_t size = PyDict_Size(seen);
+        PyObject *key = lazy_load(s, k);
+        if (key == NULL)
+            goto bail;
+        if (PyDict_SetItem(seen, key, Py_None) ||
+                (PyDict_Size(seen) != size && PyList_Append(keys, key))) {
+            Py_DECREF(key);
+            goto bail;
         }
+        Py_DECREF(key);
     }
-    else {
-        /* parse as an int using a fast path if available, otherwise call user defined method */
-        if (s->parse_int != (PyObject *)&PyInt_Type) {
-            rval = PyObject_CallFunctionObjArgs(s->parse_int, numstr, NULL);
+    Py_DECREF(seen);
+    return keys;
+bail:
+    Py_XDECREF(keys);
+    Py_XDECREF(seen);
+    return NULL;
+}
+
+static Py_ssize_t
+lazy_count(PyLazyDocumentObject *s)
+{
+    /* Number of elements of an array or distinct keys of an object,
+       cached after the first walk.  -1 on error. */
+    if (s->count < 0) {
+        if (lazy_kind(s) == '{') {
+            PyObject *keys = lazy_key_list(s);
+            if (keys == NULL)
+                return -1;
+            s->count = PyList_GET_SIZE(keys);
+            Py_DECREF(keys);
         }
         else {
-            rval = PyInt_FromString(PyString_AS_STRING(numstr), NULL, 10);
+            Py_ssize_t child = s->node + 1;
+            Py_ssize_t end = s->tape[s->node].next;
+            Py_ssize_t count = 0;
+            while (child < end) {
+                child = s->tape[child].next;
+                count++;
+            }
+            s->count = count;
         }
     }
-    Py_DECREF(numstr);
-    return _build_rval_index_tuple(rval, idx);
+    return s->count;
 }
 
-static PyObject *
-_match_number_unicode(PyScannerObject *s, PyObject *pystr, Py_ssize_t start) {
-    Py_UNICODE *str = PyUnicode_AS_UNICODE(pystr);
-    Py_ssize_t end_idx = PyUnicode_GET_SIZE(pystr) - 1;
-    Py_ssize_t idx = start;
-    int is_float = 0;
-    PyObject *rval;
-    PyObject *numstr;
-
-    /* read a sign if it's there, make sure it's not the end of the string */
-    if (str[idx] == '-') {
-        idx++;
-        if (idx > end_idx) {
-            PyErr_SetNone(PyExc_StopIteration);
-            return NULL;
-        }
-    }
-
-    /* read as many integer digits as we find as long as it doesn't start with 0 */
-    if (str[idx] >= '1' && str[idx] <= '9') {
-        idx++;
-        while (idx <= end_idx && str[idx] >= '0' && str[idx] <= '9') idx++;
-    }
-    /* if it starts with 0 we only expect one integer digit */
-    else if (str[idx] == '0') {
-        idx++;
+static Py_ssize_t
+lazy_array_child(PyLazyDocumentObject *s, Py_ssize_t i)
+{
+    /* Tape index of element i, or -1.  Walks on from the last element
+       found so reading an array in order is linear. */
+    Py_ssize_t j = 0;
+    Py_ssize_t child = s->node + 1;
+    Py_ssize_t end = s->tape[s->node].next;
+    if (s->cache_index >= 0 && s->cache_index <= i) {
+        j = s->cache_index;
+        child = s->cache_child;
     }
-    /* no integer digits, error */
-    else {
-        PyErr_SetNone(PyExc_StopIteration);
-        return NULL;
+    while (child < end && j < i) {
+        child = s->tape[child].next;
+        j++;
     }
+    if (child >= end)
+        return -1;
+    s->cache_index = i;
+    s->cache_child = child;
+    return child;
+}
 
-    /* if the next char is '.' followed by a digit then read all float digits */
-    if (idx < end_idx && str[idx] == '.' && str[idx + 1] >= '0' && str[idx + 1] <= '9') {
-        is_float = 1;
-        idx += 2;
-        while (idx < end_idx && str[idx] >= '0' && str[idx] <= '9') idx++;
+static int
+lazy_has_backslash(PyLazyDocumentObject *s, Py_ssize_t start, Py_ssize_t end)
+{
+    Py_ssize_t i;
+    if (s->ustr == NULL)
+        return memchr(s->cstr + start, '\\', end - start) != NULL;
+    for (i = start; i < end; i++) {
+        if (s->ustr[i] == '\\')
+            return 1;
     }
+    return 0;
+}
 
-    /* if the next char is 'e' or 'E' then maybe read the exponent (or backtrack) */
-    if (idx < end_idx && (str[idx] == 'e' || str[idx] == 'E')) {
-        Py_ssize_t e_start = idx;
-        idx++;
-
-        /* read an exponent sign if present */
-        if (idx < end_idx && (str[idx] == '-' || str[idx] == '+')) idx++;
-
-        /* read all digits */
-        while (idx <= end_idx && str[idx] >= '0' && str[idx] <= '9') idx++;
-
-        /* if we got a digit, then parse as float. if not, backtrack */
-        if (str[idx - 1] >= '0' && str[idx - 1] <= '9') {
-            is_float = 1;
+static Py_ssize_t
+lazy_find(PyLazyDocumentObject *s, PyObject *key)
+{
+    /* Tape index of the value for key in an object, the last one if the
+       key repeats.  Returns -1 if it is missing and -2 on error.  Keys
+       without escapes are compared to key in the document's own
+       representation, the rest are decoded and compared. */
+    PyScannerObject *scanner = (PyScannerObject *)s->scanner;
+    PyObject *raw = NULL;
+    Py_ssize_t found = -1;
+    Py_ssize_t k;
+    Py_ssize_t end = s->tape[s->node].next;
+    if (!PyString_Check(key) && !PyUnicode_Check(key))
+        return -1;
+    if (PyString_Check(key)) {
+        /* Only ASCII str keys compare equal to the decoded unicode */
+        const char *p = PyString_AS_STRING(key);
+        Py_ssize_t i;
+        for (i = 0; i < PyString_GET_SIZE(key); i++) {
+            if ((unsigned char)p[i] > 0x7f)
+                break;
+        }
+        if (i == PyString_GET_SIZE(key)) {
+            if (s->ustr != NULL) {
+                raw = PyUnicode_FromObject(key);
+            }
+            else {
+                Py_INCREF(key);
+                raw = key;
+            }
+            if (raw == NULL)
+                return -2;
+        }
+    }
+    else if (s->ustr != NULL) {
+        Py_INCREF(key);
+        raw = key;
+    }
+    else if (strcmp(PyString_AS_STRING(scanner->encoding), DEFAULT_ENCODING) == 0) {
+        raw = PyUnicode_AsUTF8String(key);
+        if (raw == NULL)
+            return -2;
+    }
+    for (k = s->node + 1; k < end; k = s->tape[k + 1].next) {
+        Py_ssize_t start = s->tape[k].start + 1;
+        Py_ssize_t stop = s->tape[k].end - 1;
+        int match;
+        if (raw != NULL && !lazy_has_backslash(s, start, stop)) {
+            if (s->ustr != NULL) {
+                match = (PyUnicode_GET_SIZE(raw) == stop - start &&
+                    memcmp(PyUnicode_AS_UNICODE(raw), s->ustr + start, (stop - start) * sizeof(Py_UNICODE)) == 0);
+            }
+            else {
+                match = (PyString_GET_SIZE(raw) == stop - start &&
+                    memcmp(PyString_AS_STRING(raw), s->cstr + start, stop - start) == 0);
+            }
         }
         else {
-            idx = e_start;
+            PyObject *decoded = lazy_load(s, k);
+            if (decoded == NULL)
+                goto bail;
+            match = PyObject_RichCompareBool(decoded, key, Py_EQ);
+            Py_DECREF(decoded);
+            if (match < 0)
+                goto bail;
         }
+        if (match)
+            found = k + 1;
     }
+    Py_XDECREF(raw);
+    return found;
+bail:
+    Py_XDECREF(raw);
+    return -2;
+}
 
-    /* copy the section we determined to be a number */
-    numstr = PyUnicode_FromUnicode(&str[start], idx - start);
-    if (numstr == NULL)
-        return NULL;
-    if (is_float) {
-        /* parse as a float using a fast path if available, otherwise call user defined method */
-        if (s->parse_float != (PyObject *)&PyFloat_Type) {
-            rval = PyObject_CallFunctionObjArgs(s->parse_float, numstr, NULL);
+static Py_ssize_t
+lazy_length(PyObject *self)
+{
+    PyLazyDocumentObject *s = (PyLazyDocumentObject *)self;
+    if (lazy_check_kind(s, 0))
+        return -1;
+    return lazy_count(s);
+}
+
+static PyObject *
+lazy_subscript(PyObject *self, PyObject *key)
+{
+    PyLazyDocumentObject *s = (PyLazyDocumentObject *)self;
+    Py_UCS4 kind = lazy_kind(s);
+    Py_ssize_t child;
+    if (kind == '{') {
+        child = lazy_find(s, key);
+        if (child == -2)
+            return NULL;
+        if (child < 0) {
+            PyObject *tup = PyTuple_Pack(1, key);
+            if (tup != NULL) {
+                PyErr_SetObject(PyExc_KeyError, tup);
+                Py_DECREF(tup);
+            }
+            return NULL;
         }
-        else {
-            rval = PyFloat_FromString(numstr, NULL);
+    }
+    else if (kind == '[') {
+        Py_ssize_t i;
+        if (!PyIndex_Check(key)) {
+            PyErr_Format(PyExc_TypeError,
+                         "list indices must be integers, not %.200s",
+                         Py_TYPE(key)->tp_name);
+            return NULL;
+        }
+        i = PyNumber_AsSsize_t(key, PyExc_IndexError);
+        if (i == -1 && PyErr_Occurred())
+            return NULL;
+        if (i < 0)
+            i += lazy_count(s);
+        child = (i < 0) ? -1 : lazy_array_child(s, i);
+        if (child < 0) {
+            PyErr_SetString(PyExc_IndexError, "list index out of range");
+            return NULL;
         }
     }
     else {
-        /* no fast path for unicode -> int, just call */
-        rval = PyObject_CallFunctionObjArgs(s->parse_int, numstr, NULL);
+        lazy_check_kind(s, 0);
+        return NULL;
     }
-    Py_DECREF(numstr);
-    return _build_rval_index_tuple(rval, idx);
+    return lazy_child(s, child);
+}
+
+static int
+lazy_contains(PyObject *self, PyObject *key)
+{
+    PyLazyDocumentObject *s = (PyLazyDocumentObject *)self;
+    Py_ssize_t child;
+    if (lazy_check_kind(s, '{'))
+        return -1;
+    child = lazy_find(s, key);
+    if (child == -2)
+        return -1;
+    return child >= 0;
 }
 
+PyDoc_STRVAR(lazy_get_doc,
+    "get(key, default=None)\n"
+    "\n"
+    "The value for key if the object has it, else default."
+);
+
 static PyObject *
-scan_once_str(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx)
+lazy_get(PyObject *self, PyObject *args)
 {
-    char *str = PyString_AS_STRING(pystr);
-    Py_ssize_t length = PyString_GET_SIZE(pystr);
-    Py_ssize_t next_idx = -1;
-    PyObject *rval;
-    if (idx >= length) {
-        PyErr_SetNone(PyExc_StopIteration);
+    PyLazyDocumentObject *s = (PyLazyDocumentObject *)self;
+    PyObject *key;
+    PyObject *def = Py_None;
+    Py_ssize_t child;
+    if (!PyArg_ParseTuple(args, "O|O:get", &key, &def))
         return NULL;
+    if (lazy_check_kind(s, '{'))
+        return NULL;
+    child = lazy_find(s, key);
+    if (child == -2)
+        return NULL;
+    if (child < 0) {
+        Py_INCREF(def);
+        return def;
     }
-    switch (str[idx]) {
-        case '"':
-            /* string */
-            rval = scanstring_str(pystr, idx + 1,
-                PyString_AS_STRING(s->encoding),
-                PyObject_IsTrue(s->strict),
-                &next_idx);
-            return _build_rval_index_tuple(rval, next_idx);
-        case '{':
-            /* object */
-            return _parse_object_str(s, pystr, idx + 1);
-        case '[':
-            /* array */
-            return _parse_array_str(s, pystr, idx + 1);
-        case 'n':
-            /* null */
-            if ((idx + 3 < length) && str[idx + 1] == 'u' && str[idx + 2] == 'l' && str[idx + 3] == 'l') {
-                Py_INCREF(Py_None);
-                return _build_rval_index_tuple(Py_None, idx + 4);
-            }
-            break;
-        case 't':
-            /* true */
-            if ((idx + 3 < length) && str[idx + 1] == 'r' && str[idx + 2] == 'u' && str[idx + 3] == 'e') {
-                Py_INCREF(Py_True);
-                return _build_rval_index_tuple(Py_True, idx + 4);
-            }
-            break;
-        case 'f':
-            /* false */
-            if ((idx + 4 < length) && str[idx + 1] == 'a' && str[idx + 2] == 'l' && str[idx + 3] == 's' && str[idx + 4] == 'e') {
-                Py_INCREF(Py_False);
-                return _build_rval_index_tuple(Py_False, idx + 5);
-            }
-            break;
-        case 'N':
-            /* NaN */
-            if ((idx + 2 < length) && str[idx + 1] == 'a' && str[idx + 2] == 'N') {
-                return _parse_constant(s, "NaN", idx);
-            }
-            break;
-        case 'I':
-            /* Infinity */
-            if ((idx + 7 < length) && str[idx + 1] == 'n' && str[idx + 2] == 'f' && str[idx + 3] == 'i' && str[idx + 4] == 'n' && str[idx + 5] == 'i' && str[idx + 6] == 't' && str[idx + 7] == 'y') {
-                return _parse_constant(s, "Infinity", idx);
-            }
-            break;
-        case '-':
-            /* -Infinity */
-            if ((idx + 8 < length) && str[idx + 1] == 'I' && str[idx + 2] == 'n' && str[idx + 3] == 'f' && str[idx + 4] == 'i' && str[idx + 5] == 'n' && str[idx + 6] == 'i' && str[idx + 7] == 't' && str[idx + 8] == 'y') {
-                return _parse_constant(s, "-Infinity", idx);
-            }
-            break;
-    }
-    /* Didn't find a string, object, array, or named constant. Look for a number. */
-    return _match_number_str(s, pystr, idx);
+    return lazy_child(s, child);
 }
 
+PyDoc_STRVAR(lazy_keys_doc,
+    "keys() -> list\n"
+    "\n"
+    "The keys of the object in document order, each listed once."
+);
+
 static PyObject *
-scan_once_unicode(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx)
+lazy_keys(PyObject *self, PyObject *args UNUSED)
 {
-    Py_UNICODE *str = PyUnicode_AS_UNICODE(pystr);
-    Py_ssize_t length = PyUnicode_GET_SIZE(pystr);
-    Py_ssize_t next_idx = -1;
-    PyObject *rval;
-    if (idx >= length) {
-        PyErr_SetNone(PyExc_StopIteration);
+    PyLazyDocumentObject *s = (PyLazyDocumentObject *)self;
+    if (lazy_check_kind(s, '{'))
         return NULL;
+    return lazy_key_list(s);
+}
+
+PyDoc_STRVAR(lazy_load_doc,
+    "load() -> object\n"
+    "\n"
+    "Decode this value completely, as loads() would."
+);
+
+static PyObject *
+lazy_load_method(PyObject *self, PyObject *args UNUSED)
+{
+    PyLazyDocumentObject *s = (PyLazyDocumentObject *)self;
+    return lazy_load(s, s->node);
+}
+
+static PyMethodDef lazy_document_methods[] = {
+    {"get", (PyCFunction)lazy_get, METH_VARARGS, lazy_get_doc},
+    {"keys", (PyCFunction)lazy_keys, METH_NOARGS, lazy_keys_doc},
+    {"load", (PyCFunction)lazy_load_method, METH_NOARGS, lazy_load_doc},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyMappingMethods lazy_document_as_mapping = {
+    lazy_length,          /* mp_length */
+    lazy_subscript,       /* mp_subscript */
+    0,                    /* mp_ass_subscript */
+};
+
+static PySequenceMethods lazy_document_as_sequence = {
+    0,                    /* sq_length */
+    0,                    /* sq_concat */
+    0,                    /* sq_repeat */
+    0,                    /* sq_item */
+    0,                    /* sq_slice */
+    0,                    /* sq_ass_item */
+    0,                    /* sq_ass_slice */
+    lazy_contains,        /* sq_contains */
+};
+
+static int
+lazy_document_init(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"context", "s", NULL};
+    PyLazyDocumentObject *s = (PyLazyDocumentObject *)self;
+    PyObject *ctx;
+    PyObject *pystr;
+
+    assert(PyLazyDocument_Check(self));
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO:make_lazy_document", kwlist, &ctx, &pystr))
+        return -1;
+    if (s->pystr != NULL) {
+        PyErr_SetString(PyExc_TypeError, "lazy document is already initialized");
+        return -1;
     }
-    switch (str[idx]) {
-        case '"':
-            /* string */
-            rval = scanstring_unicode(pystr, idx + 1,
-                PyObject_IsTrue(s->strict),
-                &next_idx);
-            return _build_rval_index_tuple(rval, next_idx);
-        case '{':
-            /* object */
-            return _parse_object_unicode(s, pystr, idx + 1);
-        case '[':
-            /* array */
-            return _parse_array_unicode(s, pystr, idx + 1);
-        case 'n':
-            /* null */
-            if ((idx + 3 < length) && str[idx + 1] == 'u' && str[idx + 2] == 'l' && str[idx + 3] == 'l') {
-                Py_INCREF(Py_None);
-                return _build_rval_index_tuple(Py_None, idx + 4);
-            }
-            break;
-        case 't':
-            /* true */
-            if ((idx + 3 < length) && str[idx + 1] == 'r' && str[idx + 2] == 'u' && str[idx + 3] == 'e') {
-                Py_INCREF(Py_True);
-                return _build_rval_index_tuple(Py_True, idx + 4);
-            }
-            break;
-        case 'f':
-            /* false */
-            if ((idx + 4 < length) && str[idx + 1] == 'a' && str[idx + 2] == 'l' && str[idx + 3] == 's' && str[idx + 4] == 'e') {
-                Py_INCREF(Py_False);
-                return _build_rval_index_tuple(Py_False, idx + 5);
-            }
-            break;
-        case 'N':
-            /* NaN */
-            if ((idx + 2 < length) && str[idx + 1] == 'a' && str[idx + 2] == 'N') {
-                return _parse_constant(s, "NaN", idx);
-            }
-            break;
-        case 'I':
-            /* Infinity */
-            if ((idx + 7 < length) && str[idx + 1] == 'n' && str[idx + 2] == 'f' && str[idx + 3] == 'i' && str[idx + 4] == 'n' && str[idx + 5] == 'i' && str[idx + 6] == 't' && str[idx + 7] == 'y') {
-                return _parse_constant(s, "Infinity", idx);
-            }
-            break;
-        case '-':
-            /* -Infinity */
-            if ((idx + 8 < length) && str[idx + 1] == 'I' && str[idx + 2] == 'n' && str[idx + 3] == 'f' && str[idx + 4] == 'i' && str[idx + 5] == 'n' && str[idx + 6] == 'i' && str[idx + 7] == 't' && str[idx + 8] == 'y') {
-                return _parse_constant(s, "-Infinity", idx);
-            }
-            break;
+    if (!PyString_Check(pystr) && !PyUnicode_Check(pystr)) {
+        PyErr_Format(PyExc_TypeError,
+                     "s must be a string, not %.80s",
+                     Py_TYPE(pystr)->tp_name);
+        return -1;
+    }
+    /* Accept a scanner or anything make_scanner accepts as a context */
+    if (PyScanner_Check(ctx)) {
+        Py_INCREF(ctx);
+        s->scanner = ctx;
+    }
+    else {
+        s->scanner = PyObject_CallFunctionObjArgs((PyObject *)&PyScannerType, ctx, NULL);
+        if (s->scanner == NULL)
+            return -1;
+    }
+    Py_INCREF(pystr);
+    s->pystr = pystr;
+    if (PyUnicode_Check(pystr)) {
+        s->ustr = PyUnicode_AS_UNICODE(pystr);
+        s->len = PyUnicode_GET_SIZE(pystr);
     }
-    /* Didn't find a string, object, array, or named constant. Look for a number. */
-    return _match_number_unicode(s, pystr, idx);
+    else {
+        s->cstr = PyString_AS_STRING(pystr);
+        s->len = PyString_GET_SIZE(pystr);
+    }
+    s->node = 0;
+    s->count = -1;
+    s->cache_index = -1;
+    s->cache_child = -1;
+    STATS_ADD(bytes_scanned, s->len);
+    return lazy_build_tape(s);
 }
 
-static PyObject *
-scanner_call(PyObject *self, PyObject *args, PyObject *kwds)
+static void
+lazy_document_dealloc(PyObject *self)
+{
+    PyLazyDocumentObject *s = (PyLazyDocumentObject *)self;
+    if (s->root == NULL)
+        PyMem_Free(s->tape);
+    s->tape = NULL;
+    Py_CLEAR(s->root);
+    Py_CLEAR(s->pystr);
+    Py_CLEAR(s->scanner);
+    self->ob_type->tp_free(self);
+}
+
+PyDoc_STRVAR(lazy_document_doc,
+    "make_lazy_document(context, s)\n"
+    "\n"
+    "JSON document that is decoded on demand.  s is indexed once, then\n"
+    "reading a key or index builds only that value; objects and arrays\n"
+    "are returned as further lazy documents.  load() decodes the value\n"
+    "completely."
+);
+
+static
+PyTypeObject PyLazyDocumentType = {
+    PyObject_HEAD_INIT(0)
+    0,                    /* tp_internal */
+    "make_lazy_document", /* tp_name */
+    sizeof(PyLazyDocumentObject), /* tp_basicsize */
+    0,                    /* tp_itemsize */
+    lazy_document_dealloc, /* tp_dealloc */
+    0,                    /* tp_print */
+    0,                    /* tp_getattr */
+    0,                    /* tp_setattr */
+    0,                    /* tp_compare */
+    0,                    /* tp_repr */
+    0,                    /* tp_as_number */
+    &lazy_document_as_sequence, /* tp_as_sequence */
+    &lazy_document_as_mapping, /* tp_as_mapping */
+    0,                    /* tp_hash */
+    0,                    /* tp_call */
+    0,                    /* tp_str */
+    0,/* PyObject_GenericGetAttr, */                    /* tp_getattro */
+    0,/* PyObject_GenericSetAttr, */                    /* tp_setattro */
+    0,                    /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,   /* tp_flags */
+    lazy_document_doc,    /* tp_doc */
+    0,                    /* tp_traverse */
+    0,                    /* tp_clear */
+    0,                    /* tp_richcompare */
+    0,                    /* tp_weaklistoffset */
+    0,                    /* tp_iter */
+    0,                    /* tp_iternext */
+    lazy_document_methods, /* tp_methods */
+    0,                    /* tp_members */
+    0,                    /* tp_getset */
+    0,                    /* tp_base */
+    0,                    /* tp_dict */
+    0,                    /* tp_descr_get */
+    0,                    /* tp_descr_set */
+    0,                    /* tp_dictoffset */
+    lazy_document_init,   /* tp_init */
+    0,/* PyType_GenericAlloc, */        /* tp_alloc */
+    0,/* PyType_GenericNew, */          /* tp_new */
+    0,/* _PyObject_Del, */              /* tp_free */
+};
+
+#define JSON_LINES_CHUNK 65536
+
+static int
+line_reader_fill(PyLineReaderObject *s, Py_ssize_t len)
 {
+    /* Append the next chunk of the file to the unread rest of pystr,
+       reading at least as much as is left so a long record costs linear
+       time.  An empty read sets eof. */
+    Py_ssize_t rest = len - s->pos;
+    Py_ssize_t want = (rest > s->chunk_size) ? rest : s->chunk_size;
+    PyObject *chunk;
     PyObject *pystr;
-    Py_ssize_t idx;
-    static char *kwlist[] = {"string", "idx", NULL};
-    PyScannerObject *s = (PyScannerObject *)self;
-    assert(PyScanner_Check(self));
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO&:scan_once", kwlist, &pystr, _convertPyInt_AsSsize_t, &idx))
-        return NULL;
-    if (PyString_Check(pystr)) {
-        return scan_once_str(s, pystr, idx);
+    chunk = PyObject_CallFunction(s->read, "n", want);
+    if (chunk == NULL)
+        return -1;
+    if (!PyString_Check(chunk)) {
+        PyErr_Format(PyExc_TypeError,
+                     "read() must return a string, not %.80s",
+                     Py_TYPE(chunk)->tp_name);
+        Py_DECREF(chunk);
+        return -1;
     }
-    else if (PyUnicode_Check(pystr)) {
-        return scan_once_unicode(s, pystr, idx);
+    if (PyString_GET_SIZE(chunk) == 0) {
+        Py_DECREF(chunk);
+        s->eof = 1;
+        return 0;
+    }
+    if (rest == 0) {
+        pystr = chunk;
+    }
+    else {
+        pystr = PyString_FromStringAndSize(NULL, rest + PyString_GET_SIZE(chunk));
+        if (pystr == NULL) {
+            Py_DECREF(chunk);
+            return -1;
+        }
+        memcpy(PyString_AS_STRING(pystr), PyString_AS_STRING(s->pystr) + s->pos, rest);
+        memcpy(PyString_AS_STRING(pystr) + rest, PyString_AS_STRING(chunk), PyString_GET_SIZE(chunk));
+        Py_DECREF(chunk);
+    }
+    Py_DECREF(s->pystr);
+    s->pystr = pystr;
+    s->offset += s->pos;
+    s->pos = 0;
+    /* keys are shared within a chunk */
+    memo_clear((PyScannerObject *)s->scanner);
+    return 0;
+}
+
+static PyObject *
+line_reader_error(PyLineReaderObject *s, PyObject *pystr, Py_ssize_t start, Py_ssize_t end)
+{
+    /* Decode the record on its own, so a failure is reported the way
+       decode() would report it, then name the record's offset */
+    PyObject *line;
+    PyObject *val;
+    PyObject *type, *value, *tb;
+    PyObject *msg;
+    if (PyUnicode_Check(pystr)) {
+        line = PyUnicode_FromUnicode(PyUnicode_AS_UNICODE(pystr) + start, end - start);
     }
     else {
-        PyErr_Format(PyExc_TypeError,
-                 "first argument must be a string, not %.80s",
-                 Py_TYPE(pystr)->tp_name);
+        Py_ssize_t len;
+        char *buf = str_source(pystr, &len);
+        if (buf == NULL || end > len) {
+            /* a hook closed or resized it while the record was scanned */
+            PyErr_Clear();
+            PyErr_SetString(PyExc_ValueError, "source was closed or resized while being decoded");
+            return NULL;
+        }
+        line = PyString_FromStringAndSize(buf + start, end - start);
+    }
+    if (line == NULL)
         return NULL;
+    val = scanner_decode_one((PyScannerObject *)s->scanner, line);
+    Py_DECREF(line);
+    if (val != NULL || !PyErr_ExceptionMatches(PyExc_ValueError))
+        return val;
+    PyErr_Fetch(&type, &value, &tb);
+    msg = PyObject_Str(value);
+    if (msg != NULL) {
+        PyErr_Format(PyExc_ValueError, "%s (record at offset %" PY_FORMAT_SIZE_T "d)",
+                     PyString_AS_STRING(msg), s->offset + start);
+        Py_DECREF(msg);
+        Py_XDECREF(type);
+        Py_XDECREF(value);
+        Py_XDECREF(tb);
+    }
+    else {
+        PyErr_Restore(type, value, tb);
+    }
+    return NULL;
+}
+
+static PyObject *
+line_reader_next(PyObject *self)
+{
+    PyLineReaderObject *s = (PyLineReaderObject *)self;
+    PyScannerObject *scanner = (PyScannerObject *)s->scanner;
+    assert(PyLineReader_Check(self));
+    while (s->pystr != NULL) {
+        const char *cstr = NULL;
+        const Py_UNICODE *ustr = NULL;
+        Py_ssize_t len;
+        Py_ssize_t start = s->pos;
+        Py_ssize_t end;
+        Py_ssize_t idx;
+        Py_ssize_t next_idx = -1;
+        PyObject *val;
+        if (PyUnicode_Check(s->pystr)) {
+            ustr = PyUnicode_AS_UNICODE(s->pystr);
+            len = PyUnicode_GET_SIZE(s->pystr);
+        }
+        else {
+            cstr = str_source(s->pystr, &len);
+            if (cstr == NULL)
+                return NULL;
+        }
+        if (start >= len && s->eof) {
+            /* exhausted */
+            Py_CLEAR(s->pystr);
+            memo_clear(scanner);
+            break;
+        }
+        /* find the end of the record's line */
+        end = len;
+        if (start < len) {
+            if (ustr != NULL) {
+                for (end = start; end < len && ustr[end] != '\n'; end++);
+            }
+            else {
+                const char *nl = memchr(cstr + start, '\n', len - start);
+                if (nl != NULL)
+                    end = nl - cstr;
+            }
+        }
+        if (end == len && !s->eof) {
+            if (line_reader_fill(s, len))
+                return NULL;
+            continue;
+        }
+        s->pos = end + 1;
+        if (ustr != NULL) {
+            for (idx = start; idx < end && IS_WHITESPACE(ustr[idx]); idx++);
+        }
+        else {
+            for (idx = start; idx < end && IS_WHITESPACE(cstr[idx]); idx++);
+        }
+        if (idx == end) {
+            /* blank line */
+            continue;
+        }
+        if (ustr != NULL) {
+            val = scan_once_unicode(scanner, s->pystr, idx, &next_idx);
+        }
+        else if (PyString_Check(s->pystr)) {
+            val = scan_once_str(scanner, s->pystr, idx, &next_idx);
+        }
+        else {
+            val = scan_once_buffer(scanner, s->pystr, idx, &next_idx);
+        }
+        if (val != NULL) {
+            /* nothing but whitespace may follow on the same line */
+            idx = next_idx;
+            if (ustr != NULL) {
+                for (; idx < end && IS_WHITESPACE(ustr[idx]); idx++);
+            }
+            else if (idx <= end) {
+                cstr = str_source(s->pystr, &len);
+                if (cstr == NULL) {
+                    Py_DECREF(val);
+                    return NULL;
+                }
+                for (; idx < end && IS_WHITESPACE(cstr[idx]); idx++);
+            }
+            if (idx != end) {
+                Py_CLEAR(val);
+            }
+        }
+        else if (PyErr_ExceptionMatches(PyExc_StopIteration) ||
+                 PyErr_ExceptionMatches(PyExc_ValueError)) {
+            PyErr_Clear();
+        }
+        else {
+            return NULL;
+        }
+        if (val == NULL) {
+            val = line_reader_error(s, s->pystr, start, end);
+            if (val == NULL)
+                return NULL;
+        }
+        STATS_ADD(bytes_scanned, end - start);
+        if (s->offsets)
+            return Py_BuildValue("(nN)", s->offset + start, val);
+        return val;
     }
+    return NULL;
 }
 
 static int
-scanner_init(PyObject *self, PyObject *args, PyObject *kwds)
+line_reader_init(PyObject *self, PyObject *args, PyObject *kwds)
 {
+    static char *kwlist[] = {"context", "source", "offsets", "chunk_size", NULL};
+    PyLineReaderObject *s = (PyLineReaderObject *)self;
     PyObject *ctx;
-    static char *kwlist[] = {"context", NULL};
-
-    assert(PyScanner_Check(self));
-    PyScannerObject *s = (PyScannerObject *)self;
+    PyObject *source;
+    PyObject *scanner;
+    int offsets = 0;
+    Py_ssize_t chunk_size = JSON_LINES_CHUNK;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O:make_scanner", kwlist, &ctx))
+    assert(PyLineReader_Check(self));
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO|in:make_line_reader", kwlist,
+        &ctx, &source, &offsets, &chunk_size))
+        return -1;
+    if (s->scanner != NULL) {
+        PyErr_SetString(PyExc_TypeError, "line reader is already initialized");
         return -1;
-
-    s->encoding = NULL;
-    s->strict = NULL;
-    s->object_hook = NULL;
-    s->parse_float = NULL;
-    s->parse_int = NULL;
-    s->parse_constant = NULL;
-
-    /* PyString_AS_STRING is used on encoding */
-    s->encoding = PyObject_GetAttrString(ctx, "encoding");
-    if (s->encoding == Py_None) {
-        Py_DECREF(Py_None);
-        s->encoding = PyString_InternFromString(DEFAULT_ENCODING);
     }
-    else if (PyUnicode_Check(s->encoding)) {
-        PyObject *tmp = PyUnicode_AsEncodedString(s->encoding, NULL, NULL);
-        Py_DECREF(s->encoding);
-        s->encoding = tmp;
+    if (chunk_size <= 0) {
+        PyErr_SetString(PyExc_ValueError, "chunk_size must be positive");
+        return -1;
     }
-    if (s->encoding == NULL || !PyString_Check(s->encoding))
-        goto bail;
-    
-    /* All of these will fail "gracefully" so we don't need to verify them */
-    s->strict = PyObject_GetAttrString(ctx, "strict");
-    if (s->strict == NULL)
-        goto bail;
-    s->object_hook = PyObject_GetAttrString(ctx, "object_hook");
-    if (s->object_hook == NULL)
-        goto bail;
-    s->parse_float = PyObject_GetAttrString(ctx, "parse_float");
-    if (s->parse_float == NULL)
-        goto bail;
-    s->parse_int = PyObject_GetAttrString(ctx, "parse_int");
-    if (s->parse_int == NULL)
-        goto bail;
-    s->parse_constant = PyObject_GetAttrString(ctx, "parse_constant");
-    if (s->parse_constant == NULL)
-        goto bail;
-    
+    /* Accept a scanner or anything make_scanner accepts as a context */
+    if (PyScanner_Check(ctx)) {
+        Py_INCREF(ctx);
+        scanner = ctx;
+    }
+    else {
+        scanner = PyObject_CallFunctionObjArgs((PyObject *)&PyScannerType, ctx, NULL);
+        if (scanner == NULL)
+            return -1;
+    }
+    if (PyString_Check(source) || PyUnicode_Check(source) || PyObject_CheckReadBuffer(source)) {
+        Py_INCREF(source);
+        s->pystr = source;
+        s->eof = 1;
+    }
+    else {
+        s->read = PyObject_GetAttrString(source, "read");
+        if (s->read == NULL) {
+            Py_DECREF(scanner);
+            PyErr_Format(PyExc_TypeError,
+                         "source must be a string, buffer or file, not %.80s",
+                         Py_TYPE(source)->tp_name);
+            return -1;
+        }
+        s->pystr = PyString_FromStringAndSize(NULL, 0);
+        if (s->pystr == NULL) {
+            Py_DECREF(scanner);
+            return -1;
+        }
+        s->eof = 0;
+    }
+    s->scanner = scanner;
+    s->pos = 0;
+    s->offset = 0;
+    s->chunk_size = chunk_size;
+    s->offsets = offsets;
     return 0;
+}
 
-bail:
-    Py_XDECREF(s->encoding);
-    Py_XDECREF(s->strict);
-    Py_XDECREF(s->object_hook);
-    Py_XDECREF(s->parse_float);
-    Py_XDECREF(s->parse_int);
-    Py_XDECREF(s->parse_constant);
-    s->encoding = NULL;
-    s->strict = NULL;
-    s->object_hook = NULL;
-    s->parse_float = NULL;
-    s->parse_int = NULL;
-    s->parse_constant = NULL;
-    return -1;
+static void
+line_reader_dealloc(PyObject *self)
+{
+    PyLineReaderObject *s = (PyLineReaderObject *)self;
+    if (s->scanner != NULL)
+        memo_clear((PyScannerObject *)s->scanner);
+    Py_CLEAR(s->scanner);
+    Py_CLEAR(s->read);
+    Py_CLEAR(s->pystr);
+    self->ob_type->tp_free(self);
 }
 
-PyDoc_STRVAR(scanner_doc, "JSON scanner object");
+PyDoc_STRVAR(line_reader_doc,
+    "make_line_reader(context, source, offsets=False, chunk_size=65536)\n"
+    "\n"
+    "Iterator over newline-delimited JSON, yielding the value on each\n"
+    "non-blank line.  source is a string or buffer, which is scanned in\n"
+    "place, or a file that is read chunk_size bytes at a time.  With\n"
+    "offsets set, (offset, value) pairs are yielded, where offset is\n"
+    "where the record's line starts in the source.  A record that fails\n"
+    "to decode raises ValueError and iteration can go on with the next."
+);
 
 static
-PyTypeObject PyScannerType = {
+PyTypeObject PyLineReaderType = {
     PyObject_HEAD_INIT(0)
     0,                    /* tp_internal */
-    "make_scanner",       /* tp_name */
-    sizeof(PyScannerObject), /* tp_basicsize */
+    "make_line_reader",   /* tp_name */
+    sizeof(PyLineReaderObject), /* tp_basicsize */
     0,                    /* tp_itemsize */
-    scanner_dealloc, /* tp_dealloc */
+    line_reader_dealloc,  /* tp_dealloc */
     0,                    /* tp_print */
     0,                    /* tp_getattr */
     0,                    /* tp_setattr */
@@ -1553,28 +5747,28 @@ PyTypeObject PyScannerType = {
     0,                    /* tp_as_sequence */
     0,                    /* tp_as_mapping */
     0,                    /* tp_hash */
-    scanner_call,         /* tp_call */
+    0,                    /* tp_call */
     0,                    /* tp_str */
     0,/* PyObject_GenericGetAttr, */                    /* tp_getattro */
     0,/* PyObject_GenericSetAttr, */                    /* tp_setattro */
     0,                    /* tp_as_buffer */
     Py_TPFLAGS_DEFAULT,   /* tp_flags */
-    scanner_doc,          /* tp_doc */
+    line_reader_doc,      /* tp_doc */
     0,                    /* tp_traverse */
     0,                    /* tp_clear */
     0,                    /* tp_richcompare */
     0,                    /* tp_weaklistoffset */
-    0,                    /* tp_iter */
-    0,                    /* tp_iternext */
+    PyObject_SelfIter,    /* tp_iter */
+    line_reader_next,     /* tp_iternext */
     0,                    /* tp_methods */
-    scanner_members,                    /* tp_members */
+    line_reader_members,  /* tp_members */
     0,                    /* tp_getset */
     0,                    /* tp_base */
     0,                    /* tp_dict */
     0,                    /* tp_descr_get */
     0,                    /* tp_descr_set */
     0,                    /* tp_dictoffset */
-    scanner_init,                    /* tp_init */
+    line_reader_init,     /* tp_init */
     0,/* PyType_GenericAlloc, */        /* tp_alloc */
     0,/* PyType_GenericNew, */          /* tp_new */
     0,/* _PyObject_Del, */              /* tp_free */
@@ -1583,11 +5777,14 @@ PyTypeObject PyScannerType = {
 static int
 encoder_init(PyObject *self, PyObject *args, PyObject *kwds)
 {
-    static char *kwlist[] = {"markers", "default", "encoder", "indent", "key_separator", "item_separator", "sort_keys", "skipkeys", "allow_nan", NULL};
+    static char *kwlist[] = {"markers", "default", "encoder", "indent", "key_separator", "item_separator", "sort_keys", "skipkeys", "allow_nan", "markers_depth", "use_decimal", "use_datetime", "use_set", NULL};
 
     assert(PyEncoder_Check(self));
     PyEncoderObject *s = (PyEncoderObject *)self;
     PyObject *allow_nan;
+    PyObject *use_decimal = Py_False;
+    PyObject *use_datetime = Py_False;
+    PyObject *use_set = Py_False;
 
     s->markers = NULL;
     s->defaultfn = NULL;
@@ -1597,9 +5794,12 @@ encoder_init(PyObject *self, PyObject *args, PyObject *kwds)
     s->item_separator = NULL;
     s->sort_keys = NULL;
     s->skipkeys = NULL;
+    s->decimal_type = NULL;
+    s->markers_depth = JSON_MARKERS_DEPTH;
     
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOOOOOOOO:make_encoder", kwlist,
-        &s->markers, &s->defaultfn, &s->encoder, &s->indent, &s->key_separator, &s->item_separator, &s->sort_keys, &s->skipkeys, &allow_nan))
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOOOOOOOO|nOOO:make_encoder", kwlist,
+        &s->markers, &s->defaultfn, &s->encoder, &s->indent, &s->key_separator, &s->item_separator, &s->sort_keys, &s->skipkeys, &allow_nan, &s->markers_depth,
+        &use_decimal, &use_datetime, &use_set))
         return -1;
     
     Py_INCREF(s->markers);
@@ -1610,226 +5810,582 @@ encoder_init(PyObject *self, PyObject *args, PyObject *kwds)
     Py_INCREF(s->item_separator);
     Py_INCREF(s->sort_keys);
     Py_INCREF(s->skipkeys);
-    s->fast_encode = (PyCFunction_Check(s->encoder) && PyCFunction_GetFunction(s->encoder) == (PyCFunction)py_encode_basestring_ascii);
+    s->fast_encode = FAST_ENCODE_NONE;
+    if (PyCFunction_Check(s->encoder)) {
+        if (PyCFunction_GetFunction(s->encoder) == (PyCFunction)py_encode_basestring_ascii)
+            s->fast_encode = FAST_ENCODE_ASCII;
+        else if (PyCFunction_GetFunction(s->encoder) == (PyCFunction)py_encode_basestring)
+            s->fast_encode = FAST_ENCODE_UNICODE;
+    }
     s->allow_nan = PyObject_IsTrue(allow_nan);
+    s->sort_keys_flag = PyObject_IsTrue(s->sort_keys);
+    if (s->sort_keys_flag == -1)
+        return -1;
+    /* indent is None or a number of spaces per level, -1 means None */
+    s->indent_width = -1;
+    if (s->indent != Py_None) {
+        s->indent_width = PyInt_AsSsize_t(s->indent);
+        if (s->indent_width == -1 && PyErr_Occurred())
+            return -1;
+        if (s->indent_width < 0)
+            s->indent_width = 0;
+    }
+    /* the optional native encoders for types that would go to default */
+    s->use_datetime = PyObject_IsTrue(use_datetime);
+    s->use_set = PyObject_IsTrue(use_set);
+    if (s->use_datetime == -1 || s->use_set == -1)
+        return -1;
+    if (s->use_datetime && PyDateTimeAPI == NULL) {
+        PyDateTime_IMPORT;
+        if (PyDateTimeAPI == NULL)
+            return -1;
+    }
+    switch (PyObject_IsTrue(use_decimal)) {
+        case -1:
+            return -1;
+        case 1:
+            s->decimal_type = decimal_type();
+            if (s->decimal_type == NULL)
+                return -1;
+    }
     return 0;
 }
 
 static PyObject *
 encoder_call(PyObject *self, PyObject *args, PyObject *kwds)
 {
+    /* Encode obj into one string, returned as the only chunk of a tuple */
     static char *kwlist[] = {"obj", "_current_indent_level", NULL};
     PyObject *obj;
+    PyObject *encoded;
     PyObject *rval;
     Py_ssize_t indent_level;
+    JSON_Buffer buf;
+    JSON_Markers markers;
+    int rv;
     PyEncoderObject *s = (PyEncoderObject *)self;
     assert(PyEncoder_Check(self));
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO&:_iterencode", kwlist,
         &obj, _convertPyInt_AsSsize_t, &indent_level))
         return NULL;
-    rval = PyList_New(0);
-    if (rval == NULL)
-        return NULL;
-    if (encoder_listencode_obj(s, rval, obj, indent_level)) {
-        Py_DECREF(rval);
+    buffer_init(&buf);
+    markers_init(&markers);
+    rv = encoder_listencode_obj(s, &buf, (s->markers == Py_None) ? NULL : &markers, obj, indent_level);
+    markers_free(&markers);
+    if (rv) {
+        buffer_free(&buf);
         return NULL;
     }
+    STATS_ADD(bytes_encoded, buf.len);
+    encoded = buffer_finish(&buf);
+    if (encoded == NULL)
+        return NULL;
+    rval = PyTuple_Pack(1, encoded);
+    Py_DECREF(encoded);
     return rval;
 }
 
+PyDoc_STRVAR(encoder_dump_doc,
+    "dump(obj, fp, _current_indent_level=0)\n"
+    "\n"
+    "Encode obj straight to fp, an integer file descriptor or an object\n"
+    "with a write method.  Output is collected in a fixed size buffer and\n"
+    "written out each time it fills."
+);
+
 static PyObject *
+encoder_dump(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    /* Like encoder_call, but the buffer drains to fp as it fills */
+    static char *kwlist[] = {"obj", "fp", "_current_indent_level", NULL};
+    PyObject *obj;
+    PyObject *fp;
+    Py_ssize_t indent_level = 0;
+    JSON_Buffer buf;
+    JSON_Markers markers;
+    int rv;
+    PyEncoderObject *s = (PyEncoderObject *)self;
+    assert(PyEncoder_Check(self));
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO|O&:dump", kwlist,
+        &obj, &fp, _convertPyInt_AsSsize_t, &indent_level))
+        return NULL;
+    buffer_init(&buf);
+    buf.flush_size = JSON_BUFFER_FLUSH;
+    if (PyInt_Check(fp) || PyLong_Check(fp)) {
+        long fd = PyInt_AsLong(fp);
+        if (fd == -1 && PyErr_Occurred())
+            return NULL;
+        if (fd < 0 || fd > INT_MAX) {
+            PyErr_SetString(PyExc_ValueError, "file descriptor must be a non-negative int");
+            return NULL;
+        }
+        buf.fd = (int)fd;
+    }
+    else {
+        buf.write = PyObject_GetAttrString(fp, "write");
+        if (buf.write == NULL)
+            return NULL;
+    }
+    markers_init(&markers);
+    rv = encoder_listencode_obj(s, &buf, (s->markers == Py_None) ? NULL : &markers, obj, indent_level);
+    markers_free(&markers);
+    if (rv == 0)
+        rv = buffer_flush(&buf);
+    Py_XDECREF(buf.write);
+    buffer_free(&buf);
+    if (rv)
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef encoder_methods[] = {
+    {"dump", (PyCFunction)encoder_dump, METH_VARARGS | METH_KEYWORDS, encoder_dump_doc},
+    {NULL, NULL, 0, NULL}
+};
+
+static const char *
 _encoded_const(PyObject *obj)
 {
     if (obj == Py_None) {
-        static PyObject *s_null = NULL;
-        if (s_null == NULL) {
-            s_null = PyString_InternFromString("null");
-        }
-        return s_null;
+        return "null";
     }
     else if (obj == Py_True) {
-        static PyObject *s_true = NULL;
-        if (s_true == NULL) {
-            s_true = PyString_InternFromString("true");
-        }
-        return s_true;
+        return "true";
     }
     else if (obj == Py_False) {
-        static PyObject *s_false = NULL;
-        if (s_false == NULL) {
-            s_false = PyString_InternFromString("false");
+        return "false";
+    }
+    else {
+        PyErr_SetString(PyExc_ValueError, "not a const");
+        return NULL;
+    }
+}
+
+static PyObject *
+encoder_encode_float(PyEncoderObject *s, PyObject *obj)
+{
+    double i = PyFloat_AS_DOUBLE(obj);
+    if (!Py_IS_FINITE(i)) {
+        if (!s->allow_nan) {
+            PyErr_SetString(PyExc_ValueError, "Out of range float values are not JSON compliant");
+            return NULL;
+        }
+        if (i > 0) {
+            return PyString_FromString("Infinity");
         }
-        return s_false;
+        else if (i < 0) {
+            return PyString_FromString("-Infinity");
+        }
+        else {
+            return PyString_FromString("NaN");
+        }
+    }
+    /* Use a better float format here? */
+    STATS_INC(fallbacks);
+    return PyObject_Repr(obj);
+}
+
+static int
+encoder_write_string(PyEncoderObject *s, JSON_Buffer *rval, PyObject *obj)
+{
+    /* The builtin string encoders write straight into the buffer */
+    int rv;
+    PyObject *encoded;
+    if (s->fast_encode == FAST_ENCODE_ASCII) {
+        if (PyString_Check(obj))
+            return buffer_ascii_escape_str(rval, obj);
+        else
+            return buffer_ascii_escape_unicode(rval, obj);
+    }
+    else if (s->fast_encode == FAST_ENCODE_UNICODE) {
+        if (PyString_Check(obj))
+            return buffer_escape_str(rval, obj);
+        else
+            return buffer_escape_unicode(rval, obj);
+    }
+    STATS_INC(fallbacks);
+    encoded = PyObject_CallFunctionObjArgs(s->encoder, obj, NULL);
+    if (encoded == NULL)
+        return -1;
+    rv = buffer_append_obj(rval, encoded);
+    Py_DECREF(encoded);
+    return rv;
+}
+
+static int
+encoder_write_obj(JSON_Buffer *rval, PyObject *encoded)
+{
+    /* Append and release a freshly encoded chunk */
+    int rv;
+    if (encoded == NULL)
+        return -1;
+    rv = buffer_append_obj(rval, encoded);
+    Py_DECREF(encoded);
+    return rv;
+}
+
+static int
+encoder_write_newline_indent(PyEncoderObject *s, JSON_Buffer *rval, Py_ssize_t indent_level)
+{
+    /* '\n' + (' ' * (_indent * _current_indent_level)) */
+    Py_ssize_t spaces = s->indent_width * indent_level;
+    if (spaces < 0)
+        spaces = 0;
+    if (BUFFER_RESERVE(rval, 1 + spaces))
+        return -1;
+    rval->buf[rval->len++] = '\n';
+    memset(rval->buf + rval->len, ' ', spaces);
+    rval->len += spaces;
+    return 0;
+}
+
+static int
+encoder_write_item_separator(PyEncoderObject *s, JSON_Buffer *rval, Py_ssize_t indent_level)
+{
+    if (buffer_append_obj(rval, s->item_separator))
+        return -1;
+    if (s->indent_width >= 0)
+        return encoder_write_newline_indent(s, rval, indent_level);
+    return 0;
+}
+
+/*
+Native encoders for Decimal, date and datetime.  A Decimal of the exact
+type is laid out from its sign, digits and exponent the same way
+Decimal.__str__ does with the default context, and a date or naive
+datetime the way isoformat() does, so neither runs any Python code.
+Subclasses and aware datetimes fall back to their own methods.
+*/
+static PyObject *decimal_attr_is_special = NULL;
+static PyObject *decimal_attr_int = NULL;
+static PyObject *decimal_attr_exp = NULL;
+static PyObject *decimal_attr_sign = NULL;
+
+static PyObject *
+decimal_type(void)
+{
+    /* decimal.Decimal, imported on first use */
+    PyObject *mod;
+    PyObject *rval;
+    if (decimal_attr_sign == NULL) {
+        decimal_attr_is_special = PyString_InternFromString("_is_special");
+        decimal_attr_int = PyString_InternFromString("_int");
+        decimal_attr_exp = PyString_InternFromString("_exp");
+        decimal_attr_sign = PyString_InternFromString("_sign");
+        if (decimal_attr_is_special == NULL || decimal_attr_int == NULL ||
+                decimal_attr_exp == NULL || decimal_attr_sign == NULL) {
+            Py_CLEAR(decimal_attr_sign);
+            return NULL;
+        }
+    }
+    mod = PyImport_ImportModule("decimal");
+    if (mod == NULL)
+        return NULL;
+    rval = PyObject_GetAttrString(mod, "Decimal");
+    Py_DECREF(mod);
+    return rval;
+}
+
+static int
+encoder_decimal_special(PyEncoderObject *s, JSON_Buffer *rval, PyObject *obj)
+{
+    /* NaN, Infinity and -Infinity like the float encoder */
+    PyObject *res;
+    int is_nan;
+    int is_signed;
+    res = PyObject_CallMethod(obj, "is_nan", NULL);
+    if (res == NULL)
+        return -1;
+    is_nan = PyObject_IsTrue(res);
+    Py_DECREF(res);
+    res = PyObject_CallMethod(obj, "is_signed", NULL);
+    if (res == NULL)
+        return -1;
+    is_signed = PyObject_IsTrue(res);
+    Py_DECREF(res);
+    if (is_nan == -1 || is_signed == -1)
+        return -1;
+    if (!s->allow_nan) {
+        PyErr_SetString(PyExc_ValueError, "Out of range float values are not JSON compliant");
+        return -1;
+    }
+    if (is_nan)
+        return buffer_append(rval, "NaN", 3);
+    if (is_signed)
+        return buffer_append(rval, "-Infinity", 9);
+    return buffer_append(rval, "Infinity", 8);
+}
+
+static int
+encoder_write_decimal(PyEncoderObject *s, JSON_Buffer *rval, PyObject *obj)
+{
+    /* str(obj) for a finite Decimal, which is always a valid JSON number */
+    PyObject *special = NULL;
+    PyObject *digits = NULL;
+    PyObject *pyexp = NULL;
+    PyObject *pysign = NULL;
+    Py_ssize_t ndigits;
+    Py_ssize_t exp;
+    Py_ssize_t leftdigits;
+    Py_ssize_t dotplace;
+    long sign;
+    char *p;
+    char *d;
+    int rv = -1;
+    if (Py_TYPE(obj) != (PyTypeObject *)s->decimal_type)
+        goto fallback;
+    special = PyObject_GetAttr(obj, decimal_attr_is_special);
+    digits = PyObject_GetAttr(obj, decimal_attr_int);
+    pyexp = PyObject_GetAttr(obj, decimal_attr_exp);
+    pysign = PyObject_GetAttr(obj, decimal_attr_sign);
+    if (special == NULL || digits == NULL || pyexp == NULL || pysign == NULL ||
+            !PyString_Check(digits) || !PyInt_Check(pyexp) || !PyInt_Check(pysign)) {
+        /* specials have a string exponent */
+        PyErr_Clear();
+        goto fallback;
+    }
+    if (special != Py_False)
+        goto fallback;
+    d = PyString_AS_STRING(digits);
+    ndigits = PyString_GET_SIZE(digits);
+    exp = PyInt_AS_LONG(pyexp);
+    sign = PyInt_AS_LONG(pysign);
+    if (exp > PY_SSIZE_T_MAX / 2 || exp < -(PY_SSIZE_T_MAX / 2) || ndigits > PY_SSIZE_T_MAX / 4)
+        goto fallback;
+    leftdigits = exp + ndigits;
+    if (exp <= 0 && leftdigits > -6)
+        dotplace = leftdigits;
+    else
+        dotplace = 1;
+    /* sign, "0.", up to 6 zeros, the digits and an exponent */
+    if (BUFFER_RESERVE(rval, ndigits + 48))
+        goto bail;
+    p = rval->buf + rval->len;
+    if (sign)
+        *p++ = '-';
+    if (dotplace <= 0) {
+        *p++ = '0';
+        *p++ = '.';
+        memset(p, '0', -dotplace);
+        p += -dotplace;
+        memcpy(p, d, ndigits);
+        p += ndigits;
+    }
+    else {
+        /* exp <= 0 here unless dotplace is 1, so dotplace <= ndigits */
+        memcpy(p, d, dotplace);
+        p += dotplace;
+        if (dotplace < ndigits) {
+            *p++ = '.';
+            memcpy(p, d + dotplace, ndigits - dotplace);
+            p += ndigits - dotplace;
+        }
+    }
+    if (leftdigits != dotplace) {
+        p += PyOS_snprintf(p, 24, "E%+" PY_FORMAT_SIZE_T "d", leftdigits - dotplace);
     }
-    else {
-        PyErr_SetString(PyExc_ValueError, "not a const");
-        return NULL;
+    rval->len = p - rval->buf;
+    rv = 0;
+    goto bail;
+fallback:
+    STATS_INC(fallbacks);
+    {
+        PyObject *res = PyObject_CallMethod(obj, "is_finite", NULL);
+        int finite;
+        if (res == NULL)
+            goto bail;
+        finite = PyObject_IsTrue(res);
+        Py_DECREF(res);
+        if (finite == -1)
+            goto bail;
+        if (!finite)
+            rv = encoder_decimal_special(s, rval, obj);
+        else
+            rv = encoder_write_obj(rval, PyObject_Str(obj));
     }
+bail:
+    Py_XDECREF(special);
+    Py_XDECREF(digits);
+    Py_XDECREF(pyexp);
+    Py_XDECREF(pysign);
+    return rv;
 }
 
-static PyObject *
-encoder_encode_float(PyEncoderObject *s, PyObject *obj)
+static Py_ssize_t
+encoder_format_date(PyObject *obj, char *out, size_t size)
 {
-    double i = PyFloat_AS_DOUBLE(obj);
-    if (!Py_IS_FINITE(i)) {
-        if (!s->allow_nan) {
-            PyErr_SetString(PyExc_ValueError, "Out of range float values are not JSON compliant");
-            return NULL;
-        }
-        if (i > 0) {
-            return PyString_FromString("Infinity");
-        }
-        else if (i < 0) {
-            return PyString_FromString("-Infinity");
-        }
-        else {
-            return PyString_FromString("NaN");
-        }
+    /* obj.isoformat() for a date or naive datetime of the builtin types,
+       or -1 */
+    if (PyDateTime_CheckExact(obj)) {
+        int us = PyDateTime_DATE_GET_MICROSECOND(obj);
+        if (((_PyDateTime_BaseTZInfo *)obj)->hastzinfo)
+            return -1;
+        if (us)
+            return PyOS_snprintf(out, size, "%04d-%02d-%02dT%02d:%02d:%02d.%06d",
+                PyDateTime_GET_YEAR(obj), PyDateTime_GET_MONTH(obj), PyDateTime_GET_DAY(obj),
+                PyDateTime_DATE_GET_HOUR(obj), PyDateTime_DATE_GET_MINUTE(obj),
+                PyDateTime_DATE_GET_SECOND(obj), us);
+        return PyOS_snprintf(out, size, "%04d-%02d-%02dT%02d:%02d:%02d",
+            PyDateTime_GET_YEAR(obj), PyDateTime_GET_MONTH(obj), PyDateTime_GET_DAY(obj),
+            PyDateTime_DATE_GET_HOUR(obj), PyDateTime_DATE_GET_MINUTE(obj),
+            PyDateTime_DATE_GET_SECOND(obj));
     }
-    /* Use a better float format here? */
-    return PyObject_Repr(obj);
+    if (PyDate_CheckExact(obj))
+        return PyOS_snprintf(out, size, "%04d-%02d-%02d",
+            PyDateTime_GET_YEAR(obj), PyDateTime_GET_MONTH(obj), PyDateTime_GET_DAY(obj));
+    return -1;
 }
 
 static PyObject *
-encoder_encode_string(PyEncoderObject *s, PyObject *obj)
+encoder_date_str(PyObject *obj)
 {
-    if (s->fast_encode)
-        return py_encode_basestring_ascii(NULL, obj);
-    else
-        return PyObject_CallFunctionObjArgs(s->encoder, obj, NULL);
+    /* obj.isoformat() */
+    char iso[40];
+    Py_ssize_t n = encoder_format_date(obj, iso, sizeof(iso));
+    if (n >= 0)
+        return PyString_FromStringAndSize(iso, n);
+    STATS_INC(fallbacks);
+    return PyObject_CallMethod(obj, "isoformat", NULL);
 }
 
 static int
-encoder_listencode_obj(PyEncoderObject *s, PyObject *rval, PyObject *obj, Py_ssize_t indent_level)
+encoder_write_date(PyEncoderObject *s, JSON_Buffer *rval, PyObject *obj)
 {
-    if (obj == Py_None || obj == Py_True || obj == Py_False) {
-        PyObject *cstr = _encoded_const(obj);
-        if (cstr == NULL)
+    char iso[40];
+    Py_ssize_t n = encoder_format_date(obj, iso, sizeof(iso));
+    PyObject *isostr;
+    int rv;
+    if (n >= 0) {
+        /* all ASCII digits and punctuation, nothing to escape */
+        if (BUFFER_RESERVE(rval, n + 2))
             return -1;
-        return PyList_Append(rval, cstr);
+        rval->buf[rval->len++] = '"';
+        memcpy(rval->buf + rval->len, iso, n);
+        rval->len += n;
+        rval->buf[rval->len++] = '"';
+        return 0;
+    }
+    STATS_INC(fallbacks);
+    isostr = PyObject_CallMethod(obj, "isoformat", NULL);
+    if (isostr == NULL)
+        return -1;
+    if (!PyString_Check(isostr) && !PyUnicode_Check(isostr)) {
+        PyErr_SetString(PyExc_TypeError, "isoformat() did not return a string");
+        Py_DECREF(isostr);
+        return -1;
+    }
+    rv = encoder_write_string(s, rval, isostr);
+    Py_DECREF(isostr);
+    return rv;
+}
+
+static int
+encoder_listencode_obj(PyEncoderObject *s, JSON_Buffer *rval, JSON_Markers *markers, PyObject *obj, Py_ssize_t indent_level)
+{
+    if (obj == Py_None || obj == Py_True || obj == Py_False) {
+        const char *cstr = _encoded_const(obj);
+        return buffer_append(rval, cstr, strlen(cstr));
     }
     else if (PyString_Check(obj) || PyUnicode_Check(obj))
     {
-        PyObject *encoded = encoder_encode_string(s, obj);
-        if (encoded == NULL)
-            return -1;
-        return PyList_Append(rval, encoded);
+        return encoder_write_string(s, rval, obj);
+    }
+    else if (PyInt_CheckExact(obj)) {
+        return buffer_append_long(rval, PyInt_AS_LONG(obj));
     }
     else if (PyInt_Check(obj) || PyLong_Check(obj)) {
-        PyObject *encoded = PyObject_Str(obj);
-        if (encoded == NULL)
-            return -1;
-        return PyList_Append(rval, encoded);
+        return encoder_write_obj(rval, PyObject_Str(obj));
+    }
+    else if (PyFloat_CheckExact(obj) && float_shortest && Py_IS_FINITE(PyFloat_AS_DOUBLE(obj))) {
+        return buffer_append_double(rval, PyFloat_AS_DOUBLE(obj));
     }
     else if (PyFloat_Check(obj)) {
-        PyObject *encoded = encoder_encode_float(s, obj);
-        if (encoded == NULL)
-            return -1;
-        return PyList_Append(rval, encoded);
+        return encoder_write_obj(rval, encoder_encode_float(s, obj));
     }
     else if (PyList_Check(obj) || PyTuple_Check(obj)) {
-        return encoder_listencode_list(s, rval, obj, indent_level);
+        return encoder_listencode_list(s, rval, markers, obj, indent_level);
     }
     else if (PyDict_Check(obj)) {
-        return encoder_listencode_dict(s, rval, obj, indent_level);
+        return encoder_listencode_dict(s, rval, markers, obj, indent_level);
+    }
+    else if (s->decimal_type != NULL && PyObject_TypeCheck(obj, (PyTypeObject *)s->decimal_type)) {
+        return encoder_write_decimal(s, rval, obj);
+    }
+    else if (s->use_datetime && PyDate_Check(obj)) {
+        return encoder_write_date(s, rval, obj);
+    }
+    else if (s->use_set && PyAnySet_Check(obj)) {
+        return encoder_listencode_list(s, rval, markers, obj, indent_level);
     }
     else {
-        PyObject *ident = NULL;
-        if (s->markers != Py_None) {
-            ident = PyLong_FromVoidPtr(obj);
-            int has_key;
-            if (ident == NULL)
-                return -1;
-            has_key = PyDict_Contains(s->markers, ident);
-            if (has_key) {
-                if (has_key != -1)
-                    PyErr_SetString(PyExc_ValueError, "Circular reference detected");
-                Py_DECREF(ident);
-                return -1;
-            }
-            if (PyDict_SetItem(s->markers, ident, obj)) {
-                Py_DECREF(ident);
-                return -1;
-            }
-        }
-        PyObject *newobj = PyObject_CallFunctionObjArgs(s->defaultfn, obj, NULL);
+        PyObject *newobj;
+        int rv;
+        if (markers_push(s, markers, obj))
+            return -1;
+        STATS_INC(callbacks);
+        newobj = PyObject_CallFunctionObjArgs(s->defaultfn, obj, NULL);
         if (newobj == NULL) {
-            Py_DECREF(ident);
+            markers_pop(markers);
             return -1;
         }
-        int rv = encoder_listencode_obj(s, rval, newobj, indent_level);
+        rv = encoder_listencode_obj(s, rval, markers, newobj, indent_level);
         Py_DECREF(newobj);
-        if (rv) {
-            Py_DECREF(ident);
-            return -1;
-        }
-        if (ident != NULL) {
-            if (PyDict_DelItem(s->markers, ident)) {
-                Py_DECREF(ident);
-                ident = NULL;
-                return -1;
-            }
-            Py_DECREF(ident);
-            ident = NULL;
-        }
+        markers_pop(markers);
         return rv;
     }
 }
 
 static int
-encoder_listencode_dict(PyEncoderObject *s, PyObject *rval, PyObject *dct, Py_ssize_t indent_level)
+encoder_listencode_dict(PyEncoderObject *s, JSON_Buffer *rval, JSON_Markers *markers, PyObject *dct, Py_ssize_t indent_level)
 {
-    static PyObject *open_dict = NULL;
-    static PyObject *close_dict = NULL;
-    static PyObject *empty_dict = NULL;
     PyObject *kstr = NULL;
-    if (open_dict == NULL || close_dict == NULL || empty_dict == NULL) {
-        open_dict = PyString_InternFromString("{");
-        close_dict = PyString_InternFromString("}");
-        empty_dict = PyString_InternFromString("{}");
-        if (open_dict == NULL || close_dict == NULL || empty_dict == NULL)
-            return -1;
-    }
-    PyObject *ident = NULL;
+    PyObject *keys = NULL;
+    PyObject *key, *value;
+    Py_ssize_t pos;
+    int skipkeys;
+    Py_ssize_t idx;
     if (PyDict_Size(dct) == 0)
-        return PyList_Append(rval, empty_dict);
-    
-    if (s->markers != Py_None) {
-        ident = PyLong_FromVoidPtr(dct);
-        int has_key;
-        if (ident == NULL)
-            goto bail;
-        has_key = PyDict_Contains(s->markers, ident);
-        if (has_key) {
-            if (has_key != -1)
-                PyErr_SetString(PyExc_ValueError, "Circular reference detected");
-            goto bail;
-        }
-        if (PyDict_SetItem(s->markers, ident, dct)) {
-            goto bail;
-        }
-    }
+        return buffer_append(rval, "{}", 2);
+
+    if (markers_push(s, markers, dct))
+        return -1;
 
-    if (PyList_Append(rval, open_dict))
+    if (buffer_append(rval, "{", 1))
         goto bail;
 
-    if (s->indent != Py_None) {
-        /* TODO: DOES NOT RUN */
+    if (s->indent_width >= 0) {
         indent_level += 1;
-        /*
-            newline_indent = '\n' + (' ' * (_indent * _current_indent_level))
-            separator = _item_separator + newline_indent
-            buf += newline_indent
-        */
+        if (encoder_write_newline_indent(s, rval, indent_level))
+            goto bail;
     }
 
-    /* TODO: C speedup not implemented for sort_keys */
+    if (s->sort_keys_flag) {
+        /* items.sort(key=lambda kv: kv[0]), keys are unique so sort them alone */
+        keys = PyDict_Keys(dct);
+        if (keys == NULL)
+            goto bail;
+        if (PyList_Sort(keys))
+            goto bail;
+    }
 
-    PyObject *key, *value;
-    Py_ssize_t pos = 0;
-    int skipkeys = PyObject_IsTrue(s->skipkeys);
-    Py_ssize_t idx = 0;
-    while (PyDict_Next(dct, &pos, &key, &value)) {
+    pos = 0;
+    skipkeys = PyObject_IsTrue(s->skipkeys);
+    idx = 0;
+    while (1) {
+        if (keys != NULL) {
+            if (pos >= PyList_GET_SIZE(keys))
+                break;
+            key = PyList_GET_ITEM(keys, pos);
+            pos++;
+            value = PyDict_GetItem(dct, key);
+            if (value == NULL) {
+                PyErr_SetObject(PyExc_KeyError, key);
+                goto bail;
+            }
+        }
+        else if (!PyDict_Next(dct, &pos, &key, &value)) {
+            break;
+        }
         if (PyString_Check(key) || PyUnicode_Check(key)) {
             Py_INCREF(key);
             kstr = key;
@@ -1845,178 +6401,547 @@ encoder_listencode_dict(PyEncoderObject *s, PyObject *rval, PyObject *dct, Py_ss
                 goto bail;
         }
         else if (key == Py_True || key == Py_False || key == Py_None) {
-            kstr = _encoded_const(key);
+            kstr = PyString_FromString(_encoded_const(key));
+            if (kstr == NULL)
+                goto bail;
+        }
+        else if (s->decimal_type != NULL && PyObject_TypeCheck(key, (PyTypeObject *)s->decimal_type)) {
+            JSON_Buffer kbuf;
+            buffer_init(&kbuf);
+            if (encoder_write_decimal(s, &kbuf, key)) {
+                buffer_free(&kbuf);
+                goto bail;
+            }
+            kstr = buffer_finish(&kbuf);
+            if (kstr == NULL)
+                goto bail;
+        }
+        else if (s->use_datetime && PyDate_Check(key)) {
+            kstr = encoder_date_str(key);
+            if (kstr == NULL)
+                goto bail;
         }
         else if (skipkeys) {
             continue;
         }
         else {
-            /* TODO: include repr of key */
-            PyErr_SetString(PyExc_ValueError, "keys must be a string");
+            PyObject *krepr = PyObject_Repr(key);
+            if (krepr != NULL) {
+                PyErr_Format(PyExc_TypeError, "key %.200s is not a string",
+                             PyString_AS_STRING(krepr));
+                Py_DECREF(krepr);
+            }
             goto bail;
         }
-        
+
         if (idx) {
-            if (PyList_Append(rval, s->item_separator))
+            if (encoder_write_item_separator(s, rval, indent_level))
                 goto bail;
         }
-        
-        PyObject *encoded = encoder_encode_string(s, kstr);
-        Py_DECREF(kstr);
-        kstr = NULL;
-        if (encoded == NULL)
-            goto bail;
-        if (PyList_Append(rval, encoded))
+
+        if (encoder_write_string(s, rval, kstr))
             goto bail;
-        if (PyList_Append(rval, s->key_separator))
+        Py_CLEAR(kstr);
+        if (buffer_append_obj(rval, s->key_separator))
             goto bail;
-        if (encoder_listencode_obj(s, rval, value, indent_level))
+        if (encoder_listencode_obj(s, rval, markers, value, indent_level))
             goto bail;
         idx += 1;
     }
-    if (ident != NULL) {
-        if (PyDict_DelItem(s->markers, ident))
+    Py_CLEAR(keys);
+    if (s->indent_width >= 0) {
+        indent_level -= 1;
+        if (encoder_write_newline_indent(s, rval, indent_level))
             goto bail;
-        Py_DECREF(ident);
-        ident = NULL;
     }
-    if (s->indent != Py_None) {
-        /* TODO: DOES NOT RUN */
+    if (buffer_append(rval, "}", 1))
+        goto bail;
+    markers_pop(markers);
+    return 0;
+
+bail:
+    markers_pop(markers);
+    Py_XDECREF(keys);
+    Py_XDECREF(kstr);
+    return -1;
+}
+
+
+static int
+encoder_listencode_list(PyEncoderObject *s, JSON_Buffer *rval, JSON_Markers *markers, PyObject *seq, Py_ssize_t indent_level)
+{
+    PyObject *s_fast = NULL;
+    PyObject **seq_items;
+    Py_ssize_t num_items;
+    Py_ssize_t i;
+
+    s_fast = PySequence_Fast(seq, "_iterencode_list needs a sequence");
+    if (s_fast == NULL)
+        return -1;
+    num_items = PySequence_Fast_GET_SIZE(s_fast);
+    if (num_items == 0) {
+        Py_DECREF(s_fast);
+        return buffer_append(rval, "[]", 2);
+    }
+
+    if (markers_push(s, markers, seq)) {
+        Py_DECREF(s_fast);
+        return -1;
+    }
+
+    seq_items = PySequence_Fast_ITEMS(s_fast);
+    if (buffer_append(rval, "[", 1))
+        goto bail;
+    if (s->indent_width >= 0) {
+        indent_level += 1;
+        if (encoder_write_newline_indent(s, rval, indent_level))
+            goto bail;
+    }
+    for (i = 0; i < num_items; i++) {
+        PyObject *obj = seq_items[i];
+        if (i) {
+            if (encoder_write_item_separator(s, rval, indent_level))
+                goto bail;
+        }
+        if (encoder_listencode_obj(s, rval, markers, obj, indent_level))
+            goto bail;
+    }
+    if (s->indent_width >= 0) {
         indent_level -= 1;
-        /*
-            yield '\n' + (' ' * (_indent * _current_indent_level))
-        */
+        if (encoder_write_newline_indent(s, rval, indent_level))
+            goto bail;
+    }
+    if (buffer_append(rval, "]", 1))
+        goto bail;
+    markers_pop(markers);
+    Py_DECREF(s_fast);
+    return 0;
+
+bail:
+    markers_pop(markers);
+    Py_DECREF(s_fast);
+    return -1;
+}
+
+static void
+encoder_dealloc(PyObject *self)
+{
+    assert(PyEncoder_Check(self));
+    PyObject_GC_UnTrack(self);
+    encoder_clear(self);
+    self->ob_type->tp_free(self);
+}
+
+static int
+encoder_traverse(PyObject *self, visitproc visit, void *arg)
+{
+    /* default is usually a method of the JSONEncoder that caches this
+       encoder, so the two form a cycle */
+    PyEncoderObject *s = (PyEncoderObject *)self;
+    assert(PyEncoder_Check(self));
+    Py_VISIT(s->markers);
+    Py_VISIT(s->defaultfn);
+    Py_VISIT(s->encoder);
+    Py_VISIT(s->indent);
+    Py_VISIT(s->key_separator);
+    Py_VISIT(s->item_separator);
+    Py_VISIT(s->sort_keys);
+    Py_VISIT(s->skipkeys);
+    Py_VISIT(s->decimal_type);
+    return 0;
+}
+
+static int
+encoder_clear(PyObject *self)
+{
+    PyEncoderObject *s = (PyEncoderObject *)self;
+    assert(PyEncoder_Check(self));
+    Py_CLEAR(s->markers);
+    Py_CLEAR(s->defaultfn);
+    Py_CLEAR(s->encoder);
+    Py_CLEAR(s->indent);
+    Py_CLEAR(s->key_separator);
+    Py_CLEAR(s->item_separator);
+    Py_CLEAR(s->sort_keys);
+    Py_CLEAR(s->skipkeys);
+    Py_CLEAR(s->decimal_type);
+    return 0;
+}
+
+PyDoc_STRVAR(encoder_doc, "_iterencode(obj, _current_indent_level) -> iterable");
+
+static
+PyTypeObject PyEncoderType = {
+    PyObject_HEAD_INIT(0)
+    0,                    /* tp_internal */
+    "make_encoder",       /* tp_name */
+    sizeof(PyEncoderObject), /* tp_basicsize */
+    0,                    /* tp_itemsize */
+    encoder_dealloc, /* tp_dealloc */
+    0,                    /* tp_print */
+    0,                    /* tp_getattr */
+    0,                    /* tp_setattr */
+    0,                    /* tp_compare */
+    0,                    /* tp_repr */
+    0,                    /* tp_as_number */
+    0,                    /* tp_as_sequence */
+    0,                    /* tp_as_mapping */
+    0,                    /* tp_hash */
+    encoder_call,                    /* tp_call */
+    0,                    /* tp_str */
+    0,/* PyObject_GenericGetAttr, */                    /* tp_getattro */
+    0,/* PyObject_GenericSetAttr, */                    /* tp_setattro */
+    0,                    /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC, /* tp_flags */
+    encoder_doc,          /* tp_doc */
+    encoder_traverse,     /* tp_traverse */
+    encoder_clear,        /* tp_clear */
+    0,                    /* tp_richcompare */
+    0,                    /* tp_weaklistoffset */
+    0,                    /* tp_iter */
+    0,                    /* tp_iternext */
+    encoder_methods,      /* tp_methods */
+    encoder_members,                    /* tp_members */
+    0,                    /* tp_getset */
+    0,                    /* tp_base */
+    0,                    /* tp_dict */
+    0,                    /* tp_descr_get */
+    0,                    /* tp_descr_set */
+    0,                    /* tp_dictoffset */
+    encoder_init,                    /* tp_init */
+    0,/* PyType_GenericAlloc, */       /* tp_alloc */
+    0,/* PyType_GenericNew, */         /* tp_new */
+    0,/* PyObject_GC_Del, */           /* tp_free */
+};
+
+static int
+record_encoder_write(PyRecordEncoderObject *r, JSON_Buffer *rval, Py_ssize_t frag)
+{
+    /* Copy one of the precompiled fragments */
+    Py_ssize_t start = r->frag_start[frag];
+    Py_ssize_t n = r->frag_start[frag + 1] - start;
+    if (BUFFER_RESERVE(rval, n))
+        return -1;
+    memcpy(rval->buf + rval->len, r->frags + start, n);
+    rval->len += n;
+    return 0;
+}
+
+static int
+record_encoder_values(PyRecordEncoderObject *r, PyObject *record, PyObject **values)
+{
+    /* Fill values with new references to the fields of a record of the
+       declared shape, return 0 if record is not a record, -1 with
+       ValueError for a tuple of the wrong length */
+    Py_ssize_t i;
+    if (PyTuple_Check(record)) {
+        if (PyTuple_GET_SIZE(record) != r->num_fields) {
+            PyErr_Format(PyExc_ValueError,
+                         "record has %zd values for %zd fields",
+                         PyTuple_GET_SIZE(record), r->num_fields);
+            return -1;
+        }
+        for (i = 0; i < r->num_fields; i++) {
+            values[i] = PyTuple_GET_ITEM(record, i);
+            Py_INCREF(values[i]);
+        }
+        return 1;
+    }
+    if (!PyDict_Check(record) || PyDict_Size(record) != r->num_fields)
+        return 0;
+    for (i = 0; i < r->num_fields; i++) {
+        values[i] = PyDict_GetItem(record, PyTuple_GET_ITEM(r->fields, i));
+        if (values[i] == NULL) {
+            while (--i >= 0)
+                Py_CLEAR(values[i]);
+            return 0;
+        }
+        Py_INCREF(values[i]);
+    }
+    return 1;
+}
+
+static int
+record_encoder_listencode(PyRecordEncoderObject *r, JSON_Buffer *rval, JSON_Markers *markers, PyObject *seq, PyObject **values)
+{
+    PyEncoderObject *s = (PyEncoderObject *)r->encoder;
+    PyObject *s_fast;
+    PyObject **seq_items;
+    Py_ssize_t num_items;
+    Py_ssize_t i, j;
+    int is_record;
+
+    s_fast = PySequence_Fast(seq, "records must be a sequence");
+    if (s_fast == NULL)
+        return -1;
+    num_items = PySequence_Fast_GET_SIZE(s_fast);
+    if (num_items == 0) {
+        Py_DECREF(s_fast);
+        return buffer_append(rval, "[]", 2);
     }
-    if (PyList_Append(rval, close_dict))
+    if (markers_push(s, markers, seq)) {
+        Py_DECREF(s_fast);
+        return -1;
+    }
+    if (r->is_unicode)
+        rval->is_unicode = 1;
+    seq_items = PySequence_Fast_ITEMS(s_fast);
+    if (record_encoder_write(r, rval, RECORD_OPEN))
+        goto bail;
+    for (i = 0; i < num_items; i++) {
+        PyObject *record = seq_items[i];
+        if (i) {
+            if (record_encoder_write(r, rval, RECORD_NEXT))
+                goto bail;
+        }
+        is_record = record_encoder_values(r, record, values);
+        if (is_record < 0)
+            goto bail;
+        if (!is_record) {
+            /* not a record, records sit at indent level 1 */
+            if (encoder_listencode_obj(s, rval, markers, record, 1))
+                goto bail;
+            continue;
+        }
+        if (markers_push(s, markers, record))
+            goto bail_values;
+        for (j = 0; j < r->num_fields; j++) {
+            if (record_encoder_write(r, rval, RECORD_FIELD + j))
+                goto bail_record;
+            if (encoder_listencode_obj(s, rval, markers, values[r->order[j]], 2))
+                goto bail_record;
+        }
+        for (j = 0; j < r->num_fields; j++)
+            Py_CLEAR(values[j]);
+        markers_pop(markers);
+        if (record_encoder_write(r, rval, RECORD_END))
+            goto bail;
+    }
+    if (record_encoder_write(r, rval, RECORD_CLOSE))
         goto bail;
+    markers_pop(markers);
+    Py_DECREF(s_fast);
     return 0;
-    
+
+bail_record:
+    markers_pop(markers);
+bail_values:
+    for (j = 0; j < r->num_fields; j++)
+        Py_CLEAR(values[j]);
 bail:
-    Py_XDECREF(kstr);
-    Py_XDECREF(ident);
+    markers_pop(markers);
+    Py_DECREF(s_fast);
     return -1;
 }
 
+static PyObject *
+record_encoder_call(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    /* Encode a sequence of records into one string */
+    static char *kwlist[] = {"records", NULL};
+    PyObject *records;
+    PyObject **values;
+    JSON_Buffer buf;
+    JSON_Markers markers;
+    int rv;
+    PyRecordEncoderObject *r = (PyRecordEncoderObject *)self;
+    PyEncoderObject *s = (PyEncoderObject *)r->encoder;
+    assert(PyRecordEncoder_Check(self));
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O:_encode_records", kwlist, &records))
+        return NULL;
+    values = PyMem_New(PyObject *, r->num_fields);
+    if (values == NULL)
+        return PyErr_NoMemory();
+    memset(values, 0, r->num_fields * sizeof(PyObject *));
+    buffer_init(&buf);
+    markers_init(&markers);
+    rv = record_encoder_listencode(r, &buf, (s->markers == Py_None) ? NULL : &markers, records, values);
+    markers_free(&markers);
+    PyMem_Free(values);
+    if (rv) {
+        buffer_free(&buf);
+        return NULL;
+    }
+    STATS_ADD(bytes_encoded, buf.len);
+    return buffer_finish(&buf);
+}
 
 static int
-encoder_listencode_list(PyEncoderObject *s, PyObject *rval, PyObject *seq, Py_ssize_t indent_level)
+record_encoder_init(PyObject *self, PyObject *args, PyObject *kwds)
 {
-    static PyObject *open_array = NULL;
-    static PyObject *close_array = NULL;
-    static PyObject *empty_array = NULL;
-    if (open_array == NULL || close_array == NULL || empty_array == NULL) {
-        open_array = PyString_InternFromString("[");
-        close_array = PyString_InternFromString("]");
-        empty_array = PyString_InternFromString("[]");
-        if (open_array == NULL || close_array == NULL || empty_array == NULL)
-            return -1;
+    static char *kwlist[] = {"encoder", "fields", NULL};
+    PyObject *encoder;
+    PyObject *fields;
+    PyEncoderObject *s;
+    JSON_Buffer b;
+    Py_ssize_t i;
+    PyRecordEncoderObject *r = (PyRecordEncoderObject *)self;
+    assert(PyRecordEncoder_Check(self));
+
+    r->encoder = NULL;
+    r->fields = NULL;
+    r->num_fields = 0;
+    r->order = NULL;
+    r->frags = NULL;
+    r->frag_start = NULL;
+    r->is_unicode = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO:make_record_encoder", kwlist,
+        &encoder, &fields))
+        return -1;
+    if (!PyEncoder_Check(encoder)) {
+        PyErr_SetString(PyExc_TypeError, "encoder must be a make_encoder instance");
+        return -1;
     }
-    PyObject *ident = NULL;
-    PyObject *s_fast = PySequence_Fast(seq, "_iterencode_list needs a sequence");
-    if (s_fast == NULL)
+    s = (PyEncoderObject *)encoder;
+    Py_INCREF(encoder);
+    r->encoder = encoder;
+    r->fields = PySequence_Tuple(fields);
+    if (r->fields == NULL)
+        return -1;
+    r->num_fields = PyTuple_GET_SIZE(r->fields);
+    if (r->num_fields == 0) {
+        PyErr_SetString(PyExc_ValueError, "fields must not be empty");
         return -1;
-    Py_ssize_t num_items = PySequence_Fast_GET_SIZE(s_fast);
-    if (num_items == 0) {
-        Py_DECREF(s_fast);
-        return PyList_Append(rval, empty_array);
     }
-    
-    if (s->markers != Py_None) {
-        ident = PyLong_FromVoidPtr(seq);
-        int has_key;
-        if (ident == NULL)
-            goto bail;
-        has_key = PyDict_Contains(s->markers, ident);
-        if (has_key) {
-            if (has_key != -1)
-                PyErr_SetString(PyExc_ValueError, "Circular reference detected");
-            goto bail;
+    for (i = 0; i < r->num_fields; i++) {
+        PyObject *key = PyTuple_GET_ITEM(r->fields, i);
+        if (!PyString_Check(key) && !PyUnicode_Check(key)) {
+            PyErr_SetString(PyExc_TypeError, "fields must be strings");
+            return -1;
         }
-        if (PyDict_SetItem(s->markers, ident, seq)) {
-            goto bail;
+    }
+    r->order = PyMem_New(Py_ssize_t, r->num_fields);
+    r->frag_start = PyMem_New(Py_ssize_t, RECORD_FIELD + r->num_fields + 1);
+    if (r->order == NULL || r->frag_start == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    for (i = 0; i < r->num_fields; i++) {
+        /* insertion sort of the field indexes when keys are sorted */
+        Py_ssize_t j = i;
+        while (s->sort_keys_flag && j > 0) {
+            int lt = PyObject_RichCompareBool(PyTuple_GET_ITEM(r->fields, i),
+                                              PyTuple_GET_ITEM(r->fields, r->order[j - 1]), Py_LT);
+            if (lt == -1)
+                return -1;
+            if (!lt)
+                break;
+            r->order[j] = r->order[j - 1];
+            j--;
         }
+        r->order[j] = i;
     }
-    
-    PyObject **seq_items = PySequence_Fast_ITEMS(s_fast);
-    if (PyList_Append(rval, open_array))
+
+    /* The records are the items of a list at indent level 0, so every
+       fragment, indentation included, is the same for all of them */
+    buffer_init(&b);
+    r->frag_start[RECORD_OPEN] = b.len;
+    if (buffer_append(&b, "[", 1))
         goto bail;
-    Py_ssize_t i;
-    if (s->indent != Py_None) {
-        /* TODO: DOES NOT RUN */
-        indent_level += 1;
-        /*
-            newline_indent = '\n' + (' ' * (_indent * _current_indent_level))
-            separator = _item_separator + newline_indent
-            buf += newline_indent
-        */
-    }
-    for (i = 0; i < num_items; i++) {
-        PyObject *obj = seq_items[i];
-        if (i) {
-            if (PyList_Append(rval, s->item_separator))
+    if (s->indent_width >= 0 && encoder_write_newline_indent(s, &b, 1))
+        goto bail;
+    r->frag_start[RECORD_NEXT] = b.len;
+    if (encoder_write_item_separator(s, &b, 1))
+        goto bail;
+    r->frag_start[RECORD_END] = b.len;
+    if (s->indent_width >= 0 && encoder_write_newline_indent(s, &b, 1))
+        goto bail;
+    if (buffer_append(&b, "}", 1))
+        goto bail;
+    r->frag_start[RECORD_CLOSE] = b.len;
+    if (s->indent_width >= 0 && encoder_write_newline_indent(s, &b, 0))
+        goto bail;
+    if (buffer_append(&b, "]", 1))
+        goto bail;
+    for (i = 0; i < r->num_fields; i++) {
+        PyObject *key = PyTuple_GET_ITEM(r->fields, r->order[i]);
+        r->frag_start[RECORD_FIELD + i] = b.len;
+        if (i == 0) {
+            if (buffer_append(&b, "{", 1))
+                goto bail;
+            if (s->indent_width >= 0 && encoder_write_newline_indent(s, &b, 2))
                 goto bail;
         }
-        if (encoder_listencode_obj(s, rval, obj, indent_level))
+        else if (encoder_write_item_separator(s, &b, 2)) {
             goto bail;
-    }
-    if (ident != NULL) {
-        if (PyDict_DelItem(s->markers, ident))
+        }
+        if (encoder_write_string(s, &b, key))
+            goto bail;
+        if (buffer_append_obj(&b, s->key_separator))
             goto bail;
-        Py_DECREF(ident);
-        ident = NULL;
-    }
-    if (s->indent != Py_None) {
-        /* TODO: DOES NOT RUN */
-        indent_level -= 1;
-        /*
-            yield '\n' + (' ' * (_indent * _current_indent_level))
-        */
     }
-    if (PyList_Append(rval, close_array))
+    r->frag_start[RECORD_FIELD + r->num_fields] = b.len;
+    r->frags = (char *)PyMem_Malloc(b.len);
+    if (r->frags == NULL) {
+        PyErr_NoMemory();
         goto bail;
-    Py_DECREF(s_fast);
+    }
+    memcpy(r->frags, b.buf, b.len);
+    r->is_unicode = b.is_unicode;
+    buffer_free(&b);
     return 0;
-    
+
 bail:
-    Py_XDECREF(ident);
-    Py_DECREF(s_fast);
+    buffer_free(&b);
     return -1;
 }
 
+static int
+record_encoder_traverse(PyObject *self, visitproc visit, void *arg)
+{
+    PyRecordEncoderObject *r = (PyRecordEncoderObject *)self;
+    assert(PyRecordEncoder_Check(self));
+    Py_VISIT(r->encoder);
+    Py_VISIT(r->fields);
+    return 0;
+}
+
+static int
+record_encoder_clear(PyObject *self)
+{
+    PyRecordEncoderObject *r = (PyRecordEncoderObject *)self;
+    assert(PyRecordEncoder_Check(self));
+    Py_CLEAR(r->encoder);
+    Py_CLEAR(r->fields);
+    return 0;
+}
+
 static void
-encoder_dealloc(PyObject *self)
+record_encoder_dealloc(PyObject *self)
 {
-    assert(PyEncoder_Check(self));
-    PyEncoderObject *s = (PyEncoderObject *)self;
-    Py_XDECREF(s->markers);
-    s->markers = NULL;
-    Py_XDECREF(s->defaultfn);
-    s->defaultfn = NULL;
-    Py_XDECREF(s->encoder);
-    s->encoder = NULL;
-    Py_XDECREF(s->indent);
-    s->indent = NULL;
-    Py_XDECREF(s->key_separator);
-    s->key_separator = NULL;
-    Py_XDECREF(s->item_separator);
-    s->item_separator = NULL;
-    Py_XDECREF(s->sort_keys);
-    s->sort_keys = NULL;
-    Py_XDECREF(s->skipkeys);
-    s->skipkeys = NULL;
+    PyRecordEncoderObject *r = (PyRecordEncoderObject *)self;
+    assert(PyRecordEncoder_Check(self));
+    PyObject_GC_UnTrack(self);
+    record_encoder_clear(self);
+    PyMem_Free(r->order);
+    r->order = NULL;
+    PyMem_Free(r->frags);
+    r->frags = NULL;
+    PyMem_Free(r->frag_start);
+    r->frag_start = NULL;
     self->ob_type->tp_free(self);
 }
 
-PyDoc_STRVAR(encoder_doc, "_iterencode(obj, _current_indent_level) -> iterable");
+PyDoc_STRVAR(record_encoder_doc,
+    "make_record_encoder(encoder, fields)\n"
+    "\n"
+    "Callable that encodes a sequence of records as a JSON array, with\n"
+    "the settings of encoder, a make_encoder instance.  A record is a\n"
+    "dict with exactly the keys in fields or a tuple with one value per\n"
+    "field; it is written as an object with the fields in that order.\n"
+    "Keys and separators are escaped once, when the encoder is made.\n"
+    "Items of any other shape are encoded as usual."
+);
 
 static
-PyTypeObject PyEncoderType = {
+PyTypeObject PyRecordEncoderType = {
     PyObject_HEAD_INIT(0)
     0,                    /* tp_internal */
-    "make_encoder",       /* tp_name */
-    sizeof(PyEncoderObject), /* tp_basicsize */
+    "make_record_encoder", /* tp_name */
+    sizeof(PyRecordEncoderObject), /* tp_basicsize */
     0,                    /* tp_itemsize */
-    encoder_dealloc, /* tp_dealloc */
+    record_encoder_dealloc, /* tp_dealloc */
     0,                    /* tp_print */
     0,                    /* tp_getattr */
     0,                    /* tp_setattr */
@@ -2026,42 +6951,526 @@ PyTypeObject PyEncoderType = {
     0,                    /* tp_as_sequence */
     0,                    /* tp_as_mapping */
     0,                    /* tp_hash */
-    encoder_call,                    /* tp_call */
+    record_encoder_call,  /* tp_call */
     0,                    /* tp_str */
     0,/* PyObject_GenericGetAttr, */                    /* tp_getattro */
     0,/* PyObject_GenericSetAttr, */                    /* tp_setattro */
     0,                    /* tp_as_buffer */
-    Py_TPFLAGS_DEFAULT,   /* tp_flags */
-    encoder_doc,          /* tp_doc */
-    0,                    /* tp_traverse */
-    0,                    /* tp_clear */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC, /* tp_flags */
+    record_encoder_doc,   /* tp_doc */
+    record_encoder_traverse, /* tp_traverse */
+    record_encoder_clear, /* tp_clear */
     0,                    /* tp_richcompare */
     0,                    /* tp_weaklistoffset */
     0,                    /* tp_iter */
     0,                    /* tp_iternext */
     0,                    /* tp_methods */
-    encoder_members,                    /* tp_members */
+    record_encoder_members, /* tp_members */
     0,                    /* tp_getset */
     0,                    /* tp_base */
     0,                    /* tp_dict */
     0,                    /* tp_descr_get */
     0,                    /* tp_descr_set */
     0,                    /* tp_dictoffset */
-    encoder_init,                    /* tp_init */
-    0,/* PyType_GenericAlloc, */       /* tp_alloc */
-    0,/* PyType_GenericNew, */         /* tp_new */
-    0,/* _PyObject_Del, */             /* tp_free */
+    record_encoder_init,  /* tp_init */
+    0,/* PyType_GenericAlloc, */        /* tp_alloc */
+    0,/* PyType_GenericNew, */          /* tp_new */
+    0,/* PyObject_GC_Del, */            /* tp_free */
 };
 
+/*
+Validation and minification of encoded JSON text.  The checker only reads
+the bytes and writes into a preallocated string, so it runs with the GIL
+released; for the same reason its stack of open containers uses malloc
+rather than PyMem_Malloc.  Nesting is limited to JSON_MAX_DEPTH, as for
+loads().
+*/
+#define JSON_CHECK_STACK 256
+
+typedef struct {
+    const unsigned char *buf;
+    Py_ssize_t len;
+    int strict;
+    char *out;
+    Py_ssize_t out_len;
+    Py_ssize_t err_pos;
+    char *err_msg;
+} JSON_Checker;
+
+static int
+check_error(JSON_Checker *c, char *msg, Py_ssize_t pos)
+{
+    c->err_msg = msg;
+    c->err_pos = pos;
+    return -1;
+}
+
+static void
+check_emit(JSON_Checker *c, Py_ssize_t start, Py_ssize_t end)
+{
+    /* Copy buf[start:end] to the minified output, if there is one */
+    if (c->out != NULL) {
+        memcpy(c->out + c->out_len, c->buf + start, end - start);
+        c->out_len += end - start;
+    }
+}
+
+static Py_ssize_t
+check_skip_whitespace(JSON_Checker *c, Py_ssize_t idx)
+{
+    while (idx < c->len && IS_WHITESPACE(c->buf[idx]))
+        idx++;
+    return idx;
+}
+
+static Py_ssize_t
+check_utf8(const unsigned char *p, Py_ssize_t i, Py_ssize_t end)
+{
+    /* Offset of the first byte of p[i:end] that does not start a valid
+       UTF-8 sequence, or -1.  Encoded surrogates are allowed because
+       Python's codec accepts them. */
+    while (i < end) {
+        unsigned char c = p[i];
+        int n;
+        int k;
+        if (c < 0x80) {
+            i++;
+            continue;
+        }
+        if (c >= 0xc2 && c <= 0xdf)
+            n = 1;
+        else if (c >= 0xe0 && c <= 0xef)
+            n = 2;
+        else if (c >= 0xf0 && c <= 0xf4)
+            n = 3;
+        else
+            return i;
+        if (i + n >= end)
+            return i;
+        for (k = 1; k <= n; k++) {
+            if ((p[i + k] & 0xc0) != 0x80)
+                return i;
+        }
+        /* overlong forms and code points past U+10FFFF */
+        if ((c == 0xe0 && p[i + 1] < 0xa0) || (c == 0xf0 && p[i + 1] < 0x90) ||
+                (c == 0xf4 && p[i + 1] >= 0x90))
+            return i;
+        i += n + 1;
+    }
+    return -1;
+}
+
+static int
+check_hex4(JSON_Checker *c, Py_ssize_t idx, unsigned int *value)
+{
+    /* Read the 4 hex digits at idx */
+    int k;
+    unsigned int v = 0;
+    for (k = 0; k < 4; k++) {
+        unsigned char d = c->buf[idx + k];
+        v <<= 4;
+        if (d >= '0' && d <= '9')
+            v |= d - '0';
+        else if (d >= 'a' && d <= 'f')
+            v |= d - 'a' + 10;
+        else if (d >= 'A' && d <= 'F')
+            v |= d - 'A' + 10;
+        else
+            return -1;
+    }
+    *value = v;
+    return 0;
+}
+
+static Py_ssize_t
+check_string(JSON_Checker *c, Py_ssize_t begin)
+{
+    /* The string whose opening quote is at begin, following the rules of
+       scanstring.  Returns the index just past the closing quote. */
+    Py_ssize_t idx = begin + 1;
+    for (;;) {
+        int has_unicode = 0;
+        Py_ssize_t next = scan_plain_str((const char *)c->buf, idx, c->len, &has_unicode);
+        unsigned char ch;
+        if (has_unicode) {
+            Py_ssize_t bad = check_utf8(c->buf, idx, next);
+            if (bad >= 0)
+                return check_error(c, "Invalid UTF-8 at", bad);
+        }
+        if (next >= c->len)
+            return check_error(c, "Unterminated string starting at", begin);
+        ch = c->buf[next];
+        if (ch == '"') {
+            idx = next + 1;
+            break;
+        }
+        if (ch != '\\') {
+            if (c->strict)
+                return check_error(c, "Invalid control character at", next);
+            idx = next + 1;
+            continue;
+        }
+        if (next + 1 >= c->len)
+            return check_error(c, "Unterminated string starting at", begin);
+        ch = c->buf[next + 1];
+        if (ch == 'u') {
+            unsigned int u;
+            if (next + 6 >= c->len || check_hex4(c, next + 2, &u))
+                return check_error(c, "Invalid \\uXXXX escape", next + 1);
+            idx = next + 6;
+#ifdef Py_UNICODE_WIDE
+            if ((u & 0xfc00) == 0xd800) {
+                unsigned int u2;
+                if (idx + 6 >= c->len || c->buf[idx] != '\\' || c->buf[idx + 1] != 'u')
+                    return check_error(c, "Unpaired high surrogate", next + 1);
+                if (check_hex4(c, idx + 2, &u2))
+                    return check_error(c, "Invalid \\uXXXX escape", idx + 1);
+                if ((u2 & 0xfc00) != 0xdc00)
+                    return check_error(c, "Unpaired high surrogate", next + 1);
+                idx += 6;
+            }
+            else if ((u & 0xfc00) == 0xdc00) {
+                return check_error(c, "Unpaired low surrogate", next + 1);
+            }
+#endif
+        }
+        else if (ch == '"' || ch == '\\' || ch == '/' || ch == 'b' ||
+                 ch == 'f' || ch == 'n' || ch == 'r' || ch == 't') {
+            idx = next + 2;
+        }
+        else {
+            return check_error(c, "Invalid \\escape", next);
+        }
+    }
+    check_emit(c, begin, idx);
+    return idx;
+}
+
+static Py_ssize_t
+check_scalar(JSON_Checker *c, Py_ssize_t idx)
+{
+    /* A number or constant at idx, as the scanner would match it */
+    static const char *constants[] = {"true", "false", "null", "NaN", "Infinity", "-Infinity", NULL};
+    const unsigned char *buf = c->buf;
+    Py_ssize_t start = idx;
+    int k;
+    for (k = 0; constants[k] != NULL; k++) {
+        Py_ssize_t n = (Py_ssize_t)strlen(constants[k]);
+        if (c->len - idx >= n && memcmp(buf + idx, constants[k], n) == 0) {
+            check_emit(c, idx, idx + n);
+            return idx + n;
+        }
+    }
+    if (idx < c->len && buf[idx] == '-')
+        idx++;
+    if (idx < c->len && buf[idx] == '0') {
+        idx++;
+    }
+    else if (idx < c->len && buf[idx] >= '1' && buf[idx] <= '9') {
+        while (idx < c->len && buf[idx] >= '0' && buf[idx] <= '9')
+            idx++;
+    }
+    else {
+        return check_error(c, "Expecting value", start);
+    }
+    if (idx + 1 < c->len && buf[idx] == '.' && buf[idx + 1] >= '0' && buf[idx + 1] <= '9') {
+        idx += 2;
+        while (idx < c->len && buf[idx] >= '0' && buf[idx] <= '9')
+            idx++;
+    }
+    if (idx < c->len && (buf[idx] == 'e' || buf[idx] == 'E')) {
+        Py_ssize_t e = idx + 1;
+        if (e < c->len && (buf[e] == '-' || buf[e] == '+'))
+            e++;
+        if (e < c->len && buf[e] >= '0' && buf[e] <= '9') {
+            while (e < c->len && buf[e] >= '0' && buf[e] <= '9')
+                e++;
+            idx = e;
+        }
+    }
+    check_emit(c, start, idx);
+    return idx;
+}
+
+static int
+check_json(JSON_Checker *c)
+{
+    /* 0 if buf holds one JSON document, -1 with err_msg set if it does
+       not, -2 if the stack could not be grown.  Must not touch any
+       Python object. */
+    char inline_stack[JSON_CHECK_STACK];
+    char *stack = inline_stack;
+    Py_ssize_t stack_size = JSON_CHECK_STACK;
+    Py_ssize_t depth = 0;
+    Py_ssize_t idx = check_skip_whitespace(c, 0);
+    int rv = -1;
+    unsigned char ch;
+    for (;;) {
+        if (idx >= c->len) {
+            check_error(c, "Expecting value", idx);
+            goto done;
+        }
+        ch = c->buf[idx];
+        if (ch == '{' || ch == '[') {
+            if (depth == JSON_MAX_DEPTH) {
+                check_error(c, "Maximum nesting depth exceeded", idx);
+                goto done;
+            }
+            if (depth == stack_size) {
+                char *new_stack;
+                if (stack == inline_stack) {
+                    new_stack = (char *)malloc(stack_size * 2);
+                    if (new_stack != NULL)
+                        memcpy(new_stack, inline_stack, depth);
+                }
+                else {
+                    new_stack = (char *)realloc(stack, stack_size * 2);
+                }
+                if (new_stack == NULL) {
+                    rv = -2;
+                    goto done;
+                }
+                stack = new_stack;
+                stack_size *= 2;
+            }
+            stack[depth++] = ch;
+            check_emit(c, idx, idx + 1);
+            idx = check_skip_whitespace(c, idx + 1);
+            /* '}' and ']' are two past '{' and '[' */
+            if (idx >= c->len || c->buf[idx] != ch + 2) {
+                if (ch == '{')
+                    goto key;
+                continue;
+            }
+        }
+        else {
+            idx = (ch == '"') ? check_string(c, idx) : check_scalar(c, idx);
+            if (idx < 0)
+                goto done;
+            idx = check_skip_whitespace(c, idx);
+        }
+        /* After a complete value: close containers or go on to the next member */
+        for (;;) {
+            if (depth == 0) {
+                if (idx != c->len) {
+                    check_error(c, "Extra data", idx);
+                    goto done;
+                }
+                rv = 0;
+                goto done;
+            }
+            ch = stack[depth - 1];
+            if (idx < c->len && c->buf[idx] == ch + 2) {
+                check_emit(c, idx, idx + 1);
+                depth--;
+                idx = check_skip_whitespace(c, idx + 1);
+            }
+            else if (idx < c->len && c->buf[idx] == ',') {
+                check_emit(c, idx, idx + 1);
+                idx = check_skip_whitespace(c, idx + 1);
+                if (ch == '{')
+                    goto key;
+                break;
+            }
+            else {
+                check_error(c, "Expecting , delimiter", idx);
+                goto done;
+            }
+        }
+        continue;
+key:
+        if (idx >= c->len || c->buf[idx] != '"') {
+            check_error(c, "Expecting property name", idx);
+            goto done;
+        }
+        idx = check_string(c, idx);
+        if (idx < 0)
+            goto done;
+        idx = check_skip_whitespace(c, idx);
+        if (idx >= c->len || c->buf[idx] != ':') {
+            check_error(c, "Expecting : delimiter", idx);
+            goto done;
+        }
+        check_emit(c, idx, idx + 1);
+        idx = check_skip_whitespace(c, idx + 1);
+    }
+done:
+    if (stack != inline_stack)
+        free(stack);
+    return rv;
+}
+
+static Py_ssize_t
+check_unicode_pos(JSON_Checker *c, Py_ssize_t pos)
+{
+    /* The index into the unicode a UTF-8 byte offset of buf came from */
+    Py_ssize_t i;
+    Py_ssize_t upos = 0;
+    for (i = 0; i < pos; i++) {
+        unsigned char ch = c->buf[i];
+        if ((ch & 0xc0) != 0x80)
+            upos++;
+#ifndef Py_UNICODE_WIDE
+        /* a surrogate pair on narrow builds */
+        if (ch >= 0xf0)
+            upos++;
+#endif
+    }
+    return upos;
+}
+
+static PyObject *
+check_text(PyObject *pystr, int strict, int minify)
+{
+    /* validate() and minify().  unicode is checked as UTF-8, and minified
+       unicode is returned as unicode. */
+    JSON_Checker c;
+    PyObject *encoded;
+    PyObject *out = NULL;
+    PyObject *rval = NULL;
+    int rv;
+    if (PyString_Check(pystr)) {
+        Py_INCREF(pystr);
+        encoded = pystr;
+    }
+    else if (PyUnicode_Check(pystr)) {
+        encoded = PyUnicode_AsUTF8String(pystr);
+        if (encoded == NULL)
+            return NULL;
+    }
+    else {
+        PyErr_Format(PyExc_TypeError,
+                     "first argument must be a string, not %.80s",
+                     Py_TYPE(pystr)->tp_name);
+        return NULL;
+    }
+    c.buf = (const unsigned char *)PyString_AS_STRING(encoded);
+    c.len = PyString_GET_SIZE(encoded);
+    c.strict = strict;
+    c.out = NULL;
+    c.out_len = 0;
+    c.err_pos = -1;
+    c.err_msg = NULL;
+    if (minify) {
+        out = PyString_FromStringAndSize(NULL, c.len);
+        if (out == NULL)
+            goto bail;
+        c.out = PyString_AS_STRING(out);
+    }
+    Py_BEGIN_ALLOW_THREADS
+    rv = check_json(&c);
+    Py_END_ALLOW_THREADS
+    if (rv == -2) {
+        PyErr_NoMemory();
+        goto bail;
+    }
+    if (!minify) {
+        rval = PyBool_FromLong(rv == 0);
+        goto bail;
+    }
+    if (rv) {
+        if (PyUnicode_Check(pystr))
+            raise_errmsg(c.err_msg, pystr, check_unicode_pos(&c, c.err_pos));
+        else
+            raise_errmsg(c.err_msg, encoded, c.err_pos);
+        goto bail;
+    }
+    if (_PyString_Resize(&out, c.out_len))
+        goto bail;
+    if (PyUnicode_Check(pystr))
+        rval = PyUnicode_DecodeUTF8(PyString_AS_STRING(out), c.out_len, "strict");
+    else
+        rval = out;
+    out = (rval == out) ? NULL : out;
+bail:
+    Py_XDECREF(out);
+    Py_DECREF(encoded);
+    return rval;
+}
+
+PyDoc_STRVAR(pydoc_validate,
+    "validate(s, strict=True) -> bool\n"
+    "\n"
+    "Return True if s is a single JSON document that loads() would accept,\n"
+    "without building any objects.  str input must be UTF-8.  The GIL is\n"
+    "released while checking."
+);
+
+static PyObject *
+py_validate(PyObject *self UNUSED, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"s", "strict", NULL};
+    PyObject *pystr;
+    int strict = 1;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|i:validate", kwlist, &pystr, &strict))
+        return NULL;
+    return check_text(pystr, strict, 0);
+}
+
+PyDoc_STRVAR(pydoc_minify,
+    "minify(s, strict=True) -> str or unicode\n"
+    "\n"
+    "Return s with all whitespace outside of strings removed, raising\n"
+    "ValueError if it is not a single valid JSON document.  The GIL is\n"
+    "released while the text is processed."
+);
+
+static PyObject *
+py_minify(PyObject *self UNUSED, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"s", "strict", NULL};
+    PyObject *pystr;
+    int strict = 1;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|i:minify", kwlist, &pystr, &strict))
+        return NULL;
+    return check_text(pystr, strict, 1);
+}
+
 static PyMethodDef speedups_methods[] = {
     {"encode_basestring_ascii",
         (PyCFunction)py_encode_basestring_ascii,
         METH_O,
         pydoc_encode_basestring_ascii},
+    {"encode_basestring",
+        (PyCFunction)py_encode_basestring,
+        METH_O,
+        pydoc_encode_basestring},
     {"scanstring",
         (PyCFunction)py_scanstring,
         METH_VARARGS,
         pydoc_scanstring},
+    {"simd_level",
+        (PyCFunction)py_simd_level,
+        METH_NOARGS,
+        pydoc_simd_level},
+    {"_set_simd_level",
+        (PyCFunction)py_set_simd_level,
+        METH_VARARGS,
+        pydoc_set_simd_level},
+    {"_set_float_format",
+        (PyCFunction)py_set_float_format,
+        METH_VARARGS,
+        pydoc_set_float_format},
+    {"enable_stats",
+        (PyCFunction)py_enable_stats,
+        METH_VARARGS,
+        pydoc_enable_stats},
+    {"stats",
+        (PyCFunction)py_stats,
+        METH_NOARGS,
+        pydoc_stats},
+    {"reset_stats",
+        (PyCFunction)py_reset_stats,
+        METH_NOARGS,
+        pydoc_reset_stats},
+    {"validate",
+        (PyCFunction)py_validate,
+        METH_VARARGS | METH_KEYWORDS,
+        pydoc_validate},
+    {"minify",
+        (PyCFunction)py_minify,
+        METH_VARARGS | METH_KEYWORDS,
+        pydoc_minify},
     {NULL, NULL, 0, NULL}
 };
 
@@ -2072,6 +7481,12 @@ void
 init_speedups(void)
 {
     PyObject *m;
+    int level;
+    for (level = SIMD_AVX2; level > SIMD_SCALAR; level--) {
+        if (simd_supported(level))
+            break;
+    }
+    simd_select(level);
     PyScannerType.tp_getattro = PyObject_GenericGetAttr;
     PyScannerType.tp_setattro = PyObject_GenericSetAttr;
     PyScannerType.tp_alloc  = PyType_GenericAlloc;
@@ -2083,12 +7498,48 @@ init_speedups(void)
     PyEncoderType.tp_setattro = PyObject_GenericSetAttr;
     PyEncoderType.tp_alloc  = PyType_GenericAlloc;
     PyEncoderType.tp_new = PyType_GenericNew;
-    PyEncoderType.tp_free = _PyObject_Del;
+    PyEncoderType.tp_free = PyObject_GC_Del;
     if (PyType_Ready(&PyEncoderType) < 0)
         return;
+    PyPushParserType.tp_getattro = PyObject_GenericGetAttr;
+    PyPushParserType.tp_setattro = PyObject_GenericSetAttr;
+    PyPushParserType.tp_alloc  = PyType_GenericAlloc;
+    PyPushParserType.tp_new = PyType_GenericNew;
+    PyPushParserType.tp_free = _PyObject_Del;
+    if (PyType_Ready(&PyPushParserType) < 0)
+        return;
+    PyLazyDocumentType.tp_getattro = PyObject_GenericGetAttr;
+    PyLazyDocumentType.tp_setattro = PyObject_GenericSetAttr;
+    PyLazyDocumentType.tp_alloc  = PyType_GenericAlloc;
+    PyLazyDocumentType.tp_new = PyType_GenericNew;
+    PyLazyDocumentType.tp_free = _PyObject_Del;
+    if (PyType_Ready(&PyLazyDocumentType) < 0)
+        return;
+    PyLineReaderType.tp_getattro = PyObject_GenericGetAttr;
+    PyLineReaderType.tp_setattro = PyObject_GenericSetAttr;
+    PyLineReaderType.tp_alloc  = PyType_GenericAlloc;
+    PyLineReaderType.tp_new = PyType_GenericNew;
+    PyLineReaderType.tp_free = _PyObject_Del;
+    if (PyType_Ready(&PyLineReaderType) < 0)
+        return;
+    PyRecordEncoderType.tp_getattro = PyObject_GenericGetAttr;
+    PyRecordEncoderType.tp_setattro = PyObject_GenericSetAttr;
+    PyRecordEncoderType.tp_alloc  = PyType_GenericAlloc;
+    PyRecordEncoderType.tp_new = PyType_GenericNew;
+    PyRecordEncoderType.tp_free = PyObject_GC_Del;
+    if (PyType_Ready(&PyRecordEncoderType) < 0)
+        return;
     m = Py_InitModule3("_speedups", speedups_methods, module_doc);
     Py_INCREF((PyObject*)&PyScannerType);
     PyModule_AddObject(m, "make_scanner", (PyObject*)&PyScannerType);
     Py_INCREF((PyObject*)&PyEncoderType);
     PyModule_AddObject(m, "make_encoder", (PyObject*)&PyEncoderType);
+    Py_INCREF((PyObject*)&PyPushParserType);
+    PyModule_AddObject(m, "make_push_parser", (PyObject*)&PyPushParserType);
+    Py_INCREF((PyObject*)&PyLazyDocumentType);
+    PyModule_AddObject(m, "make_lazy_document", (PyObject*)&PyLazyDocumentType);
+    Py_INCREF((PyObject*)&PyLineReaderType);
+    PyModule_AddObject(m, "make_line_reader", (PyObject*)&PyLineReaderType);
+    Py_INCREF((PyObject*)&PyRecordEncoderType);
+    PyModule_AddObject(m, "make_record_encoder", (PyObject*)&PyRecordEncoderType);
 }
@@ -0,0 +1,1361 @@
+/* Tables of 5**i for the shortest float formatting in _speedups.c, stored
+   as {low, high} 64-bit halves.  Generated with:
+
+    for i in range(342):
+        v = (1 << ((5 ** i).bit_length() - 1 + 125)) // 5 ** i + 1
+    for i in range(326):
+        b = (5 ** i).bit_length() - 125
+        v = 5 ** i >> b if b > 0 else 5 ** i << -b
+*/
+
+#define DOUBLE_POW5_INV_BITCOUNT 125
+#define DOUBLE_POW5_BITCOUNT 125
+#define DOUBLE_POW5_INV_TABLE_SIZE 342
+#define DOUBLE_POW5_TABLE_SIZE 326
+
+static const JSON_UINT64 DOUBLE_POW5_INV_SPLIT[DOUBLE_POW5_INV_TABLE_SIZE][2] = {
+    {1U, 2305843009213693952U},
+    {11068046444225730970U, 1844674407370955161U},
+    {5165088340638674453U, 1475739525896764129U},
+    {7821419487252849886U, 1180591620717411303U},
+    {8824922364862649494U, 1888946593147858085U},
+    {7059937891890119595U, 1511157274518286468U},
+    {13026647942995916322U, 1208925819614629174U},
+    {9774590264567735146U, 1934281311383406679U},
+    {11509021026396098440U, 1547425049106725343U},
+    {16585914450600699399U, 1237940039285380274U},
+    {15469416676735388068U, 1980704062856608439U},
+    {16064882156130220778U, 1584563250285286751U},
+    {9162556910162266299U, 1267650600228229401U},
+    {7281393426775805432U, 2028240960365167042U},
+    {16893161185646375315U, 1622592768292133633U},
+    {2446482504291369283U, 1298074214633706907U},
+    {7603720821608101175U, 2076918743413931051U},
+    {2393627842544570617U, 1661534994731144841U},
+    {16672297533003297786U, 1329227995784915872U},
+    {11918280793837635165U, 2126764793255865396U},
+    {5845275820328197809U, 1701411834604692317U},
+    {15744267100488289217U, 1361129467683753853U},
+    {3054734472329800808U, 2177807148294006166U},
+    {17201182836831481939U, 1742245718635204932U},
+    {6382248639981364905U, 1393796574908163946U},
+    {2832900194486363201U, 2230074519853062314U},
+    {5955668970331000884U, 1784059615882449851U},
+    {1075186361522890384U, 1427247692705959881U},
+    {12788344622662355584U, 2283596308329535809U},
+    {13920024512871794791U, 1826877046663628647U},
+    {3757321980813615186U, 1461501637330902918U},
+    {10384555214134712795U, 1169201309864722334U},
+    {5547241898389809503U, 1870722095783555735U},
+    {4437793518711847602U, 1496577676626844588U},
+    {10928932444453298728U, 1197262141301475670U},
+    {17486291911125277965U, 1915619426082361072U},
+    {6610335899416401726U, 1532495540865888858U},
+    {12666966349016942027U, 1225996432692711086U},
+    {12888448528943286597U, 1961594292308337738U},
+    {17689456452638449924U, 1569275433846670190U},
+    {14151565162110759939U, 1255420347077336152U},
+    {7885109000409574610U, 2008672555323737844U},
+    {9997436015069570011U, 1606938044258990275U},
+    {7997948812055656009U, 1285550435407192220U},
+    {12796718099289049614U, 2056880696651507552U},
+    {2858676849947419045U, 1645504557321206042U},
+    {13354987924183666206U, 1316403645856964833U},
+    {17678631863951955605U, 2106245833371143733U},
+    {3074859046935833515U, 1684996666696914987U},
+    {13527933681774397782U, 1347997333357531989U},
+    {10576647446613305481U, 2156795733372051183U},
+    {15840015586774465031U, 1725436586697640946U},
+    {8982663654677661702U, 1380349269358112757U},
+    {18061610662226169046U, 2208558830972980411U},
+    {10759939715039024913U, 1766847064778384329U},
+    {12297300586773130254U, 1413477651822707463U},
+    {15986332124095098083U, 2261564242916331941U},
+    {9099716884534168143U, 1809251394333065553U},
+    {14658471137111155161U, 1447401115466452442U},
+    {4348079280205103483U, 1157920892373161954U},
+    {14335624477811986218U, 1852673427797059126U},
+    {7779150767507678651U, 1482138742237647301U},
+    {2533971799264232598U, 1185710993790117841U},
+    {15122401323048503126U, 1897137590064188545U},
+    {12097921058438802501U, 1517710072051350836U},
+    {5988988032009131678U, 1214168057641080669U},
+    {16961078480698431330U, 1942668892225729070U},
+    {13568862784558745064U, 1554135113780583256U},
+    {7165741412905085728U, 1243308091024466605U},
+    {11465186260648137165U, 1989292945639146568U},
+    {16550846638002330379U, 1591434356511317254U},
+    {16930026125143774626U, 1273147485209053803U},
+    {4951948911778577463U, 2037035976334486086U},
+    {272210314680951647U, 1629628781067588869U},
+    {3907117066486671641U, 1303703024854071095U},
+    {6251387306378674625U, 2085924839766513752U},
+    {16069156289328670670U, 1668739871813211001U},
+    {9165976216721026213U, 1334991897450568801U},
+    {7286864317269821294U, 2135987035920910082U},
+    {16897537898041588005U, 1708789628736728065U},
+    {13518030318433270404U, 1367031702989382452U},
+    {6871453250525591353U, 2187250724783011924U},
+    {9186511415162383406U, 1749800579826409539U},
+    {11038557946871817048U, 1399840463861127631U},
+    {10282995085511086630U, 2239744742177804210U},
+    {8226396068408869304U, 1791795793742243368U},
+    {13959814484210916090U, 1433436634993794694U},
+    {11267656730511734774U, 2293498615990071511U},
+    {5324776569667477496U, 1834798892792057209U},
+    {7949170070475892320U, 1467839114233645767U},
+    {17427382500606444826U, 1174271291386916613U},
+    {5747719112518849781U, 1878834066219066582U},
+    {15666221734240810795U, 1503067252975253265U},
+    {12532977387392648636U, 1202453802380202612U},
+    {5295368560860596524U, 1923926083808324180U},
+    {4236294848688477220U, 1539140867046659344U},
+    {7078384693692692099U, 1231312693637327475U},
+    {11325415509908307358U, 1970100309819723960U},
+    {9060332407926645887U, 1576080247855779168U},
+    {14626963555825137356U, 1260864198284623334U},
+    {12335095245094488799U, 2017382717255397335U},
+    {9868076196075591040U, 1613906173804317868U},
+    {15273158586344293478U, 1291124939043454294U},
+    {13369007293925138595U, 2065799902469526871U},
+    {7005857020398200553U, 1652639921975621497U},
+    {16672732060544291412U, 1322111937580497197U},
+    {11918976037903224966U, 2115379100128795516U},
+    {5845832015580669650U, 1692303280103036413U},
+    {12055363241948356366U, 1353842624082429130U},
+    {841837113407818570U, 2166148198531886609U},
+    {4362818505468165179U, 1732918558825509287U},
+    {14558301248600263113U, 1386334847060407429U},
+    {12225235553534690011U, 2218135755296651887U},
+    {2401490813343931363U, 1774508604237321510U},
+    {1921192650675145090U, 1419606883389857208U},
+    {17831303500047873437U, 2271371013423771532U},
+    {6886345170554478103U, 1817096810739017226U},
+    {1819727321701672159U, 1453677448591213781U},
+    {16213177116328979020U, 1162941958872971024U},
+    {14873036941900635463U, 1860707134196753639U},
+    {15587778368262418694U, 1488565707357402911U},
+    {8780873879868024632U, 1190852565885922329U},
+    {2981351763563108441U, 1905364105417475727U},
+    {13453127855076217722U, 1524291284333980581U},
+    {7073153469319063855U, 1219433027467184465U},
+    {11317045550910502167U, 1951092843947495144U},
+    {12742985255470312057U, 1560874275157996115U},
+    {10194388204376249646U, 1248699420126396892U},
+    {1553625868034358140U, 1997919072202235028U},
+    {8621598323911307159U, 1598335257761788022U},
+    {17965325103354776697U, 1278668206209430417U},
+    {13987124906400001422U, 2045869129935088668U},
+    {121653480894270168U, 1636695303948070935U},
+    {97322784715416134U, 1309356243158456748U},
+    {14913111714512307107U, 2094969989053530796U},
+    {8241140556867935363U, 1675975991242824637U},
+    {17660958889720079260U, 1340780792994259709U},
+    {17189487779326395846U, 2145249268790815535U},
+    {13751590223461116677U, 1716199415032652428U},
+    {18379969808252713988U, 1372959532026121942U},
+    {14650556434236701088U, 2196735251241795108U},
+    {652398703163629901U, 1757388200993436087U},
+    {11589965406756634890U, 1405910560794748869U},
+    {7475898206584884855U, 2249456897271598191U},
+    {2291369750525997561U, 1799565517817278553U},
+    {9211793429904618695U, 1439652414253822842U},
+    {18428218302589300235U, 2303443862806116547U},
+    {7363877012587619542U, 1842755090244893238U},
+    {13269799239553916280U, 1474204072195914590U},
+    {10615839391643133024U, 1179363257756731672U},
+    {2227947767661371545U, 1886981212410770676U},
+    {16539753473096738529U, 1509584969928616540U},
+    {13231802778477390823U, 1207667975942893232U},
+    {6413489186596184024U, 1932268761508629172U},
+    {16198837793502678189U, 1545815009206903337U},
+    {5580372605318321905U, 1236652007365522670U},
+    {8928596168509315048U, 1978643211784836272U},
+    {18210923379033183008U, 1582914569427869017U},
+    {7190041073742725760U, 1266331655542295214U},
+    {436019273762630246U, 2026130648867672343U},
+    {7727513048493924843U, 1620904519094137874U},
+    {9871359253537050198U, 1296723615275310299U},
+    {4726128361433549347U, 2074757784440496479U},
+    {7470251503888749801U, 1659806227552397183U},
+    {13354898832594820487U, 1327844982041917746U},
+    {13989140502667892133U, 2124551971267068394U},
+    {14880661216876224029U, 1699641577013654715U},
+    {11904528973500979224U, 1359713261610923772U},
+    {4289851098633925465U, 2175541218577478036U},
+    {18189276137874781665U, 1740432974861982428U},
+    {3483374466074094362U, 1392346379889585943U},
+    {1884050330976640656U, 2227754207823337509U},
+    {5196589079523222848U, 1782203366258670007U},
+    {15225317707844309248U, 1425762693006936005U},
+    {5913764258841343181U, 2281220308811097609U},
+    {8420360221814984868U, 1824976247048878087U},
+    {17804334621677718864U, 1459980997639102469U},
+    {17932816512084085415U, 1167984798111281975U},
+    {10245762345624985047U, 1868775676978051161U},
+    {4507261061758077715U, 1495020541582440929U},
+    {7295157664148372495U, 1196016433265952743U},
+    {7982903447895485668U, 1913626293225524389U},
+    {10075671573058298858U, 1530901034580419511U},
+    {4371188443704728763U, 1224720827664335609U},
+    {14372599139411386667U, 1959553324262936974U},
+    {15187428126271019657U, 1567642659410349579U},
+    {15839291315758726049U, 1254114127528279663U},
+    {3206773216762499739U, 2006582604045247462U},
+    {13633465017635730761U, 1605266083236197969U},
+    {14596120828850494932U, 1284212866588958375U},
+    {4907049252451240275U, 2054740586542333401U},
+    {236290587219081897U, 1643792469233866721U},
+    {14946427728742906810U, 1315033975387093376U},
+    {16535586736504830250U, 2104054360619349402U},
+    {5849771759720043554U, 1683243488495479522U},
+    {15747863852001765813U, 1346594790796383617U},
+    {10439186904235184007U, 2154551665274213788U},
+    {15730047152871967852U, 1723641332219371030U},
+    {12584037722297574282U, 1378913065775496824U},
+    {9066413911450387881U, 2206260905240794919U},
+    {10942479943902220628U, 1765008724192635935U},
+    {8753983955121776503U, 1412006979354108748U},
+    {10317025513452932081U, 2259211166966573997U},
+    {874922781278525018U, 1807368933573259198U},
+    {8078635854506640661U, 1445895146858607358U},
+    {13841606313089133175U, 1156716117486885886U},
+    {14767872471458792434U, 1850745787979017418U},
+    {746251532941302978U, 1480596630383213935U},
+    {597001226353042382U, 1184477304306571148U},
+    {15712597221132509104U, 1895163686890513836U},
+    {8880728962164096960U, 1516130949512411069U},
+    {10793931984473187891U, 1212904759609928855U},
+    {17270291175157100626U, 1940647615375886168U},
+    {2748186495899949531U, 1552518092300708935U},
+    {2198549196719959625U, 1242014473840567148U},
+    {18275073973719576693U, 1987223158144907436U},
+    {10930710364233751031U, 1589778526515925949U},
+    {12433917106128911148U, 1271822821212740759U},
+    {8826220925580526867U, 2034916513940385215U},
+    {7060976740464421494U, 1627933211152308172U},
+    {16716827836597268165U, 1302346568921846537U},
+    {11989529279587987770U, 2083754510274954460U},
+    {9591623423670390216U, 1667003608219963568U},
+    {15051996368420132820U, 1333602886575970854U},
+    {13015147745246481542U, 2133764618521553367U},
+    {3033420566713364587U, 1707011694817242694U},
+    {6116085268112601993U, 1365609355853794155U},
+    {9785736428980163188U, 2184974969366070648U},
+    {15207286772667951197U, 1747979975492856518U},
+    {1097782973908629988U, 1398383980394285215U},
+    {1756452758253807981U, 2237414368630856344U},
+    {5094511021344956708U, 1789931494904685075U},
+    {4075608817075965366U, 1431945195923748060U},
+    {6520974107321544586U, 2291112313477996896U},
+    {1527430471115325346U, 1832889850782397517U},
+    {12289990821117991246U, 1466311880625918013U},
+    {17210690286378213644U, 1173049504500734410U},
+    {9090360384495590213U, 1876879207201175057U},
+    {18340334751822203140U, 1501503365760940045U},
+    {14672267801457762512U, 1201202692608752036U},
+    {16096930852848599373U, 1921924308174003258U},
+    {1809498238053148529U, 1537539446539202607U},
+    {12515645034668249793U, 1230031557231362085U},
+    {1578287981759648052U, 1968050491570179337U},
+    {12330676829633449412U, 1574440393256143469U},
+    {13553890278448669853U, 1259552314604914775U},
+    {3239480371808320148U, 2015283703367863641U},
+    {17348979556414297411U, 1612226962694290912U},
+    {6500486015647617283U, 1289781570155432730U},
+    {10400777625036187652U, 2063650512248692368U},
+    {15699319729512770768U, 1650920409798953894U},
+    {16248804598352126938U, 1320736327839163115U},
+    {7551343283653851484U, 2113178124542660985U},
+    {6041074626923081187U, 1690542499634128788U},
+    {12211557331022285596U, 1352433999707303030U},
+    {1091747655926105338U, 2163894399531684849U},
+    {4562746939482794594U, 1731115519625347879U},
+    {7339546366328145998U, 1384892415700278303U},
+    {8053925371383123274U, 2215827865120445285U},
+    {6443140297106498619U, 1772662292096356228U},
+    {12533209867169019542U, 1418129833677084982U},
+    {5295740528502789974U, 2269007733883335972U},
+    {15304638867027962949U, 1815206187106668777U},
+    {4865013464138549713U, 1452164949685335022U},
+    {14960057215536570740U, 1161731959748268017U},
+    {9178696285890871890U, 1858771135597228828U},
+    {14721654658196518159U, 1487016908477783062U},
+    {4398626097073393881U, 1189613526782226450U},
+    {7037801755317430209U, 1903381642851562320U},
+    {5630241404253944167U, 1522705314281249856U},
+    {814844308661245011U, 1218164251424999885U},
+    {1303750893857992017U, 1949062802279999816U},
+    {15800395974054034906U, 1559250241823999852U},
+    {5261619149759407279U, 1247400193459199882U},
+    {12107939454356961969U, 1995840309534719811U},
+    {5997002748743659252U, 1596672247627775849U},
+    {8486951013736837725U, 1277337798102220679U},
+    {2511075177753209390U, 2043740476963553087U},
+    {13076906586428298482U, 1634992381570842469U},
+    {14150874083884549109U, 1307993905256673975U},
+    {4194654460505726958U, 2092790248410678361U},
+    {18113118827372222859U, 1674232198728542688U},
+    {3422448617672047318U, 1339385758982834151U},
+    {16543964232501006678U, 2143017214372534641U},
+    {9545822571258895019U, 1714413771498027713U},
+    {15015355686490936662U, 1371531017198422170U},
+    {5577825024675947042U, 2194449627517475473U},
+    {11840957649224578280U, 1755559702013980378U},
+    {16851463748863483271U, 1404447761611184302U},
+    {12204946739213931940U, 2247116418577894884U},
+    {13453306206113055875U, 1797693134862315907U},
+    {3383947335406624054U, 1438154507889852726U},
+    {16482362180876329456U, 2301047212623764361U},
+    {9496540929959153242U, 1840837770099011489U},
+    {11286581558709232917U, 1472670216079209191U},
+    {5339916432225476010U, 1178136172863367353U},
+    {4854517476818851293U, 1885017876581387765U},
+    {3883613981455081034U, 1508014301265110212U},
+    {14174937629389795797U, 1206411441012088169U},
+    {11611853762797942306U, 1930258305619341071U},
+    {5600134195496443521U, 1544206644495472857U},
+    {15548153800622885787U, 1235365315596378285U},
+    {6430302007287065643U, 1976584504954205257U},
+    {16212288050055383484U, 1581267603963364205U},
+    {12969830440044306787U, 1265014083170691364U},
+    {9683682259845159889U, 2024022533073106183U},
+    {15125643437359948558U, 1619218026458484946U},
+    {8411165935146048523U, 1295374421166787957U},
+    {17147214310975587960U, 2072599073866860731U},
+    {10028422634038560045U, 1658079259093488585U},
+    {8022738107230848036U, 1326463407274790868U},
+    {9147032156827446534U, 2122341451639665389U},
+    {11006974540203867551U, 1697873161311732311U},
+    {5116230817421183718U, 1358298529049385849U},
+    {15564666937357714594U, 2173277646479017358U},
+    {1383687105660440706U, 1738622117183213887U},
+    {12174996128754083534U, 1390897693746571109U},
+    {8411947361780802685U, 2225436309994513775U},
+    {6729557889424642148U, 1780349047995611020U},
+    {5383646311539713719U, 1424279238396488816U},
+    {1235136468979721303U, 2278846781434382106U},
+    {15745504434151418335U, 1823077425147505684U},
+    {16285752362063044992U, 1458461940118004547U},
+    {5649904260166615347U, 1166769552094403638U},
+    {5350498001524674232U, 1866831283351045821U},
+    {591049586477829062U, 1493465026680836657U},
+    {11540886113407994219U, 1194772021344669325U},
+    {18673707743239135U, 1911635234151470921U},
+    {14772334225162232601U, 1529308187321176736U},
+    {8128518565387875758U, 1223446549856941389U},
+    {1937583260394870242U, 1957514479771106223U},
+    {8928764237799716840U, 1566011583816884978U},
+    {14521709019723594119U, 1252809267053507982U},
+    {8477339172590109297U, 2004494827285612772U},
+    {17849917782297818407U, 1603595861828490217U},
+    {6901236596354434079U, 1282876689462792174U},
+    {18420676183650915173U, 2052602703140467478U},
+    {3668494502695001169U, 1642082162512373983U},
+    {10313493231639821582U, 1313665730009899186U},
+    {9122891541139893884U, 2101865168015838698U},
+    {14677010862395735754U, 1681492134412670958U},
+    {673562245690857633U, 1345193707530136767U},
+};
+
+static const JSON_UINT64 DOUBLE_POW5_SPLIT[DOUBLE_POW5_TABLE_SIZE][2] = {
+    {0U, 1152921504606846976U},
+    {0U, 1441151880758558720U},
+    {0U, 1801439850948198400U},
+    {0U, 2251799813685248000U},
+    {0U, 1407374883553280000U},
+    {0U, 1759218604441600000U},
+    {0U, 2199023255552000000U},
+    {0U, 1374389534720000000U},
+    {0U, 1717986918400000000U},
+    {0U, 2147483648000000000U},
+    {0U, 1342177280000000000U},
+    {0U, 1677721600000000000U},
+    {0U, 2097152000000000000U},
+    {0U, 1310720000000000000U},
+    {0U, 1638400000000000000U},
+    {0U, 2048000000000000000U},
+    {0U, 1280000000000000000U},
+    {0U, 1600000000000000000U},
+    {0U, 2000000000000000000U},
+    {0U, 1250000000000000000U},
+    {0U, 1562500000000000000U},
+    {0U, 1953125000000000000U},
+    {0U, 1220703125000000000U},
+    {0U, 1525878906250000000U},
+    {0U, 1907348632812500000U},
+    {0U, 1192092895507812500U},
+    {0U, 1490116119384765625U},
+    {4611686018427387904U, 1862645149230957031U},
+    {9799832789158199296U, 1164153218269348144U},
+    {12249790986447749120U, 1455191522836685180U},
+    {15312238733059686400U, 1818989403545856475U},
+    {14528612397897220096U, 2273736754432320594U},
+    {13692068767113150464U, 1421085471520200371U},
+    {12503399940464050176U, 1776356839400250464U},
+    {15629249925580062720U, 2220446049250313080U},
+    {9768281203487539200U, 1387778780781445675U},
+    {7598665485932036096U, 1734723475976807094U},
+    {274959820560269312U, 2168404344971008868U},
+    {9395221924704944128U, 1355252715606880542U},
+    {2520655369026404352U, 1694065894508600678U},
+    {12374191248137781248U, 2117582368135750847U},
+    {14651398557727195136U, 1323488980084844279U},
+    {13702562178731606016U, 1654361225106055349U},
+    {3293144668132343808U, 2067951531382569187U},
+    {18199116482078572544U, 1292469707114105741U},
+    {8913837547316051968U, 1615587133892632177U},
+    {15753982952572452864U, 2019483917365790221U},
+    {12152082354571476992U, 1262177448353618888U},
+    {15190102943214346240U, 1577721810442023610U},
+    {9764256642163156992U, 1972152263052529513U},
+    {17631875447420442880U, 1232595164407830945U},
+    {8204786253993389888U, 1540743955509788682U},
+    {1032610780636961552U, 1925929944387235853U},
+    {2951224747111794922U, 1203706215242022408U},
+    {3689030933889743652U, 1504632769052528010U},
+    {13834660704216955373U, 1880790961315660012U},
+    {17870034976990372916U, 1175494350822287507U},
+    {17725857702810578241U, 1469367938527859384U},
+    {3710578054803671186U, 1836709923159824231U},
+    {26536550077201078U, 2295887403949780289U},
+    {11545800389866720434U, 1434929627468612680U},
+    {14432250487333400542U, 1793662034335765850U},
+    {8816941072311974870U, 2242077542919707313U},
+    {17039803216263454053U, 1401298464324817070U},
+    {12076381983474541759U, 1751623080406021338U},
+    {5872105442488401391U, 2189528850507526673U},
+    {15199280947623720629U, 1368455531567204170U},
+    {9775729147674874978U, 1710569414459005213U},
+    {16831347453020981627U, 2138211768073756516U},
+    {1296220121283337709U, 1336382355046097823U},
+    {15455333206886335848U, 1670477943807622278U},
+    {10095794471753144002U, 2088097429759527848U},
+    {6309871544845715001U, 1305060893599704905U},
+    {12499025449484531656U, 1631326116999631131U},
+    {11012095793428276666U, 2039157646249538914U},
+    {11494245889320060820U, 1274473528905961821U},
+    {532749306367912313U, 1593091911132452277U},
+    {5277622651387278295U, 1991364888915565346U},
+    {7910200175544436838U, 1244603055572228341U},
+    {14499436237857933952U, 1555753819465285426U},
+    {8900923260467641632U, 1944692274331606783U},
+    {12480606065433357876U, 1215432671457254239U},
+    {10989071563364309441U, 1519290839321567799U},
+    {9124653435777998898U, 1899113549151959749U},
+    {8008751406574943263U, 1186945968219974843U},
+    {5399253239791291175U, 1483682460274968554U},
+    {15972438586593889776U, 1854603075343710692U},
+    {759402079766405302U, 1159126922089819183U},
+    {14784310654990170340U, 1448908652612273978U},
+    {9257016281882937117U, 1811135815765342473U},
+    {16182956370781059300U, 2263919769706678091U},
+    {7808504722524468110U, 1414949856066673807U},
+    {5148944884728197234U, 1768687320083342259U},
+    {1824495087482858639U, 2210859150104177824U},
+    {1140309429676786649U, 1381786968815111140U},
+    {1425386787095983311U, 1727233711018888925U},
+    {6393419502297367043U, 2159042138773611156U},
+    {13219259225790630210U, 1349401336733506972U},
+    {16524074032238287762U, 1686751670916883715U},
+    {16043406521870471799U, 2108439588646104644U},
+    {803757039314269066U, 1317774742903815403U},
+    {14839754354425000045U, 1647218428629769253U},
+    {4714634887749086344U, 2059023035787211567U},
+    {9864175832484260821U, 1286889397367007229U},
+    {16941905809032713930U, 1608611746708759036U},
+    {2730638187581340797U, 2010764683385948796U},
+    {10930020904093113806U, 1256727927116217997U},
+    {18274212148543780162U, 1570909908895272496U},
+    {4396021111970173586U, 1963637386119090621U},
+    {5053356204195052443U, 1227273366324431638U},
+    {15540067292098591362U, 1534091707905539547U},
+    {14813398096695851299U, 1917614634881924434U},
+    {13870059828862294966U, 1198509146801202771U},
+    {12725888767650480803U, 1498136433501503464U},
+    {15907360959563101004U, 1872670541876879330U},
+    {14553786618154326031U, 1170419088673049581U},
+    {4357175217410743827U, 1463023860841311977U},
+    {10058155040190817688U, 1828779826051639971U},
+    {7961007781811134206U, 2285974782564549964U},
+    {14199001900486734687U, 1428734239102843727U},
+    {13137066357181030455U, 1785917798878554659U},
+    {11809646928048900164U, 2232397248598193324U},
+    {16604401366885338411U, 1395248280373870827U},
+    {16143815690179285109U, 1744060350467338534U},
+    {10956397575869330579U, 2180075438084173168U},
+    {6847748484918331612U, 1362547148802608230U},
+    {17783057643002690323U, 1703183936003260287U},
+    {17617136035325974999U, 2128979920004075359U},
+    {17928239049719816230U, 1330612450002547099U},
+    {17798612793722382384U, 1663265562503183874U},
+    {13024893955298202172U, 2079081953128979843U},
+    {5834715712847682405U, 1299426220705612402U},
+    {16516766677914378815U, 1624282775882015502U},
+    {11422586310538197711U, 2030353469852519378U},
+    {11750802462513761473U, 1268970918657824611U},
+    {10076817059714813937U, 1586213648322280764U},
+    {12596021324643517422U, 1982767060402850955U},
+    {5566670318688504437U, 1239229412751781847U},
+    {2346651879933242642U, 1549036765939727309U},
+    {7545000868343941206U, 1936295957424659136U},
+    {4715625542714963254U, 1210184973390411960U},
+    {5894531928393704067U, 1512731216738014950U},
+    {16591536947346905892U, 1890914020922518687U},
+    {17287239619732898039U, 1181821263076574179U},
+    {16997363506238734644U, 1477276578845717724U},
+    {2799960309088866689U, 1846595723557147156U},
+    {10973347230035317489U, 1154122327223216972U},
+    {13716684037544146861U, 1442652909029021215U},
+    {12534169028502795672U, 1803316136286276519U},
+    {11056025267201106687U, 2254145170357845649U},
+    {18439230838069161439U, 1408840731473653530U},
+    {13825666510731675991U, 1761050914342066913U},
+    {3447025083132431277U, 2201313642927583642U},
+    {6766076695385157452U, 1375821026829739776U},
+    {8457595869231446815U, 1719776283537174720U},
+    {10571994836539308519U, 2149720354421468400U},
+    {6607496772837067824U, 1343575221513417750U},
+    {17482743002901110588U, 1679469026891772187U},
+    {17241742735199000331U, 2099336283614715234U},
+    {15387775227926763111U, 1312085177259197021U},
+    {5399660979626290177U, 1640106471573996277U},
+    {11361262242960250625U, 2050133089467495346U},
+    {11712474920277544544U, 1281333180917184591U},
+    {10028907631919542777U, 1601666476146480739U},
+    {7924448521472040567U, 2002083095183100924U},
+    {14176152362774801162U, 1251301934489438077U},
+    {3885132398186337741U, 1564127418111797597U},
+    {9468101516160310080U, 1955159272639746996U},
+    {15140935484454969608U, 1221974545399841872U},
+    {479425281859160394U, 1527468181749802341U},
+    {5210967620751338397U, 1909335227187252926U},
+    {17091912818251750210U, 1193334516992033078U},
+    {12141518985959911954U, 1491668146240041348U},
+    {15176898732449889943U, 1864585182800051685U},
+    {11791404716994875166U, 1165365739250032303U},
+    {10127569877816206054U, 1456707174062540379U},
+    {8047776328842869663U, 1820883967578175474U},
+    {836348374198811271U, 2276104959472719343U},
+    {7440246761515338900U, 1422565599670449589U},
+    {13911994470321561530U, 1778206999588061986U},
+    {8166621051047176104U, 2222758749485077483U},
+    {2798295147690791113U, 1389224218428173427U},
+    {17332926989895652603U, 1736530273035216783U},
+    {17054472718942177850U, 2170662841294020979U},
+    {8353202440125167204U, 1356664275808763112U},
+    {10441503050156459005U, 1695830344760953890U},
+    {3828506775840797949U, 2119787930951192363U},
+    {86973725686804766U, 1324867456844495227U},
+    {13943775212390669669U, 1656084321055619033U},
+    {3594660960206173375U, 2070105401319523792U},
+    {2246663100128858359U, 1293815875824702370U},
+    {12031700912015848757U, 1617269844780877962U},
+    {5816254103165035138U, 2021587305976097453U},
+    {5941001823691840913U, 1263492066235060908U},
+    {7426252279614801142U, 1579365082793826135U},
+    {4671129331091113523U, 1974206353492282669U},
+    {5225298841145639904U, 1233878970932676668U},
+    {6531623551432049880U, 1542348713665845835U},
+    {3552843420862674446U, 1927935892082307294U},
+    {16055585193321335241U, 1204959932551442058U},
+    {10846109454796893243U, 1506199915689302573U},
+    {18169322836923504458U, 1882749894611628216U},
+    {11355826773077190286U, 1176718684132267635U},
+    {9583097447919099954U, 1470898355165334544U},
+    {11978871809898874942U, 1838622943956668180U},
+    {14973589762373593678U, 2298278679945835225U},
+    {2440964573842414192U, 1436424174966147016U},
+    {3051205717303017741U, 1795530218707683770U},
+    {13037379183483547984U, 2244412773384604712U},
+    {8148361989677217490U, 1402757983365377945U},
+    {14797138505523909766U, 1753447479206722431U},
+    {13884737113477499304U, 2191809349008403039U},
+    {15595489723564518921U, 1369880843130251899U},
+    {14882676136028260747U, 1712351053912814874U},
+    {9379973133180550126U, 2140438817391018593U},
+    {17391698254306313589U, 1337774260869386620U},
+    {3292878744173340370U, 1672217826086733276U},
+    {4116098430216675462U, 2090272282608416595U},
+    {266718509671728212U, 1306420176630260372U},
+    {333398137089660265U, 1633025220787825465U},
+    {5028433689789463235U, 2041281525984781831U},
+    {10060300083759496378U, 1275800953740488644U},
+    {12575375104699370472U, 1594751192175610805U},
+    {1884160825592049379U, 1993438990219513507U},
+    {17318501580490888525U, 1245899368887195941U},
+    {7813068920331446945U, 1557374211108994927U},
+    {5154650131986920777U, 1946717763886243659U},
+    {915813323278131534U, 1216698602428902287U},
+    {14979824709379828129U, 1520873253036127858U},
+    {9501408849870009354U, 1901091566295159823U},
+    {12855909558809837702U, 1188182228934474889U},
+    {2234828893230133415U, 1485227786168093612U},
+    {2793536116537666769U, 1856534732710117015U},
+    {8663489100477123587U, 1160334207943823134U},
+    {1605989338741628675U, 1450417759929778918U},
+    {11230858710281811652U, 1813022199912223647U},
+    {9426887369424876662U, 2266277749890279559U},
+    {12809333633531629769U, 1416423593681424724U},
+    {16011667041914537212U, 1770529492101780905U},
+    {6179525747111007803U, 2213161865127226132U},
+    {13085575628799155685U, 1383226165704516332U},
+    {16356969535998944606U, 1729032707130645415U},
+    {15834525901571292854U, 2161290883913306769U},
+    {2979049660840976177U, 1350806802445816731U},
+    {17558870131333383934U, 1688508503057270913U},
+    {8113529608884566205U, 2110635628821588642U},
+    {9682642023980241782U, 1319147268013492901U},
+    {16714988548402690132U, 1648934085016866126U},
+    {11670363648648586857U, 2061167606271082658U},
+    {11905663298832754689U, 1288229753919426661U},
+    {1047021068258779650U, 1610287192399283327U},
+    {15143834390605638274U, 2012858990499104158U},
+    {4853210475701136017U, 1258036869061940099U},
+    {1454827076199032118U, 1572546086327425124U},
+    {1818533845248790147U, 1965682607909281405U},
+    {3442426662494187794U, 1228551629943300878U},
+    {13526405364972510550U, 1535689537429126097U},
+    {3072948650933474476U, 1919611921786407622U},
+    {15755650962115585259U, 1199757451116504763U},
+    {15082877684217093670U, 1499696813895630954U},
+    {9630225068416591280U, 1874621017369538693U},
+    {8324733676974063502U, 1171638135855961683U},
+    {5794231077790191473U, 1464547669819952104U},
+    {7242788847237739342U, 1830684587274940130U},
+    {18276858095901949986U, 2288355734093675162U},
+    {16034722328366106645U, 1430222333808546976U},
+    {1596658836748081690U, 1787777917260683721U},
+    {6607509564362490017U, 2234722396575854651U},
+    {1823850468512862308U, 1396701497859909157U},
+    {6891499104068465790U, 1745876872324886446U},
+    {17837745916940358045U, 2182346090406108057U},
+    {4231062170446641922U, 1363966306503817536U},
+    {5288827713058302403U, 1704957883129771920U},
+    {6611034641322878003U, 2131197353912214900U},
+    {13355268687681574560U, 1331998346195134312U},
+    {16694085859601968200U, 1664997932743917890U},
+    {11644235287647684442U, 2081247415929897363U},
+    {4971804045566108824U, 1300779634956185852U},
+    {6214755056957636030U, 1625974543695232315U},
+    {3156757802769657134U, 2032468179619040394U},
+    {6584659645158423613U, 1270292612261900246U},
+    {17454196593302805324U, 1587865765327375307U},
+    {17206059723201118751U, 1984832206659219134U},
+    {6142101308573311315U, 1240520129162011959U},
+    {3065940617289251240U, 1550650161452514949U},
+    {8444111790038951954U, 1938312701815643686U},
+    {665883850346957067U, 1211445438634777304U},
+    {832354812933696334U, 1514306798293471630U},
+    {10263815553021896226U, 1892883497866839537U},
+    {17944099766707154901U, 1183052186166774710U},
+    {13206752671529167818U, 1478815232708468388U},
+    {16508440839411459773U, 1848519040885585485U},
+    {12623618533845856310U, 1155324400553490928U},
+    {15779523167307320387U, 1444155500691863660U},
+    {1277659885424598868U, 1805194375864829576U},
+    {1597074856780748586U, 2256492969831036970U},
+    {5609857803915355770U, 1410308106144398106U},
+    {16235694291748970521U, 1762885132680497632U},
+    {1847873790976661535U, 2203606415850622041U},
+    {12684136165428883219U, 1377254009906638775U},
+    {11243484188358716120U, 1721567512383298469U},
+    {219297180166231438U, 2151959390479123087U},
+    {7054589765244976505U, 1344974619049451929U},
+    {13429923224983608535U, 1681218273811814911U},
+    {12175718012802122765U, 2101522842264768639U},
+    {14527352785642408584U, 1313451776415480399U},
+    {13547504963625622826U, 1641814720519350499U},
+    {12322695186104640628U, 2052268400649188124U},
+    {16925056528170176201U, 1282667750405742577U},
+    {7321262604930556539U, 1603334688007178222U},
+    {18374950293017971482U, 2004168360008972777U},
+    {4566814905495150320U, 1252605225005607986U},
+    {14931890668723713708U, 1565756531257009982U},
+    {9441491299049866327U, 1957195664071262478U},
+    {1289246043478778550U, 1223247290044539049U},
+    {6223243572775861092U, 1529059112555673811U},
+    {3167368447542438461U, 1911323890694592264U},
+    {1979605279714024038U, 1194577431684120165U},
+    {7086192618069917952U, 1493221789605150206U},
+    {18081112809442173248U, 1866527237006437757U},
+    {13606538515115052232U, 1166579523129023598U},
+    {7784801107039039482U, 1458224403911279498U},
+    {507629346944023544U, 1822780504889099373U},
+    {5246222702107417334U, 2278475631111374216U},
+    {3278889188817135834U, 1424047269444608885U},
+    {8710297504448807696U, 1780059086805761106U},
+};
+
+/* 5**q for -342 <= q <= 308, normalized so bit 127 is set and truncated to
+   128 bits (rounded up for q < 0), stored as {high, low}.  Generated with:
+
+    for q in range(-342, 309):
+        if q < 0:
+            z = (5 ** -q - 1).bit_length()
+            b = z + 127 if q >= -27 else 2 * z + 128
+            v = (1 << b) // 5 ** -q + 1
+        else:
+            v = 5 ** q
+        while v < 1 << 127:
+            v <<= 1
+        while v >= 1 << 128:
+            v >>= 1
+*/
+
+#define POW5_128_MIN_EXPONENT -342
+#define POW5_128_MAX_EXPONENT 308
+
+static const JSON_UINT64 POW5_128[POW5_128_MAX_EXPONENT - POW5_128_MIN_EXPONENT + 1][2] = {
+    {17218479456385750618U, 1242899115359157055U},
+    {10761549660241094136U, 5388497965526861063U},
+    {13451937075301367670U, 6735622456908576329U},
+    {16814921344126709587U, 17642900107990496220U},
+    {10509325840079193492U, 8720969558280366185U},
+    {13136657300098991865U, 10901211947850457732U},
+    {16420821625123739831U, 18238200953240460069U},
+    {10263013515702337394U, 18316404623416369399U},
+    {12828766894627921743U, 13672133742415685941U},
+    {16035958618284902179U, 12478481159592219522U},
+    {10022474136428063862U, 5493207715531443249U},
+    {12528092670535079827U, 16089881681269079869U},
+    {15660115838168849784U, 15500666083158961933U},
+    {9787572398855531115U, 9687916301974351208U},
+    {12234465498569413894U, 7498209359040551106U},
+    {15293081873211767368U, 149389661945913074U},
+    {9558176170757354605U, 93368538716195671U},
+    {11947720213446693256U, 4728396691822632493U},
+    {14934650266808366570U, 5910495864778290617U},
+    {9334156416755229106U, 8305745933913819539U},
+    {11667695520944036383U, 1158810380537498616U},
+    {14584619401180045478U, 15283571030954036982U},
+    {18230774251475056848U, 9881091751837770420U},
+    {11394233907171910530U, 6175682344898606512U},
+    {14242792383964888162U, 16942974967978033949U},
+    {17803490479956110203U, 11955346673117766628U},
+    {11127181549972568877U, 5166248661484910190U},
+    {13908976937465711096U, 11069496845283525642U},
+    {17386221171832138870U, 13836871056604407053U},
+    {10866388232395086794U, 4036358391950366504U},
+    {13582985290493858492U, 14268820026792733938U},
+    {16978731613117323115U, 17836025033490917422U},
+    {10611707258198326947U, 8841672636718129437U},
+    {13264634072747908684U, 6440404777470273892U},
+    {16580792590934885855U, 8050505971837842365U},
+    {10362995369334303659U, 11949095260039733334U},
+    {12953744211667879574U, 10324683056622278764U},
+    {16192180264584849468U, 3682481783923072647U},
+    {10120112665365530917U, 11524923151806696212U},
+    {12650140831706913647U, 571095884476206553U},
+    {15812676039633642058U, 14548927910877421904U},
+    {9882922524771026286U, 13704765962725776594U},
+    {12353653155963782858U, 7907585416552444934U},
+    {15442066444954728573U, 661109733835780360U},
+    {9651291528096705358U, 2719036592861056677U},
+    {12064114410120881697U, 12622167777931096654U},
+    {15080143012651102122U, 1942651667131707105U},
+    {9425089382906938826U, 5825843310384704845U},
+    {11781361728633673532U, 16505676174835656864U},
+    {14726702160792091916U, 2185351144835019464U},
+    {18408377700990114895U, 2731688931043774330U},
+    {11505236063118821809U, 8624834609543440812U},
+    {14381545078898527261U, 15392729280356688919U},
+    {17976931348623159077U, 5405853545163697437U},
+    {11235582092889474423U, 5684501474941004850U},
+    {14044477616111843029U, 2493940825248868159U},
+    {17555597020139803786U, 7729112049988473103U},
+    {10972248137587377366U, 9442381049670183593U},
+    {13715310171984221708U, 2579604275232953683U},
+    {17144137714980277135U, 3224505344041192104U},
+    {10715086071862673209U, 8932844867666826921U},
+    {13393857589828341511U, 15777742103010921555U},
+    {16742321987285426889U, 15110491610336264040U},
+    {10463951242053391806U, 2526528228819083169U},
+    {13079939052566739757U, 12381532322878629770U},
+    {16349923815708424697U, 1641857348316123500U},
+    {10218702384817765435U, 12555375888766046947U},
+    {12773377981022206794U, 11082533842530170780U},
+    {15966722476277758493U, 4629795266307937667U},
+    {9979201547673599058U, 5199465050656154994U},
+    {12474001934591998822U, 15722703350174969551U},
+    {15592502418239998528U, 10430007150863936130U},
+    {9745314011399999080U, 6518754469289960081U},
+    {12181642514249998850U, 8148443086612450102U},
+    {15227053142812498563U, 962181821410786819U},
+    {9516908214257811601U, 16742264702877599426U},
+    {11896135267822264502U, 7092772823314835570U},
+    {14870169084777830627U, 18089338065998320271U},
+    {9293855677986144142U, 8999993282035256217U},
+    {11617319597482680178U, 2026619565689294464U},
+    {14521649496853350222U, 11756646493966393888U},
+    {18152061871066687778U, 5472436080603216552U},
+    {11345038669416679861U, 8031958568804398249U},
+    {14181298336770849826U, 14651634229432885715U},
+    {17726622920963562283U, 9091170749936331336U},
+    {11079139325602226427U, 3376138709496513133U},
+    {13848924157002783033U, 18055231442152805128U},
+    {17311155196253478792U, 8733981247408842698U},
+    {10819471997658424245U, 5458738279630526686U},
+    {13524339997073030306U, 11435108867965546262U},
+    {16905424996341287883U, 5070514048102157020U},
+    {10565890622713304927U, 863228270850154185U},
+    {13207363278391631158U, 14914093393844856443U},
+    {16509204097989538948U, 9419244705451294746U},
+    {10318252561243461842U, 15110399977761835024U},
+    {12897815701554327303U, 9664627935347517973U},
+    {16122269626942909129U, 7469098900757009562U},
+    {10076418516839318205U, 16197401859041600736U},
+    {12595523146049147757U, 6411694268519837208U},
+    {15744403932561434696U, 12626303854077184414U},
+    {9840252457850896685U, 7891439908798240259U},
+    {12300315572313620856U, 14475985904425188227U},
+    {15375394465392026070U, 18094982380531485284U},
+    {9609621540870016294U, 6697677969404790399U},
+    {12012026926087520367U, 17595469498610763806U},
+    {15015033657609400459U, 17382650854836066854U},
+    {9384396036005875287U, 8558313775058847832U},
+    {11730495045007344109U, 6086206200396171886U},
+    {14663118806259180136U, 12219443768922602761U},
+    {18328898507823975170U, 15274304711153253452U},
+    {11455561567389984481U, 14158126462898171311U},
+    {14319451959237480602U, 3862600023340550427U},
+    {17899314949046850752U, 14051622066030463842U},
+    {11187071843154281720U, 8782263791269039901U},
+    {13983839803942852150U, 10977829739086299876U},
+    {17479799754928565188U, 4498915137003099037U},
+    {10924874846830353242U, 12035193997481712706U},
+    {13656093558537941553U, 5820620459997365075U},
+    {17070116948172426941U, 11887461593424094248U},
+    {10668823092607766838U, 9735506505103752857U},
+    {13336028865759708548U, 2946011094524915263U},
+    {16670036082199635685U, 3682513868156144079U},
+    {10418772551374772303U, 4607414176811284001U},
+    {13023465689218465379U, 1147581702586717097U},
+    {16279332111523081723U, 15269535183515560084U},
+    {10174582569701926077U, 7237616480483531100U},
+    {12718228212127407596U, 13658706619031801779U},
+    {15897785265159259495U, 17073383273789752224U},
+    {9936115790724537184U, 17588393573759676996U},
+    {12420144738405671481U, 3538747893490044629U},
+    {15525180923007089351U, 9035120885289943691U},
+    {9703238076879430844U, 12564479580947296663U},
+    {12129047596099288555U, 15705599476184120828U},
+    {15161309495124110694U, 15020313326802763131U},
+    {9475818434452569184U, 4776009810824339053U},
+    {11844773043065711480U, 5970012263530423816U},
+    {14805966303832139350U, 7462515329413029771U},
+    {9253728939895087094U, 52386062455755702U},
+    {11567161174868858867U, 9288854614924470436U},
+    {14458951468586073584U, 6999382250228200141U},
+    {18073689335732591980U, 8749227812785250177U},
+    {11296055834832869987U, 14691639419845557168U},
+    {14120069793541087484U, 13752863256379558556U},
+    {17650087241926359355U, 17191079070474448196U},
+    {11031304526203974597U, 8438581409832836170U},
+    {13789130657754968246U, 15159912780718433117U},
+    {17236413322193710308U, 9726518939043265588U},
+    {10772758326371068942U, 15302446373756816800U},
+    {13465947907963836178U, 9904685930341245193U},
+    {16832434884954795223U, 3157485376071780683U},
+    {10520271803096747014U, 8890957387685944783U},
+    {13150339753870933768U, 1890324697752655170U},
+    {16437924692338667210U, 2362905872190818963U},
+    {10273702932711667006U, 6088502188546649756U},
+    {12842128665889583757U, 16833999772538088003U},
+    {16052660832361979697U, 7207441660390446292U},
+    {10032913020226237310U, 16033866083812498692U},
+    {12541141275282796638U, 10818960567910847557U},
+    {15676426594103495798U, 4300328673033783639U},
+    {9797766621314684873U, 16522763475928278486U},
+    {12247208276643356092U, 6818396289628184396U},
+    {15309010345804195115U, 8522995362035230495U},
+    {9568131466127621947U, 3021029092058325107U},
+    {11960164332659527433U, 17611344420355070096U},
+    {14950205415824409292U, 8179122470161673908U},
+    {9343878384890255807U, 14335323580705822000U},
+    {11679847981112819759U, 13307468457454889596U},
+    {14599809976391024699U, 12022649553391224092U},
+    {18249762470488780874U, 10416625923311642211U},
+    {11406101544055488046U, 11122077220497164286U},
+    {14257626930069360058U, 4679224488766679549U},
+    {17822033662586700072U, 15072402647813125244U},
+    {11138771039116687545U, 9420251654883203278U},
+    {13923463798895859431U, 16387000587031392001U},
+    {17404329748619824289U, 15872064715361852097U},
+    {10877706092887390181U, 3002511419460075705U},
+    {13597132616109237726U, 8364825292752482535U},
+    {16996415770136547158U, 1232659579085827361U},
+    {10622759856335341973U, 14605470292210805812U},
+    {13278449820419177467U, 4421779809981343554U},
+    {16598062275523971834U, 915538744049291538U},
+    {10373788922202482396U, 5183897733458195115U},
+    {12967236152753102995U, 6479872166822743894U},
+    {16209045190941378744U, 3488154190101041964U},
+    {10130653244338361715U, 2180096368813151227U},
+    {12663316555422952143U, 16560178516298602746U},
+    {15829145694278690179U, 16088537126945865529U},
+    {9893216058924181362U, 7749492695127472003U},
+    {12366520073655226703U, 463493832054564196U},
+    {15458150092069033378U, 14414425345350368957U},
+    {9661343807543145861U, 13620701859271368502U},
+    {12076679759428932327U, 3190819268807046916U},
+    {15095849699286165408U, 17823582141290972357U},
+    {9434906062053853380U, 11139738838306857723U},
+    {11793632577567316725U, 13924673547883572154U},
+    {14742040721959145907U, 3570783879572301480U},
+    {18427550902448932383U, 18298537904747540562U},
+    {11517219314030582739U, 18354115218108294707U},
+    {14396524142538228424U, 18330958004207980480U},
+    {17995655178172785531U, 4466953431550423984U},
+    {11247284486357990957U, 486002885505321038U},
+    {14059105607947488696U, 5219189625309039202U},
+    {17573882009934360870U, 6523987031636299002U},
+    {10983676256208975543U, 17912549950054850588U},
+    {13729595320261219429U, 17779001419141175331U},
+    {17161994150326524287U, 8388693718644305452U},
+    {10726246343954077679U, 12160462601793772764U},
+    {13407807929942597099U, 10588892233814828051U},
+    {16759759912428246374U, 8624429273841147159U},
+    {10474849945267653984U, 778582277723329070U},
+    {13093562431584567480U, 973227847154161338U},
+    {16366953039480709350U, 1216534808942701673U},
+    {10229345649675443343U, 14595392310871352257U},
+    {12786682062094304179U, 13632554370161802418U},
+    {15983352577617880224U, 12429006944274865118U},
+    {9989595361011175140U, 7768129340171790699U},
+    {12486994201263968925U, 9710161675214738374U},
+    {15608742751579961156U, 16749388112445810871U},
+    {9755464219737475723U, 1244995533423855986U},
+    {12194330274671844653U, 15391302472061983695U},
+    {15242912843339805817U, 5404070034795315907U},
+    {9526820527087378635U, 14906758817815542202U},
+    {11908525658859223294U, 14021762503842039848U},
+    {14885657073574029118U, 8303831092947774002U},
+    {9303535670983768199U, 578208414664970847U},
+    {11629419588729710248U, 14557818573613377271U},
+    {14536774485912137810U, 18197273217016721589U},
+    {18170968107390172263U, 13523219484416126178U},
+    {11356855067118857664U, 15369541205401160717U},
+    {14196068833898572081U, 765182433041899281U},
+    {17745086042373215101U, 5568164059729762005U},
+    {11090678776483259438U, 5785945546544795205U},
+    {13863348470604074297U, 16455803970035769814U},
+    {17329185588255092872U, 6734696907262548556U},
+    {10830740992659433045U, 4209185567039092847U},
+    {13538426240824291306U, 9873167977226253963U},
+    {16923032801030364133U, 3118087934678041646U},
+    {10576895500643977583U, 4254647968387469981U},
+    {13221119375804971979U, 706623942056949572U},
+    {16526399219756214973U, 14718337982853350677U},
+    {10328999512347634358U, 11504804248497038125U},
+    {12911249390434542948U, 5157633273766521849U},
+    {16139061738043178685U, 6447041592208152311U},
+    {10086913586276986678U, 6335244004343789146U},
+    {12608641982846233347U, 17142427042284512241U},
+    {15760802478557791684U, 16816347784428252397U},
+    {9850501549098619803U, 1286845328412881940U},
+    {12313126936373274753U, 15443614715798266137U},
+    {15391408670466593442U, 5469460339465668959U},
+    {9619630419041620901U, 8030098730593431003U},
+    {12024538023802026126U, 14649309431669176658U},
+    {15030672529752532658U, 9088264752731695015U},
+    {9394170331095332911U, 10291851488884697288U},
+    {11742712913869166139U, 8253128342678483706U},
+    {14678391142336457674U, 5704724409920716729U},
+    {18347988927920572092U, 16354277549255671720U},
+    {11467493079950357558U, 998051431430019017U},
+    {14334366349937946947U, 10470936326142299579U},
+    {17917957937422433684U, 8476984389250486570U},
+    {11198723710889021052U, 14521487280136329914U},
+    {13998404638611276315U, 18151859100170412392U},
+    {17498005798264095394U, 18078137856785627587U},
+    {10936253623915059621U, 15910522178918405146U},
+    {13670317029893824527U, 6053094668365842720U},
+    {17087896287367280659U, 2954682317029915496U},
+    {10679935179604550411U, 17987577512639554849U},
+    {13349918974505688014U, 17872785872372055657U},
+    {16687398718132110018U, 13117610303610293764U},
+    {10429624198832568761U, 12810192458183821506U},
+    {13037030248540710952U, 2177682517447613171U},
+    {16296287810675888690U, 2722103146809516464U},
+    {10185179881672430431U, 6313000485183335694U},
+    {12731474852090538039U, 3279564588051781713U},
+    {15914343565113172548U, 17934513790346890853U},
+    {9946464728195732843U, 1985699082112030975U},
+    {12433080910244666053U, 16317181907922202431U},
+    {15541351137805832567U, 6561419329620589327U},
+    {9713344461128645354U, 11018416108653950185U},
+    {12141680576410806693U, 4549648098962661924U},
+    {15177100720513508366U, 10298746142130715309U},
+    {9485687950320942729U, 1825030320404309164U},
+    {11857109937901178411U, 6892973918932774359U},
+    {14821387422376473014U, 4004531380238580045U},
+    {9263367138985295633U, 16337890167931276240U},
+    {11579208923731619542U, 6587304654631931588U},
+    {14474011154664524427U, 17457502855144690293U},
+    {18092513943330655534U, 17210192550503474962U},
+    {11307821214581659709U, 6144684325637283947U},
+    {14134776518227074636U, 12292541425473992838U},
+    {17668470647783843295U, 15365676781842491048U},
+    {11042794154864902059U, 16521077016292638761U},
+    {13803492693581127574U, 16039660251938410547U},
+    {17254365866976409468U, 10826203278068237376U},
+    {10783978666860255917U, 15989749085647424168U},
+    {13479973333575319897U, 6152128301777116498U},
+    {16849966666969149871U, 12301846395648783526U},
+    {10531229166855718669U, 14606183024921571560U},
+    {13164036458569648337U, 4422670725869800738U},
+    {16455045573212060421U, 10140024425764638826U},
+    {10284403483257537763U, 8643358275316593218U},
+    {12855504354071922204U, 6192511825718353619U},
+    {16069380442589902755U, 7740639782147942024U},
+    {10043362776618689222U, 2532056854628769813U},
+    {12554203470773361527U, 12388443105140738074U},
+    {15692754338466701909U, 10873867862998534689U},
+    {9807971461541688693U, 9102010423587778132U},
+    {12259964326927110866U, 15989199047912110569U},
+    {15324955408658888583U, 10763126773035362404U},
+    {9578097130411805364U, 13644483260788183358U},
+    {11972621413014756705U, 17055604075985229198U},
+    {14965776766268445882U, 7484447039699372786U},
+    {9353610478917778676U, 9289465418239495895U},
+    {11692013098647223345U, 11611831772799369869U},
+    {14615016373309029182U, 679731660717048624U},
+    {18268770466636286477U, 10073036612751086588U},
+    {11417981541647679048U, 8601490892183123070U},
+    {14272476927059598810U, 10751863615228903838U},
+    {17840596158824498513U, 4216457482181353989U},
+    {11150372599265311570U, 14164500972431816003U},
+    {13937965749081639463U, 8482254178684994196U},
+    {17422457186352049329U, 5991131704928854841U},
+    {10889035741470030830U, 15273672361649004036U},
+    {13611294676837538538U, 9868718415206479237U},
+    {17014118346046923173U, 3112525982153323238U},
+    {10633823966279326983U, 4251171748059520976U},
+    {13292279957849158729U, 702278666647013315U},
+    {16615349947311448411U, 5489534351736154548U},
+    {10384593717069655257U, 1125115960621402641U},
+    {12980742146337069071U, 6018080969204141205U},
+    {16225927682921336339U, 2910915193077788602U},
+    {10141204801825835211U, 17960223060169475540U},
+    {12676506002282294014U, 17838592806784456521U},
+    {15845632502852867518U, 13074868971625794844U},
+    {9903520314283042199U, 3560107088838733873U},
+    {12379400392853802748U, 18285191916330581054U},
+    {15474250491067253436U, 4409745821703674701U},
+    {9671406556917033397U, 11979463175419572496U},
+    {12089258196146291747U, 1139270913992301908U},
+    {15111572745182864683U, 15259146697772541097U},
+    {9444732965739290427U, 7231123676894144234U},
+    {11805916207174113034U, 4427218577690292388U},
+    {14757395258967641292U, 14757395258967641293U},
+    {9223372036854775808U, 0U},
+    {11529215046068469760U, 0U},
+    {14411518807585587200U, 0U},
+    {18014398509481984000U, 0U},
+    {11258999068426240000U, 0U},
+    {14073748835532800000U, 0U},
+    {17592186044416000000U, 0U},
+    {10995116277760000000U, 0U},
+    {13743895347200000000U, 0U},
+    {17179869184000000000U, 0U},
+    {10737418240000000000U, 0U},
+    {13421772800000000000U, 0U},
+    {16777216000000000000U, 0U},
+    {10485760000000000000U, 0U},
+    {13107200000000000000U, 0U},
+    {16384000000000000000U, 0U},
+    {10240000000000000000U, 0U},
+    {12800000000000000000U, 0U},
+    {16000000000000000000U, 0U},
+    {10000000000000000000U, 0U},
+    {12500000000000000000U, 0U},
+    {15625000000000000000U, 0U},
+    {9765625000000000000U, 0U},
+    {12207031250000000000U, 0U},
+    {15258789062500000000U, 0U},
+    {9536743164062500000U, 0U},
+    {11920928955078125000U, 0U},
+    {14901161193847656250U, 0U},
+    {9313225746154785156U, 4611686018427387904U},
+    {11641532182693481445U, 5764607523034234880U},
+    {14551915228366851806U, 11817445422220181504U},
+    {18189894035458564758U, 5548434740920451072U},
+    {11368683772161602973U, 17302829768357445632U},
+    {14210854715202003717U, 7793479155164643328U},
+    {17763568394002504646U, 14353534962383192064U},
+    {11102230246251565404U, 4359273333062107136U},
+    {13877787807814456755U, 5449091666327633920U},
+    {17347234759768070944U, 2199678564482154496U},
+    {10842021724855044340U, 1374799102801346560U},
+    {13552527156068805425U, 1718498878501683200U},
+    {16940658945086006781U, 6759809616554491904U},
+    {10587911840678754238U, 6530724019560251392U},
+    {13234889800848442797U, 17386777061305090048U},
+    {16543612251060553497U, 7898413271349198848U},
+    {10339757656912845935U, 16465723340661719040U},
+    {12924697071141057419U, 15970468157399760896U},
+    {16155871338926321774U, 15351399178322313216U},
+    {10097419586828951109U, 4982938468024057856U},
+    {12621774483536188886U, 10840359103457460224U},
+    {15777218104420236108U, 4327076842467049472U},
+    {9860761315262647567U, 11927795063396681728U},
+    {12325951644078309459U, 10298057810818464256U},
+    {15407439555097886824U, 8260886245095692416U},
+    {9629649721936179265U, 5163053903184807760U},
+    {12037062152420224081U, 11065503397408397604U},
+    {15046327690525280101U, 18443565265187884909U},
+    {9403954806578300063U, 13833071299956122020U},
+    {11754943508222875079U, 12679653106517764621U},
+    {14693679385278593849U, 11237880364719817872U},
+    {18367099231598242312U, 212292400617608628U},
+    {11479437019748901445U, 132682750386005392U},
+    {14349296274686126806U, 4777539456409894645U},
+    {17936620343357658507U, 15195296357367144114U},
+    {11210387714598536567U, 7191217214140771119U},
+    {14012984643248170709U, 4377335499248575995U},
+    {17516230804060213386U, 10083355392488107898U},
+    {10947644252537633366U, 10913783138732455340U},
+    {13684555315672041708U, 4418856886560793367U},
+    {17105694144590052135U, 5523571108200991709U},
+    {10691058840368782584U, 10369760970266701674U},
+    {13363823550460978230U, 12962201212833377092U},
+    {16704779438076222788U, 6979379479186945558U},
+    {10440487148797639242U, 13585484211346616781U},
+    {13050608935997049053U, 7758483227328495169U},
+    {16313261169996311316U, 14309790052588006865U},
+    {10195788231247694572U, 18166990819722280098U},
+    {12744735289059618216U, 4261994450943298507U},
+    {15930919111324522770U, 5327493063679123134U},
+    {9956824444577826731U, 7941369183226839863U},
+    {12446030555722283414U, 5315025460606161924U},
+    {15557538194652854267U, 15867153862612478214U},
+    {9723461371658033917U, 7611128154919104931U},
+    {12154326714572542396U, 14125596212076269068U},
+    {15192908393215677995U, 17656995265095336336U},
+    {9495567745759798747U, 8729779031470891258U},
+    {11869459682199748434U, 6300537770911226168U},
+    {14836824602749685542U, 17099044250493808518U},
+    {9273015376718553464U, 6075216638131242420U},
+    {11591269220898191830U, 7594020797664053025U},
+    {14489086526122739788U, 269153960225290473U},
+    {18111358157653424735U, 336442450281613091U},
+    {11319598848533390459U, 7127805559067090038U},
+    {14149498560666738074U, 4298070930406474644U},
+    {17686873200833422592U, 14595960699862869113U},
+    {11054295750520889120U, 9122475437414293195U},
+    {13817869688151111400U, 11403094296767866494U},
+    {17272337110188889250U, 14253867870959833118U},
+    {10795210693868055781U, 13520353437777283602U},
+    {13494013367335069727U, 3065383741939440791U},
+    {16867516709168837158U, 17666787732706464701U},
+    {10542197943230523224U, 6430056314514152534U},
+    {13177747429038154030U, 8037570393142690668U},
+    {16472184286297692538U, 823590954573587527U},
+    {10295115178936057836U, 5126430365035880108U},
+    {12868893973670072295U, 6408037956294850135U},
+    {16086117467087590369U, 3398361426941174765U},
+    {10053823416929743980U, 13653190937906703988U},
+    {12567279271162179975U, 17066488672383379985U},
+    {15709099088952724969U, 16721424822051837077U},
+    {9818186930595453106U, 3533361486141316317U},
+    {12272733663244316382U, 13640073894531421205U},
+    {15340917079055395478U, 7826720331309500698U},
+    {9588073174409622174U, 280014188641050032U},
+    {11985091468012027717U, 9573389772656088348U},
+    {14981364335015034646U, 16578423234247498339U},
+    {9363352709384396654U, 5749828502977298558U},
+    {11704190886730495817U, 16410657665576399005U},
+    {14630238608413119772U, 6678264026688335045U},
+    {18287798260516399715U, 8347830033360418806U},
+    {11429873912822749822U, 2911550761636567802U},
+    {14287342391028437277U, 12862810488900485560U},
+    {17859177988785546597U, 2243455055843443238U},
+    {11161986242990966623U, 3708002419115845976U},
+    {13952482803738708279U, 23317005467419566U},
+    {17440603504673385348U, 13864204312116438170U},
+    {10900377190420865842U, 17888499731927549664U},
+    {13625471488026082303U, 13137252628054661272U},
+    {17031839360032602879U, 11809879766640938686U},
+    {10644899600020376799U, 14298703881791668535U},
+    {13306124500025470999U, 13261693833812197764U},
+    {16632655625031838749U, 11965431273837859301U},
+    {10395409765644899218U, 9784237555362356015U},
+    {12994262207056124023U, 3006924907348169211U},
+    {16242827758820155028U, 17593714189467375226U},
+    {10151767349262596893U, 1772699331562333708U},
+    {12689709186578246116U, 6827560182880305039U},
+    {15862136483222807645U, 8534450228600381299U},
+    {9913835302014254778U, 7639874402088932264U},
+    {12392294127517818473U, 326470965756389522U},
+    {15490367659397273091U, 5019774725622874806U},
+    {9681479787123295682U, 831516194300602802U},
+    {12101849733904119602U, 10262767279730529310U},
+    {15127312167380149503U, 3605087062808385830U},
+    {9454570104612593439U, 9170708441896323000U},
+    {11818212630765741799U, 6851699533943015846U},
+    {14772765788457177249U, 3952938399001381903U},
+    {9232978617785735780U, 13999801545444333449U},
+    {11541223272232169725U, 17499751931805416812U},
+    {14426529090290212157U, 8039631859474607303U},
+    {18033161362862765196U, 14661225842770647033U},
+    {11270725851789228247U, 18386638188586430203U},
+    {14088407314736535309U, 18371611717305649850U},
+    {17610509143420669137U, 9129456591349898601U},
+    {11006568214637918210U, 17235125415662156385U},
+    {13758210268297397763U, 12320534732722919674U},
+    {17197762835371747204U, 10788982397476261688U},
+    {10748601772107342002U, 15966486035277439363U},
+    {13435752215134177503U, 10734735507242023396U},
+    {16794690268917721879U, 8806733365625141341U},
+    {10496681418073576174U, 12421737381156795194U},
+    {13120851772591970218U, 6303799689591218185U},
+    {16401064715739962772U, 17103121648843798539U},
+    {10250665447337476733U, 1466078993672598279U},
+    {12813331809171845916U, 6444284760518135752U},
+    {16016664761464807395U, 8055355950647669691U},
+    {10010415475915504622U, 2728754459941099604U},
+    {12513019344894380777U, 12634315111781150314U},
+    {15641274181117975972U, 1957835834444274180U},
+    {9775796363198734982U, 10447019433382447170U},
+    {12219745453998418728U, 3835402254873283155U},
+    {15274681817498023410U, 4794252818591603944U},
+    {9546676135936264631U, 7608094030047140369U},
+    {11933345169920330789U, 4898431519131537557U},
+    {14916681462400413486U, 10734725417341809851U},
+    {9322925914000258429U, 2097517367411243253U},
+    {11653657392500323036U, 7233582727691441970U},
+    {14567071740625403795U, 9041978409614302462U},
+    {18208839675781754744U, 6690786993590490174U},
+    {11380524797363596715U, 4181741870994056359U},
+    {14225655996704495894U, 615491320315182544U},
+    {17782069995880619867U, 9992736187248753989U},
+    {11113793747425387417U, 3939617107816777291U},
+    {13892242184281734271U, 9536207403198359517U},
+    {17365302730352167839U, 7308573235570561493U},
+    {10853314206470104899U, 11485387299872682789U},
+    {13566642758087631124U, 9745048106413465582U},
+    {16958303447609538905U, 12181310133016831978U},
+    {10598939654755961816U, 695789805494438130U},
+    {13248674568444952270U, 869737256868047663U},
+    {16560843210556190337U, 10310543607939835386U},
+    {10350527006597618960U, 17973304801030866876U},
+    {12938158758247023701U, 4019886927579031980U},
+    {16172698447808779626U, 9636544677901177879U},
+    {10107936529880487266U, 10634526442115624078U},
+    {12634920662350609083U, 4069786015789754290U},
+    {15793650827938261354U, 475546501309804958U},
+    {9871031767461413346U, 4908902581746016003U},
+    {12338789709326766682U, 15359500264037295811U},
+    {15423487136658458353U, 9976003293191843956U},
+    {9639679460411536470U, 17764217104313372233U},
+    {12049599325514420588U, 12981899343536939483U},
+    {15061999156893025735U, 16227374179421174354U},
+    {9413749473058141084U, 17059637889779315827U},
+    {11767186841322676356U, 2877803288514593168U},
+    {14708983551653345445U, 3597254110643241460U},
+    {18386229439566681806U, 9108253656731439729U},
+    {11491393399729176129U, 1080972517029761926U},
+    {14364241749661470161U, 5962901664714590312U},
+    {17955302187076837701U, 12065313099320625794U},
+    {11222063866923023563U, 9846663696289085073U},
+    {14027579833653779454U, 7696643601933968437U},
+    {17534474792067224318U, 397432465562684739U},
+    {10959046745042015198U, 14083453346258841674U},
+    {13698808431302518998U, 8380944645968776284U},
+    {17123510539128148748U, 1252808770606194547U},
+    {10702194086955092967U, 10006377518483647400U},
+    {13377742608693866209U, 7896285879677171346U},
+    {16722178260867332761U, 14482043368023852087U},
+    {10451361413042082976U, 2133748077373825698U},
+    {13064201766302603720U, 2667185096717282123U},
+    {16330252207878254650U, 3333981370896602653U},
+    {10206407629923909156U, 6695424375237764562U},
+    {12758009537404886445U, 8369280469047205703U},
+    {15947511921756108056U, 15073286604736395033U},
+    {9967194951097567535U, 9420804127960246895U},
+    {12458993688871959419U, 7164319141522920715U},
+    {15573742111089949274U, 4343712908476262990U},
+    {9733588819431218296U, 7326506586225052273U},
+    {12166986024289022870U, 9158133232781315341U},
+    {15208732530361278588U, 2224294504121868368U},
+    {9505457831475799117U, 10613556101930943538U},
+    {11881822289344748896U, 17878631145841067327U},
+    {14852277861680936121U, 3901544858591782542U},
+    {9282673663550585075U, 13967680582688333849U},
+    {11603342079438231344U, 12847914709933029407U},
+    {14504177599297789180U, 16059893387416286759U},
+    {18130221999122236476U, 1628122660560806833U},
+    {11331388749451397797U, 10240948699705280078U},
+    {14164235936814247246U, 17412871893058988002U},
+    {17705294921017809058U, 12542717829468959195U},
+    {11065809325636130661U, 12450884661845487401U},
+    {13832261657045163327U, 1728547772024695539U},
+    {17290327071306454158U, 15995742770313033136U},
+    {10806454419566533849U, 5385653213018257806U},
+    {13508068024458167311U, 11343752534700210161U},
+    {16885085030572709139U, 9568004649947874797U},
+    {10553178144107943212U, 3674159897003727796U},
+    {13191472680134929015U, 4592699871254659745U},
+    {16489340850168661269U, 1129188820640936778U},
+    {10305838031355413293U, 3011586022114279438U},
+    {12882297539194266616U, 8376168546070237202U},
+    {16102871923992833270U, 10470210682587796502U},
+    {10064294952495520794U, 1932195658189984910U},
+    {12580368690619400992U, 11638616609592256945U},
+    {15725460863274251240U, 14548270761990321182U},
+    {9828413039546407025U, 9092669226243950738U},
+    {12285516299433008781U, 15977522551232326327U},
+    {15356895374291260977U, 6136845133758244197U},
+    {9598059608932038110U, 15364743254667372383U},
+    {11997574511165047638U, 9982557031479439671U},
+    {14996968138956309548U, 3254824252494523781U},
+    {9373105086847693467U, 11257637194663853171U},
+    {11716381358559616834U, 9460360474902428559U},
+    {14645476698199521043U, 2602078556773259891U},
+    {18306845872749401303U, 17087656251248738576U},
+    {11441778670468375814U, 17597314184671543466U},
+    {14302223338085469768U, 12773270693984653525U},
+    {17877779172606837210U, 15966588367480816906U},
+    {11173611982879273256U, 14590803748102898470U},
+    {13967014978599091570U, 18238504685128623088U},
+    {17458768723248864463U, 13574758819556003052U},
+    {10911730452030540289U, 15401753289863583763U},
+    {13639663065038175362U, 5417133557047315992U},
+    {17049578831297719202U, 15994788983163920798U},
+    {10655986769561074501U, 14608429132904838403U},
+    {13319983461951343127U, 4425478360848884291U},
+    {16649979327439178909U, 920161932633717460U},
+    {10406237079649486818U, 2880944217109767365U},
+    {13007796349561858522U, 12824552308241985014U},
+    {16259745436952323153U, 6807318348447705459U},
+    {10162340898095201970U, 15783789013848285672U},
+    {12702926122619002463U, 10506364230455581282U},
+    {15878657653273753079U, 8521269269642088699U},
+    {9924161033296095674U, 12243322321167387293U},
+    {12405201291620119593U, 6080780864604458308U},
+    {15506501614525149491U, 12212662099182960789U},
+    {9691563509078218432U, 5327070802775656541U},
+    {12114454386347773040U, 6658838503469570676U},
+    {15143067982934716300U, 8323548129336963345U},
+    {9464417489334197687U, 14425589617690377899U},
+    {11830521861667747109U, 13420301003685584469U},
+    {14788152327084683887U, 2940318199324816875U},
+    {9242595204427927429U, 8755227902219092403U},
+    {11553244005534909286U, 15555720896201253407U},
+    {14441555006918636608U, 10221279083396790951U},
+    {18051943758648295760U, 12776598854245988689U},
+    {11282464849155184850U, 7985374283903742931U},
+    {14103081061443981063U, 758345818024902856U},
+    {17628851326804976328U, 14782990327813292282U},
+    {11018032079253110205U, 9239368954883307676U},
+    {13772540099066387756U, 16160897212031522499U},
+    {17215675123832984696U, 1754377441329851508U},
+    {10759796952395615435U, 1096485900831157192U},
+    {13449746190494519293U, 15205665431321110202U},
+    {16812182738118149117U, 5172023733869224041U},
+    {10507614211323843198U, 5538357842881958977U},
+    {13134517764154803997U, 16146319340457224530U},
+    {16418147205193504997U, 6347841120289366950U},
+    {10261342003245940623U, 6273243709394548296U},
+};
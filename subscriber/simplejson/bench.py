@@ -0,0 +1,417 @@
+r"""
+Timing comparisons for the C speedups::
+
+    $ python -m simplejson.bench
+    encode_floats
+        shortest          0.0176s
+        repr              0.1177s
+
+Pass benchmark names to run only those.  Each benchmark times the
+alternatives it compares on the same data and reports the best of
+several runs.
+
+The ``*_corpus`` benchmarks run the C entry points (``make_scanner``,
+``scanstring``, ``make_encoder`` and ``encode_basestring_ascii``) and
+their pure Python fallbacks over a fixed corpus of documents shaped
+like the hub's own traffic, and also report throughput.  Allocations
+per document are reported by interpreters built with COUNT_ALLOCS,
+which provide ``sys.getcounts()``.
+"""
+import random
+import sys
+import timeit
+
+import simplejson
+from simplejson import decoder
+from simplejson import encoder
+from simplejson import scanner
+
+try:
+    from simplejson import _speedups
+except ImportError:
+    _speedups = None
+
+BENCHMARKS = []
+
+def benchmark(fn):
+    BENCHMARKS.append(fn)
+    return fn
+
+def best_of(fn, repeat=5, number=1):
+    return min(timeit.Timer(fn).repeat(repeat, number)) / number
+
+def _floats(n, seed=0):
+    r = random.Random(seed)
+    return [r.uniform(-1e6, 1e6) for _ in xrange(n // 2)] + \
+        [r.random() * 10 ** r.randint(-20, 20) for _ in xrange(n - n // 2)]
+
+def _text(r, n, alphabet):
+    return u''.join(r.choice(alphabet) for _ in xrange(n))
+
+def _items(r):
+    # The /items output of subscriber/main.py ItemsHandler
+    words = u'pubsubhubbub feed entry hub subscriber topic update atom rss'.split()
+    return [{'time': '2009-%02d-%02d %02d:%02d:%02d.%06d' % (
+                 r.randint(1, 12), r.randint(1, 28), r.randint(0, 23),
+                 r.randint(0, 59), r.randint(0, 59), r.randint(0, 999999)),
+             'title': u' '.join(r.choice(words) for _ in xrange(6)),
+             'content': u'<p>%s</p>\n<a href="http://example.com/%d">more</a>' % (
+                 u' '.join(r.choice(words) for _ in xrange(60)), i),
+             'source': 'http://example.com/feeds/%d/entry/%d' % (r.randint(0, 999), i)}
+            for i in xrange(10)]
+
+def _mapreduce_state(r):
+    # MapreduceState / ShardState blobs as stored by hub/mapreduce/model.py
+    mapreduce_id = '%d' % (r.randint(10 ** 14, 10 ** 15),)
+    return {
+        'mapreduce_spec': {
+            'name': 'Cleanup old feed records',
+            'mapreduce_id': mapreduce_id,
+            'mapper_spec': {
+                'mapper_handler_spec': 'offline_jobs.CleanupOldEventToDeliver.run',
+                'mapper_input_reader': 'mapreduce.input_readers.DatastoreInputReader',
+                'mapper_params': {'entity_kind': 'main.EventToDeliver',
+                                  'age_days': 14, 'batch_size': 20},
+                'mapper_shard_count': 8,
+            },
+            'params': {'done_callback': '/mapreduce/done', 'processing_rate': 100},
+        },
+        'counters_map': {'counters': dict(
+            ('mapper_calls.%d' % (i,), r.randint(0, 10 ** 6)) for i in xrange(8))},
+        'shards': [{'shard_id': '%s-%d' % (mapreduce_id, i),
+                    'active': bool(i % 3),
+                    'result_status': None,
+                    'input_reader': {'entity_kind': 'main.EventToDeliver',
+                                     'key_range': {'key_start': 'agRodWJych' + 'x' * 40,
+                                                   'key_end': None,
+                                                   'direction': 'ASC'}},
+                    'update_time': r.random() * 1e9}
+                   for i in xrange(8)],
+    }
+
+def corpus():
+    """Fixed (name, documents) pairs shaped like the hub's JSON traffic"""
+    r = random.Random(0)
+    return [
+        ('items', [_items(r) for _ in xrange(50)]),
+        ('mapreduce', [_mapreduce_state(r) for _ in xrange(100)]),
+        ('unicode', [[_text(r, 2000, u'\u0417\u0434\u0440\u0430\u0432\u4e16\u754c\xe9 \U0001d120')
+                      for _ in xrange(4)] for _ in xrange(50)]),
+        ('escapes', [[_text(r, 2000, u'ab"\\/\n\t\r\x00\x1f<>&')
+                      for _ in xrange(4)] for _ in xrange(50)]),
+    ]
+
+def _strings(obj, out):
+    if isinstance(obj, basestring):
+        out.append(obj)
+    elif isinstance(obj, dict):
+        for k, v in obj.iteritems():
+            out.append(k)
+            _strings(v, out)
+    elif isinstance(obj, list):
+        for v in obj:
+            _strings(v, out)
+    return out
+
+def _allocs(fn, ndocs):
+    getcounts = getattr(sys, 'getcounts', None)
+    if getcounts is None:
+        return None
+    before = sum(c[1] for c in getcounts())
+    fn()
+    return (sum(c[1] for c in getcounts()) - before) / float(ndocs)
+
+def _compare(c_fn, py_fn, ndocs, nbytes):
+    # (label, secs, bytes, allocs per doc) for the C and Python versions
+    results = []
+    for label, fn in (('c', c_fn), ('py', py_fn)):
+        if fn is None:
+            continue
+        results.append((label, best_of(fn, repeat=3), nbytes, _allocs(fn, ndocs)))
+    return results
+
+def _corpus_benchmark(fn):
+    def run():
+        results = []
+        for name, docs in corpus():
+            for label, secs, nbytes, allocs in fn(docs):
+                results.append(('%s/%s' % (name, label), secs, nbytes, allocs))
+        return results
+    run.__name__ = fn.__name__
+    run.__doc__ = fn.__doc__
+    return benchmark(run)
+
+@_corpus_benchmark
+def scanner_corpus(docs):
+    """make_scanner over each corpus document"""
+    texts = [simplejson.dumps(doc) for doc in docs]
+    def scan_all(scan_once):
+        for text in texts:
+            scan_once(text, 0)
+    c_scan = py_scan = None
+    if scanner.c_make_scanner is not None:
+        c_scan = lambda: scan_all(scanner.c_make_scanner(simplejson.JSONDecoder()))
+    py_decoder = simplejson.JSONDecoder()
+    py_decoder.parse_string = decoder.py_scanstring
+    def py_scan():
+        # JSONObject looks scanstring up in the module for keys
+        prev = decoder.scanstring
+        decoder.scanstring = decoder.py_scanstring
+        try:
+            scan_all(scanner.py_make_scanner(py_decoder))
+        finally:
+            decoder.scanstring = prev
+    return _compare(c_scan, py_scan, len(texts), sum(map(len, texts)))
+
+@_corpus_benchmark
+def scanstring_corpus(docs):
+    """scanstring over every string in the corpus"""
+    quoted = [simplejson.dumps(s) for doc in docs for s in _strings(doc, [])]
+    def scan_all(scanstring):
+        for q in quoted:
+            scanstring(q, 1, None, True)
+    c_scan = None
+    if decoder.c_scanstring is not None:
+        c_scan = lambda: scan_all(decoder.c_scanstring)
+    return _compare(c_scan, lambda: scan_all(decoder.py_scanstring),
+                    len(docs), sum(map(len, quoted)))
+
+@_corpus_benchmark
+def encoder_corpus(docs):
+    """make_encoder (JSONEncoder.encode) over each corpus document"""
+    enc = simplejson.JSONEncoder()
+    nbytes = sum(len(enc.encode(doc)) for doc in docs)
+    def encode_all():
+        for doc in docs:
+            enc.encode(doc)
+    def py_encode_all():
+        prev = encoder.c_make_encoder, encoder.encode_basestring_ascii
+        encoder.c_make_encoder = None
+        encoder.encode_basestring_ascii = encoder.py_encode_basestring_ascii
+        try:
+            encode_all()
+        finally:
+            encoder.c_make_encoder, encoder.encode_basestring_ascii = prev
+    c_encode = None
+    if encoder.c_make_encoder is not None:
+        c_encode = encode_all
+    return _compare(c_encode, py_encode_all, len(docs), nbytes)
+
+@_corpus_benchmark
+def basestring_ascii_corpus(docs):
+    """encode_basestring_ascii over every string in the corpus"""
+    strings = [s for doc in docs for s in _strings(doc, [])]
+    nbytes = sum(len(encoder.py_encode_basestring_ascii(s)) for s in strings)
+    def escape_all(fn):
+        for s in strings:
+            fn(s)
+    c_escape = None
+    if encoder.c_encode_basestring_ascii is not None:
+        c_escape = lambda: escape_all(encoder.c_encode_basestring_ascii)
+    return _compare(c_escape,
+                    lambda: escape_all(encoder.py_encode_basestring_ascii),
+                    len(docs), nbytes)
+
+@benchmark
+def lazy_fields():
+    """Reading two fields of a large mapreduce state, loads() and lazy_decode()"""
+    r = random.Random(0)
+    state = _mapreduce_state(r)
+    state['shards'] = [_mapreduce_state(r)['shards'] for _ in xrange(200)]
+    text = simplejson.dumps(state)
+    dec = simplejson.JSONDecoder()
+    def eager():
+        doc = dec.decode(text)
+        return doc['mapreduce_spec']['params'], doc['counters_map']
+    def lazy():
+        doc = dec.lazy_decode(text)
+        return doc['mapreduce_spec']['params'].load(), doc['counters_map'].load()
+    return [('loads', best_of(eager), len(text)),
+            ('lazy', best_of(lazy), len(text))]
+
+@benchmark
+def decode_batch():
+    """5k small messages, loads() each and one decode_many()"""
+    docs = [simplejson.dumps({'id': i, 'topic': 'http://example.com/feed/%d' % (i,),
+                              'subscribed': True})
+            for i in xrange(5000)]
+    dec = simplejson.JSONDecoder()
+    nbytes = sum(map(len, docs))
+    return [('loads', best_of(lambda: [simplejson.loads(doc) for doc in docs]), nbytes),
+            ('decode_many', best_of(lambda: dec.decode_many(docs)), nbytes)]
+
+@benchmark
+def decode_mmap():
+    """A 15MB file of mapreduce states, read() then loads() and decode() of an mmap"""
+    import mmap
+    import tempfile
+    r = random.Random(0)
+    f = tempfile.TemporaryFile()
+    simplejson.dump([_mapreduce_state(r) for _ in xrange(5000)], f)
+    f.flush()
+    size = f.tell()
+    dec = simplejson.JSONDecoder()
+    def read():
+        f.seek(0)
+        return dec.decode(f.read())
+    def mapped():
+        m = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        try:
+            return dec.decode(m)
+        finally:
+            m.close()
+    try:
+        return [('read', best_of(read, repeat=3), size),
+                ('mmap', best_of(mapped, repeat=3), size)]
+    finally:
+        f.close()
+
+@benchmark
+def decode_lines():
+    """20k JSON lines from a file, readline() and loads() each, and decode_lines()"""
+    import tempfile
+    r = random.Random(0)
+    f = tempfile.TemporaryFile()
+    for _ in xrange(2000):
+        for item in _items(r):
+            f.write(simplejson.dumps(item) + '\n')
+    f.flush()
+    size = f.tell()
+    dec = simplejson.JSONDecoder()
+    def lines():
+        f.seek(0)
+        return [dec.decode(line) for line in f if line.strip()]
+    def native():
+        f.seek(0)
+        return list(dec.decode_lines(f))
+    try:
+        return [('loads', best_of(lines), size),
+                ('decode_lines', best_of(native), size)]
+    finally:
+        f.close()
+
+@benchmark
+def decode_records():
+    """loads() of 2k /items entries as dicts, via object_hook and as records"""
+    from collections import namedtuple
+    Item = namedtuple('Item', 'time title content source')
+    r = random.Random(0)
+    text = simplejson.dumps([item for _ in xrange(200) for item in _items(r)])
+    hook = simplejson.JSONDecoder(object_hook=lambda d: Item(**d))
+    record = simplejson.JSONDecoder(record_type=Item)
+    return [('dict', best_of(lambda: simplejson.loads(text)), len(text)),
+            ('object_hook', best_of(lambda: hook.decode(text)), len(text)),
+            ('record_type', best_of(lambda: record.decode(text)), len(text))]
+
+@benchmark
+def encode_small():
+    """encode() of 5k small messages, reusing the C encoder and making one per call"""
+    docs = [{'id': i, 'topic': 'http://example.com/feed/%d' % (i,), 'subscribed': True}
+            for i in xrange(5000)]
+    enc = simplejson.JSONEncoder()
+    def uncached():
+        for doc in docs:
+            enc._c_encoder = None
+            enc.encode(doc)
+    return [('cached', best_of(lambda: [enc.encode(doc) for doc in docs])),
+            ('uncached', best_of(uncached))]
+
+@benchmark
+def encode_records():
+    """dumps() of 2k /items entries as dicts and with record_encoder()"""
+    r = random.Random(0)
+    items = [item for _ in xrange(200) for item in _items(r)]
+    enc = simplejson.JSONEncoder()
+    records = enc.record_encoder(('time', 'title', 'content', 'source'))
+    nbytes = len(enc.encode(items))
+    return [('dict', best_of(lambda: enc.encode(items)), nbytes),
+            ('record_encoder', best_of(lambda: records(items)), nbytes)]
+
+@benchmark
+def encode_floats():
+    """dumps() of 100k floats with the native formatter and float.__repr__"""
+    if _speedups is None:
+        return []
+    data = _floats(100000)
+    enc = simplejson.JSONEncoder()
+    results = []
+    for fmt in ('shortest', 'repr'):
+        try:
+            prev = _speedups._set_float_format(fmt)
+        except ValueError:
+            continue
+        try:
+            results.append((fmt, best_of(lambda: enc.encode(data))))
+        finally:
+            _speedups._set_float_format(prev)
+    return results
+
+@benchmark
+def encode_text():
+    """dumps() of 20k non-Latin strings with and without ensure_ascii"""
+    from simplejson import encoder
+    data = [u'\u0417\u0434\u0440\u0430\u0432\u0441\u0442\u0432\u0443\u0439 %d "\u4e16\u754c"\n' % (i,)
+            for i in xrange(20000)]
+    results = [('ascii', best_of(lambda: simplejson.dumps(data))),
+               ('utf8', best_of(lambda: simplejson.dumps(data, ensure_ascii=False)))]
+    prev = encoder.encode_basestring
+    encoder.encode_basestring = encoder.py_encode_basestring
+    try:
+        results.append(('utf8-py', best_of(lambda: simplejson.dumps(data, ensure_ascii=False))))
+    finally:
+        encoder.encode_basestring = prev
+    return results
+
+@benchmark
+def encode_native():
+    """dumps() of 20k rows of Decimal, datetime and set via default and natively"""
+    import datetime
+    from decimal import Decimal
+    r = random.Random(0)
+    start = datetime.datetime(2009, 1, 1)
+    data = [[Decimal(r.randint(0, 10 ** 8)).scaleb(-r.randint(0, 6)),
+             start + datetime.timedelta(seconds=r.random() * 10 ** 7),
+             set(r.randint(0, 99) for _ in xrange(4))]
+            for _ in xrange(20000)]
+    def default(o):
+        if isinstance(o, Decimal):
+            return float(o)
+        if isinstance(o, datetime.date):
+            return o.isoformat()
+        if isinstance(o, (set, frozenset)):
+            return list(o)
+        raise TypeError(repr(o))
+    hook = simplejson.JSONEncoder(default=default)
+    native = simplejson.JSONEncoder(use_decimal=True, use_datetime=True, use_set=True)
+    return [('default', best_of(lambda: hook.encode(data))),
+            ('native', best_of(lambda: native.encode(data)))]
+
+@benchmark
+def decode_arrays():
+    """loads() of 50k short arrays, mixed values and ints only"""
+    mixed = simplejson.dumps([[i, i * 0.25, True, None, [i]] for i in xrange(50000)])
+    umixed = mixed.decode('ascii')
+    ints = simplejson.dumps([range(8)] * 50000)
+    return [('mixed', best_of(lambda: simplejson.loads(mixed))),
+            ('umixed', best_of(lambda: simplejson.loads(umixed))),
+            ('ints', best_of(lambda: simplejson.loads(ints)))]
+
+def main(args=None):
+    if args is None:
+        args = sys.argv[1:]
+    for fn in BENCHMARKS:
+        if args and fn.__name__ not in args:
+            continue
+        print fn.__name__
+        for result in fn():
+            # (label, secs) optionally followed by bytes and allocs per doc
+            line = '    %-16s  %.4fs' % result[:2]
+            if len(result) > 2:
+                line += '  %8.1f MB/s' % (result[2] / result[1] / 1e6,)
+            if len(result) > 3 and result[3] is not None:
+                line += '  %8.1f allocs/doc' % (result[3],)
+            print line
+
+
+if __name__ == '__main__':
+    main()
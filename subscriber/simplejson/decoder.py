@@ -5,11 +5,27 @@ import re
 import sys
 import struct
 
-from simplejson.scanner import make_scanner
+from simplejson.scanner import make_scanner, py_make_scanner, c_make_scanner
 try:
     from simplejson._speedups import scanstring as c_scanstring
 except ImportError:
     c_scanstring = None
+try:
+    from simplejson._speedups import make_push_parser as c_make_push_parser
+except ImportError:
+    c_make_push_parser = None
+try:
+    from simplejson._speedups import make_lazy_document as c_make_lazy_document
+except ImportError:
+    c_make_lazy_document = None
+try:
+    from simplejson._speedups import make_line_reader as c_make_line_reader
+except ImportError:
+    c_make_line_reader = None
+try:
+    from simplejson._speedups import validate as c_validate, minify as c_minify
+except ImportError:
+    c_validate = c_minify = None
 
 FLAGS = re.VERBOSE | re.MULTILINE | re.DOTALL
 
@@ -34,6 +50,9 @@ def linecol(doc, pos):
 
 def errmsg(msg, doc, pos, end=None):
     # Note that this function is called from _speedups
+    if not isinstance(doc, basestring):
+        # a buffer decoded in place, only the text up to pos and end counts
+        doc = buffer(doc, 0, max(pos, end))[:]
     lineno, colno = linecol(doc, pos)
     if end is None:
         return '%s: line %d column %d (char %d)' % (msg, lineno, colno, pos)
@@ -198,6 +217,29 @@ def JSONObject((s, end), encoding, strict, scan_once, object_hook, _w=WHITESPACE
         pairs = object_hook(pairs)
     return pairs, end
 
+def make_record_parser(record_type, record_fields, _parse_object=JSONObject):
+    """
+    Wrap ``_parse_object`` so objects whose keys are all in
+    ``record_fields`` come back as ``record_type`` instances, with None for
+    missing fields.  This is the pure Python version of the record support
+    in the C scanner.
+    """
+    fields = tuple(record_fields)
+    field_set = frozenset(fields)
+    if isinstance(record_type, type) and issubclass(record_type, tuple):
+        make = lambda values: tuple.__new__(record_type, values)
+    else:
+        make = lambda values: record_type(*values)
+
+    def parse_object(s_end, encoding, strict, scan_once, object_hook):
+        pairs, end = _parse_object(s_end, encoding, strict, scan_once, None)
+        if field_set.issuperset(pairs):
+            return make([pairs.get(name) for name in fields]), end
+        if object_hook is not None:
+            pairs = object_hook(pairs)
+        return pairs, end
+    return parse_object
+
 def JSONArray((s, end), scan_once, _w=WHITESPACE.match, _ws=WHITESPACE_STR):
     values = []
     nextchar = s[end:end + 1]
@@ -234,6 +276,572 @@ def JSONArray((s, end), scan_once, _w=WHITESPACE.match, _ws=WHITESPACE_STR):
 
     return values, end
 
+TOKEN_CHARS = frozenset('0123456789abcdefghijklmnopqrstuvwxyz'
+    'ABCDEFGHIJKLMNOPQRSTUVWXYZ+-.')
+WHITESPACE_CHARS = frozenset(' \t\n\r')
+STRINGPLAIN = re.compile(r'[^"\\]*')
+
+SCANERROR = re.compile(r'(.*): line \d+ column \d+(?: - line \d+ column \d+)? \(char (\d+)', re.DOTALL)
+
+class py_make_push_parser(object):
+    """
+    Incremental decoder for JSON text that arrives in chunks.  ``feed``
+    returns each top-level value as soon as it is complete.  With
+    ``items`` set, the stream must hold one array and each element is
+    returned as soon as it is complete.
+    """
+    VALUE, STRING, ESCAPE, TOKEN, NESTED, ERROR = range(6)
+    EXPECT_OPEN, EXPECT_FIRST, EXPECT_VALUE, EXPECT_DELIMITER, EXPECT_END = range(5)
+
+    def __init__(self, context, items=False):
+        if callable(context):
+            self.scanner = context
+        else:
+            self.scanner = py_make_scanner(context)
+        self.items = bool(items)
+        self.offset = 0
+        self._buf = ''
+        self._pos = 0
+        self._start = -1
+        self._depth = 0
+        self._state = self.VALUE
+        self._expect = self.EXPECT_OPEN
+        self._running = False
+        self._pending = None
+
+    def _error(self, msg, pos):
+        self._state = self.ERROR
+        return ValueError('%s: stream offset %d' % (msg, self.offset + pos))
+
+    def _emit(self, values, end):
+        doc = self._buf[self._start:end]
+        try:
+            obj, next_idx = self.scanner(doc, 0)
+        except StopIteration:
+            raise self._error("No JSON object could be decoded", self._start)
+        except ValueError, e:
+            # restate "msg: line L column C (char N)" about doc in the
+            # stream's terms, leave errors from hooks alone
+            self._state = self.ERROR
+            m = SCANERROR.match(str(e))
+            if m is None:
+                raise
+            raise self._error(m.group(1), self._start + int(m.group(2)))
+        except:
+            self._state = self.ERROR
+            raise
+        if next_idx != len(doc):
+            raise self._error("Extra data", self._start + next_idx)
+        values.append(obj)
+        self._start = -1
+        self._state = self.VALUE
+        if self.items:
+            self._expect = self.EXPECT_DELIMITER
+
+    def _begin(self, pos):
+        c = self._buf[pos]
+        self._start = pos
+        if c == '"':
+            self._state = self.STRING
+        elif c == '{' or c == '[':
+            self._depth = int(self.items) + 1
+            self._state = self.NESTED
+        elif c in TOKEN_CHARS:
+            self._state = self.TOKEN
+        else:
+            raise self._error("Expecting value", pos)
+
+    def _scan(self, values, _plain=STRINGPLAIN.match):
+        buf = self._buf
+        pos = self._pos
+        base = int(self.items)
+        while pos < len(buf):
+            c = buf[pos]
+            state = self._state
+            if state == self.STRING:
+                pos = _plain(buf, pos).end()
+                if pos == len(buf):
+                    break
+                pos += 1
+                if buf[pos - 1] == '\\':
+                    self._state = self.ESCAPE
+                elif self._depth > base:
+                    self._state = self.NESTED
+                else:
+                    self._emit(values, pos)
+            elif state == self.ESCAPE:
+                pos += 1
+                self._state = self.STRING
+            elif state == self.TOKEN:
+                if c in TOKEN_CHARS:
+                    pos += 1
+                else:
+                    self._emit(values, pos)
+            elif state == self.NESTED:
+                pos += 1
+                if c == '"':
+                    self._state = self.STRING
+                elif c == '{' or c == '[':
+                    self._depth += 1
+                elif c == '}' or c == ']':
+                    self._depth -= 1
+                    if self._depth == base:
+                        self._emit(values, pos)
+            elif state == self.VALUE:
+                expect = self._expect
+                if c in WHITESPACE_CHARS:
+                    pos += 1
+                elif not self.items:
+                    self._begin(pos)
+                    pos += 1
+                elif expect == self.EXPECT_OPEN:
+                    if c != '[':
+                        raise self._error("Expecting array", pos)
+                    self._expect = self.EXPECT_FIRST
+                    pos += 1
+                elif expect == self.EXPECT_END:
+                    raise self._error("Extra data", pos)
+                elif c == ']' and expect != self.EXPECT_VALUE:
+                    self._expect = self.EXPECT_END
+                    pos += 1
+                elif expect == self.EXPECT_DELIMITER:
+                    if c != ',':
+                        raise self._error("Expecting , delimiter", pos)
+                    self._expect = self.EXPECT_VALUE
+                    pos += 1
+                else:
+                    self._begin(pos)
+                    pos += 1
+            else:
+                raise ValueError("push parser is in an error state")
+        self._pos = pos
+
+    def _compact(self):
+        if self._start == -1:
+            drop = self._pos
+        else:
+            drop = self._start
+            self._start -= drop
+        self._buf = self._buf[drop:]
+        self._pos -= drop
+        self.offset += drop
+
+    def _ready(self):
+        # An error held back by the previous feed() is raised now
+        if self._running:
+            raise ValueError("push parser is already running")
+        if self._pending is not None:
+            e, self._pending = self._pending, None
+            raise e
+        if self._state == self.ERROR:
+            raise ValueError("push parser is in an error state")
+
+    def feed(self, data):
+        """
+        Add a chunk of encoded JSON text and return the values it completed.
+        If the chunk goes wrong after completing some values, those are
+        returned and the error is raised by the next call.
+        """
+        self._ready()
+        self._buf += str(data)
+        values = []
+        # hooks run by the scanner must not feed() while _buf is in use
+        self._running = True
+        try:
+            try:
+                self._scan(values)
+            except Exception, e:
+                self._state = self.ERROR
+                if not values:
+                    raise
+                self._pending = e
+                return values
+        finally:
+            self._running = False
+        self._compact()
+        return values
+
+    def close(self):
+        """
+        Finish the stream and return any value completed by its end.
+        Raises ValueError if the stream stops inside a value.
+        """
+        self._ready()
+        values = []
+        if self._state == self.TOKEN:
+            self._running = True
+            try:
+                self._emit(values, len(self._buf))
+            finally:
+                self._running = False
+        if self._state != self.VALUE:
+            raise self._error("Unterminated value starting at", self._start)
+        if self.items and self._expect != self.EXPECT_END:
+            raise self._error("Unterminated array", len(self._buf))
+        self._compact()
+        return values
+
+make_push_parser = c_make_push_parser or py_make_push_parser
+
+LAZYTOKEN = re.compile(r'[0-9a-zA-Z+\-.]*')
+LAZYCLOSE = {'{': '}', '[': ']'}
+
+def _lazy_string_end(s, idx, _plain=STRINGPLAIN.match):
+    # Index just past the closing quote of the string whose body starts
+    # at idx, or -1.  Escapes are checked when the string is read.
+    n = len(s)
+    while True:
+        idx = _plain(s, idx).end()
+        if idx >= n:
+            return -1
+        if s[idx] == '"':
+            return idx + 1
+        idx += 2
+
+def _lazy_tape(s, _w=WHITESPACE.match, _token=LAZYTOKEN.match):
+    # [start, end, next] for every value and object key in document order,
+    # next being the index just past the entry and its children
+    tape = []
+    stack = []
+    n = len(s)
+
+    def key(idx):
+        if idx >= n or s[idx] != '"':
+            raise ValueError(errmsg("Expecting property name", s, idx))
+        end = _lazy_string_end(s, idx + 1)
+        if end < 0:
+            raise ValueError(errmsg("Unterminated string starting at", s, idx))
+        tape.append([idx, end, len(tape) + 1])
+        idx = _w(s, end).end()
+        if idx >= n or s[idx] != ':':
+            raise ValueError(errmsg("Expecting : delimiter", s, idx))
+        return _w(s, idx + 1).end()
+
+    idx = _w(s, 0).end()
+    while True:
+        if idx >= n:
+            raise ValueError(errmsg("Expecting value", s, idx))
+        c = s[idx]
+        entry = [idx, -1, -1]
+        tape.append(entry)
+        if c == '{' or c == '[':
+            stack.append(entry)
+            idx = _w(s, idx + 1).end()
+            if idx >= n or s[idx] != LAZYCLOSE[c]:
+                if c == '{':
+                    idx = key(idx)
+                continue
+        else:
+            if c == '"':
+                end = _lazy_string_end(s, idx + 1)
+                if end < 0:
+                    raise ValueError(errmsg("Unterminated string starting at", s, idx))
+            else:
+                end = _token(s, idx).end()
+                if end == idx:
+                    raise ValueError(errmsg("Expecting value", s, idx))
+            entry[1] = end
+            entry[2] = len(tape)
+            idx = _w(s, end).end()
+        # After a complete value: close containers or go on to the next member
+        while stack:
+            c = s[stack[-1][0]]
+            if idx < n and s[idx] == LAZYCLOSE[c]:
+                entry = stack.pop()
+                entry[1] = idx + 1
+                entry[2] = len(tape)
+                idx = _w(s, idx + 1).end()
+            elif idx < n and s[idx] == ',':
+                idx = _w(s, idx + 1).end()
+                if c == '{':
+                    idx = key(idx)
+                break
+            else:
+                raise ValueError(errmsg("Expecting , delimiter", s, idx))
+        if not stack:
+            break
+    if idx != n:
+        raise ValueError(errmsg("Extra data", s, idx))
+    return tape
+
+class py_make_lazy_document(object):
+    """
+    JSON document that is decoded on demand.  ``s`` is indexed once,
+    then reading a key or index builds only that value; objects and
+    arrays are returned as further lazy documents.  ``load()`` decodes
+    the value completely.
+    """
+    def __init__(self, context, s):
+        if callable(context):
+            self._scanner = context
+        else:
+            self._scanner = py_make_scanner(context)
+        if not isinstance(s, basestring):
+            raise TypeError("s must be a string, not %s" % (type(s).__name__,))
+        self._s = s
+        self._tape = _lazy_tape(s)
+        self._node = 0
+        self._count = None
+        self._cache = None
+
+    def _view(self, node):
+        view = object.__new__(type(self))
+        view._scanner = self._scanner
+        view._s = self._s
+        view._tape = self._tape
+        view._node = node
+        view._count = None
+        view._cache = None
+        return view
+
+    def _kind(self):
+        c = self._s[self._tape[self._node][0]]
+        if c == '{' or c == '[':
+            return c
+        return None
+
+    def _check_kind(self, kind=None):
+        c = self._kind()
+        if c is None or (kind is not None and c != kind):
+            if kind == '{':
+                raise TypeError("JSON value is not an object")
+            raise TypeError("JSON value is not a container")
+
+    def _load(self, node):
+        start, end, _ = self._tape[node]
+        try:
+            obj, next_idx = self._scanner(self._s, start)
+        except StopIteration:
+            raise ValueError(errmsg("Expecting value", self._s, start))
+        if next_idx != end:
+            raise ValueError(errmsg("Extra data", self._s, next_idx))
+        return obj
+
+    def _child(self, node):
+        c = self._s[self._tape[node][0]]
+        if c == '{' or c == '[':
+            return self._view(node)
+        return self._load(node)
+
+    def _members(self):
+        tape = self._tape
+        child = self._node + 1
+        end = tape[self._node][2]
+        while child < end:
+            yield child
+            child = tape[child][2]
+
+    def _find(self, key):
+        found = -1
+        if isinstance(key, basestring):
+            members = self._members()
+            for k in members:
+                if self._load(k) == key:
+                    found = k + 1
+                members.next()
+        return found
+
+    def __len__(self):
+        self._check_kind()
+        if self._count is None:
+            if self._kind() == '{':
+                self._count = len(self.keys())
+            else:
+                self._count = len(list(self._members()))
+        return self._count
+
+    def __getitem__(self, key):
+        kind = self._kind()
+        if kind == '{':
+            child = self._find(key)
+            if child < 0:
+                raise KeyError(key)
+        elif kind == '[':
+            if not isinstance(key, (int, long)):
+                raise TypeError("list indices must be integers, not %s" % (type(key).__name__,))
+            if key < 0:
+                key += len(self)
+            child = -1
+            if key >= 0:
+                # Walk on from the last element found
+                i, child = 0, self._node + 1
+                if self._cache is not None and self._cache[0] <= key:
+                    i, child = self._cache
+                end = self._tape[self._node][2]
+                while child < end and i < key:
+                    child = self._tape[child][2]
+                    i += 1
+                if child >= end:
+                    child = -1
+                else:
+                    self._cache = (key, child)
+            if child < 0:
+                raise IndexError("list index out of range")
+        else:
+            self._check_kind()
+        return self._child(child)
+
+    def __contains__(self, key):
+        self._check_kind('{')
+        return self._find(key) >= 0
+
+    def get(self, key, default=None):
+        """
+        The value for ``key`` if the object has it, else ``default``.
+        """
+        self._check_kind('{')
+        child = self._find(key)
+        if child < 0:
+            return default
+        return self._child(child)
+
+    def keys(self):
+        """
+        The keys of the object in document order.  A repeated key is
+        listed once, where it first appears.
+        """
+        self._check_kind('{')
+        keys = []
+        seen = set()
+        members = self._members()
+        for k in members:
+            key = self._load(k)
+            if key not in seen:
+                seen.add(key)
+                keys.append(key)
+            members.next()
+        return keys
+
+    def load(self):
+        """
+        Decode this value completely, as ``loads()`` would.
+        """
+        return self._load(self._node)
+
+make_lazy_document = c_make_lazy_document or py_make_lazy_document
+
+
+class py_make_line_reader(object):
+    """
+    Iterator over newline-delimited JSON, yielding the value on each
+    non-blank line.  ``source`` is a string or buffer, or a file that is
+    read ``chunk_size`` bytes at a time.  With ``offsets`` set,
+    ``(offset, value)`` pairs are yielded, where ``offset`` is where the
+    record's line starts in the source.
+    """
+    def __init__(self, context, source, offsets=False, chunk_size=65536):
+        if callable(context):
+            self.scanner = context
+        else:
+            self.scanner = py_make_scanner(context)
+        if chunk_size <= 0:
+            raise ValueError("chunk_size must be positive")
+        self.offsets = offsets
+        self.chunk_size = chunk_size
+        if isinstance(source, basestring):
+            self._read = None
+            self._s = source
+        else:
+            try:
+                self._s = buffer(source)[:]
+                self._read = None
+            except TypeError:
+                self._read = getattr(source, 'read', None)
+                if self._read is None:
+                    raise TypeError("source must be a string, buffer or file, not %s"
+                                    % (type(source).__name__,))
+                self._s = ''
+        self._eof = self._read is None
+        self._pos = 0
+        self._offset = 0
+
+    def __iter__(self):
+        return self
+
+    def _fill(self):
+        rest = self._s[self._pos:]
+        chunk = self._read(max(len(rest), self.chunk_size))
+        if not isinstance(chunk, str):
+            raise TypeError("read() must return a string, not %s"
+                            % (type(chunk).__name__,))
+        if not chunk:
+            self._eof = True
+            return
+        self._offset += self._pos
+        self._pos = 0
+        self._s = rest + chunk
+
+    def _decode(self, line, start):
+        idx = WHITESPACE.match(line, 0).end()
+        try:
+            obj, end = self.scanner(line, idx)
+        except StopIteration:
+            msg = "No JSON object could be decoded"
+        except ValueError, e:
+            msg = str(e)
+        else:
+            end = WHITESPACE.match(line, end).end()
+            if end == len(line):
+                return obj
+            msg = errmsg("Extra data", line, end, len(line))
+        raise ValueError("%s (record at offset %d)" % (msg, self._offset + start))
+
+    def next(self):
+        while True:
+            s = self._s
+            start = self._pos
+            if start >= len(s) and self._eof:
+                raise StopIteration
+            end = s.find('\n', start)
+            if end == -1:
+                if not self._eof:
+                    self._fill()
+                    continue
+                end = len(s)
+            self._pos = end + 1
+            line = s[start:end]
+            if line.strip(' \t\n\r'):
+                break
+        obj = self._decode(line, start)
+        if self.offsets:
+            return self._offset + start, obj
+        return obj
+
+make_line_reader = c_make_line_reader or py_make_line_reader
+
+
+MINIFY = re.compile(r'("(?:[^"\\]+|\\.)*")|[ \t\n\r]+', re.DOTALL)
+
+def _py_checker(strict):
+    # validate() and minify() without the C extension, which must not
+    # pick up the C scanner either
+    decoder = JSONDecoder(strict=strict)
+    decoder.scan_once = py_make_scanner(decoder)
+    return decoder
+
+def py_validate(s, strict=True):
+    """
+    Return True if ``s`` is a single JSON document that ``loads()``
+    would accept.
+    """
+    try:
+        _py_checker(strict).decode(s)
+    except ValueError:
+        return False
+    return True
+
+def py_minify(s, strict=True):
+    """
+    Return ``s`` with all whitespace outside of strings removed, raising
+    ``ValueError`` if it is not a single valid JSON document.
+    """
+    _py_checker(strict).decode(s)
+    return MINIFY.sub(lambda m: m.group(1) or '', s)
+
+validate = c_validate or py_validate
+minify = c_minify or py_minify
+
+
 class JSONDecoder(object):
     """
     Simple JSON <http://json.org> decoder
@@ -264,10 +872,12 @@ class JSONDecoder(object):
     their corresponding ``float`` values, which is outside the JSON spec.
     """
 
-    __all__ = ['__init__', 'decode', 'raw_decode']
+    __all__ = ['__init__', 'decode', 'raw_decode', 'decode_many', 'push_parser', 'lazy_decode',
+               'decode_lines']
 
     def __init__(self, encoding=None, object_hook=None, parse_float=None,
-            parse_int=None, parse_constant=None, strict=True):
+            parse_int=None, parse_constant=None, strict=True,
+            record_type=None, record_fields=None, max_depth=None):
         """
         ``encoding`` determines the encoding used to interpret any ``str``
         objects decoded by this instance (utf-8 by default).  It has no
@@ -295,14 +905,51 @@ class JSONDecoder(object):
         following strings: -Infinity, Infinity, NaN.
         This can be used to raise an exception if invalid JSON numbers
         are encountered.
+
+        ``record_fields``, if specified, is a sequence of field names.  Every
+        JSON object whose keys are all among them is decoded as a tuple of
+        its values in that order, with None for missing fields, and
+        ``object_hook`` only sees the other objects.  ``record_type`` makes
+        them instances of a tuple subclass such as a ``namedtuple`` instead,
+        and supplies ``record_fields`` from its ``_fields`` when they are not
+        given.  The C scanner fills records in without building a dict or
+        calling back into Python, other types of ``record_type`` are called
+        with the values as positional arguments.
+
+        ``max_depth``, if specified, is how deeply objects and arrays may
+        nest (1000 by default).  Deeper documents raise ``ValueError``.
+        The C scanner keeps open containers on a stack of its own rather
+        than recursing, so the limit, not the thread's stack, bounds what
+        a hostile document can cost.  The pure Python scanner recurses
+        for every level and so usually hits the interpreter's recursion
+        limit first, a few hundred levels in, which raises
+        ``RuntimeError``.
         """
+        if record_fields is None and record_type is not None:
+            record_fields = record_type._fields
+        if record_fields is not None:
+            for name in record_fields:
+                if not isinstance(name, basestring):
+                    raise TypeError("record_fields must be a sequence of strings")
+            record_fields = tuple(map(unicode, record_fields))
+            if not record_fields:
+                raise ValueError("record_fields must not be empty")
+            if len(set(record_fields)) != len(record_fields):
+                raise ValueError("record_fields must not repeat a field")
+            if record_type is None:
+                record_type = tuple
         self.encoding = encoding
         self.object_hook = object_hook
         self.parse_float = parse_float or float
         self.parse_int = parse_int or int
         self.parse_constant = parse_constant or _CONSTANTS.__getitem__
         self.strict = strict
+        self.record_type = record_type
+        self.record_fields = record_fields
+        self.max_depth = max_depth
         self.parse_object = JSONObject
+        if record_fields is not None:
+            self.parse_object = make_record_parser(record_type, record_fields)
         self.parse_array = JSONArray
         self.parse_string = scanstring
         self.scan_once = make_scanner(self)
@@ -311,6 +958,11 @@ class JSONDecoder(object):
         """
         Return the Python representation of ``s`` (a ``str`` or ``unicode``
         instance containing a JSON document)
+
+        ``s`` can also be any object with a read buffer, such as an
+        ``mmap``, ``bytearray`` or ``buffer`` of encoded text.  The C
+        scanner parses it in place without copying it, so a large file can
+        be decoded straight from an ``mmap``.
         """
         obj, end = self.raw_decode(s, idx=_w(s, 0).end())
         end = _w(s, end).end()
@@ -327,10 +979,77 @@ class JSONDecoder(object):
         This can be used to decode a JSON document from a string that may
         have extraneous data at the end.
         """
+        if (not isinstance(s, basestring) and
+                (c_make_scanner is None or not isinstance(self.scan_once, c_make_scanner))):
+            # only the C scanner reads buffers in place
+            s = buffer(s)[:]
         try:
             obj, end = self.scan_once(s, idx)
         except StopIteration:
             raise ValueError("No JSON object could be decoded")
         return obj, end
 
+    def decode_many(self, docs):
+        """
+        Decode each of the JSON documents in ``docs`` and return the list
+        of results.  A document that fails to decode gets its
+        ``ValueError`` in its place in the list rather than stopping the
+        batch.
+
+        With the C speedups the whole batch is decoded in one call and
+        object keys are shared across the documents.
+        """
+        if c_make_scanner is not None and isinstance(self.scan_once, c_make_scanner):
+            return self.scan_once.decode_many(docs)
+        results = []
+        for s in docs:
+            try:
+                results.append(self.decode(s))
+            except ValueError, e:
+                results.append(e)
+        return results
+
+    def push_parser(self, items=False):
+        """
+        Return an incremental parser for text that arrives in chunks.  Its
+        ``feed(data)`` method returns the list of values completed so far
+        and ``close()`` checks that the stream did not stop mid-value.
+
+        With ``items`` set, the stream must hold a single JSON array and
+        each of its elements is returned as soon as it is complete.
+        """
+        return make_push_parser(self, items)
+
+    def lazy_decode(self, s):
+        """
+        Return a lazy document for ``s``, which is indexed once without
+        building any values.  Indexing it with a key or position decodes
+        just that value, objects and arrays come back as lazy documents,
+        and ``load()`` decodes a value completely::
+
+            doc = JSONDecoder().lazy_decode(state)
+            params = doc['mapreduce_spec']['params'].load()
+
+        Only the structure of ``s`` is checked up front, values that are
+        never read are never validated.
+        """
+        return make_lazy_document(self.scan_once, s)
+
+    def decode_lines(self, source, offsets=False):
+        """
+        Return an iterator over the values in newline-delimited JSON
+        (JSON lines), one document per non-blank line.  ``source`` can be
+        a ``str``, ``unicode`` or buffer such as an ``mmap``, which is
+        scanned in place, or a file, which is read in large chunks::
+
+            for offset, record in decoder.decode_lines(f, offsets=True):
+                ...
+
+        With ``offsets`` set, each value comes paired with the offset of
+        its line in the source, suitable for ``f.seek()``.  A record that
+        fails to decode raises ``ValueError`` naming its offset, and
+        iteration can carry on with the next record.
+        """
+        return make_line_reader(self.scan_once, source, offsets)
+
 __all__ = ['JSONDecoder']
@@ -1,16 +1,25 @@
 """
 Implementation of JSONEncoder
 """
+import os
 import re
 
 try:
     from simplejson._speedups import encode_basestring_ascii as c_encode_basestring_ascii
 except ImportError:
     c_encode_basestring_ascii = None
+try:
+    from simplejson._speedups import encode_basestring as c_encode_basestring
+except ImportError:
+    c_encode_basestring = None
 try:
     from simplejson._speedups import make_encoder as c_make_encoder
 except ImportError:
     c_make_encoder = None
+try:
+    from simplejson._speedups import make_record_encoder as c_make_record_encoder
+except ImportError:
+    c_make_record_encoder = None
 
 ESCAPE = re.compile(r'[\x00-\x1f\\"\b\f\n\r\t]')
 ESCAPE_ASCII = re.compile(r'([\\"]|[^\ -~])')
@@ -31,7 +40,7 @@ for i in range(0x20):
 INFINITY = float('1e66666')
 FLOAT_REPR = repr
 
-def encode_basestring(s):
+def py_encode_basestring(s):
     """
     Return a JSON representation of a Python string
     """
@@ -61,6 +70,7 @@ def py_encode_basestring_ascii(s):
 
 
 encode_basestring_ascii = c_encode_basestring_ascii or py_encode_basestring_ascii
+encode_basestring = c_encode_basestring or py_encode_basestring
 
 class JSONEncoder(object):
     """
@@ -91,12 +101,15 @@ class JSONEncoder(object):
     object for ``o`` if possible, otherwise it should call the superclass
     implementation (to raise ``TypeError``).
     """
-    __all__ = ['__init__', 'default', 'encode', 'iterencode']
+    __all__ = ['__init__', 'default', 'encode', 'iterencode', 'dump', 'record_encoder']
     item_separator = ', '
     key_separator = ': '
+    # (settings, encoder) for the last C encoder made, see _make_encoder
+    _c_encoder = None
     def __init__(self, skipkeys=False, ensure_ascii=True,
             check_circular=True, allow_nan=True, sort_keys=False,
-            indent=None, separators=None, encoding='utf-8', default=None):
+            indent=None, separators=None, encoding='utf-8', default=None,
+            use_decimal=False, use_datetime=False, use_set=False):
         """
         Constructor for JSONEncoder, with sensible defaults.
 
@@ -138,6 +151,13 @@ class JSONEncoder(object):
         If encoding is not None, then all input strings will be
         transformed into unicode using that encoding prior to JSON-encoding.
         The default is UTF-8.
+
+        If use_decimal is True, then decimal.Decimal values are encoded as
+        JSON numbers with exactly the digits of str(value).  If use_datetime
+        is True, then date and datetime values are encoded as their
+        isoformat() strings.  If use_set is True, then set and frozenset
+        values are encoded as arrays.  These are handled natively by the C
+        speedups instead of calling default for every value.
         """
 
         self.skipkeys = skipkeys
@@ -151,6 +171,9 @@ class JSONEncoder(object):
         if default is not None:
             self.default = default
         self.encoding = encoding
+        self.use_decimal = use_decimal
+        self.use_datetime = use_datetime
+        self.use_set = use_set
 
     def default(self, o):
         """
@@ -208,6 +231,86 @@ class JSONEncoder(object):
             for chunk in JSONEncoder().iterencode(bigobject):
                 mysocket.write(chunk)
         """
+        return self._make_encoder(_one_shot)(o, 0)
+
+    def dump(self, o, fp):
+        """
+        Write the JSON representation of ``o`` to ``fp``, a
+        ``.write()``-supporting file-like object or an integer file
+        descriptor.
+
+        With the C speedups the output is buffered natively and written
+        in large blocks rather than one call per chunk.  A file descriptor
+        is always written UTF-8 encoded bytes.  Subclasses that override
+        ``iterencode`` or ``encode`` are written chunk by chunk from
+        ``iterencode``.
+        """
+        if (c_make_encoder is not None
+                and getattr(self.iterencode, 'im_func', None) is JSONEncoder.iterencode.im_func
+                and getattr(self.encode, 'im_func', None) is JSONEncoder.encode.im_func):
+            _iterencode = self._make_encoder(_one_shot=True)
+            if isinstance(_iterencode, c_make_encoder):
+                _iterencode.dump(o, fp)
+                return
+        if isinstance(fp, (int, long)):
+            def write(chunk, _fd=fp, _write=os.write):
+                if isinstance(chunk, unicode):
+                    chunk = chunk.encode('utf-8')
+                while chunk:
+                    chunk = chunk[_write(_fd, chunk):]
+        else:
+            write = fp.write
+        # could accelerate with writelines in some versions of Python, at
+        # a debuggability cost
+        for chunk in self.iterencode(o):
+            write(chunk)
+
+    def record_encoder(self, fields):
+        """
+        Return a callable that encodes a list of records, all with the
+        field names in the sequence ``fields``, as a JSON array.
+
+        A record is a dict with exactly those keys, or a tuple (such as
+        a namedtuple) with one value per field, and is encoded as an
+        object with the fields in the given order, or sorted if
+        sort_keys is True.  Tuple values are always taken in the given
+        order, and a tuple of any other length raises ``ValueError``.
+        Other items are encoded as usual.  With the
+        C speedups the keys and separators are escaped once here rather
+        than for every record::
+
+            encode_items = JSONEncoder().record_encoder(('time', 'title'))
+            text = encode_items([{'time': 1, 'title': 'a'}, (2, 'b')])
+        """
+        fields = tuple(fields)
+        for name in fields:
+            if not isinstance(name, basestring):
+                raise TypeError("fields must be a sequence of strings")
+        if not fields:
+            raise ValueError("fields must not be empty")
+        if len(set(fields)) != len(fields):
+            raise ValueError("fields must not repeat a field")
+        _iterencode = self._make_encoder(_one_shot=True)
+        if c_make_record_encoder is not None and isinstance(_iterencode, c_make_encoder):
+            return c_make_record_encoder(_iterencode, fields)
+        return py_make_record_encoder(self, fields)
+
+    def _make_encoder(self, _one_shot=False):
+        _use_c = (_one_shot and c_make_encoder is not None
+                  and (self.indent is None or isinstance(self.indent, (int, long))))
+        if _use_c:
+            # The C encoder keeps no state between calls, so the one made
+            # for the current settings is reused, by any number of threads.
+            # The key also catches settings changed after the first call.
+            key = (c_make_encoder, encode_basestring_ascii, encode_basestring,
+                   self.check_circular, self.ensure_ascii, self.encoding,
+                   self.default, self.indent, self.key_separator,
+                   self.item_separator, self.sort_keys, self.skipkeys,
+                   self.allow_nan, self.use_decimal, self.use_datetime,
+                   self.use_set)
+            cached = self._c_encoder
+            if cached is not None and cached[0] == key:
+                return cached[1]
         if self.check_circular:
             markers = {}
         else:
@@ -240,21 +343,82 @@ class JSONEncoder(object):
                     % (o,))
 
             return text
+
+        def decimalstr(o, allow_nan=self.allow_nan):
+            if o.is_finite():
+                return str(o)
+            if not allow_nan:
+                raise ValueError("Out of range float values are not JSON compliant: %r"
+                    % (o,))
+            if o.is_nan():
+                return 'NaN'
+            elif o.is_signed():
+                return '-Infinity'
+            return 'Infinity'
         
         
-        if _one_shot and c_make_encoder is not None and not self.indent and not self.sort_keys:
+        if _use_c:
             _iterencode = c_make_encoder(
                 markers, self.default, _encoder, self.indent,
                 self.key_separator, self.item_separator, self.sort_keys,
-                self.skipkeys, self.allow_nan)
+                self.skipkeys, self.allow_nan,
+                use_decimal=self.use_decimal, use_datetime=self.use_datetime,
+                use_set=self.use_set)
+            self._c_encoder = (key, _iterencode)
         else:
+            _Decimal = _date = None
+            if self.use_decimal:
+                from decimal import Decimal as _Decimal
+            if self.use_datetime:
+                from datetime import date as _date
             _iterencode = _make_iterencode(
                 markers, self.default, _encoder, self.indent, floatstr,
                 self.key_separator, self.item_separator, self.sort_keys,
-                self.skipkeys, _one_shot)
-        return _iterencode(o, 0)
+                self.skipkeys, _one_shot, _Decimal, decimalstr, _date,
+                self.use_set)
+        return _iterencode
+
+class _Record(dict):
+    # A record as a dict whose items come out in field order
+    def __init__(self, fields, values):
+        dict.__init__(self, zip(fields, values))
+        self._fields = fields
+
+    def iteritems(self):
+        for key in self._fields:
+            yield key, self[key]
+
+
+class py_make_record_encoder(object):
+    """
+    Pure Python version of make_record_encoder, which takes the
+    JSONEncoder rather than its C encoder
+    """
+    def __init__(self, encoder, fields):
+        self.encoder = encoder
+        self.fields = tuple(fields)
+
+    def __call__(self, records):
+        fields = self.fields
+        items = []
+        for record in records:
+            if isinstance(record, tuple):
+                if len(record) != len(fields):
+                    raise ValueError("record has %d values for %d fields"
+                                     % (len(record), len(fields)))
+                record = _Record(fields, record)
+            elif isinstance(record, dict) and len(record) == len(fields):
+                for key in fields:
+                    if key not in record:
+                        break
+                else:
+                    record = _Record(fields, [record[key] for key in fields])
+            items.append(record)
+        return ''.join(self.encoder._make_encoder()(items, 0))
+
 
 def _make_iterencode(markers, _default, _encoder, _indent, _floatstr, _key_separator, _item_separator, _sort_keys, _skipkeys, _one_shot,
+        _Decimal=None, _decimalstr=None, _date=None, _use_set=False,
         ## HACK: hand-optimized bytecode; turn globals into locals
         False=False,
         True=True,
@@ -269,6 +433,8 @@ def _make_iterencode(markers, _default, _encoder, _indent, _floatstr, _key_separ
         long=long,
         str=str,
         tuple=tuple,
+        frozenset=frozenset,
+        set=set,
     ):
 
     def _iterencode_list(lst, _current_indent_level):
@@ -363,6 +529,10 @@ def _make_iterencode(markers, _default, _encoder, _indent, _floatstr, _key_separ
                 key = 'false'
             elif key is None:
                 key = 'null'
+            elif _Decimal is not None and isinstance(key, _Decimal):
+                key = _decimalstr(key)
+            elif _date is not None and isinstance(key, _date):
+                key = key.isoformat()
             elif _skipkeys:
                 continue
             else:
@@ -420,6 +590,13 @@ def _make_iterencode(markers, _default, _encoder, _indent, _floatstr, _key_separ
         elif isinstance(o, dict):
             for chunk in _iterencode_dict(o, _current_indent_level):
                 yield chunk
+        elif _Decimal is not None and isinstance(o, _Decimal):
+            yield _decimalstr(o)
+        elif _date is not None and isinstance(o, _date):
+            yield _encoder(o.isoformat())
+        elif _use_set and isinstance(o, (set, frozenset)):
+            for chunk in _iterencode_list(o, _current_indent_level):
+                yield chunk
         else:
             if markers is not None:
                 markerid = id(o)
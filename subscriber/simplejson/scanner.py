@@ -2,6 +2,7 @@
 JSON token scanner
 """
 import re
+import threading
 try:
     from simplejson._speedups import make_scanner as c_make_scanner
 except ImportError:
@@ -9,6 +10,8 @@ except ImportError:
 
 __all__ = ['make_scanner']
 
+MAX_DEPTH = 1000
+
 NUMBER_RE = re.compile(
     r'(-?(?:0|[1-9]\d*))(\.\d+)?([eE][-+]?\d+)?',
     (re.VERBOSE | re.MULTILINE | re.DOTALL))
@@ -24,6 +27,15 @@ def py_make_scanner(context):
     parse_int = context.parse_int
     parse_constant = context.parse_constant
     object_hook = context.object_hook
+    max_depth = getattr(context, 'max_depth', None)
+    if max_depth is None:
+        max_depth = MAX_DEPTH
+    elif max_depth < 1:
+        raise ValueError("max_depth must be positive")
+
+    # number of containers open around the current position, per thread
+    # and counted from zero again by hooks that decode with this scanner
+    state = threading.local()
 
     def _scan_once(string, idx):
         try:
@@ -33,10 +45,18 @@ def py_make_scanner(context):
         
         if nextchar == '"':
             return parse_string(string, idx + 1, encoding, strict)
-        elif nextchar == '{':
-            return parse_object((string, idx + 1), encoding, strict, _scan_once, object_hook)
-        elif nextchar == '[':
-            return parse_array((string, idx + 1), _scan_once)
+        elif nextchar == '{' or nextchar == '[':
+            depth = state.depth
+            if depth >= max_depth:
+                from simplejson.decoder import errmsg
+                raise ValueError(errmsg("Maximum nesting depth exceeded", string, idx))
+            state.depth = depth + 1
+            try:
+                if nextchar == '{':
+                    return parse_object((string, idx + 1), encoding, strict, _scan_once, object_hook)
+                return parse_array((string, idx + 1), _scan_once)
+            finally:
+                state.depth = depth
         elif nextchar == 'n' and string[idx:idx + 4] == 'null':
             return None, idx + 4
         elif nextchar == 't' and string[idx:idx + 4] == 'true':
@@ -60,7 +80,15 @@ def py_make_scanner(context):
             return parse_constant('-Infinity'), idx + 9
         else:
             raise StopIteration
-    
-    return _scan_once
+
+    def scan_once(string, idx):
+        outer = getattr(state, 'depth', 0)
+        state.depth = 0
+        try:
+            return _scan_once(string, idx)
+        finally:
+            state.depth = outer
+
+    return scan_once
 
 make_scanner = c_make_scanner or py_make_scanner
\ No newline at end of file
@@ -20,3 +20,216 @@ class TestDecode(TestCase):
         # exercise the uncommon cases. The array cases are already covered.
         rval = S.loads('{   "key"    :    "value"    ,  "k":"v"    }')
         self.assertEquals(rval, {"key":"value", "k":"v"})
+
+    def test_keys_memoized(self):
+        if S.decoder.c_scanstring is None:
+            return
+        for doc in ('[{"a": 1, "\xc3\xa9": 2, "x\\u00e8y": 3}, {"a": 4, "\xc3\xa9": 5, "x\\u00e8y": 6}]',
+                    u'[{"a": 1, "\xe9": 2, "x\\u00e8y": 3}, {"a": 4, "\xe9": 5, "x\\u00e8y": 6}]'):
+            rval = S.loads(doc)
+            self.assertEquals(rval[0].keys(), rval[1].keys())
+            a, b = [sorted(d.keys()) for d in rval]
+            # keys without escapes are shared, escaped keys are decoded again
+            self.assert_(a[0] is b[0])
+            self.assert_(a[1] is not b[1])
+            self.assert_(a[2] is b[2])
+
+    def test_keys_memo_reentrant_codec(self):
+        # A codec that decodes with the same scanner while a key is read
+        import codecs
+        def search(name):
+            if name != 'simplejson_test_reentrant':
+                return None
+            latin = codecs.lookup('latin-1')
+            def decode(data, errors='strict'):
+                if not busy:
+                    busy.append(1)
+                    self.assertEquals(dec.decode('{"k\xe9": 1, "k\xe9": 2}'), {u'k\xe9': 2})
+                    busy.pop()
+                return latin.decode(data, errors)
+            return codecs.CodecInfo(latin.encode, decode, name=name)
+        codecs.register(search)
+        busy = []
+        dec = S.JSONDecoder(encoding='simplejson_test_reentrant')
+        for i in range(3):
+            self.assertEquals(dec.decode('[{"k\xe9": 1}, {"k\xe9": 2}]'),
+                              [{u'k\xe9': 1}, {u'k\xe9': 2}])
+
+    def test_keys_not_leaked(self):
+        if S.decoder.c_scanstring is None:
+            return
+        import sys
+        rval = S.loads('[{"leak_check": 1}, {"leak_check": 2}]')
+        key = rval[0].keys()[0]
+        count = sys.getrefcount(key)
+        del rval
+        self.assertEquals(sys.getrefcount(key), count - 2)
+
+    def test_many_distinct_keys(self):
+        doc = dict(('k%d' % (i,), i) for i in range(2000))
+        self.assertEquals(S.loads(S.dumps([doc, doc])), [doc, doc])
+        self.assertEquals(S.loads(unicode(S.dumps([doc, doc]))), [doc, doc])
+
+    def test_numbers(self):
+        for s in ['1.25', '-0.0', '0', '-0', '123456789012345678',
+                  '1234567890123456789', '-99999999999999999999999',
+                  '1e400', '-1e400', '1e-400', '5e-324', '2.4703282292062328e-324',
+                  '1.7976931348623157e308', '9007199254740993',
+                  '9007199254740993.0', '2.2250738585072011e-308',
+                  '0.1000000000000000055511151231257827021181583404541015625',
+                  '7.2057594037927933e16', '123.456e-2', '1E+2', '1e-5']:
+            if '.' in s or 'e' in s or 'E' in s:
+                expect = float(s)
+            else:
+                expect = int(s)
+            for doc in (s, unicode(s), '[%s]' % (s,), u'[%s]' % (s,)):
+                rval = S.loads(doc)
+                if isinstance(rval, list):
+                    rval = rval[0]
+                self.assertEquals(type(rval), type(expect))
+                self.assertEquals(repr(rval), repr(expect))
+
+    def test_float_at_end(self):
+        # the C scanner used to drop the last fraction digit of a float
+        # that ends the input and report "Extra data"
+        decoder = S.JSONDecoder()
+        for s in ['1.25', '-0.125', '3.14159', '10.75e-1', '0.5']:
+            for scan_once in self._scanners(decoder):
+                for doc in (s, unicode(s)):
+                    self.assertEquals(scan_once(doc, 0), (float(s), len(s)))
+            self.assertEquals(S.loads(s), float(s))
+
+    def test_decode_many(self):
+        docs = [' {"a": [1, 2.5]} ', u'"\\u2603"', '', '[1] 2', '{"a": tru}',
+                '\n null \t', u'{"a": {"b": []}}']
+        decoder = S.JSONDecoder()
+        rval = decoder.decode_many(docs)
+        self.assertEquals(len(rval), len(docs))
+        for doc, result in zip(docs, rval):
+            try:
+                expect = decoder.decode(doc)
+            except ValueError, e:
+                self.assert_(isinstance(result, ValueError))
+                self.assertEquals(str(result), str(e))
+            else:
+                self.assertEquals(result, expect)
+        self.assertRaises(TypeError, decoder.decode_many, ['[]', 1])
+
+    def test_decode_many_shares_keys(self):
+        if S.decoder.c_scanstring is None:
+            return
+        a, b = S.JSONDecoder().decode_many(['{"shared_key": 1}', '{"shared_key": 2}'])
+        self.assert_(a.keys()[0] is b.keys()[0])
+
+    def _scanners(self, decoder):
+        scanners = [S.scanner.py_make_scanner(decoder)]
+        if S.scanner.c_make_scanner is not None:
+            scanners.append(S.scanner.c_make_scanner(decoder))
+        return scanners
+
+    def test_records(self):
+        from collections import namedtuple
+        Entry = namedtuple('Entry', 'time title source')
+        class Pair(object):
+            def __init__(self, a, b):
+                self.a, self.b = a, b
+        docs = ['[{"title": "t", "time": 1, "source": "s"}, {"time": 2}, {}]',
+                u'[{"title": "\\u2603", "time": 1, "source": "s", "title": "u"}]',
+                '{"title": "t", "extra": {"time": 3}}']
+        for doc in docs:
+            expect = S.loads(doc)
+            def as_record(obj, make):
+                if isinstance(obj, list):
+                    return [as_record(v, make) for v in obj]
+                if not isinstance(obj, dict):
+                    return obj
+                obj = dict((k, as_record(v, make)) for k, v in obj.iteritems())
+                if set(obj) <= set(Entry._fields):
+                    return make(obj.get(name) for name in Entry._fields)
+                return obj
+            for record_type, kw, make in [
+                    (Entry, {}, lambda values: Entry(*values)),
+                    (None, {'record_fields': Entry._fields}, tuple)]:
+                decoder = S.JSONDecoder(record_type=record_type, **kw)
+                for scan_once in self._scanners(decoder):
+                    rval, end = scan_once(doc, 0)
+                    self.assertEquals(rval, as_record(expect, make))
+                    if isinstance(rval, list):
+                        # the records themselves, not just equal tuples
+                        self.assertEquals(repr(rval), repr(as_record(expect, make)))
+        decoder = S.JSONDecoder(record_type=Pair, record_fields=['a', 'b'],
+                                object_hook=lambda d: sorted(d.items()))
+        for scan_once in self._scanners(decoder):
+            rval, end = scan_once('[{"b": 2}, {"a": 1, "c": 3}]', 0)
+            self.assertEquals((rval[0].a, rval[0].b), (None, 2))
+            self.assertEquals(rval[1], [(u'a', 1), (u'c', 3)])
+
+    def test_record_fields_checked(self):
+        self.assertRaises(ValueError, S.JSONDecoder, record_fields=[])
+        self.assertRaises(ValueError, S.JSONDecoder, record_fields=['a', u'a'])
+        self.assertRaises(TypeError, S.JSONDecoder, record_fields=['a', 1])
+        self.assertRaises(AttributeError, S.JSONDecoder, record_type=dict)
+
+    def test_decode_buffers(self):
+        import mmap
+        import tempfile
+        doc = S.dumps({'a': [1, 2.5, u'\u2603', 'x\ny', None, True], 'b': {'c': 'd' * 1000}})
+        expect = S.loads(doc)
+        f = tempfile.TemporaryFile()
+        f.write(doc)
+        f.flush()
+        m = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        py_decoder = S.JSONDecoder()
+        py_decoder.scan_once = S.scanner.py_make_scanner(py_decoder)
+        try:
+            for decoder in (S.JSONDecoder(), py_decoder):
+                for src in (m, bytearray(doc), buffer(doc), buffer(' ' + doc + ' ', 1)):
+                    self.assertEquals(decoder.decode(src), expect)
+                for bad in ('{"a": 1,}', '[1, 2] x', '{"a": "\\q"}', '[1,\n 2,\n x]', ''):
+                    try:
+                        decoder.decode(bad)
+                    except ValueError, e:
+                        msg = str(e)
+                    for src in (bytearray(bad), buffer(bad)):
+                        try:
+                            decoder.decode(src)
+                        except ValueError, e:
+                            self.assertEquals(str(e), msg)
+                        else:
+                            self.fail('decoded %r' % (bad,))
+        finally:
+            m.close()
+            f.close()
+        self.assertRaises(TypeError, S.JSONDecoder().scan_once, 1, 0)
+
+    def test_decode_buffer_not_resized(self):
+        if S.scanner.c_make_scanner is None:
+            return
+        data = bytearray('[{"a": 1}, {"a": 2}]')
+        def hook(d):
+            data.extend('   ')
+            return d
+        self.assertRaises(BufferError, S.JSONDecoder(object_hook=hook).decode, data)
+
+    def test_decode_mmap_closed_by_hook(self):
+        # only the C scanner reads an mmap in place
+        if S.scanner.c_make_scanner is None:
+            return
+        import mmap
+        doc = S.dumps([{'a': i, 'b': [1.5, 'x\\u00e9', 2]} for i in range(100)])
+        def closing(action, convert=lambda x: x):
+            m = mmap.mmap(-1, len(doc))
+            m.write(doc)
+            calls = [0]
+            def hook(x):
+                calls[0] += 1
+                if calls[0] == 10:
+                    action(m)
+                return convert(x)
+            return m, hook
+        for action in (mmap.mmap.close, lambda m: m.resize(len(doc) // 2)):
+            for kw, convert in (('object_hook', None), ('parse_float', float), ('parse_int', int)):
+                m, hook = closing(action, convert or (lambda x: x))
+                self.assertRaises(ValueError, S.loads, m, **{kw: hook})
+                m, hook = closing(action, convert or (lambda x: x))
+                self.assertRaises(ValueError, list, S.JSONDecoder(**{kw: hook}).decode_lines(m))
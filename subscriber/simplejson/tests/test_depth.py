@@ -0,0 +1,104 @@
+from unittest import TestCase
+
+import simplejson as S
+from simplejson import scanner
+
+def _nested(depth):
+    return '[' * depth + ']' * depth
+
+class TestDepth(TestCase):
+    def _decoder(self, make_scanner, **kw):
+        dec = S.JSONDecoder(**kw)
+        dec.scan_once = make_scanner(dec)
+        return dec
+
+    def test_c_default_limit(self):
+        if not scanner.c_make_scanner:
+            return
+        dec = S.JSONDecoder()
+        rval = dec.decode(_nested(scanner.MAX_DEPTH))
+        for i in range(scanner.MAX_DEPTH - 1):
+            rval = rval[0]
+        self.assertEquals(rval, [])
+        self.assertRaises(ValueError, dec.decode, _nested(scanner.MAX_DEPTH + 1))
+
+    def test_py_recursion_limit(self):
+        # The fallback recurses for every level, so the interpreter's
+        # recursion limit comes before MAX_DEPTH and is not reported as it
+        dec = self._decoder(scanner.py_make_scanner)
+        self.assertEquals(dec.decode(_nested(50)[:-1] + ', 1]')[-1], 1)
+        self.assertRaises(RuntimeError, dec.decode, _nested(scanner.MAX_DEPTH))
+        self.assertEquals(dec.decode('[[]]'), [[]])
+
+    def test_py_threads(self):
+        # Each thread counts its own open containers
+        import threading
+        dec = self._decoder(scanner.py_make_scanner, max_depth=20)
+        errors = []
+        def run(depth):
+            try:
+                for i in range(200):
+                    dec.decode(_nested(depth))
+            except Exception, e:
+                errors.append(e)
+        threads = [threading.Thread(target=run, args=(15,)) for i in range(4)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        self.assertEquals(errors, [])
+
+    def test_py_reentrant(self):
+        self._test_reentrant(scanner.py_make_scanner)
+
+    def test_c_reentrant(self):
+        if not scanner.c_make_scanner:
+            return
+        self._test_reentrant(scanner.c_make_scanner)
+
+    def _test_reentrant(self, make_scanner):
+        # A hook that decodes again starts from depth zero
+        dec = self._decoder(make_scanner, max_depth=3,
+                            object_hook=lambda o: dict(o, b=dec.decode('[[1]]')))
+        self.assertEquals(dec.decode('[[{"a": 1}]]'), [[{'a': 1, 'b': [[1]]}]])
+
+    def test_py_max_depth(self):
+        self._test_max_depth(scanner.py_make_scanner)
+
+    def test_c_max_depth(self):
+        if not scanner.c_make_scanner:
+            return
+        self._test_max_depth(scanner.c_make_scanner)
+
+    def _test_max_depth(self, make_scanner):
+        dec = self._decoder(make_scanner, max_depth=3)
+        self.assertEquals(dec.decode('[{"a": [1]}, [], {}]'), [{'a': [1]}, [], {}])
+        for doc in ('[[[[]]]]', '{"a": {"b": {"c": {}}}}', '[1, [2, [3, {"d": 4}]]]'):
+            try:
+                dec.decode(doc)
+            except ValueError, e:
+                self.assert_(str(e).startswith('Maximum nesting depth exceeded'), str(e))
+            else:
+                self.fail('no ValueError for %r' % (doc,))
+        # the limit applies per document, not across calls
+        self.assertEquals(dec.decode('[[[]]]'), [[[]]])
+
+    def test_c_deep(self):
+        if not scanner.c_make_scanner:
+            return
+        # The C scanner keeps open containers on its own stack, not the C stack
+        dec = S.JSONDecoder(max_depth=100000)
+        rval = dec.decode(_nested(100000))
+        for i in range(100000):
+            self.assertEquals(len(rval), 1 if i < 99999 else 0)
+            rval = rval[0] if rval else rval
+        rval = dec.decode('{"a": ' * 50000 + 'null' + '}' * 50000)
+        for i in range(50000):
+            rval = rval['a']
+        self.assertEquals(rval, None)
+
+    def test_invalid(self):
+        self.assertRaises(ValueError, S.JSONDecoder, max_depth=0)
+        dec = S.JSONDecoder()
+        dec.max_depth = -1
+        self.assertRaises(ValueError, scanner.py_make_scanner, dec)
@@ -1,8 +1,14 @@
+import tempfile
 from unittest import TestCase
 from cStringIO import StringIO
 
 import simplejson as S
 
+class PyEncoder(S.JSONEncoder):
+    # dump() writes an overridden iterencode chunk by chunk, never natively
+    def iterencode(self, o, _one_shot=False):
+        return S.JSONEncoder.iterencode(self, o, _one_shot)
+
 class TestDump(TestCase):
     def test_dump(self):
         sio = StringIO()
@@ -11,3 +17,65 @@ class TestDump(TestCase):
     
     def test_dumps(self):
         self.assertEquals(S.dumps({}), '{}')
+
+    def test_py_dump_large(self):
+        self._test_dump_large(PyEncoder)
+
+    def test_c_dump_large(self):
+        if not S.encoder.c_make_encoder:
+            return
+        chunks = self._test_dump_large(S.JSONEncoder)
+        # written in large blocks, not one call per chunk
+        self.assert_(1 < len(chunks) < 100)
+
+    def _test_dump_large(self, cls):
+        obj = [{'key %d' % (i,): [i, i * 0.5, None, u'\u2603' * (i % 7)]}
+               for i in xrange(20000)]
+        class Writer(object):
+            def __init__(self):
+                self.chunks = []
+            def write(self, chunk):
+                self.chunks.append(chunk)
+        w = Writer()
+        S.dump(obj, w, cls=cls, ensure_ascii=False, indent=2)
+        self.assertEquals(u''.join(w.chunks), S.dumps(obj, ensure_ascii=False, indent=2))
+        w = Writer()
+        S.dump(obj, w, cls=cls)
+        self.assertEquals(''.join(w.chunks), S.dumps(obj))
+        return w.chunks
+
+    def test_py_dump_fd(self):
+        self._test_dump_fd(PyEncoder)
+
+    def test_c_dump_fd(self):
+        if not S.encoder.c_make_encoder:
+            return
+        self._test_dump_fd(S.JSONEncoder)
+
+    def _test_dump_fd(self, cls):
+        obj = {'a': [1, 2.5, u'\u00e9\u2603', 'x' * 100000]}
+        f = tempfile.TemporaryFile()
+        try:
+            S.dump(obj, f.fileno(), cls=cls, ensure_ascii=False)
+            f.seek(0)
+            self.assertEquals(f.read(), S.dumps(obj, ensure_ascii=False).encode('utf-8'))
+        finally:
+            f.close()
+
+    def test_dump_write_error(self):
+        class Broken(object):
+            def write(self, chunk):
+                raise IOError('broken')
+        self.assertRaises(IOError, S.dump, range(100000), Broken())
+        self.assertRaises(AttributeError, S.dump, [], object())
+
+    def test_dump_subclass(self):
+        # dump() goes through an overridden iterencode, like dumps() does
+        class Upper(S.JSONEncoder):
+            def iterencode(self, o, _one_shot=False):
+                for chunk in S.JSONEncoder.iterencode(self, o, _one_shot):
+                    yield chunk.upper()
+        sio = StringIO()
+        S.dump({'a': 'b'}, sio, cls=Upper)
+        self.assertEquals(sio.getvalue(), '{"A": "B"}')
+        self.assertEquals(S.dumps({'a': 'b'}, cls=Upper), '{"A": "B"}')
@@ -0,0 +1,42 @@
+from unittest import TestCase
+
+import simplejson as S
+import simplejson.encoder
+
+CASES = [
+    (u'/\\"\ucafe\ubabe\x08\x0c\n\r\t\x00\x1f\x7f`1~!@#$%^&*()_+-=[]{}|;:\',./<>?', u'"/\\\\\\"\ucafe\ubabe\\b\\f\\n\\r\\t\\u0000\\u001f\x7f`1~!@#$%^&*()_+-=[]{}|;:\',./<>?"'),
+    (u'\u0123\u4567\u89ab\ucdef\uabcd\uef4a', u'"\u0123\u4567\u89ab\ucdef\uabcd\uef4a"'),
+    (u'controls', u'"controls"'),
+    (u'\U0001d120', u'"\U0001d120"'),
+    (u'\ud834', u'"\ud834"'),
+    (u'\u03b1\u03a9', u'"\u03b1\u03a9"'),
+    ('\xce\xb1\xce\xa9\n', '"\xce\xb1\xce\xa9\\n"'),
+    ('"quoted"', '"\\"quoted\\""'),
+    ('', '""'),
+]
+
+class TestEncodeBaseString(TestCase):
+    def test_py_encode_basestring(self):
+        self._test_encode_basestring(simplejson.encoder.py_encode_basestring)
+
+    def test_c_encode_basestring(self):
+        if not simplejson.encoder.c_encode_basestring:
+            return
+        self._test_encode_basestring(simplejson.encoder.c_encode_basestring)
+
+    def _test_encode_basestring(self, encode_basestring):
+        fname = encode_basestring.__name__
+        for input_string, expect in CASES:
+            result = encode_basestring(input_string)
+            self.assertEquals(type(result), type(expect))
+            self.assertEquals(result, expect,
+                '%r != %r for %s(%r)' % (result, expect, fname, input_string))
+
+    def test_dumps(self):
+        doc = {u'\u03b1': [u'\u2603\n', 'plain', u'\U0001d120'], 'k': u'\x00'}
+        for kw in [{}, {'sort_keys': True, 'indent': 2}]:
+            j = S.dumps(doc, ensure_ascii=False, **kw)
+            self.assert_(isinstance(j, unicode))
+            self.assert_(u'\u2603' in j)
+            self.assertEquals(S.loads(j), doc)
+        self.assertEquals(S.dumps(['a\xce\xb1'], ensure_ascii=False), '["a\xce\xb1"]')
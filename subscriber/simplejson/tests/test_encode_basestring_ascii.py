@@ -2,6 +2,11 @@ from unittest import TestCase
 
 import simplejson.encoder
 
+try:
+    from simplejson import _speedups
+except ImportError:
+    _speedups = None
+
 CASES = [
     (u'/\\"\ucafe\ubabe\uab98\ufcde\ubcda\uef4a\x08\x0c\n\r\t`1~!@#$%^&*()_+-=[]{}|;:\',./<>?', '"/\\\\\\"\\ucafe\\ubabe\\uab98\\ufcde\\ubcda\\uef4a\\b\\f\\n\\r\\t`1~!@#$%^&*()_+-=[]{}|;:\',./<>?"'),
     (u'\u0123\u4567\u89ab\ucdef\uabcd\uef4a', '"\\u0123\\u4567\\u89ab\\ucdef\\uabcd\\uef4a"'),
@@ -36,3 +41,28 @@ class TestEncodeBaseStringAscii(TestCase):
             result = encode_basestring_ascii(input_string)
             self.assertEquals(result, expect,
                 '%r != %r for %s(%r)' % (result, expect, fname, input_string))
+
+    def test_simd_levels(self):
+        # Every kind of character at every offset around the 16 and 32
+        # byte blocks the vector scans work in, as str and unicode
+        if _speedups is None:
+            return
+        py_encode = simplejson.encoder.py_encode_basestring_ascii
+        c_encode = simplejson.encoder.c_encode_basestring_ascii
+        prev = _speedups.simd_level()
+        try:
+            for level in ('scalar', 'sse2', 'avx2'):
+                try:
+                    _speedups._set_simd_level(level)
+                except ValueError:
+                    continue
+                for n in range(0, 70):
+                    for special in (u'"', u'\\', u'\n', u'\x1f', u' ', u'~', u'\x7f',
+                                    u'\x80', u'\xff', u'\u0100', u'\u2603', u'\U0001d120'):
+                        for s in (u'a' * n + special + u'tail' * 10,
+                                  special * 3 + u'b' * n):
+                            for s in (s, s.encode('utf-8')):
+                                self.assertEquals(c_encode(s), py_encode(s),
+                                    '%r with %s' % (s, level))
+        finally:
+            _speedups._set_simd_level(prev)
@@ -12,3 +12,22 @@ class TestFloat(TestCase):
         for num in [1, 1L, 1<<32, 1<<64]:
             self.assertEquals(S.dumps(num), str(num))
             self.assertEquals(int(S.dumps(num)), num)
+
+    def test_repr(self):
+        # The native formatter must agree with float.__repr__ exactly
+        nums = [0.0, -0.0, 0.1, -1.5, 1e16, 1e15, 9007199254740993.0,
+                1e-4, 1e-5, 1.5e-5, 5e-324, 2.2250738585072014e-308,
+                1.7976931348623157e308, 1617161771.7650001, 1e22, 1e23,
+                123456789012345678.0, 2.0 ** -1074 * 3, math.pi ** 100]
+        nums.extend(math.pi * 10.0 ** e for e in range(-300, 300))
+        nums.extend(1.0 / n for n in range(1, 1000))
+        enc = S.JSONEncoder()
+        for num in nums:
+            self.assertEquals(enc.encode([num, -num]),
+                '[%r, %r]' % (num, -num))
+
+    def test_subclass_repr(self):
+        class F(float):
+            def __repr__(self):
+                return '1.25'
+        self.assertEquals(S.dumps([F(3.0)]), '[1.25]')
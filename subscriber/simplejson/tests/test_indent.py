@@ -39,3 +39,20 @@ class TestIndent(TestCase):
         self.assertEquals(h1, h)
         self.assertEquals(h2, h)
         self.assertEquals(d2, expect)
+
+    def test_indent0(self):
+        h = {3: 1, 'b': [], 'a': [1, {}]}
+        expect = '{\n"3": 1,\n"a": [\n1,\n{}\n],\n"b": []\n}'
+        self.assertEquals(S.dumps(h, indent=0, sort_keys=True, separators=(',', ': ')), expect)
+
+    def test_c_matches_py(self):
+        if S.encoder.c_make_encoder is None:
+            return
+        h = [{'z': [1, 2.5, None], 'a': {'y': u'\u03b1', 'x': [[], {}]}}, 'x', [True]]
+        for kw in ({'indent': 2}, {'indent': 4, 'sort_keys': True},
+                   {'sort_keys': True, 'separators': (',', ':')},
+                   {'indent': 1, 'sort_keys': True, 'ensure_ascii': False}):
+            enc = S.JSONEncoder(**kw)
+            c = enc.encode(h)
+            py = ''.join(enc.iterencode(h))
+            self.assertEquals(c, py)
@@ -0,0 +1,150 @@
+from unittest import TestCase
+
+import simplejson as S
+import simplejson.decoder
+
+DOC = '''
+{"mapreduce_spec": {"name": "cleanup", "mapper_spec": {"mapper_params": {"age_days": 14}},
+                    "params": {"done_callback": "/done", "rate": 1.5e2}},
+ "shards": [{"id": 0, "active": true}, {"id": 1, "active": false}, [], {}, null, "\\u2603"],
+ "esc\\"aped": "a\\\\b", "dup": 1, "dup": 2, "\\u00e9": -3}
+'''
+
+STRUCTURE_ERRORS = ['', '[1, 2', '{"a" 1}', '{"a": 1,}', '[1,]', '[1 2]',
+                    '{1: 2}', '"abc', '[1] 2', ']', '{"a": "b}']
+
+class TestLazyDocument(TestCase):
+    def _docs(self, make, text):
+        for s in (text, text.decode('utf-8')):
+            yield make(S.JSONDecoder(), s)
+
+    def _check(self, lazy, value):
+        # Walk the whole document through the lazy interface
+        if isinstance(value, dict):
+            self.assertEquals(len(lazy), len(value))
+            self.assertEquals(sorted(lazy.keys()), sorted(value))
+            for k in lazy.keys():
+                self.assert_(k in lazy)
+                self._check(lazy[k], value[k])
+        elif isinstance(value, list):
+            self.assertEquals(len(lazy), len(value))
+            for i in range(len(value)):
+                self._check(lazy[i], value[i])
+            for i in range(1, len(value) + 1):
+                self._check(lazy[-i], value[-i])
+        else:
+            self.assertEquals(lazy, value)
+            return
+        self.assertEquals(lazy.load(), value)
+
+    def test_py_matches_loads(self):
+        self._test_matches_loads(simplejson.decoder.py_make_lazy_document)
+
+    def test_c_matches_loads(self):
+        if not simplejson.decoder.c_make_lazy_document:
+            return
+        self._test_matches_loads(simplejson.decoder.c_make_lazy_document)
+
+    def _test_matches_loads(self, make):
+        texts = [DOC, '[]', '{}', ' [[[1], [2, [3]]], {"a": {"b": {}}}] ',
+                 S.dumps([{'k%d' % (i,): range(i)} for i in range(50)])]
+        for text in texts:
+            for lazy in self._docs(make, text):
+                self._check(lazy, S.loads(text))
+
+    def test_py_access(self):
+        self._test_access(simplejson.decoder.py_make_lazy_document)
+
+    def test_c_access(self):
+        if not simplejson.decoder.c_make_lazy_document:
+            return
+        self._test_access(simplejson.decoder.c_make_lazy_document)
+
+    def _test_access(self, make):
+        for doc in self._docs(make, DOC):
+            spec = doc['mapreduce_spec']
+            self.assertEquals(spec['params'].load(), {'done_callback': '/done', 'rate': 150.0})
+            self.assertEquals(spec['mapper_spec']['mapper_params']['age_days'], 14)
+            self.assertEquals(doc['shards'][1]['active'], False)
+            self.assertEquals(doc['shards'][-1], u'\u2603')
+            self.assertEquals(doc['esc"aped'], u'a\\b')
+            self.assertEquals(doc[u'\u00e9'], -3)
+            self.assertEquals(doc['dup'], 2)
+            self.assertEquals(doc.get('missing', 'x'), 'x')
+            self.assertEquals(doc.get('dup'), 2)
+            self.assertEquals(len(doc), 5)
+            self.assertEquals(doc.keys(), ['mapreduce_spec', 'shards', 'esc"aped', 'dup', u'\u00e9'])
+            self.assertRaises(KeyError, doc.__getitem__, 'missing')
+            self.assertRaises(KeyError, doc.__getitem__, 1)
+            self.assertRaises(IndexError, doc['shards'].__getitem__, 6)
+            self.assertRaises(IndexError, doc['shards'].__getitem__, -7)
+            self.assertRaises(TypeError, doc['shards'].__getitem__, 'a')
+            self.assertRaises(TypeError, doc['shards'].keys)
+
+    def test_py_hooks(self):
+        self._test_hooks(simplejson.decoder.py_make_lazy_document)
+
+    def test_c_hooks(self):
+        if not simplejson.decoder.c_make_lazy_document:
+            return
+        self._test_hooks(simplejson.decoder.c_make_lazy_document)
+
+    def _test_hooks(self, make):
+        decoder = S.JSONDecoder(object_hook=lambda d: sorted(d), parse_float=str)
+        doc = make(decoder, DOC)
+        self.assertEquals(doc['mapreduce_spec']['params']['rate'], '1.5e2')
+        self.assertEquals(doc['shards'][0].load(), [u'active', u'id'])
+
+    def test_py_scalar_document(self):
+        self._test_scalar_document(simplejson.decoder.py_make_lazy_document)
+
+    def test_c_scalar_document(self):
+        if not simplejson.decoder.c_make_lazy_document:
+            return
+        self._test_scalar_document(simplejson.decoder.c_make_lazy_document)
+
+    def _test_scalar_document(self, make):
+        for doc in self._docs(make, ' 12 '):
+            self.assertEquals(doc.load(), 12)
+            self.assertRaises(TypeError, len, doc)
+            self.assertRaises(TypeError, doc.__getitem__, 0)
+
+    def _structure_error(self, make, text):
+        try:
+            make(S.JSONDecoder(), text)
+        except ValueError, e:
+            return str(e)
+        self.fail('no ValueError for %r' % (text,))
+
+    def test_py_structure_errors(self):
+        for text in STRUCTURE_ERRORS:
+            self._structure_error(simplejson.decoder.py_make_lazy_document, text)
+
+    def test_c_structure_errors(self):
+        # The C index reports the same errors as the fallback
+        if not simplejson.decoder.c_make_lazy_document:
+            return
+        for text in STRUCTURE_ERRORS:
+            self.assertEquals(
+                self._structure_error(simplejson.decoder.c_make_lazy_document, text),
+                self._structure_error(simplejson.decoder.py_make_lazy_document, text))
+
+    def test_py_values_checked_on_read(self):
+        self._test_values_checked_on_read(simplejson.decoder.py_make_lazy_document)
+
+    def test_c_values_checked_on_read(self):
+        if not simplejson.decoder.c_make_lazy_document:
+            return
+        self._test_values_checked_on_read(simplejson.decoder.c_make_lazy_document)
+
+    def _test_values_checked_on_read(self, make):
+        for doc in self._docs(make, '[1, tru, "\\x", 12abc]'):
+            self.assertEquals(doc[0], 1)
+            self.assertRaises(ValueError, doc.__getitem__, 1)
+            self.assertRaises(ValueError, doc.__getitem__, 2)
+            self.assertRaises(ValueError, doc.__getitem__, 3)
+            self.assertRaises(ValueError, doc.load)
+
+    def test_lazy_decode(self):
+        doc = S.JSONDecoder().lazy_decode(DOC)
+        self.assertEquals(doc['shards'][0]['id'], 0)
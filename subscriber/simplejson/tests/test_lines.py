@@ -0,0 +1,106 @@
+import mmap
+from StringIO import StringIO
+from unittest import TestCase
+
+import simplejson as S
+import simplejson.decoder
+
+TEXT = '{"a": 1, "b": [true, null]}\n\n  [1, 2.5, "x\\ny"] \r\n"\\u2603"\n  \n{}\n42'
+
+class TestLines(TestCase):
+    def _expect(self, text):
+        return [S.loads(line) for line in text.split('\n') if line.strip()]
+
+    def _offsets(self, text):
+        rval = []
+        pos = 0
+        for line in text.split('\n'):
+            if line.strip():
+                rval.append(pos)
+            pos += len(line) + 1
+        return rval
+
+    def test_py_sources(self):
+        self._test_sources(simplejson.decoder.py_make_line_reader)
+
+    def test_c_sources(self):
+        if not simplejson.decoder.c_make_line_reader:
+            return
+        self._test_sources(simplejson.decoder.c_make_line_reader)
+
+    def _test_sources(self, make):
+        expect = self._expect(TEXT)
+        self.assertEquals(list(make(S.JSONDecoder(), TEXT)), expect)
+        self.assertEquals(list(make(S.JSONDecoder(), unicode(TEXT))), expect)
+        self.assertEquals(list(make(S.JSONDecoder(), bytearray(TEXT))), expect)
+        m = mmap.mmap(-1, len(TEXT))
+        m.write(TEXT)
+        self.assertEquals(list(make(S.JSONDecoder(), m)), expect)
+        m.close()
+        for chunk_size in range(1, len(TEXT) + 2):
+            f = StringIO(TEXT)
+            self.assertEquals(list(make(S.JSONDecoder(), f, chunk_size=chunk_size)),
+                              expect)
+
+    def test_decode_lines(self):
+        self.assertEquals(list(S.JSONDecoder().decode_lines(TEXT)), self._expect(TEXT))
+        self.assertEquals(list(S.JSONDecoder().decode_lines(StringIO(''))), [])
+        self.assertEquals(list(S.JSONDecoder().decode_lines('\n \n')), [])
+
+    def test_py_offsets(self):
+        self._test_offsets(simplejson.decoder.py_make_line_reader)
+
+    def test_c_offsets(self):
+        if not simplejson.decoder.c_make_line_reader:
+            return
+        self._test_offsets(simplejson.decoder.c_make_line_reader)
+
+    def _test_offsets(self, make):
+        expect = zip(self._offsets(TEXT), self._expect(TEXT))
+        self.assertEquals(list(make(S.JSONDecoder(), TEXT, True)), expect)
+        for chunk_size in (1, 3, 7, 64):
+            f = StringIO(TEXT)
+            rval = list(make(S.JSONDecoder(), f, True, chunk_size))
+            self.assertEquals(rval, expect)
+            # an offset locates the record's line in the file
+            for offset, obj in rval:
+                f.seek(offset)
+                self.assertEquals(S.loads(f.readline()), obj)
+
+    def test_py_long_record(self):
+        self._test_long_record(simplejson.decoder.py_make_line_reader)
+
+    def test_c_long_record(self):
+        if not simplejson.decoder.c_make_line_reader:
+            return
+        self._test_long_record(simplejson.decoder.c_make_line_reader)
+
+    def _test_long_record(self, make):
+        big = S.dumps([{'k%d' % i: 'v' * i} for i in range(200)])
+        text = '1\n%s\n2\n' % (big,)
+        self.assertEquals(list(make(S.JSONDecoder(), StringIO(text), chunk_size=16)),
+                          [1, S.loads(big), 2])
+
+    def test_py_errors(self):
+        self._test_errors(simplejson.decoder.py_make_line_reader)
+
+    def test_c_errors(self):
+        if not simplejson.decoder.c_make_line_reader:
+            return
+        self._test_errors(simplejson.decoder.c_make_line_reader)
+
+    def _test_errors(self, make):
+        text = '1\n[2,\n3]\n{"a": 1} x\n"ok"\n'
+        reader = make(S.JSONDecoder(), StringIO(text), chunk_size=4)
+        self.assertEquals(reader.next(), 1)
+        for offset in (2, 6, 9):
+            try:
+                reader.next()
+            except ValueError, e:
+                self.assert_(str(e).endswith('(record at offset %d)' % (offset,)), str(e))
+            else:
+                self.fail('no ValueError at offset %d' % (offset,))
+        self.assertEquals(list(reader), [u'ok'])
+        self.assertRaises(TypeError, make, S.JSONDecoder(), 42)
+        self.assertRaises(TypeError, list, make(S.JSONDecoder(), StringIO(u'1')))
+        self.assertRaises(ValueError, make, S.JSONDecoder(), '', chunk_size=0)
@@ -0,0 +1,108 @@
+import datetime
+from decimal import Decimal
+from unittest import TestCase
+
+import simplejson as S
+from simplejson import encoder
+
+class FixedOffset(datetime.tzinfo):
+    def utcoffset(self, dt):
+        return datetime.timedelta(hours=-5)
+
+    def dst(self, dt):
+        return None
+
+class MyDecimal(Decimal):
+    pass
+
+def _native(o, **kw):
+    return S.dumps(o, use_decimal=True, use_datetime=True, use_set=True, **kw)
+
+def _py_native(o, **kw):
+    # iterencode() without _one_shot never uses the C encoder
+    enc = S.JSONEncoder(use_decimal=True, use_datetime=True, use_set=True, **kw)
+    return ''.join(enc.iterencode(o))
+
+class TestNativeTypes(TestCase):
+    def assertEncodes(self, native, o, expect, **kw):
+        self.assertEquals(native(o, **kw), expect)
+
+    def test_py_decimal(self):
+        self._test_decimal(_py_native)
+
+    def test_c_decimal(self):
+        if not encoder.c_make_encoder:
+            return
+        self._test_decimal(_native)
+
+    def _test_decimal(self, native):
+        for text in ['0', '-0', '1.10', '-12.5', '1E+3', '123E-2', '1.000E-7',
+                     '0.000001', '0E-10', '3.14159265358979323846264338327950288',
+                     '123456789012345678901234567890', '1E+999999']:
+            self.assertEncodes(native, Decimal(text), str(Decimal(text)))
+            self.assertEquals(S.loads(native([Decimal(text)]), parse_float=Decimal),
+                              [Decimal(text)])
+        self.assertEncodes(native, MyDecimal('2.50'), '2.50')
+
+    def test_py_decimal_specials(self):
+        self._test_decimal_specials(_py_native)
+
+    def test_c_decimal_specials(self):
+        if not encoder.c_make_encoder:
+            return
+        self._test_decimal_specials(_native)
+
+    def _test_decimal_specials(self, native):
+        self.assertEncodes(native, [Decimal('NaN'), Decimal('-Infinity'), Decimal('Infinity')],
+                           '[NaN, -Infinity, Infinity]')
+        for text in ('NaN', 'sNaN', 'Infinity', '-Infinity'):
+            self.assertRaises(ValueError, native, [Decimal(text)], allow_nan=False)
+
+    def test_py_datetime(self):
+        self._test_datetime(_py_native)
+
+    def test_c_datetime(self):
+        if not encoder.c_make_encoder:
+            return
+        self._test_datetime(_native)
+
+    def _test_datetime(self, native):
+        dt = datetime.datetime(2009, 7, 4, 13, 5, 9)
+        self.assertEncodes(native, dt, '"2009-07-04T13:05:09"')
+        self.assertEncodes(native, dt.replace(microsecond=42), '"2009-07-04T13:05:09.000042"')
+        self.assertEncodes(native, dt.date(), '"2009-07-04"')
+        self.assertEncodes(native, datetime.date(1, 1, 1), '"0001-01-01"')
+        aware = dt.replace(tzinfo=FixedOffset())
+        self.assertEncodes(native, aware, '"2009-07-04T13:05:09-05:00"')
+
+    def test_py_sets(self):
+        self._test_sets(_py_native)
+
+    def test_c_sets(self):
+        if not encoder.c_make_encoder:
+            return
+        self._test_sets(_native)
+
+    def _test_sets(self, native):
+        self.assertEncodes(native, set(), '[]')
+        self.assertEncodes(native, frozenset([1]), '[1]')
+        s = set([1, 2, 3])
+        self.assertEncodes(native, {'a': s}, '{"a": [%s]}' % ', '.join(map(str, s)))
+
+    def test_py_keys(self):
+        self._test_keys(_py_native)
+
+    def test_c_keys(self):
+        if not encoder.c_make_encoder:
+            return
+        self._test_keys(_native)
+
+    def _test_keys(self, native):
+        self.assertEncodes(native, {Decimal('1.50'): 1}, '{"1.50": 1}')
+        self.assertEncodes(native, {datetime.date(2009, 7, 4): 1}, '{"2009-07-04": 1}')
+
+    def test_opt_in(self):
+        for o in (Decimal('1.5'), datetime.date(2009, 7, 4), set([1])):
+            self.assertRaises(TypeError, S.dumps, o)
+            self.assertRaises(TypeError, S.dumps, [o])
+            self.assertEquals(S.dumps([o], default=lambda o: 0), '[0]')
@@ -0,0 +1,159 @@
+from unittest import TestCase
+
+import simplejson as S
+import simplejson.decoder
+
+DOC = '[1, -2.5e3, "a\\"b\\\\", {"k": [true, false, null]}, [], {}, "\\u2603", "]{"]'
+
+class TestPushParser(TestCase):
+    def _feed_all(self, make, text, step, items=False):
+        p = make(S.JSONDecoder(), items)
+        values = []
+        for i in range(0, len(text), step):
+            values.extend(p.feed(text[i:i + step]))
+        values.extend(p.close())
+        return values
+
+    def test_py_items(self):
+        self._test_items(simplejson.decoder.py_make_push_parser)
+
+    def test_c_items(self):
+        if not simplejson.decoder.c_make_push_parser:
+            return
+        self._test_items(simplejson.decoder.c_make_push_parser)
+
+    def _test_items(self, make):
+        expect = S.loads(DOC)
+        for step in range(1, len(DOC) + 1):
+            self.assertEquals(self._feed_all(make, DOC, step, True), expect)
+
+    def test_py_documents(self):
+        self._test_documents(simplejson.decoder.py_make_push_parser)
+
+    def test_c_documents(self):
+        if not simplejson.decoder.c_make_push_parser:
+            return
+        self._test_documents(simplejson.decoder.c_make_push_parser)
+
+    def _test_documents(self, make):
+        text = ' {"a": 1}\n[2] "x" 3 true\n4.5e1 null{}'
+        expect = [{u'a': 1}, [2], u'x', 3, True, 45.0, None, {}]
+        for step in range(1, len(text) + 1):
+            self.assertEquals(self._feed_all(make, text, step), expect)
+
+    def test_py_emits_early(self):
+        self._test_emits_early(simplejson.decoder.py_make_push_parser)
+
+    def test_c_emits_early(self):
+        if not simplejson.decoder.c_make_push_parser:
+            return
+        self._test_emits_early(simplejson.decoder.c_make_push_parser)
+
+    def _test_emits_early(self, make):
+        p = make(S.JSONDecoder(), items=True)
+        self.assertEquals(p.feed('[{"a": 1}, 12'), [{u'a': 1}])
+        self.assertEquals(p.feed(', "x'), [12])
+        self.assertEquals(p.feed('"]'), [u'x'])
+        self.assertEquals(p.close(), [])
+
+    def test_py_empty_items(self):
+        self._test_empty_items(simplejson.decoder.py_make_push_parser)
+
+    def test_c_empty_items(self):
+        if not simplejson.decoder.c_make_push_parser:
+            return
+        self._test_empty_items(simplejson.decoder.c_make_push_parser)
+
+    def _test_empty_items(self, make):
+        self.assertEquals(self._feed_all(make, ' [ ] ', 1, True), [])
+
+    def test_py_errors(self):
+        self._test_errors(simplejson.decoder.py_make_push_parser)
+
+    def test_c_errors(self):
+        if not simplejson.decoder.c_make_push_parser:
+            return
+        self._test_errors(simplejson.decoder.c_make_push_parser)
+
+    def _test_errors(self, make):
+        for text, items in [
+                ('{"a": 1', False),
+                ('"abc', False),
+                ('[1, 2', True),
+                ('[1 2]', True),
+                ('[1,]', True),
+                ('{}', True),
+                ('[1] 2', True),
+                ('[1, tru]', True),
+                ('{"a" 1}', False),
+                (']', False)]:
+            self.assertRaises(ValueError, self._feed_all, make, text, 1, items)
+
+    def test_py_error_offset(self):
+        self._test_error_offset(simplejson.decoder.py_make_push_parser)
+
+    def test_c_error_offset(self):
+        if not simplejson.decoder.c_make_push_parser:
+            return
+        self._test_error_offset(simplejson.decoder.c_make_push_parser)
+
+    def _test_error_offset(self, make):
+        p = make(S.JSONDecoder(), items=True)
+        p.feed('[1, 2, ')
+        try:
+            p.feed(' :')
+        except ValueError, e:
+            self.assertEquals(str(e), 'Expecting value: stream offset 8')
+        else:
+            self.fail('expected ValueError')
+        self.assertRaises(ValueError, p.feed, '3]')
+
+    def test_py_scanner_error(self):
+        self._test_scanner_error(simplejson.decoder.py_make_push_parser)
+
+    def test_c_scanner_error(self):
+        if not simplejson.decoder.c_make_push_parser:
+            return
+        self._test_scanner_error(simplejson.decoder.c_make_push_parser)
+
+    def _test_scanner_error(self, make):
+        # Values completed before the error are returned, the error is
+        # raised by the next call and stops the parser
+        p = make(S.JSONDecoder())
+        self.assertEquals(p.feed('1 2 [3 4] '), [1, 2])
+        try:
+            p.feed('5 ')
+        except ValueError, e:
+            self.assert_(str(e).startswith('Expecting , delimiter: stream offset '), str(e))
+        else:
+            self.fail('expected ValueError')
+        self.assertRaises(ValueError, p.feed, '5 ')
+        self.assertRaises(ValueError, p.close)
+        p = make(S.JSONDecoder(), items=True)
+        p.feed('[1, ')
+        try:
+            p.feed('{"a" 2}]')
+        except ValueError, e:
+            self.assertEquals(str(e), 'Expecting : delimiter: stream offset 9')
+        else:
+            self.fail('expected ValueError')
+        self.assertRaises(ValueError, p.close)
+
+    def test_py_reentrant_feed(self):
+        self._test_reentrant_feed(simplejson.decoder.py_make_push_parser)
+
+    def test_c_reentrant_feed(self):
+        if not simplejson.decoder.c_make_push_parser:
+            return
+        self._test_reentrant_feed(simplejson.decoder.c_make_push_parser)
+
+    def _test_reentrant_feed(self, make):
+        def hook(o):
+            p.feed(' ' * 100000)
+            return o
+        p = make(S.JSONDecoder(object_hook=hook))
+        self.assertRaises(ValueError, p.feed, '{"a": 1}')
+
+    def test_decoder_method(self):
+        p = S.JSONDecoder().push_parser(items=True)
+        self.assertEquals(p.feed('[1, 2]') + p.close(), [1, 2])
@@ -0,0 +1,103 @@
+from unittest import TestCase
+
+import simplejson as S
+from simplejson import encoder
+
+FIELDS = ('time', 'title', 'content', 'source')
+
+class Item(tuple):
+    pass
+
+class TestRecords(TestCase):
+    def assertEncodes(self, make, records, expect, fields=FIELDS, **kw):
+        self.assertEquals(make(S.JSONEncoder(**kw), fields)(records), expect)
+
+    def test_py_records(self):
+        self._test_records(encoder.py_make_record_encoder)
+
+    def test_c_records(self):
+        if not encoder.c_make_record_encoder:
+            return
+        self._test_records(S.JSONEncoder.record_encoder)
+
+    def _test_records(self, make):
+        items = [{'title': 'a', 'time': 1, 'source': None, 'content': [1.5, {'b': 2}]},
+                 (2, u'\u2603', u'x"y', True),
+                 Item(['t', 'c', 's', 3])]
+        self.assertEncodes(make, items,
+            '[{"time": 1, "title": "a", "content": [1.5, {"b": 2}], "source": null}, '
+            '{"time": 2, "title": "\\u2603", "content": "x\\"y", "source": true}, '
+            '{"time": "t", "title": "c", "content": "s", "source": 3}]')
+        self.assertEncodes(make, [], '[]')
+        self.assertEncodes(make, (), '[]')
+        self.assertEncodes(make, iter([(1, 2, 3, 4)]),
+                           '[{"time": 1, "title": 2, "content": 3, "source": 4}]')
+
+    def test_py_other_items(self):
+        self._test_other_items(encoder.py_make_record_encoder)
+
+    def test_c_other_items(self):
+        if not encoder.c_make_record_encoder:
+            return
+        self._test_other_items(S.JSONEncoder.record_encoder)
+
+    def _test_other_items(self, make):
+        # Anything but a record of the declared shape is encoded as usual
+        items = [{'time': 1}, {'time': 1, 'title': 2, 'content': 3, 'other': 4},
+                 [1, 2, 3, 4], 'x', None]
+        self.assertEncodes(make, items, S.dumps(items, sort_keys=True), sort_keys=True)
+
+    def test_py_settings(self):
+        self._test_settings(encoder.py_make_record_encoder)
+
+    def test_c_settings(self):
+        if not encoder.c_make_record_encoder:
+            return
+        self._test_settings(S.JSONEncoder.record_encoder)
+
+    def _test_settings(self, make):
+        items = [(1, [2], u'\xe9', {})]
+        self.assertEncodes(make, items, S.dumps([{'c': 1, 'a': [2], 'd': u'\xe9', 'b': {}}],
+                                                indent=2, sort_keys=True),
+                           fields=('c', 'a', 'd', 'b'), indent=2, sort_keys=True)
+        self.assertEncodes(make, items, '[{"a":1,"b":[2],"c":"\\u00e9","d":{}}]',
+                           fields=('a', 'b', 'c', 'd'), separators=(',', ':'))
+        self.assertEncodes(make, items, u'[{"\xe9": 1, "b": [2], "c": "\xe9", "d": {}}]',
+                           fields=(u'\xe9', 'b', 'c', 'd'), ensure_ascii=False)
+
+    def test_py_circular(self):
+        self._test_circular(encoder.py_make_record_encoder)
+
+    def test_c_circular(self):
+        if not encoder.c_make_record_encoder:
+            return
+        self._test_circular(S.JSONEncoder.record_encoder)
+
+    def _test_circular(self, make):
+        item = {'time': 1, 'title': 2, 'content': 3, 'source': None}
+        item['source'] = item
+        self.assertRaises(ValueError, make(S.JSONEncoder(), FIELDS), [item])
+
+    def test_py_invalid(self):
+        self._test_invalid(encoder.py_make_record_encoder)
+
+    def test_c_invalid(self):
+        if not encoder.c_make_record_encoder:
+            return
+        self._test_invalid(S.JSONEncoder.record_encoder)
+
+    def _test_invalid(self, make):
+        encode = make(S.JSONEncoder(), FIELDS)
+        self.assertRaises(TypeError, encode, 42)
+        self.assertRaises(TypeError, encode, [(1, 2, 3, object())])
+        # a tuple is taken as a record, so its length must match
+        for record in [(1, 2), (1, 2, 3, 4, 5), (), Item([1, 2, 3])]:
+            self.assertRaises(ValueError, encode, [(1, 2, 3, 4), record])
+        self.assertEquals(encode([(1, 2, 3, 4)]),
+                          '[{"time": 1, "title": 2, "content": 3, "source": 4}]')
+
+    def test_invalid_fields(self):
+        enc = S.JSONEncoder()
+        self.assertRaises(ValueError, enc.record_encoder, ())
+        self.assertRaises(ValueError, enc.record_encoder, ('a', 'a'))
+        self.assertRaises(TypeError, enc.record_encoder, ('a', 1))
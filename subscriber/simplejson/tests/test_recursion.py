@@ -63,3 +63,41 @@ class TestRecursion(TestCase):
             pass
         else:
             self.fail("didn't raise ValueError on default recursion")
+
+    def test_deep_recursion(self):
+        # cycles that start below the depth where markers are first checked
+        for depth in (1, 31, 32, 33, 100):
+            x = root = []
+            for i in range(depth):
+                x.append([])
+                x = x[0]
+            x.append(root)
+            self.assertRaises(ValueError, S.dumps, root)
+            d = root = {}
+            for i in range(depth):
+                d['k'] = {}
+                d = d['k']
+            d['k'] = [root]
+            self.assertRaises(ValueError, S.dumps, root)
+
+    def test_deep_shared(self):
+        # the same container twice is not a cycle at any depth
+        shared = [1]
+        x = root = []
+        for i in range(100):
+            child = []
+            x.extend([shared, child, shared])
+            x = child
+        self.assertEquals(S.loads(S.dumps(root)), S.loads(S.dumps(root, check_circular=False)))
+
+    def test_markers_depth(self):
+        if S.encoder.c_make_encoder is None:
+            return
+        x = []
+        x.append(x)
+        for depth in (0, 1, 64):
+            enc = S.encoder.c_make_encoder({}, None, S.encoder.encode_basestring_ascii,
+                None, ':', ',', False, False, True, depth)
+            self.assertEquals(enc.markers_depth, depth)
+            self.assertRaises(ValueError, enc, x, 0)
+            self.assertEquals(enc([[1], [[2]]], 0), ('[[1],[[2]]]',))
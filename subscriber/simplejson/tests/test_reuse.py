@@ -0,0 +1,72 @@
+import gc
+import threading
+import weakref
+from unittest import TestCase
+
+import simplejson as S
+from simplejson import encoder
+
+class TestReuse(TestCase):
+    def test_cached(self):
+        enc = S.JSONEncoder()
+        first = enc._make_encoder(_one_shot=True)
+        if encoder.c_make_encoder is None:
+            return
+        self.assert_(enc._make_encoder(_one_shot=True) is first)
+        enc.encode({'a': [1, 2]})
+        self.assert_(enc._make_encoder(_one_shot=True) is first)
+        self.assert_(S.JSONEncoder()._make_encoder(_one_shot=True) is not first)
+
+    def test_collected(self):
+        # The cached C encoder holds enc.default, a method of enc
+        enc = S.JSONEncoder(indent=2)
+        enc.encode({'a': [1]})
+        enc.items = enc.record_encoder(('a',))
+        ref = weakref.ref(enc)
+        del enc
+        gc.collect()
+        self.assert_(ref() is None)
+        gc.collect()
+        before = len(gc.get_objects())
+        for i in range(1000):
+            S.dumps([i], sort_keys=True)
+        gc.collect()
+        self.assert_(len(gc.get_objects()) - before < 100)
+
+    def test_settings_changed(self):
+        enc = S.JSONEncoder()
+        self.assertEquals(enc.encode({'a': [1]}), '{"a": [1]}')
+        enc.item_separator, enc.key_separator = ',', ':'
+        self.assertEquals(enc.encode({'a': [1, 2]}), '{"a":[1,2]}')
+        enc.indent = 1
+        self.assertEquals(enc.encode([1]), '[\n 1\n]')
+        enc.indent = None
+        enc.default = lambda o: 'x'
+        self.assertEquals(enc.encode([object()]), '["x"]')
+
+    def test_reentrant(self):
+        enc = S.JSONEncoder(default=lambda o: enc.encode(o.items))
+        class Box(object):
+            def __init__(self, items):
+                self.items = items
+        self.assertEquals(enc.encode([1, Box([2, Box([3])])]),
+                          '[1, "[2, \\"[3]\\"]"]')
+
+    def test_threads(self):
+        enc = S.JSONEncoder(sort_keys=True)
+        docs = [dict(('k%d' % j, [i] * j) for j in range(20)) for i in range(8)]
+        expect = [enc.encode(doc) for doc in docs]
+        errors = []
+        def run(i):
+            try:
+                for _ in range(200):
+                    if enc.encode(docs[i]) != expect[i]:
+                        errors.append(i)
+            except Exception, e:
+                errors.append(e)
+        threads = [threading.Thread(target=run, args=(i,)) for i in range(8)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        self.assertEquals(errors, [])
@@ -102,3 +102,19 @@ class TestScanString(TestCase):
         self.assertEquals(
             scanstring('["Bad value", truth]', 2, None, True),
             (u'Bad value', 12))
+
+    def test_long_escaped(self):
+        if not simplejson.decoder.c_scanstring:
+            return
+        c_scanstring = simplejson.decoder.c_scanstring
+        py_scanstring = simplejson.decoder.py_scanstring
+        for n in (1, 100, 255, 256, 257, 2000):
+            for piece in ('a\\n', '<p class=\\"x\\">', '\xc3\xa9\\u2603', '\xf0\x9d\x84\xa0\\t'):
+                doc = '"' + piece * n + '"'
+                for s in (doc, doc.decode('utf-8')):
+                    self.assertEquals(c_scanstring(s, 1, None, True),
+                                      py_scanstring(s, 1, None, True))
+                self.assertEquals(c_scanstring(doc, 1, 'latin-1', True),
+                                  py_scanstring(doc, 1, 'latin-1', True))
+            self.assertRaises(UnicodeDecodeError, c_scanstring,
+                              '"' + 'a\\n' * n + '\xc3(' + '"', 1, None, True)
@@ -0,0 +1,77 @@
+from unittest import TestCase
+
+import simplejson as S
+import simplejson.decoder
+
+try:
+    from simplejson import _speedups
+except ImportError:
+    _speedups = None
+
+LEVELS = ('scalar', 'sse2', 'avx2')
+
+def _bodies():
+    # Put every kind of interesting character at every offset around the
+    # 16 and 32 byte block boundaries, with and without non-ASCII padding.
+    for pad in ('a', u'\xe9', u'\u2603', u'\U0001d120'):
+        for n in range(0, 70):
+            for special in (u'"', u'\\n', u'\\"', u'\\u00e9', u'\x01', u'\x1f', u'\x7f', u'\x80', u'\xff'):
+                yield pad * n + special + u'tail'
+                yield u'x' * n + special + pad * 3
+
+class TestScanStringSIMD(TestCase):
+    def _levels(self):
+        levels = []
+        prev = _speedups.simd_level()
+        try:
+            for level in LEVELS:
+                try:
+                    _speedups._set_simd_level(level)
+                except ValueError:
+                    continue
+                levels.append(level)
+        finally:
+            _speedups._set_simd_level(prev)
+        return levels
+
+    def _scan_all(self, level, strict):
+        prev = _speedups._set_simd_level(level)
+        results = []
+        try:
+            for body in _bodies():
+                for doc in ('"' + body.encode('utf-8') + '"', u'"' + body + u'"'):
+                    try:
+                        results.append(simplejson.decoder.c_scanstring(doc, 1, None, strict))
+                    except ValueError, e:
+                        results.append(str(e))
+        finally:
+            _speedups._set_simd_level(prev)
+        return results
+
+    def test_levels_match_scalar(self):
+        if _speedups is None:
+            return
+        levels = self._levels()
+        self.assert_('scalar' in levels)
+        for strict in (True, False):
+            expect = self._scan_all('scalar', strict)
+            for level in levels:
+                self.assertEquals(self._scan_all(level, strict), expect,
+                    'scanstring differs between scalar and %s' % (level,))
+
+    def test_unterminated(self):
+        if _speedups is None:
+            return
+        for level in self._levels():
+            prev = _speedups._set_simd_level(level)
+            try:
+                for n in range(0, 70):
+                    self.assertRaises(ValueError, S.loads, '"' + 'a' * n)
+                    self.assertRaises(ValueError, S.loads, u'"' + u'\u2603' * n)
+            finally:
+                _speedups._set_simd_level(prev)
+
+    def test_bad_level(self):
+        if _speedups is None:
+            return
+        self.assertRaises(ValueError, _speedups._set_simd_level, 'mmx')
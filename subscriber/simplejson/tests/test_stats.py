@@ -0,0 +1,54 @@
+from unittest import TestCase
+
+import simplejson as S
+
+try:
+    from simplejson import _speedups
+except ImportError:
+    _speedups = None
+
+class TestStats(TestCase):
+    def setUp(self):
+        if _speedups is not None:
+            self.prev = _speedups.enable_stats()
+            _speedups.reset_stats()
+
+    def tearDown(self):
+        if _speedups is not None:
+            _speedups.enable_stats(self.prev)
+            _speedups.reset_stats()
+
+    def test_decode(self):
+        if _speedups is None:
+            return
+        doc = '[{"a": "x\\ny\\u00e9", "b": [1, 2.5]}, {"a": "plain", "b": []}]'
+        S.loads(doc)
+        stats = _speedups.stats()
+        self.assertEquals(stats['bytes_scanned'], len(doc))
+        self.assertEquals(stats['objects'], 5)
+        # "a" and "b" come from the memo the second time
+        self.assertEquals(stats['strings'], 4)
+        self.assertEquals(stats['escapes'], 2)
+        self.assertEquals(stats['callbacks'], 0)
+        S.loads(doc, object_hook=dict, parse_float=float.fromhex)
+        self.assertEquals(_speedups.stats()['callbacks'], 3)
+
+    def test_encode(self):
+        if _speedups is None:
+            return
+        text = S.dumps([1, object(), 1.5], default=lambda o: None)
+        stats = _speedups.stats()
+        self.assertEquals(stats['bytes_encoded'], len(text))
+        self.assertEquals(stats['callbacks'], 1)
+        S.dumps([u'x'], encoding='latin-1')
+        self.assertEquals(_speedups.stats()['fallbacks'], 1)
+
+    def test_disabled(self):
+        if _speedups is None:
+            return
+        _speedups.enable_stats(False)
+        S.loads('{"a": [1, 2, "b"]}')
+        S.dumps({'a': [1, 2, 'b']})
+        self.assertEquals(set(_speedups.stats().values()), set([0]))
+        self.assertEquals(_speedups.enable_stats(), False)
+        self.assertEquals(_speedups.enable_stats(), True)
@@ -0,0 +1,114 @@
+from unittest import TestCase
+
+import simplejson as S
+import simplejson.decoder
+
+VALID = [
+    '{"a": [1, -2.5e3, true, false, null], "b": {"c": "\\u2603\\"\\\\"}}',
+    ' [ ] ', '{}', '"x"', '0', '-0.5E-2', 'NaN', '-Infinity', '"\xc3\xa9"',
+    '"\\ud834\\udd20"', '[[[[[[[[[[1]]]]]]]]]]',
+]
+
+INVALID = [
+    '', ' ', '[1,]', '{"a" 1}', '{"a": 1,}', '[1 2]', '{1: 2}', '"abc',
+    '[1] 2', ']', '01', '1.', '.5', '1e', '-', 'tru', '"\\x"', '"\\u12"',
+    '"\x01"', '"\xc3"', '"\xff"', '"\xc0\x80"',
+]
+
+class TestValidate(TestCase):
+    def test_py_valid(self):
+        self._test_valid(simplejson.decoder.py_validate, simplejson.decoder.py_minify)
+
+    def test_c_valid(self):
+        if not simplejson.decoder.c_validate:
+            return
+        self._test_valid(simplejson.decoder.c_validate, simplejson.decoder.c_minify)
+
+    def _test_valid(self, validate, minify):
+        for doc in VALID:
+            self.assert_(validate(doc), doc)
+            self.assertEquals(minify(doc), simplejson.decoder.py_minify(doc))
+            self.assert_(validate(minify(doc)))
+
+    def test_c_deep(self):
+        # the pure Python scanner runs out of recursion long before this
+        if not simplejson.decoder.c_validate:
+            return
+        validate = simplejson.decoder.c_validate
+        self.assert_(validate('[' * 1000 + ']' * 1000))
+        for doc in ('[' * 1000 + ']' * 999, '[' * 1001 + ']' * 1001,
+                    '{"a": ' * 1001 + '1' + '}' * 1001):
+            self.assertFalse(validate(doc))
+            self.assertRaises(ValueError, simplejson.decoder.c_minify, doc)
+
+    def test_py_invalid(self):
+        self._test_invalid(simplejson.decoder.py_validate, simplejson.decoder.py_minify)
+
+    def test_c_invalid(self):
+        if not simplejson.decoder.c_validate:
+            return
+        self._test_invalid(simplejson.decoder.c_validate, simplejson.decoder.c_minify)
+
+    def _test_invalid(self, validate, minify):
+        for doc in INVALID:
+            self.assertFalse(validate(doc), doc)
+            self.assertRaises(ValueError, minify, doc)
+
+    def test_py_strict(self):
+        self._test_strict(simplejson.decoder.py_validate, simplejson.decoder.py_minify)
+
+    def test_c_strict(self):
+        if not simplejson.decoder.c_validate:
+            return
+        self._test_strict(simplejson.decoder.c_validate, simplejson.decoder.c_minify)
+
+    def _test_strict(self, validate, minify):
+        self.assertFalse(validate('"a\tb"'))
+        self.assert_(validate('"a\tb"', strict=False))
+        self.assertEquals(minify(' [ "a\tb" ] ', strict=False), '["a\tb"]')
+
+    def test_py_minify(self):
+        self._test_minify(simplejson.decoder.py_validate, simplejson.decoder.py_minify)
+
+    def test_c_minify(self):
+        if not simplejson.decoder.c_validate:
+            return
+        self._test_minify(simplejson.decoder.c_validate, simplejson.decoder.c_minify)
+
+    def _test_minify(self, validate, minify):
+        doc = S.dumps({'a b': [1, 2.5, u'\u2603 " \\ x'], 'c': {'d': None}}, indent=4)
+        self.assertEquals(minify(doc), S.dumps(S.loads(doc), separators=(',', ':')))
+        self.assertEquals(minify(doc.decode('utf-8')), minify(doc).decode('utf-8'))
+        self.assertEquals(type(minify(u' 1 ')), unicode)
+        self.assertEquals(type(minify(' 1 ')), str)
+
+    def test_py_type_error(self):
+        self._test_type_error(simplejson.decoder.py_validate, simplejson.decoder.py_minify)
+
+    def test_c_type_error(self):
+        if not simplejson.decoder.c_validate:
+            return
+        self._test_type_error(simplejson.decoder.c_validate, simplejson.decoder.c_minify)
+
+    def _test_type_error(self, validate, minify):
+        self.assertRaises(TypeError, minify, 1)
+
+    def test_py_error_position(self):
+        self._test_error_position(simplejson.decoder.py_minify)
+
+    def test_c_error_position(self):
+        if not simplejson.decoder.c_validate:
+            return
+        self._test_error_position(simplejson.decoder.c_minify)
+
+    def _test_error_position(self, minify):
+        # unicode errors count characters, not UTF-8 bytes
+        for doc, pos in [(u'{"\u2603\u2603": 1,}', 9), (u'{"\xe9": 1,}', 8),
+                         (u'{"\U0001d120": 1,}', len(u'{"\U0001d120": 1,')),
+                         ('{"\xc3\xa9": 1,}', 9)]:
+            try:
+                minify(doc)
+            except ValueError, e:
+                self.assert_(str(e).endswith('(char %d)' % (pos,)), str(e))
+            else:
+                self.fail('minified %r' % (doc,))